@@ -44,11 +44,8 @@ using namespace NVM;
 
 CachedDDR3Bank::CachedDDR3Bank( )
 {
-    cachedRowBuffer = NULL;
-    readOnlyBuffers = true;
-    rowBufferSize = 32;
-    rowBufferCount = 4;
-    
+    rowBufferPolicy = "";
+
     inRDBCount = 0;
     RDBAllocations = 0;
     writebackCount = 0;
@@ -61,40 +58,13 @@ CachedDDR3Bank::CachedDDR3Bank( )
 
 CachedDDR3Bank::~CachedDDR3Bank( )
 {
-    if( cachedRowBuffer )
-    {
-        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-        {
-            delete cachedRowBuffer[bufferIdx]->dirty;
-            delete cachedRowBuffer[bufferIdx];
-        }
-
-        delete [] cachedRowBuffer;
-    }
 }
 
 
 void CachedDDR3Bank::SetConfig( Config *config, bool createChildren )
 {
-    // Assume entire row is cached if CachedRowSize is unset
-    config->GetValueUL( "COLS", rowBufferSize );
-
-    config->GetBool( "CachedRowsReadOnly", readOnlyBuffers );
-    config->GetValueUL( "CachedRowSize", rowBufferSize );
-    config->GetValueUL( "CachedRowCount", rowBufferCount );
-
-    /* Initialize row buffers. */
-    cachedRowBuffer = new CachedRowBuffer*[rowBufferCount];
-    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-    {
-        cachedRowBuffer[bufferIdx] = new CachedRowBuffer;
-        cachedRowBuffer[bufferIdx]->used = false;
-        cachedRowBuffer[bufferIdx]->dirty = new bool[rowBufferSize];
-        for( ncounter_t dirtyIdx = 0; dirtyIdx < rowBufferSize; dirtyIdx++ )
-        {
-            cachedRowBuffer[bufferIdx]->dirty[dirtyIdx] = false;
-        }
-    }
+    rowBuffers.SetConfig( config );
+    rowBufferPolicy = rowBuffers.GetPolicyName( );
 
     DDR3Bank::SetConfig( config, createChildren );
 }
@@ -102,93 +72,16 @@ void CachedDDR3Bank::SetConfig( Config *config, bool createChildren )
 
 bool CachedDDR3Bank::Activate( NVMainRequest *request )
 {
-    bool foundRDB = false;
-
     assert( nextActivate <= GetEventQueue()->GetCurrentCycle() );
 
-    /* See if there is an available row buffer. */
-    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-    {
-        /* Check if this row is already active. For read-only, we must activate to allow for write-through to bank. */
-        if( cachedRowBuffer[bufferIdx]->used && 
-            request->address.GetRow( ) == cachedRowBuffer[bufferIdx]->address.GetRow( ) )
-        {
-            foundRDB = true;
-            break;
-        }
-
-        /* Look for unused buffers. Don't break so the assertion is checked. */
-        if( !cachedRowBuffer[bufferIdx]->used && !foundRDB )
-        {
-            foundRDB = true;
-            cachedRowBuffer[bufferIdx]->used = true;
-            cachedRowBuffer[bufferIdx]->address = request->address;
-            cachedRowBuffer[bufferIdx]->colStart = request->address.GetCol() 
-                                                 - (request->address.GetCol() % rowBufferSize);
-            cachedRowBuffer[bufferIdx]->colEnd = cachedRowBuffer[bufferIdx]->colStart + rowBufferSize;
-            cachedRowBuffer[bufferIdx]->reads = 0;
-            cachedRowBuffer[bufferIdx]->writes = 0;
-
-            RDBAllocations++;
-
-            //std::cout << statName << ": Buffer " << bufferIdx << " bound to address 0x" << std::hex
-            //          << request->address.GetPhysicalAddress( ) << std::dec << " from col "
-            //          << cachedRowBuffer[bufferIdx]->colStart << " to col "
-            //          << cachedRowBuffer[bufferIdx]->colEnd << std::endl;
-
-            break;
-        }
-    }
-
-    /* If we haven't found an RDB, evict the LRU row. */
-    ncounter_t dirtyCount = 0;
-
-    if( !foundRDB )
-    {
-        ncounter_t bufferIdx = rowBufferCount - 1;
-
-        if( allocationReadsMap.count( cachedRowBuffer[bufferIdx]->reads ) )
-            allocationReadsMap[ cachedRowBuffer[bufferIdx]->reads ]++;
-        else
-            allocationReadsMap[ cachedRowBuffer[bufferIdx]->reads ] = 1;
-
-        if( allocationWritesMap.count( cachedRowBuffer[bufferIdx]->writes ) )
-            allocationWritesMap[ cachedRowBuffer[bufferIdx]->writes ]++;
-        else
-            allocationWritesMap[ cachedRowBuffer[bufferIdx]->writes ] = 1;
-
-        cachedRowBuffer[bufferIdx]->used = true;
-        cachedRowBuffer[bufferIdx]->address = request->address;
-        cachedRowBuffer[bufferIdx]->colStart = request->address.GetCol() 
-                                             - (request->address.GetCol() % rowBufferSize);
-        cachedRowBuffer[bufferIdx]->colEnd = cachedRowBuffer[bufferIdx]->colStart + rowBufferSize;
-        cachedRowBuffer[bufferIdx]->reads = 0;
-        cachedRowBuffer[bufferIdx]->writes = 0;
-
-        RDBAllocations++;
-
-        //std::cout << statName << ": Buffer " << bufferIdx << " bound to address 0x" << std::hex
-        //          << request->address.GetPhysicalAddress( ) << std::dec << " from col "
-        //          << cachedRowBuffer[bufferIdx]->colStart << " to col "
-        //          << cachedRowBuffer[bufferIdx]->colEnd << std::endl;
-
-        for( ncounter_t dirtyIdx = 0; dirtyIdx < rowBufferSize; dirtyIdx++ )
-        {
-            if( cachedRowBuffer[bufferIdx]->dirty[dirtyIdx] )
-                dirtyCount++;
-
-            cachedRowBuffer[bufferIdx]->dirty[dirtyIdx] = false;
-        }
-
-        writebackCount += dirtyCount;
-    }
-
-    assert( !(readOnlyBuffers && dirtyCount > 0) );
+    /* Bind a row buffer to the requested segment, writing back any dirty victim. */
+    ncounter_t dirtyCount = rowBuffers.Allocate( request->address );
+    ncounter_t rowBufferSize = rowBuffers.GetSize( );
 
     ncycle_t activateTimer = 0;
 
     /* If dirty, simulate writebacks. */
-    // TODO: Check if row is already activated? It's probably not since LRU is evicted..
+    // TODO: Check if row is already activated? It's probably not since it was the replacement victim..
     if( dirtyCount > 0 )
     {
         activateTimer += p->tRCD;                  /* Time for extra activate */
@@ -244,56 +137,38 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
 
 bool CachedDDR3Bank::Read( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     bool rv = false;
 
     /* Check if this is in the RDB. */
-    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
+    ncounter_t bufferIdx = rowBuffers.Find( request->address );
+
+    if( bufferIdx < rowBuffers.GetCount( ) )
     {
-        if( cachedRowBuffer[bufferIdx]->address.GetRow( ) == request->address.GetRow( )
-            && request->address.GetCol( ) >= cachedRowBuffer[bufferIdx]->colStart
-            && request->address.GetCol( ) <  cachedRowBuffer[bufferIdx]->colEnd )
-        {
-            rv = true;
-
-            /* Only update read and write based on RDB timings; other commands will bypass RDB. */
-            nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
-            nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) + p->tRTRS );
-
-            /* Assume the data is placed on the bus immediately after the command. */
-            NVMainRequest *busReq = new NVMainRequest( );
-            *busReq = *request;
-            busReq->type = BUS_READ;
-            busReq->owner = this;
-
-            GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
-                    GetEventQueue()->GetCurrentCycle() + 1 );
-
-            /* Notify owner of read completion as well */
-            GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                    GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
-
-            /* Swap the cached status back to normal. */
-            request->type = (request->type == CACHED_READ ? READ : request->type);
-
-            //std::cout << GetEventQueue()->GetCurrentCycle() << " " << statName 
-            //          << ": Served read request 0x" << std::hex
-            //          << request->address.GetPhysicalAddress() << std::dec << std::endl;
-            
-            RDBReads++;
-            cachedRowBuffer[bufferIdx]->reads++;
-
-            /* Move this buffer to LRU. */
-            CachedRowBuffer *tempBuffer = cachedRowBuffer[bufferIdx];
-
-            for( uint64_t j = bufferIdx; j > 0; j-- )
-            {
-                cachedRowBuffer[j] = cachedRowBuffer[j-1];
-            }
-
-            cachedRowBuffer[0] = tempBuffer;
-
-            break;
-        }
+        rv = true;
+
+        /* Only update read and write based on RDB timings; other commands will bypass RDB. */
+        nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( burst, p->tRDB ) );
+        nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( burst, p->tRDB ) + p->tRTRS );
+
+        /* Assume the data is placed on the bus immediately after the command. */
+        NVMainRequest *busReq = new NVMainRequest( );
+        *busReq = *request;
+        busReq->type = BUS_READ;
+        busReq->owner = this;
+
+        GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
+                GetEventQueue()->GetCurrentCycle() + 1 );
+
+        /* Notify owner of read completion as well */
+        GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+                GetEventQueue()->GetCurrentCycle() + MAX( burst, p->tRDB ) );
+
+        /* Swap the cached status back to normal. */
+        request->type = (request->type == CACHED_READ ? READ : request->type);
+
+        RDBReads++;
+        rowBuffers.Read( bufferIdx );
     }
 
     if( !rv )
@@ -307,62 +182,39 @@ bool CachedDDR3Bank::Read( NVMainRequest *request )
 
 bool CachedDDR3Bank::Write( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     bool rv = false;
 
     /* Check if this is in the RDB. */
-    if( !readOnlyBuffers )
-    {
-        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-        {
-            if( cachedRowBuffer[bufferIdx]->address.GetRow( ) == request->address.GetRow( )
-                && request->address.GetCol( ) >= cachedRowBuffer[bufferIdx]->colStart
-                && request->address.GetCol( ) <  cachedRowBuffer[bufferIdx]->colEnd )
-            {
-                rv = true;
-
-                /* Only update read and write based on RDB timings; other commands will bypass RDB. */
-                nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) + p->tRTRS );
-                nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
+    ncounter_t bufferIdx = rowBuffers.Find( request->address );
 
-                /* Set this word to be dirty. */
-                cachedRowBuffer[bufferIdx]->dirty[request->address.GetCol( )] = true;
-
-                /* Assume the data is placed on the bus immediately after the command. */
-                NVMainRequest *busReq = new NVMainRequest( );
-                *busReq = *request;
-                busReq->type = BUS_WRITE;
-                busReq->owner = this;
-
-                GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
-                        GetEventQueue()->GetCurrentCycle() + 1 );
-
-                /* Notify owner of read completion as well */
-                GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                        GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
-
-                /* Swap the cached status back to normal. */
-                request->type = (request->type == CACHED_WRITE ? WRITE : request->type);
+    if( !rowBuffers.IsReadOnly( ) && bufferIdx < rowBuffers.GetCount( ) )
+    {
+        rv = true;
 
-                //std::cout << GetEventQueue()->GetCurrentCycle() << " " << statName 
-                //          << ": Served write request 0x" << std::hex
-                //          << request->address.GetPhysicalAddress() << std::dec << std::endl;
+        /* Only update read and write based on RDB timings; other commands will bypass RDB. */
+        nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( burst, p->tRDB ) + p->tRTRS );
+        nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( burst, p->tRDB ) );
 
-                RDBWrites++;
-                cachedRowBuffer[bufferIdx]->writes++;
+        /* Assume the data is placed on the bus immediately after the command. */
+        NVMainRequest *busReq = new NVMainRequest( );
+        *busReq = *request;
+        busReq->type = BUS_WRITE;
+        busReq->owner = this;
 
-                /* Move this buffer to LRU. */
-                CachedRowBuffer *tempBuffer = cachedRowBuffer[bufferIdx];
+        GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
+                GetEventQueue()->GetCurrentCycle() + 1 );
 
-                for( uint64_t j = bufferIdx; j > 0; j-- )
-                {
-                    cachedRowBuffer[j] = cachedRowBuffer[j-1];
-                }
+        /* Notify owner of read completion as well */
+        GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+                GetEventQueue()->GetCurrentCycle() + MAX( burst, p->tRDB ) );
 
-                cachedRowBuffer[0] = tempBuffer;
+        /* Swap the cached status back to normal. */
+        request->type = (request->type == CACHED_WRITE ? WRITE : request->type);
 
-                break;
-            }
-        }
+        RDBWrites++;
+        /* Marks the written column dirty. */
+        rowBuffers.Write( bufferIdx, request->address );
     }
 
     if( !rv )
@@ -377,22 +229,12 @@ bool CachedDDR3Bank::Write( NVMainRequest *request )
 bool CachedDDR3Bank::IsIssuable( NVMainRequest *request, FailReason *reason )
 {
     bool rv = false; 
-    bool inRDB = false;
+    bool inRDB = rowBuffers.Contains( request->address );
     bool cacheableRequest = false;
 
-    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-    {
-        if( cachedRowBuffer[bufferIdx]->address.GetRow( ) == request->address.GetRow( )
-            && request->address.GetCol( ) >= cachedRowBuffer[bufferIdx]->colStart
-            && request->address.GetCol( ) <  cachedRowBuffer[bufferIdx]->colEnd )
-        {
-            inRDB = true;
-        }
-    }
-
     if( request->type == READ || request->type == READ_PRECHARGE || request->type == CACHED_READ ||
-        ( !readOnlyBuffers && (request->type == WRITE || request->type == WRITE_PRECHARGE 
-                               || request->type == CACHED_WRITE )
+        ( !rowBuffers.IsReadOnly( ) && (request->type == WRITE || request->type == WRITE_PRECHARGE 
+                                        || request->type == CACHED_WRITE )
         ) 
       )
     {
@@ -407,11 +249,6 @@ bool CachedDDR3Bank::IsIssuable( NVMainRequest *request, FailReason *reason )
                 request->type == CACHED_READ || request->type == CACHED_WRITE );
         inRDBCount++;
         rv = true;
-
-        //std::cout << GetEventQueue()->GetCurrentCycle() << " " << statName << ": Found 0x"
-        //          << std::hex << request->address.GetPhysicalAddress( ) << std::dec
-        //          << " in RDB. Row = " << request->address.GetRow( ) << " Col = "
-        //          << request->address.GetCol( ) << std::endl;
     }
     else if( request->type != CACHED_READ && request->type != CACHED_WRITE )
     {
@@ -424,6 +261,9 @@ bool CachedDDR3Bank::IsIssuable( NVMainRequest *request, FailReason *reason )
 
 void CachedDDR3Bank::RegisterStats( )
 {
+    DDR3Bank::RegisterStats( );
+
+    AddStat(rowBufferPolicy);
     AddStat(inRDBCount);
     AddStat(RDBAllocations);
     AddStat(writebackCount);
@@ -435,9 +275,10 @@ void CachedDDR3Bank::RegisterStats( )
 
 void CachedDDR3Bank::CalculateStats( )
 {
-    allocationReadsHisto = PyDictHistogram<uint64_t, uint64_t>( allocationReadsMap );
-    allocationWritesHisto = PyDictHistogram<uint64_t, uint64_t>( allocationWritesMap );
-}
-
-
+    DDR3Bank::CalculateStats( );
 
+    RDBAllocations = rowBuffers.GetAllocations( );
+    writebackCount = rowBuffers.GetWritebacks( );
+    allocationReadsHisto = rowBuffers.GetReadsHistogram( );
+    allocationWritesHisto = rowBuffers.GetWritesHistogram( );
+}
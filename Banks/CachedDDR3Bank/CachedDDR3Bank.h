@@ -37,22 +37,11 @@
 #define __CACHEDDDR3BANK_H__
 
 #include "Banks/DDR3Bank/DDR3Bank.h"
+#include "Utils/Caches/RowBufferManager.h"
 
 namespace NVM {
 
 
-struct CachedRowBuffer
-{
-    bool used;
-    NVMAddress address;
-    bool *dirty;
-    ncounter_t colStart;
-    ncounter_t colEnd;
-    ncounter_t reads;
-    ncounter_t writes;
-};
-
-
 class CachedDDR3Bank : public DDR3Bank
 {
   public:
@@ -71,16 +60,12 @@ class CachedDDR3Bank : public DDR3Bank
     virtual void CalculateStats( );
 
   private:
-    CachedRowBuffer **cachedRowBuffer;
-    bool readOnlyBuffers;
-    ncounter_t rowBufferSize;
-    ncounter_t rowBufferCount;
+    RowBufferManager rowBuffers;
+    std::string rowBufferPolicy;
     ncounter_t inRDBCount;
     ncounter_t RDBAllocations;
     ncounter_t writebackCount;
     ncounter_t RDBReads, RDBWrites;
-    std::map<uint64_t, uint64_t> allocationReadsMap; // Number of reads in an allocation, Count
-    std::map<uint64_t, uint64_t> allocationWritesMap;
     std::string allocationReadsHisto;
     std::string allocationWritesHisto;
 
@@ -36,6 +36,7 @@
 #include "Banks/DDR3Bank/DDR3Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <signal.h>
 #include <cassert>
@@ -93,8 +94,17 @@ DDR3Bank::DDR3Bank( )
     slowExitPrechargeCycles = 0;
     writeCycle = false;
     writeMode = WRITE_THROUGH;
+    writeBuffer = NULL;
     idleTimer = 0;
 
+    designatedSubArray = 0;
+    selectPending = false;
+    serialActivate = 0;
+    subArrayConflicts = 0;
+    subArrayOverlapCycles = 0;
+    subArrayOverlapAverage = 0.0;
+    subArraySelects = 0;
+
     reads = 0;
     writes = 0;
     activates = 0;
@@ -113,6 +123,7 @@ DDR3Bank::DDR3Bank( )
 
 DDR3Bank::~DDR3Bank( )
 {
+    delete writeBuffer;
 }
 
 void DDR3Bank::SetConfig( Config *config, bool createChildren )
@@ -128,6 +139,15 @@ void DDR3Bank::SetConfig( Config *config, bool createChildren )
     MATHeight = p->MATHeight;
     subArrayNum = p->ROWS / MATHeight;
 
+    if( config->KeyExists( "WriteMode" ) && config->GetString( "WriteMode" ) == "DelayedWrite" )
+    {
+        writeMode = DELAYED_WRITE;
+
+        /* A bank-wide buffer is handed to every subarray before it is configured. */
+        if( p->writeBufferScope == WriteBufferScope_Bank )
+            writeBuffer = new WriteBuffer( p->WriteBufferEntries );
+    }
+
     if( createChildren )
     {
         /* When selecting a child, use the subarray field from the decoder. */
@@ -155,6 +175,8 @@ void DDR3Bank::SetConfig( Config *config, bool createChildren )
             nextSubArray->SetParent( this );
             AddChild( nextSubArray );
 
+            if( writeBuffer != NULL )
+                nextSubArray->SetWriteBuffer( writeBuffer );
             nextSubArray->SetConfig( config, createChildren );
             nextSubArray->RegisterStats( );
         }
@@ -166,7 +188,7 @@ void DDR3Bank::SetConfig( Config *config, bool createChildren )
 
 void DDR3Bank::RegisterStats( )
 {
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         AddUnitStat(bankEnergy, "mA*t");
         AddUnitStat(activeEnergy, "mA*t");
@@ -209,6 +231,16 @@ void DDR3Bank::RegisterStats( )
 
     AddStat(averageEndurance);
     AddStat(worstCaseEndurance);
+
+    if( p->subArrayParallelism != SubArrayParallelism_Ideal )
+    {
+        AddStat(subArrayConflicts);
+        AddStat(subArrayOverlapCycles);
+        AddStat(subArrayOverlapAverage);
+    }
+
+    if( p->subArrayParallelism == SubArrayParallelism_MASA )
+        AddStat(subArraySelects);
 }
 
 /*
@@ -248,6 +280,10 @@ bool DDR3Bank::PowerDown( NVMainRequest *request )
                     state = DDR3BANK_PDPS;
                     break;
 
+                case POWERDOWN_SREF:
+                    state = DDR3BANK_SREF;
+                    break;
+
                 default:
                     state = DDR3BANK_PDPF;
                     break;
@@ -269,21 +305,28 @@ bool DDR3Bank::PowerUp( NVMainRequest * /*request*/ )
     bool returnValue = false;
 
     if( nextPowerUp <= GetEventQueue()->GetCurrentCycle() 
-        && ( state == DDR3BANK_PDPF || state == DDR3BANK_PDPS || state == DDR3BANK_PDA ) )
+        && ( state == DDR3BANK_PDPF || state == DDR3BANK_PDPS || state == DDR3BANK_PDA 
+             || state == DDR3BANK_SREF ) )
     {
+        /* Self-refresh exit takes tXS, and tXSDLL for commands needing the DLL. */
+        ncycle_t tExit = ( state == DDR3BANK_SREF ) ? p->tXS : p->tXP;
+
         /* Update timing constraints */
         nextPowerDown = MAX( nextPowerDown, 
-                             GetEventQueue()->GetCurrentCycle() + p->tXP );
+                             GetEventQueue()->GetCurrentCycle() + tExit );
 
         nextActivate = MAX( nextActivate, 
-                            GetEventQueue()->GetCurrentCycle() + p->tXP );
+                            GetEventQueue()->GetCurrentCycle() + tExit );
 
         nextPrecharge = MAX( nextPrecharge, 
-                             GetEventQueue()->GetCurrentCycle() + p->tXP );
+                             GetEventQueue()->GetCurrentCycle() + tExit );
         nextWrite = MAX( nextWrite, 
-                         GetEventQueue()->GetCurrentCycle() + p->tXP );
+                         GetEventQueue()->GetCurrentCycle() + tExit );
 
-        if( state == DDR3BANK_PDPS )
+        if( state == DDR3BANK_SREF )
+            nextRead = MAX( nextRead, 
+                            GetEventQueue()->GetCurrentCycle() + p->tXSDLL );
+        else if( state == DDR3BANK_PDPS )
             nextRead = MAX( nextRead, 
                             GetEventQueue()->GetCurrentCycle() + p->tXPDLL );
         else
@@ -344,6 +387,9 @@ bool DDR3Bank::Activate( NVMainRequest *request )
     nextPowerDown = MAX( nextPowerDown, 
                          GetEventQueue()->GetCurrentCycle() + p->tRCD );
 
+    if( p->subArrayParallelism != SubArrayParallelism_Ideal )
+        CountSubArrayOverlap( activateSubArray );
+
     /* issue ACTIVATE to the target subarray */
     bool success = GetChild( request )->IssueCommand( request );
 
@@ -354,6 +400,10 @@ bool DDR3Bank::Activate( NVMainRequest *request )
         state = DDR3BANK_OPEN;
         activeSubArrayQueue.push_front( activateSubArray );
         activates++;
+
+        /* The activated subarray drives the global bitlines (MASA). */
+        designatedSubArray = activateSubArray;
+        selectPending = false;
     }
     else
     {
@@ -369,6 +419,8 @@ bool DDR3Bank::Activate( NVMainRequest *request )
  */
 bool DDR3Bank::Read( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
+
     /* TODO: Can we remove this sanity check and totally trust IsIssuable()? */
     /* sanity check */
     if( nextRead > GetEventQueue()->GetCurrentCycle() )
@@ -377,7 +429,7 @@ bool DDR3Bank::Read( NVMainRequest *request )
             << std::endl;
         return false;
     }
-    else if( state != DDR3BANK_OPEN )
+    else if( state != DDR3BANK_OPEN && !IsBuffered( request ) )
     {
         std::cerr << "NVMain Error: try to read a bank that is not active!"
             << std::endl;
@@ -392,24 +444,24 @@ bool DDR3Bank::Read( NVMainRequest *request )
     {
         nextPowerDown = MAX( nextPowerDown, 
                              GetEventQueue()->GetCurrentCycle() 
-                                 + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
+                                 + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
                                  + p->tAL + p->tRTP + p->tRP );
     }
     else
     {
         nextPowerDown = MAX( nextPowerDown, 
-                             MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
+                             MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
                              + GetEventQueue()->GetCurrentCycle() + p->tRDPDEN );
     }
 
     nextRead = MAX( nextRead, 
                     GetEventQueue()->GetCurrentCycle() 
-                        + MAX( p->tBURST, p->tCCD ) * request->burstCount );
+                        + MAX( burst, p->tCCD_L ) * request->burstCount );
 
     nextWrite = MAX( nextWrite, 
                      GetEventQueue()->GetCurrentCycle()
-                         + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                         + p->tCAS + p->tBURST + p->tRTRS - p->tCWD );
+                         + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                         + p->tCAS + burst + p->tRTRS - p->tCWD );
 
     /* issue READ/READ_RECHARGE to the target subarray */
     bool success = GetChild( request )->IssueCommand( request );
@@ -432,12 +484,15 @@ bool DDR3Bank::Read( NVMainRequest *request )
                 }
             }
 
+            CloseSubArray( readSubArray );
+
             if( activeSubArrayQueue.empty() )
                 state = DDR3BANK_CLOSED;
         } // if( request->type == READ_PRECHARGE )
 
-        dataCycles += p->tBURST;
+        dataCycles += burst;
         reads++;
+        selectPending = false;
     } // if( succsss )
     else
     {
@@ -453,6 +508,8 @@ bool DDR3Bank::Read( NVMainRequest *request )
  */
 bool DDR3Bank::Write( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
+
     /* TODO: Can we remove this sanity check and totally trust IsIssuable()? */
     /* sanity check */
     if( nextWrite > GetEventQueue()->GetCurrentCycle() )
@@ -461,7 +518,7 @@ bool DDR3Bank::Write( NVMainRequest *request )
             << std::endl;
         return false;
     }
-    else if( state != DDR3BANK_OPEN )
+    else if( state != DDR3BANK_OPEN && !IsBuffered( request ) )
     {
         std::cerr << "NVMain Error: try to read a bank that is not active!"
             << std::endl;
@@ -477,35 +534,36 @@ bool DDR3Bank::Write( NVMainRequest *request )
     {
         nextPowerDown = MAX( nextActivate, 
                              GetEventQueue()->GetCurrentCycle()
-                             + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                             + p->tAL + p->tCWD + p->tBURST + p->tWR 
+                             + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                             + p->tAL + p->tCWD + burst + p->tWR 
                              + p->tRP );
     }
     /* else, no implicit precharge is enabled, simply update the timing */
     else
     {
         nextPowerDown = MAX( nextPowerDown, 
-                             MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
+                             MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
                              + GetEventQueue()->GetCurrentCycle() + p->tWRPDEN );
     }
 
     nextRead = MAX( nextRead, 
                     GetEventQueue()->GetCurrentCycle() 
-                    + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                    + p->tCWD + p->tBURST + p->tWTR );
+                    + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                    + p->tCWD + burst + p->tWTR_L );
 
     nextWrite = MAX( nextWrite, 
                      GetEventQueue()->GetCurrentCycle() 
-                     + MAX( p->tBURST, p->tCCD ) * request->burstCount );
+                     + MAX( burst, p->tCCD_L ) * request->burstCount );
 
     /* issue WRITE/WRITE_PRECHARGE to the target subarray */
     bool success = GetChild( request )->IssueCommand( request );
 
     if( success )
     {
-        dataCycles += p->tBURST;
+        dataCycles += burst;
         writeCycle = true;
         writes++;
+        selectPending = false;
 
         if( request->type == WRITE_PRECHARGE )
         {
@@ -524,6 +582,8 @@ bool DDR3Bank::Write( NVMainRequest *request )
                 }
             }
 
+            CloseSubArray( writeSubArray );
+
             if( activeSubArrayQueue.empty( ) )
                 state = DDR3BANK_CLOSED;
         }
@@ -586,6 +646,8 @@ bool DDR3Bank::Precharge( NVMainRequest *request )
                     break;
                 }
             }
+
+            CloseSubArray( preSubArray );
         }
         else
         {
@@ -617,6 +679,8 @@ bool DDR3Bank::Precharge( NVMainRequest *request )
                     return false;
                 }
 
+                CloseSubArray( openedSubArray );
+
                 //precharges++;
             }
 
@@ -632,6 +696,8 @@ bool DDR3Bank::Precharge( NVMainRequest *request )
                 return false;
             }
 
+            CloseSubArray( openedSubArray );
+
             assert( activeSubArrayQueue.empty( ) );
         } // if( activeSubArrayQueue.empty( ) == false )
     } // if( request->type == PRECHARGE_ALL )
@@ -651,6 +717,77 @@ bool DDR3Bank::Precharge( NVMainRequest *request )
     return true;
 }
 
+/*
+ *  SelectSubArray() connects an open subarray to the global bitlines
+ *  (MASA). Column commands of the bank wait tSA for the switch.
+ */
+bool DDR3Bank::SelectSubArray( NVMainRequest *request )
+{
+    ncounter_t selectSubArray;
+    request->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, NULL, &selectSubArray );
+
+    nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + p->tSA );
+    nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + p->tSA );
+
+    designatedSubArray = selectSubArray;
+    selectPending = true;
+    subArraySelects++;
+
+    /* The select belongs to the memory controller, which deletes it. */
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+            GetEventQueue()->GetCurrentCycle() + MAX( 1, p->tSA ) );
+
+    return true;
+}
+
+SubArray *DDR3Bank::GetSubArray( ncounter_t subArrayId )
+{
+    return dynamic_cast<SubArray *>( GetChild( subArrayId )->GetTrampoline( ) );
+}
+
+/*
+ *  With one open row per bank, the next activate of any subarray waits for
+ *  the precharge. The serialized bank is also tracked for the statistics.
+ */
+void DDR3Bank::CloseSubArray( ncounter_t subArrayId )
+{
+    if( p->subArrayParallelism == SubArrayParallelism_Ideal )
+        return;
+
+    ncycle_t closed = GetSubArray( subArrayId )->GetNextActivate( );
+
+    serialActivate = MAX( serialActivate, closed );
+
+    if( p->subArrayParallelism == SubArrayParallelism_None )
+        nextActivate = MAX( nextActivate, closed );
+}
+
+/*
+ *  Counts how much earlier an activate issues than it could in a bank with
+ *  one open row, i.e., after precharging every other subarray.
+ */
+void DDR3Bank::CountSubArrayOverlap( ncounter_t activateSubArray )
+{
+    ncycle_t now = GetEventQueue()->GetCurrentCycle();
+    ncycle_t serialCycle = serialActivate;
+
+    std::deque<ncounter_t>::iterator it;
+    for( it = activeSubArrayQueue.begin( ); it != activeSubArrayQueue.end( ); ++it )
+    {
+        if( (*it) == activateSubArray )
+            continue;
+
+        ncycle_t precharge = MAX( now, GetSubArray( *it )->GetNextPrecharge( ) );
+        serialCycle = MAX( serialCycle, precharge + p->tRP );
+    }
+
+    if( serialCycle > now )
+    {
+        subArrayConflicts++;
+        subArrayOverlapCycles += serialCycle - now;
+    }
+}
+
 /* 
  * Refresh() is simply treated as a Activate()
  */
@@ -725,7 +862,8 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     {
         /* if the bank-level nextActive is not satisfied, cannot issue */
         if( nextActivate > ( GetEventQueue()->GetCurrentCycle() ) 
-            || state == DDR3BANK_PDPF || state == DDR3BANK_PDPS || state == DDR3BANK_PDA )
+            || state == DDR3BANK_PDPF || state == DDR3BANK_PDPS || state == DDR3BANK_PDA 
+            || state == DDR3BANK_SREF )
 
         {
             rv = false;
@@ -735,6 +873,17 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
             actWaits++;
             actWaitTotal += nextActivate - (GetEventQueue()->GetCurrentCycle());
         }
+        /* Without MASA at most one row is open, or two while SALP-2 switches rows. */
+        else if( ( ( p->subArrayParallelism == SubArrayParallelism_None 
+                     || p->subArrayParallelism == SubArrayParallelism_SALP1 )
+                   && !activeSubArrayQueue.empty( ) )
+                 || ( p->subArrayParallelism == SubArrayParallelism_SALP2
+                      && activeSubArrayQueue.size( ) > 1 ) )
+        {
+            rv = false;
+            if( reason ) 
+                reason->reason = BANK_TIMING;
+        }
         else
         {
             rv = GetChild( req )->IsIssuable( req, reason );
@@ -743,7 +892,8 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     else if( req->type == READ || req->type == READ_PRECHARGE )
     {
         if( nextRead > (GetEventQueue()->GetCurrentCycle()) 
-            || state != DDR3BANK_OPEN  )
+            || ( state != DDR3BANK_OPEN && !IsBuffered( req ) ) 
+            || !IsColumnSubArray( req ) )
         {
             rv = false;
             if( reason ) 
@@ -757,7 +907,8 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
     {
         if( nextWrite > (GetEventQueue()->GetCurrentCycle()) 
-            || state != DDR3BANK_OPEN )
+            || ( state != DDR3BANK_OPEN && !IsBuffered( req ) ) 
+            || !IsColumnSubArray( req ) )
         {
             rv = false;
             if( reason ) 
@@ -800,11 +951,13 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     }
     else if( req->type == POWERDOWN_PDA 
              || req->type == POWERDOWN_PDPF 
-             || req->type == POWERDOWN_PDPS )
+             || req->type == POWERDOWN_PDPS
+             || req->type == POWERDOWN_SREF )
     {
         if( nextPowerDown > (GetEventQueue()->GetCurrentCycle()) 
             || ( state != DDR3BANK_CLOSED && state != DDR3BANK_OPEN ) 
-            || ( ( req->type == POWERDOWN_PDPF || req->type == POWERDOWN_PDPS ) 
+            || ( ( req->type == POWERDOWN_PDPF || req->type == POWERDOWN_PDPS 
+                   || req->type == POWERDOWN_SREF ) 
                 && state == DDR3BANK_OPEN ) )
         {
             rv = false;
@@ -821,10 +974,21 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
             }
         }
     }
+    else if( req->type == SUBARRAY_SELECT )
+    {
+        /* The previous select waits for its column command. */
+        if( state != DDR3BANK_OPEN || selectPending )
+        {
+            rv = false;
+            if( reason ) 
+                reason->reason = BANK_TIMING;
+        }
+    }
     else if( req->type == POWERUP )
     {
         if( nextPowerUp > (GetEventQueue()->GetCurrentCycle()) 
-            || ( state != DDR3BANK_PDPF && state != DDR3BANK_PDPS && state != DDR3BANK_PDA ) )
+            || ( state != DDR3BANK_PDPF && state != DDR3BANK_PDPS && state != DDR3BANK_PDA 
+                 && state != DDR3BANK_SREF ) )
         {
             rv = false;
             if( reason ) 
@@ -863,6 +1027,42 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     return rv;
 }
 
+/*
+ *  Column commands need the subarray to be the only open one (SALP-2) or
+ *  the designated one (MASA).
+ */
+bool DDR3Bank::IsColumnSubArray( NVMainRequest *req )
+{
+    if( IsBuffered( req ) )
+        return true;
+
+    if( p->subArrayParallelism == SubArrayParallelism_SALP2 )
+        return ( activeSubArrayQueue.size( ) <= 1 );
+
+    if( p->subArrayParallelism == SubArrayParallelism_MASA )
+        return ( req->address.GetSubArray( ) == designatedSubArray );
+
+    return true;
+}
+
+/*
+ *  Column commands queued without an activate are served by the write buffer
+ *  of the subarray, so the bank only needs to be powered up.
+ */
+bool DDR3Bank::IsBuffered( NVMainRequest *req )
+{
+    if( writeMode != DELAYED_WRITE || !( req->flags & NVMainRequest::FLAG_CACHED )
+        || ( state != DDR3BANK_OPEN && state != DDR3BANK_CLOSED ) )
+    {
+        return false;
+    }
+
+    ncounter_t subarray;
+    req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, NULL, &subarray );
+
+    return GetSubArray( subarray )->IsBuffered( req );
+}
+
 /*
  * IssueCommand() issue the command so that bank status will be updated
  */
@@ -906,6 +1106,7 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
             case POWERDOWN_PDA:
             case POWERDOWN_PDPF:
             case POWERDOWN_PDPS:
+            case POWERDOWN_SREF:
                 rv = this->PowerDown( req );
                 break;
 
@@ -913,6 +1114,10 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
                 rv = this->PowerUp( req );
                 break;
 
+            case SUBARRAY_SELECT:
+                rv = this->SelectSubArray( req );
+                break;
+
             default:
                 rv = GetChild( req )->IssueCommand( req );
                 break;  
@@ -940,7 +1145,7 @@ void DDR3Bank::CalculatePower( )
         return;
     }
 
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         bankPower = ( bankEnergy * p->Voltage ) / (double)simulationTime / 1000.0f; 
         activePower = ( activeEnergy * p->Voltage ) / (double)simulationTime / 1000.0f; 
@@ -956,6 +1161,26 @@ void DDR3Bank::CalculatePower( )
     }
 }
 
+/* Sums the energy of all subarrays without going through the stats. */
+void DDR3Bank::GetEnergy( double& total, double& activate, double& burst, double& refresh )
+{
+    total = activate = burst = refresh = 0.0;
+
+    for( ncounter_t saIdx = 0; saIdx < subArrayNum; saIdx++ )
+    {
+        SubArray *subArray = dynamic_cast<SubArray *>( GetChild( saIdx )->GetTrampoline( ) );
+        double saTotal, saActivate, saBurst, saRefresh;
+
+        assert( subArray != NULL );
+        subArray->GetEnergy( saTotal, saActivate, saBurst, saRefresh );
+
+        total += saTotal;
+        activate += saActivate;
+        burst += saBurst;
+        refresh += saRefresh;
+    }
+}
+
 double DDR3Bank::GetPower( )
 {
     CalculatePower( );
@@ -1001,21 +1226,7 @@ void DDR3Bank::CalculateStats( )
     else
         utilization = 0.0f;
 
-    bankEnergy = activeEnergy = burstEnergy = refreshEnergy 
-               = 0.0f;
-
-    for( unsigned saIdx = 0; saIdx < subArrayNum; saIdx++ )
-    {
-        StatType saEstat  = GetStat( GetChild(saIdx), "subArrayEnergy" );
-        StatType actEstat = GetStat( GetChild(saIdx), "activeEnergy" );
-        StatType bstEstat = GetStat( GetChild(saIdx), "burstEnergy" );
-        StatType refEstat = GetStat( GetChild(saIdx), "refreshEnergy" );
-
-        bankEnergy += CastStat( saEstat, double );
-        activeEnergy += CastStat( actEstat, double );
-        burstEnergy += CastStat( bstEstat, double );
-        refreshEnergy += CastStat( refEstat, double );
-    }
+    GetEnergy( bankEnergy, activeEnergy, burstEnergy, refreshEnergy );
 
     CalculatePower( );
 
@@ -1036,6 +1247,12 @@ void DDR3Bank::CalculateStats( )
         averageEndurance += CastStat( subArrayAverageEndr, uint64_t );
     }
     averageEndurance /= GetChildCount( );
+
+    if( subArrayConflicts > 0 )
+    {
+        subArrayOverlapAverage = static_cast<double>(subArrayOverlapCycles) 
+                               / static_cast<double>(subArrayConflicts);
+    }
 }
 
 
@@ -1072,3 +1289,59 @@ void DDR3Bank::Cycle( ncycle_t steps )
     else if( state == DDR3BANK_CLOSED )
         standbyCycles += steps;
 }
+
+/*
+ *  Save the bank state and open subarrays. Power-down states are kept since
+ *  the controller checkpoints which ranks it powered down.
+ */
+void DDR3Bank::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        uint64_t openSubArrays = activeSubArrayQueue.size( );
+        std::deque<ncounter_t>::iterator it;
+
+        cpt.Write( state );
+        cpt.Write( openRow );
+        cpt.Write( openSubArrays );
+
+        for( it = activeSubArrayQueue.begin( ); it != activeSubArrayQueue.end( ); it++ )
+            cpt.Write( *it );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void DDR3Bank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        uint64_t openSubArrays = 0;
+
+        cpt.Read( state );
+        cpt.Read( openRow );
+        cpt.Read( openSubArrays );
+
+        activeSubArrayQueue.clear( );
+
+        for( uint64_t i = 0; i < openSubArrays && cpt.Good( ); i++ )
+        {
+            ncounter_t subArrayId = 0;
+
+            cpt.Read( subArrayId );
+            activeSubArrayQueue.push_back( subArrayId );
+        }
+
+        if( !cpt.Good( ) )
+        {
+            std::cout << StatName( ) << ": Warning: Checkpoint is incomplete." 
+                      << std::endl;
+        }
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
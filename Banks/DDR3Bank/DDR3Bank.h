@@ -71,7 +71,8 @@ enum DDR3BankState
     DDR3BANK_CLOSED,   /***< Bank is idle. */
     DDR3BANK_PDPF,     /***< Bank is in precharge powered down, fast exit mode */
     DDR3BANK_PDA,      /***< Bank is in active powered down mode */
-    DDR3BANK_PDPS      /***< Bank is in precharge powered down, slow exit mode */
+    DDR3BANK_PDPS,     /***< Bank is in precharge powered down, slow exit mode */
+    DDR3BANK_SREF      /***< Bank is in self-refresh */
 };
 
 class DDR3Bank : public Bank
@@ -92,6 +93,9 @@ class DDR3Bank : public Bank
     virtual ncycle_t GetDataCycles( ) { return dataCycles; }
     virtual void CalculatePower( );
     virtual double GetPower( ); 
+    virtual void GetEnergy( double& total, double& activate, double& burst, double& refresh );
+    virtual ncounter_t GetReads( ) { return reads; }
+    virtual ncounter_t GetWrites( ) { return writes; }
 
     virtual uint64_t GetOpenRow( ) { return openRow; }
     virtual std::deque<ncounter_t>& GetOpenSubArray( ) { return activeSubArrayQueue; }
@@ -102,6 +106,9 @@ class DDR3Bank : public Bank
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+
     virtual ncounter_t GetId( );
     virtual std::string GetName( );
 
@@ -137,6 +144,15 @@ class DDR3Bank : public Bank
     ncycle_t nextPowerUp;
     bool writeCycle;
     WriteMode writeMode;
+    WriteBuffer *writeBuffer;
+
+    ncounter_t designatedSubArray;
+    bool selectPending;
+    ncycle_t serialActivate;
+    ncounter_t subArrayConflicts;
+    ncounter_t subArrayOverlapCycles;
+    double subArrayOverlapAverage;
+    ncounter_t subArraySelects;
 
     ncounter_t actWaits;
     ncounter_t actWaitTotal;
@@ -172,6 +188,13 @@ class DDR3Bank : public Bank
     virtual bool Refresh( NVMainRequest *request );
     virtual bool PowerUp( NVMainRequest *request );
     virtual bool PowerDown( NVMainRequest *request );
+    virtual bool SelectSubArray( NVMainRequest *request );
+
+    bool IsBuffered( NVMainRequest *req );
+    bool IsColumnSubArray( NVMainRequest *req );
+    SubArray *GetSubArray( ncounter_t subArrayId );
+    void CloseSubArray( ncounter_t subArrayId );
+    void CountSubArrayOverlap( ncounter_t activateSubArray );
 };
 
 };
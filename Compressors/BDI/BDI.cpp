@@ -0,0 +1,151 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Compressors/BDI/BDI.h"
+
+using namespace NVM;
+
+BDI::BDI( )
+{
+    decompressionLatency = 1;
+}
+
+void BDI::SetConfig( Config *conf, bool createChildren )
+{
+    Compressor::SetConfig( conf, createChildren );
+
+    if( conf->KeyExists( "BDILatency" ) )
+        decompressionLatency = conf->GetValueUL( "BDILatency" );
+}
+
+/* Reads a little-endian value of the given width. */
+static uint64_t LoadValue( const uint8_t *data, ncounter_t width )
+{
+    uint64_t value = 0;
+
+    for( ncounter_t byte = 0; byte < width; byte++ )
+        value |= static_cast<uint64_t>(data[byte]) << ( 8 * byte );
+
+    return value;
+}
+
+/* Whether the difference of two width-byte values fits a signed delta. */
+static bool DeltaFits( uint64_t value, uint64_t base, ncounter_t width, 
+                       ncounter_t deltaBytes )
+{
+    uint64_t diff = value - base;
+
+    if( width < 8 )
+    {
+        uint64_t mask = ( 1ULL << ( 8 * width ) ) - 1;
+
+        diff &= mask;
+        if( diff >> ( 8 * width - 1 ) )
+            diff |= ~mask;
+    }
+
+    int64_t delta = static_cast<int64_t>(diff);
+    int64_t limit = static_cast<int64_t>( 1ULL << ( 8 * deltaBytes - 1 ) );
+
+    return ( delta >= -limit && delta < limit );
+}
+
+ncounter_t BDI::BaseDeltaSize( const uint8_t *line, ncounter_t bytes, 
+                               ncounter_t baseBytes, ncounter_t deltaBytes )
+{
+    ncounter_t values = bytes / baseBytes;
+    uint64_t base = 0;
+    bool haveBase = false;
+
+    for( ncounter_t idx = 0; idx < values; idx++ )
+    {
+        uint64_t value = LoadValue( line + idx * baseBytes, baseBytes );
+
+        /* Values close to zero use the implicit zero base. */
+        if( DeltaFits( value, 0, baseBytes, deltaBytes ) )
+            continue;
+
+        if( !haveBase )
+        {
+            base = value;
+            haveBase = true;
+        }
+        else if( !DeltaFits( value, base, baseBytes, deltaBytes ) )
+        {
+            return bytes;
+        }
+    }
+
+    /* The base, the deltas and one bit per value to select the base. */
+    return baseBytes + values * deltaBytes + ( values + 7 ) / 8;
+}
+
+ncounter_t BDI::CompressedSize( const uint8_t *line, ncounter_t bytes, 
+                                ncycle_t& latency )
+{
+    static const ncounter_t encodings[6][2] = { { 8, 1 }, { 8, 2 }, { 8, 4 },
+                                                { 4, 1 }, { 4, 2 }, { 2, 1 } };
+    ncounter_t best = bytes;
+    bool zeros = true, repeated = true;
+
+    latency = decompressionLatency;
+
+    if( bytes % 8 != 0 )
+        return bytes;
+
+    for( ncounter_t byte = 0; byte < bytes; byte++ )
+    {
+        if( line[byte] != 0 )
+            zeros = false;
+
+        if( line[byte] != line[byte % 8] )
+            repeated = false;
+    }
+
+    if( zeros )
+        return 1;
+
+    if( repeated )
+        return 8;
+
+    for( ncounter_t encoding = 0; encoding < 6; encoding++ )
+    {
+        ncounter_t size = BaseDeltaSize( line, bytes, encodings[encoding][0], 
+                                         encodings[encoding][1] );
+
+        if( size < best )
+            best = size;
+    }
+
+    return best;
+}
@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Compressors/FPC/FPC.h"
+
+using namespace NVM;
+
+FPC::FPC( )
+{
+    decompressionLatency = 5;
+}
+
+void FPC::SetConfig( Config *conf, bool createChildren )
+{
+    Compressor::SetConfig( conf, createChildren );
+
+    if( conf->KeyExists( "FPCLatency" ) )
+        decompressionLatency = conf->GetValueUL( "FPCLatency" );
+}
+
+/* Whether value is the sign extension of its low 'bits' bits. */
+static bool SignExtends( uint32_t value, unsigned int bits )
+{
+    int32_t signedValue = static_cast<int32_t>(value);
+    int32_t limit = static_cast<int32_t>( 1U << ( bits - 1 ) );
+
+    return ( signedValue >= -limit && signedValue < limit );
+}
+
+ncounter_t FPC::CompressedSize( const uint8_t *line, ncounter_t bytes, 
+                                ncycle_t& latency )
+{
+    ncounter_t words = bytes / 4;
+    ncounter_t bits = 0;
+    ncounter_t zeroRun = 0;
+
+    latency = decompressionLatency;
+
+    if( bytes % 4 != 0 )
+        return bytes;
+
+    for( ncounter_t idx = 0; idx < words; idx++ )
+    {
+        const uint8_t *data = line + idx * 4;
+        uint32_t word = static_cast<uint32_t>(data[0]) 
+                      | ( static_cast<uint32_t>(data[1]) << 8 )
+                      | ( static_cast<uint32_t>(data[2]) << 16 )
+                      | ( static_cast<uint32_t>(data[3]) << 24 );
+        uint16_t low = static_cast<uint16_t>( word & 0xFFFF );
+        uint16_t high = static_cast<uint16_t>( word >> 16 );
+
+        /* Runs of up to eight zero words share one prefix and a 3-bit length. */
+        if( word == 0 )
+        {
+            if( zeroRun == 0 )
+                bits += 3 + 3;
+
+            zeroRun = ( zeroRun + 1 ) % 8;
+            continue;
+        }
+
+        zeroRun = 0;
+
+        if( SignExtends( word, 4 ) )
+            bits += 3 + 4;
+        else if( SignExtends( word, 8 ) )
+            bits += 3 + 8;
+        else if( SignExtends( word, 16 ) )
+            bits += 3 + 16;
+        else if( low == 0 )
+            bits += 3 + 16;
+        else if( static_cast<int16_t>(low) == static_cast<int8_t>(low & 0xFF)
+                 && static_cast<int16_t>(high) == static_cast<int8_t>(high & 0xFF) )
+            bits += 3 + 16;
+        else if( data[0] == data[1] && data[0] == data[2] && data[0] == data[3] )
+            bits += 3 + 8;
+        else
+            bits += 3 + 32;
+    }
+
+    return ( bits + 7 ) / 8;
+}
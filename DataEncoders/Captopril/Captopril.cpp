@@ -0,0 +1,181 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/Captopril/Captopril.h"
+#include "src/Checkpoint.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+using namespace NVM;
+
+Captopril::Captopril( )
+{
+    hotWeight = 4.0;
+    hotThreshold = 2.0;
+    epoch = 1024;
+    programmedPartitions = 0;
+}
+
+void Captopril::SetConfig( Config *config, bool createChildren )
+{
+    ncounter_t granularity = 32;
+
+    DataComparisonEncoder::SetConfig( config, createChildren );
+
+    if( config->KeyExists( "CaptoprilGranularity" ) )
+        granularity = config->GetValueUL( "CaptoprilGranularity" );
+
+    if( config->KeyExists( "CaptoprilHotWeight" ) )
+        hotWeight = config->GetEnergy( "CaptoprilHotWeight" );
+
+    if( config->KeyExists( "CaptoprilHotThreshold" ) )
+        hotThreshold = config->GetEnergy( "CaptoprilHotThreshold" );
+
+    if( config->KeyExists( "CaptoprilEpoch" ) )
+        epoch = config->GetValueUL( "CaptoprilEpoch" );
+
+    if( epoch == 0 || hotWeight < 1.0 )
+    {
+        std::cerr << "Captopril: CaptoprilEpoch must be non-zero and "
+                  << "CaptoprilHotWeight at least 1." << std::endl;
+        exit(1);
+    }
+
+    SetLayout( "Captopril", granularity, 2 );
+
+    positionFlips.assign( lineBytes * 8, 0 );
+    hotPositions.assign( ( lineBytes + 7 ) / 8, 0 );
+    hotPart.assign( partitionWords, 0 );
+}
+
+void Captopril::Apply( ncounter_t candidate, uint64_t *part )
+{
+    if( candidate == 1 )
+        Invert( part );
+}
+
+double Captopril::Cost( ncounter_t partition, const uint64_t *stored, 
+                        const uint64_t *encoded, uint64_t oldTag, uint64_t tag )
+{
+    double hotFlips = 0.0;
+
+    Extract( hotPositions, partition, &hotPart[0] );
+
+    for( ncounter_t word = 0; word < partitionWords; word++ )
+        hotFlips += static_cast<double>( PopCount( ( stored[word] ^ encoded[word] ) 
+                                                   & hotPart[word] ) );
+
+    return DataComparisonEncoder::Cost( partition, stored, encoded, oldTag, tag )
+         + ( hotWeight - 1.0 ) * hotFlips;
+}
+
+void Captopril::Programmed( ncounter_t partition, const uint64_t *stored, 
+                            const uint64_t *encoded )
+{
+    for( ncounter_t word = 0; word < partitionWords; word++ )
+    {
+        uint64_t flips = stored[word] ^ encoded[word];
+
+        while( flips != 0 )
+        {
+            /* Index of the lowest set bit. */
+            uint64_t bit = PopCount( ( flips & ( ~flips + 1 ) ) - 1 );
+
+            positionFlips[partition * partitionBits + word * 64 + bit]++;
+            flips &= flips - 1;
+        }
+    }
+
+    programmedPartitions++;
+    if( programmedPartitions % ( epoch * partitions ) == 0 )
+        FindHotPositions( );
+}
+
+void Captopril::FindHotPositions( )
+{
+    uint64_t total = 0;
+    double limit;
+
+    for( ncounter_t position = 0; position < positionFlips.size( ); position++ )
+        total += positionFlips[position];
+
+    limit = hotThreshold * static_cast<double>(total) 
+          / static_cast<double>(positionFlips.size( ));
+
+    std::fill( hotPositions.begin( ), hotPositions.end( ), 0 );
+
+    for( ncounter_t position = 0; position < positionFlips.size( ); position++ )
+    {
+        if( total != 0 && static_cast<double>(positionFlips[position]) > limit )
+            hotPositions[position / 64] |= ( 1ULL << ( position % 64 ) );
+    }
+}
+
+void Captopril::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    std::map<uint64_t, uint64_t> flips;
+
+    DataComparisonEncoder::WriteCheckpoint( cpt );
+
+    for( ncounter_t position = 0; position < positionFlips.size( ); position++ )
+    {
+        if( positionFlips[position] != 0 )
+            flips[position] = positionFlips[position];
+    }
+
+    cpt.WriteMap( flips );
+    cpt.Write( programmedPartitions );
+}
+
+bool Captopril::ReadCheckpoint( CheckpointReader& cpt )
+{
+    std::map<uint64_t, uint64_t> flips;
+    std::map<uint64_t, uint64_t>::iterator it;
+    bool rv = DataComparisonEncoder::ReadCheckpoint( cpt );
+
+    rv = cpt.ReadMap( flips ) && rv;
+    rv = cpt.Read( programmedPartitions ) && rv;
+
+    std::fill( positionFlips.begin( ), positionFlips.end( ), 0 );
+    for( it = flips.begin( ); it != flips.end( ); ++it )
+    {
+        if( it->first < positionFlips.size( ) )
+            positionFlips[it->first] = it->second;
+    }
+
+    FindHotPositions( );
+
+    return rv;
+}
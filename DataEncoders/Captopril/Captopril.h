@@ -0,0 +1,82 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_CAPTOPRIL_H__
+#define __NVMAIN_CAPTOPRIL_H__
+
+#include "DataEncoders/DataComparisonEncoder/DataComparisonEncoder.h"
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Captopril (Jalili and Sarbazi-Azad, DATE 2016): like Flip-N-Write, but
+ *  flips at hot bit positions of the line cost CaptoprilHotWeight times
+ *  as much. A position is hot when it was programmed more than
+ *  CaptoprilHotThreshold times the average; hot positions are found
+ *  again every CaptoprilEpoch writes.
+ */
+class Captopril : public DataComparisonEncoder
+{
+  public:
+    Captopril( );
+    ~Captopril( ) { }
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
+  protected:
+    void Apply( ncounter_t candidate, uint64_t *part );
+    double Cost( ncounter_t partition, const uint64_t *stored, 
+                 const uint64_t *encoded, uint64_t oldTag, uint64_t tag );
+    void Programmed( ncounter_t partition, const uint64_t *stored, 
+                     const uint64_t *encoded );
+
+  private:
+    double hotWeight;
+    double hotThreshold;
+    ncounter_t epoch;
+    ncounter_t programmedPartitions;
+
+    std::vector<uint64_t> positionFlips;
+    std::vector<uint64_t> hotPositions;
+    std::vector<uint64_t> hotPart;
+
+    void FindHotPositions( );
+};
+
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/Coset/Coset.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace NVM;
+
+void Coset::SetConfig( Config *config, bool createChildren )
+{
+    const uint64_t patterns[] = { 0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL,
+                                  0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL,
+                                  0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL,
+                                  0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL };
+    ncounter_t granularity = 64;
+    ncounter_t count = 4;
+    uint64_t seed = 1;
+
+    DataComparisonEncoder::SetConfig( config, createChildren );
+
+    if( config->KeyExists( "CosetGranularity" ) )
+        granularity = config->GetValueUL( "CosetGranularity" );
+
+    if( config->KeyExists( "CosetCount" ) )
+        count = config->GetValueUL( "CosetCount" );
+
+    if( count < 2 || count > 256 )
+    {
+        std::cerr << "Coset: CosetCount must be between 2 and 256." << std::endl;
+        exit(1);
+    }
+
+    cosets.clear( );
+    for( ncounter_t index = 0; index < count; index++ )
+    {
+        if( index < sizeof(patterns) / sizeof(patterns[0]) )
+        {
+            cosets.push_back( patterns[index] );
+        }
+        else
+        {
+            /* splitmix64 */
+            uint64_t z = ( seed += 0x9E3779B97F4A7C15ULL );
+
+            z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+            z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+            cosets.push_back( z ^ ( z >> 31 ) );
+        }
+    }
+
+    SetLayout( "Coset", granularity, count );
+}
+
+void Coset::Apply( ncounter_t candidate, uint64_t *part )
+{
+    uint64_t coset = cosets[candidate] & partitionMask;
+
+    for( ncounter_t word = 0; word < partitionWords; word++ )
+        part[word] ^= coset;
+}
@@ -0,0 +1,376 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/DataComparisonEncoder/DataComparisonEncoder.h"
+#include "include/NVMainRequest.h"
+#include "include/NVMDataBlock.h"
+#include "src/Checkpoint.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+using namespace NVM;
+
+DataComparisonEncoder::DataComparisonEncoder( )
+{
+    partitionBits = 64;
+    partitionWords = 1;
+    partitions = 0;
+    candidates = 1;
+    tagBits = 0;
+    partitionMask = ~0ULL;
+
+    tagCost = true;
+    costMode = COST_FLIPS;
+
+    readLatency = 0;
+    writeLatency = 0;
+    lineBytes = 0;
+
+    dataBitsProgrammed = 0;
+    unencodedBits = 0;
+
+    encodedWrites = 0;
+    bitsProgrammed = 0;
+    setsProgrammed = 0;
+    resetsProgrammed = 0;
+    tagBitsProgrammed = 0;
+    encoderEnergy = 0.0;
+    averageBitsProgrammed = 0.0;
+    totalCellWriteTime = 0;
+    averageCellWriteTime = 0.0;
+    encoderCycles = 0;
+}
+
+void DataComparisonEncoder::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    Params *params = new Params( );
+    params->SetParams( config );
+    SetParams( params );
+
+    if( config->KeyExists( "DataEncoderReadLatency" ) )
+        readLatency = config->GetValueUL( "DataEncoderReadLatency" );
+
+    if( config->KeyExists( "DataEncoderWriteLatency" ) )
+        writeLatency = config->GetValueUL( "DataEncoderWriteLatency" );
+
+    if( config->KeyExists( "DataEncoderCost" ) )
+    {
+        std::string cost = config->GetString( "DataEncoderCost" );
+
+        if( cost == "Flips" )
+            costMode = COST_FLIPS;
+        else if( cost == "Energy" )
+            costMode = COST_ENERGY;
+        else if( cost == "Latency" )
+            costMode = COST_LATENCY;
+        else
+        {
+            std::cerr << "DataComparisonEncoder: Unknown DataEncoderCost '" << cost
+                      << "'. Use Flips, Energy or Latency." << std::endl;
+            exit(1);
+        }
+    }
+
+    lineBytes = p->BusWidth * p->nominalBURST * p->RATE / 8;
+}
+
+void DataComparisonEncoder::SetLayout( std::string name, ncounter_t bits, ncounter_t count )
+{
+    ncounter_t lineBits = lineBytes * 8;
+    bool wordField = ( bits != 0 && bits <= 64 && ( 64 % bits ) == 0 );
+
+    if( !( wordField || ( bits % 64 ) == 0 ) || bits == 0 
+        || ( lineBits % bits ) != 0 || count == 0 )
+    {
+        std::cerr << name << ": Granularity " << bits << " must divide 64 or be a "
+                  << "multiple of 64 and divide the " << lineBits << "-bit line." 
+                  << std::endl;
+        exit(1);
+    }
+
+    partitionBits = bits;
+    partitionWords = ( bits < 64 ) ? 1 : bits / 64;
+    partitionMask = ( bits < 64 ) ? ( ( 1ULL << bits ) - 1 ) : ~0ULL;
+    partitions = lineBits / bits;
+    candidates = count;
+
+    tagBits = 0;
+    while( ( 1ULL << tagBits ) < candidates )
+        tagBits++;
+
+    tags.SetSize( p->COLS * partitions, ( tagBits == 0 ) ? 1 : tagBits );
+
+    oldLine.assign( ( lineBytes + 7 ) / 8, 0 );
+    newLine.assign( ( lineBytes + 7 ) / 8, 0 );
+    stored.assign( partitionWords, 0 );
+    encoded.assign( partitionWords, 0 );
+    best.assign( partitionWords, 0 );
+}
+
+void DataComparisonEncoder::RegisterStats( )
+{
+    AddStat(encodedWrites);
+    AddStat(bitsProgrammed);
+    AddStat(setsProgrammed);
+    AddStat(resetsProgrammed);
+    AddStat(tagBitsProgrammed);
+    AddStat(unencodedBits);
+    AddStat(averageBitsProgrammed);
+    AddUnitStat(encoderEnergy, "nJ");
+    AddStat(averageCellWriteTime);
+    AddStat(encoderCycles);
+}
+
+void DataComparisonEncoder::CalculateStats( )
+{
+    if( encodedWrites != 0 )
+    {
+        averageBitsProgrammed = static_cast<double>(bitsProgrammed) 
+                              / static_cast<double>(encodedWrites);
+        averageCellWriteTime = static_cast<double>(totalCellWriteTime) 
+                             / static_cast<double>(encodedWrites);
+    }
+}
+
+ncycle_t DataComparisonEncoder::Read( NVMainRequest* /*request*/ )
+{
+    encoderCycles += readLatency;
+
+    return readLatency;
+}
+
+ncycle_t DataComparisonEncoder::Write( NVMainRequest *request )
+{
+    NVMDataBlock& newData = request->data;
+    NVMDataBlock& oldData = request->oldData;
+    uint64_t row, col;
+    ncounter_t sets = 0, resets = 0;
+
+    encoderCycles += writeLatency;
+
+    if( newData.rawData == NULL || newData.GetSize( ) < lineBytes || partitions == 0 )
+        return writeLatency;
+
+    request->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
+
+    LoadLine( newData, newLine );
+    LoadLine( oldData, oldLine );
+
+    for( ncounter_t partition = 0; partition < partitions; partition++ )
+    {
+        uint64_t index = col * partitions + partition;
+        uint64_t oldTag = tags.Get( row, index );
+        uint64_t bestTag = 0;
+        double bestCost = std::numeric_limits<double>::infinity( );
+
+        /* Unencoded flips are what a plain data-comparison write programs. */
+        Extract( oldLine, partition, &stored[0] );
+        Extract( newLine, partition, &encoded[0] );
+
+        for( ncounter_t word = 0; word < partitionWords; word++ )
+            unencodedBits += PopCount( stored[word] ^ encoded[word] );
+
+        Apply( oldTag, &stored[0] );
+
+        for( ncounter_t candidate = 0; candidate < candidates; candidate++ )
+        {
+            double cost;
+
+            Extract( newLine, partition, &encoded[0] );
+            Apply( candidate, &encoded[0] );
+
+            cost = Cost( partition, &stored[0], &encoded[0], oldTag, candidate );
+
+            if( cost < bestCost )
+            {
+                bestCost = cost;
+                bestTag = candidate;
+                best = encoded;
+            }
+        }
+
+        ncounter_t dataSets = CountSets( &stored[0], &best[0] );
+        ncounter_t dataResets = CountResets( &stored[0], &best[0] );
+        ncounter_t tagSets = PopCount( ~oldTag & bestTag );
+        ncounter_t tagResets = PopCount( oldTag & ~bestTag );
+
+        dataBitsProgrammed += dataSets + dataResets;
+        tagBitsProgrammed += tagSets + tagResets;
+        sets += dataSets + tagSets;
+        resets += dataResets + tagResets;
+
+        Programmed( partition, &stored[0], &best[0] );
+
+        Insert( oldLine, partition, &stored[0] );
+        Insert( newLine, partition, &best[0] );
+        tags.Set( row, index, bestTag );
+    }
+
+    /* Hand the stored form of both the old and new data to the subarray. */
+    StoreLine( newData, newLine );
+    if( oldData.IsValid( ) && oldData.GetSize( ) >= lineBytes )
+        StoreLine( oldData, oldLine );
+
+    encodedWrites++;
+    bitsProgrammed += sets + resets;
+    setsProgrammed += sets;
+    resetsProgrammed += resets;
+    encoderEnergy += p->Eset * static_cast<double>(sets) 
+                   + p->Ereset * static_cast<double>(resets);
+
+    /* SET pulses take tWP1 and RESET pulses tWP0; both kinds run in parallel. */
+    totalCellWriteTime += MAX( ( sets != 0 ) ? p->tWP1 : 0, 
+                               ( resets != 0 ) ? p->tWP0 : 0 );
+
+    return writeLatency;
+}
+
+double DataComparisonEncoder::Cost( ncounter_t /*partition*/, const uint64_t *stored, 
+                                    const uint64_t *encoded, uint64_t oldTag, uint64_t tag )
+{
+    double sets = static_cast<double>( CountSets( stored, encoded ) );
+    double resets = static_cast<double>( CountResets( stored, encoded ) );
+    double rv;
+
+    if( tagCost )
+    {
+        sets += static_cast<double>( PopCount( ~oldTag & tag ) );
+        resets += static_cast<double>( PopCount( oldTag & ~tag ) );
+    }
+
+    if( costMode == COST_ENERGY )
+    {
+        rv = p->Eset * sets + p->Ereset * resets;
+    }
+    else if( costMode == COST_LATENCY )
+    {
+        /* Any SET pulse makes the write slow, so fewer SETs always win. */
+        rv = sets * static_cast<double>( partitionBits + tagBits + 1 ) + sets + resets;
+    }
+    else
+    {
+        rv = sets + resets;
+    }
+
+    return rv;
+}
+
+ncounter_t DataComparisonEncoder::CountSets( const uint64_t *stored, const uint64_t *encoded )
+{
+    ncounter_t count = 0;
+
+    for( ncounter_t word = 0; word < partitionWords; word++ )
+        count += PopCount( ~stored[word] & encoded[word] );
+
+    return count;
+}
+
+ncounter_t DataComparisonEncoder::CountResets( const uint64_t *stored, const uint64_t *encoded )
+{
+    ncounter_t count = 0;
+
+    for( ncounter_t word = 0; word < partitionWords; word++ )
+        count += PopCount( stored[word] & ~encoded[word] );
+
+    return count;
+}
+
+void DataComparisonEncoder::Invert( uint64_t *part )
+{
+    for( ncounter_t word = 0; word < partitionWords; word++ )
+        part[word] = ~part[word] & partitionMask;
+}
+
+/* Missing data reads as zero. Byte i holds bits 8i to 8i+7 of the line. */
+void DataComparisonEncoder::LoadLine( NVMDataBlock& data, std::vector<uint64_t>& line )
+{
+    std::fill( line.begin( ), line.end( ), 0 );
+
+    if( data.IsValid( ) && data.rawData != NULL )
+    {
+        for( ncounter_t byte = 0; byte < lineBytes && byte < data.GetSize( ); byte++ )
+            line[byte / 8] |= static_cast<uint64_t>( data.rawData[byte] ) << ( ( byte % 8 ) * 8 );
+    }
+}
+
+void DataComparisonEncoder::StoreLine( NVMDataBlock& data, std::vector<uint64_t>& line )
+{
+    for( ncounter_t byte = 0; byte < lineBytes; byte++ )
+        data.rawData[byte] = static_cast<uint8_t>( line[byte / 8] >> ( ( byte % 8 ) * 8 ) );
+}
+
+void DataComparisonEncoder::Extract( std::vector<uint64_t>& line, ncounter_t partition, 
+                                     uint64_t *part )
+{
+    if( partitionBits >= 64 )
+    {
+        for( ncounter_t word = 0; word < partitionWords; word++ )
+            part[word] = line[partition * partitionWords + word];
+    }
+    else
+    {
+        uint64_t bit = partition * partitionBits;
+
+        part[0] = ( line[bit / 64] >> ( bit % 64 ) ) & partitionMask;
+    }
+}
+
+void DataComparisonEncoder::Insert( std::vector<uint64_t>& line, ncounter_t partition, 
+                                    const uint64_t *part )
+{
+    if( partitionBits >= 64 )
+    {
+        for( ncounter_t word = 0; word < partitionWords; word++ )
+            line[partition * partitionWords + word] = part[word];
+    }
+    else
+    {
+        uint64_t bit = partition * partitionBits;
+
+        line[bit / 64] = ( line[bit / 64] & ~( partitionMask << ( bit % 64 ) ) )
+                       | ( part[0] << ( bit % 64 ) );
+    }
+}
+
+void DataComparisonEncoder::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    tags.WriteCheckpoint( cpt );
+}
+
+bool DataComparisonEncoder::ReadCheckpoint( CheckpointReader& cpt )
+{
+    return tags.ReadCheckpoint( cpt );
+}
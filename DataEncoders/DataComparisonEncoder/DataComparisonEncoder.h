@@ -0,0 +1,143 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __DATACOMPARISONENCODER_H__
+#define __DATACOMPARISONENCODER_H__
+
+#include "src/DataEncoder.h"
+#include "DataEncoders/DataComparisonEncoder/FlipStateMap.h"
+#include <vector>
+
+namespace NVM {
+
+class NVMDataBlock;
+
+/*
+ *  Base for encoders which compare the new data with the stored data and
+ *  only program cells that change. Every write is split into partitions;
+ *  for each partition the encoder offers a set of candidate encodings and
+ *  the cheapest one is stored, with its index kept as the partition tag.
+ *  Partitions are handled as 64-bit words, either a field of one word or
+ *  a run of whole words.
+ */
+class DataComparisonEncoder : public DataEncoder
+{
+  public:
+    DataComparisonEncoder( );
+    virtual ~DataComparisonEncoder( ) { }
+
+    virtual void SetConfig( Config *config, bool createChildren = true );
+
+    ncycle_t Read( NVMainRequest *request );
+    ncycle_t Write( NVMainRequest *request );
+
+    virtual void RegisterStats( );
+    virtual void CalculateStats( );
+
+    virtual void WriteCheckpoint( CheckpointWriter& cpt );
+    virtual bool ReadCheckpoint( CheckpointReader& cpt );
+
+  protected:
+    enum EncoderCost { COST_FLIPS, COST_ENERGY, COST_LATENCY };
+
+    ncounter_t partitionBits;
+    ncounter_t partitionWords;
+    ncounter_t partitions;
+    ncounter_t candidates;
+    unsigned int tagBits;
+    uint64_t partitionMask;
+
+    /* Whether programming the tag cells counts towards the cost. */
+    bool tagCost;
+    EncoderCost costMode;
+
+    /* Sets the partition size and number of candidates; call from SetConfig. */
+    void SetLayout( std::string name, ncounter_t bits, ncounter_t count );
+
+    /* Turns the partition data into candidate number 'candidate' in place. */
+    virtual void Apply( ncounter_t candidate, uint64_t *part ) = 0;
+
+    virtual double Cost( ncounter_t partition, const uint64_t *stored, 
+                         const uint64_t *encoded, uint64_t oldTag, uint64_t tag );
+
+    /* Called with the chosen encoding of each partition. */
+    virtual void Programmed( ncounter_t /*partition*/, const uint64_t * /*stored*/,
+                             const uint64_t * /*encoded*/ ) { }
+
+    /* Word kernels; partitions keep unused high bits at zero. */
+    static inline uint64_t PopCount( uint64_t x )
+    {
+        x = x - ( ( x >> 1 ) & 0x5555555555555555ULL );
+        x = ( x & 0x3333333333333333ULL ) + ( ( x >> 2 ) & 0x3333333333333333ULL );
+        x = ( x + ( x >> 4 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+
+        return ( x * 0x0101010101010101ULL ) >> 56;
+    }
+
+    ncounter_t CountSets( const uint64_t *stored, const uint64_t *encoded );
+    ncounter_t CountResets( const uint64_t *stored, const uint64_t *encoded );
+    void Invert( uint64_t *part );
+
+    void Extract( std::vector<uint64_t>& line, ncounter_t partition, uint64_t *part );
+    void Insert( std::vector<uint64_t>& line, ncounter_t partition, const uint64_t *part );
+
+    ncounter_t lineBytes;
+    ncounter_t dataBitsProgrammed;
+    ncounter_t unencodedBits;
+
+  private:
+    ncycle_t readLatency, writeLatency;
+
+    FlipStateMap tags;
+
+    std::vector<uint64_t> oldLine, newLine;
+    std::vector<uint64_t> stored, encoded, best;
+
+    ncounter_t encodedWrites;
+    ncounter_t bitsProgrammed;
+    ncounter_t setsProgrammed;
+    ncounter_t resetsProgrammed;
+    ncounter_t tagBitsProgrammed;
+    double encoderEnergy;
+    double averageBitsProgrammed;
+    ncycle_t totalCellWriteTime;
+    double averageCellWriteTime;
+    ncounter_t encoderCycles;
+
+    void LoadLine( NVMDataBlock& data, std::vector<uint64_t>& line );
+    void StoreLine( NVMDataBlock& data, std::vector<uint64_t>& line );
+};
+
+};
+
+#endif
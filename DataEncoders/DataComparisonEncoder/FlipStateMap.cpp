@@ -0,0 +1,127 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/DataComparisonEncoder/FlipStateMap.h"
+#include "src/Checkpoint.h"
+
+using namespace NVM;
+
+FlipStateMap::FlipStateMap( )
+{
+    rowWords = 0;
+    fieldBits = 0;
+    fieldMask = 0;
+}
+
+/* Fields never straddle two words, so the field width must divide 64. */
+void FlipStateMap::SetSize( uint64_t partitionsPerRow, unsigned int bitsPerPartition )
+{
+    fieldBits = 1;
+    while( fieldBits < bitsPerPartition )
+        fieldBits *= 2;
+
+    fieldMask = ( fieldBits == 64 ) ? ~0ULL : ( ( 1ULL << fieldBits ) - 1 );
+    rowWords = ( partitionsPerRow * fieldBits + 63 ) / 64;
+
+    rows.clear( );
+}
+
+uint64_t FlipStateMap::Get( uint64_t row, uint64_t partition )
+{
+    std::map<uint64_t, std::vector<uint64_t> >::iterator it = rows.find( row );
+    uint64_t bit = partition * fieldBits;
+
+    if( it == rows.end( ) )
+        return 0;
+
+    return ( it->second[bit / 64] >> ( bit % 64 ) ) & fieldMask;
+}
+
+void FlipStateMap::Set( uint64_t row, uint64_t partition, uint64_t value )
+{
+    std::map<uint64_t, std::vector<uint64_t> >::iterator it = rows.find( row );
+    uint64_t bit = partition * fieldBits;
+
+    if( it == rows.end( ) )
+    {
+        /* Unwritten rows are all zero, so there is nothing to clear. */
+        if( value == 0 )
+            return;
+
+        it = rows.insert( std::make_pair( row, std::vector<uint64_t>( rowWords, 0 ) ) ).first;
+    }
+
+    uint64_t& word = it->second[bit / 64];
+
+    word = ( word & ~( fieldMask << ( bit % 64 ) ) ) 
+         | ( ( value & fieldMask ) << ( bit % 64 ) );
+}
+
+/* Non-zero bitmap words are saved under row * words per row + word. */
+void FlipStateMap::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    std::map<uint64_t, uint64_t> state;
+    std::map<uint64_t, std::vector<uint64_t> >::iterator it;
+
+    for( it = rows.begin( ); it != rows.end( ); ++it )
+    {
+        for( uint64_t word = 0; word < rowWords; word++ )
+        {
+            if( it->second[word] != 0 )
+                state[it->first * rowWords + word] = it->second[word];
+        }
+    }
+
+    cpt.WriteMap( state );
+}
+
+bool FlipStateMap::ReadCheckpoint( CheckpointReader& cpt )
+{
+    std::map<uint64_t, uint64_t> state;
+    std::map<uint64_t, uint64_t>::iterator it;
+    bool rv = cpt.ReadMap( state );
+
+    rows.clear( );
+
+    for( it = state.begin( ); it != state.end( ) && rowWords != 0; ++it )
+    {
+        uint64_t row = it->first / rowWords;
+
+        if( !rows.count( row ) )
+            rows[row] = std::vector<uint64_t>( rowWords, 0 );
+
+        rows[row][it->first % rowWords] = it->second;
+    }
+
+    return rv;
+}
@@ -37,6 +37,10 @@
 
 /* Add your decoder's include file below. */
 #include "DataEncoders/FlipNWrite/FlipNWrite.h"
+#include "DataEncoders/DCW/DCW.h"
+#include "DataEncoders/MinShift/MinShift.h"
+#include "DataEncoders/Captopril/Captopril.h"
+#include "DataEncoders/Coset/Coset.h"
 
 using namespace NVM;
 
@@ -46,6 +50,10 @@ DataEncoder *DataEncoderFactory::CreateDataEncoder( std::string encoderName )
 
     if( encoderName == "default" ) encoder = new DataEncoder( );
     else if( encoderName == "FlipNWrite" ) encoder = new FlipNWrite( );
+    else if( encoderName == "DCW" ) encoder = new DCW( );
+    else if( encoderName == "MinShift" ) encoder = new MinShift( );
+    else if( encoderName == "Captopril" ) encoder = new Captopril( );
+    else if( encoderName == "Coset" ) encoder = new Coset( );
 
     return encoder;
 }
@@ -34,12 +34,11 @@
 #ifndef __NVMAIN_FLIPNWRITE_H__
 #define __NVMAIN_FLIPNWRITE_H__
 
-#include "src/DataEncoder.h"
-#include <set>
+#include "DataEncoders/DataComparisonEncoder/DataComparisonEncoder.h"
 
 namespace NVM {
 
-class FlipNWrite : public DataEncoder
+class FlipNWrite : public DataComparisonEncoder
 {
   public:
     FlipNWrite( );
@@ -47,21 +46,17 @@ class FlipNWrite : public DataEncoder
 
     void SetConfig( Config *config, bool createChildren = true );
 
-    ncycle_t Read( NVMainRequest *request );
-    ncycle_t Write( NVMainRequest *request );
-
     void RegisterStats( );
     void CalculateStats( );
 
+  protected:
+    void Apply( ncounter_t candidate, uint64_t *part );
+
   private:
-    std::set< uint64_t > flippedAddresses;
-  
     uint64_t bitsFlipped;
     uint64_t bitCompareSwapWrites;
     double flipNWriteReduction;
     int fpSize;
-
-    void InvertData( NVMDataBlock &data, uint64_t startBit, uint64_t endBit );
 };
 
 };
@@ -0,0 +1,81 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "DataEncoders/MinShift/MinShift.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace NVM;
+
+MinShift::MinShift( )
+{
+    shiftStep = 8;
+}
+
+void MinShift::SetConfig( Config *config, bool createChildren )
+{
+    ncounter_t granularity = 64;
+
+    DataComparisonEncoder::SetConfig( config, createChildren );
+
+    if( config->KeyExists( "MinShiftGranularity" ) )
+        granularity = config->GetValueUL( "MinShiftGranularity" );
+
+    if( config->KeyExists( "MinShiftStep" ) )
+        shiftStep = config->GetValueUL( "MinShiftStep" );
+
+    /* Rotations stay within one word. */
+    if( granularity == 0 || granularity > 64 || shiftStep == 0 
+        || ( granularity % shiftStep ) != 0 )
+    {
+        std::cerr << "MinShift: MinShiftGranularity must be at most 64 and a "
+                  << "multiple of MinShiftStep." << std::endl;
+        exit(1);
+    }
+
+    SetLayout( "MinShift", granularity, 2 * ( granularity / shiftStep ) );
+}
+
+/* Even candidates rotate left by ( candidate / 2 ) steps, odd ones also invert. */
+void MinShift::Apply( ncounter_t candidate, uint64_t *part )
+{
+    ncounter_t shift = ( candidate / 2 ) * shiftStep;
+
+    if( shift != 0 )
+        part[0] = ( ( part[0] << shift ) | ( part[0] >> ( partitionBits - shift ) ) ) 
+                & partitionMask;
+
+    if( candidate & 1 )
+        Invert( part );
+}
@@ -32,6 +32,7 @@
 *******************************************************************************/
 
 #include "Decoders/Migrator/Migrator.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 #include <sstream>
@@ -229,102 +230,30 @@ void Migrator::Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64
 
 void Migrator::CreateCheckpoint( std::string dir )
 {
-    std::stringstream cpt_file;
-    cpt_file.str("");
-    cpt_file << dir << "/" << StatName( );
+    CheckpointWriter cpt( dir, StatName( ) );
 
-    std::ofstream cpt_handle;
-
-    cpt_handle.open( cpt_file.str().c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
-
-    if( !cpt_handle.is_open() )
-    {
-        std::cout << StatName( ) << ": Warning: Could not open checkpoint file: "
-                  << cpt_file.str() << std::endl;
-    }
-    else
+    if( cpt.IsOpen( ) )
     {
         /* 
          *  In-flight requests are not checkpointed (i.e., migrations). 
          *  Therefore, we assume requests have completed (i.e., there is some 
          *  draining process) and only checkpoint addresses and not state.
          */
-        std::map<uint64_t, uint64_t>::iterator it;
-        for( it = migrationMap.begin(); it != migrationMap.end(); it++ )
-        {
-            cpt_handle.write( (const char*)&(it->first), sizeof(uint64_t) );
-            cpt_handle.write( (const char*)&(it->second), sizeof(uint64_t) );
-        }
-
-        cpt_handle.close( );
-
-        /* Write checkpoint information. */
-        /* Note: For future compatability only at the memory. This is not read during restoration. */
-        std::string cpt_info = cpt_file.str() + ".json";
-
-        cpt_handle.open( cpt_info.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
-
-        if( !cpt_handle.is_open() )
-        {
-            std::cout << StatName( ) << ": Warning: Could not open checkpoint " 
-                      << "info file: " << cpt_info << std::endl;
-        }
-        else
-        {
-            std::string cpt_info_str = "{\n\t\"Version\": 1\n}";
-            cpt_handle.write( cpt_info_str.c_str(), cpt_info_str.length() ); 
-
-            cpt_handle.close();
-        }
+        cpt.WriteMap( migrationMap );
     }
 }
 
-
 void Migrator::RestoreCheckpoint( std::string dir )
 {
-    std::stringstream cpt_file;
-    cpt_file.str("");
-    cpt_file << dir << "/" << StatName( );
-
-    std::ifstream cpt_handle;
+    CheckpointReader cpt( dir, StatName( ) );
 
-    cpt_handle.open( cpt_file.str().c_str(), std::ifstream::ate | std::ofstream::binary );
-
-    if( !cpt_handle.is_open() )
-    {
-        std::cout << StatName( ) << ": Warning: Could not open checkpoint file: "
-                  << cpt_file.str() << std::endl;
-    }
-    else
+    /*
+     *  Checkpoint is assumed to only have addresses and channel mappings.
+     */
+    if( cpt.IsOpen( ) && !cpt.ReadMap( migrationMap ) )
     {
-        std::streampos cpt_size = cpt_handle.tellg( );
-
-        if( cpt_size % (sizeof(uint64_t)*2) != 0 )
-        {
-            std::cout << StatName( ) << ": Warning: Excepted checkpoint size to be "
-                      << "a multiple of " << (sizeof(uint64_t)*2) << std::endl;
-        }
-
-        cpt_handle.close( );
-
-        cpt_handle.open( cpt_file.str().c_str(), std::ifstream::in | std::ifstream::binary );
-
-        /*
-         *  Checkpoint is assumed to only have addresses and channel mappings.
-         */
-        uint64_t addressMappings = static_cast<uint64_t>(cpt_size / (sizeof(uint64_t)*2));
-        for( uint64_t mapping = 0; mapping < addressMappings; mapping++ )
-        {
-            uint64_t address, channel;
-
-            cpt_handle.read( (char*)(&address), sizeof(uint64_t) );
-            cpt_handle.read( (char*)(&channel), sizeof(uint64_t) );
-
-            std::pair<uint64_t, uint64_t> migration( address, channel );
-            migrationMap.insert( migration );
-        }
-
-        cpt_handle.close( );
+        std::cout << StatName( ) << ": Warning: Could not restore checkpoint "
+                  << "migration map." << std::endl;
     }
 }
 
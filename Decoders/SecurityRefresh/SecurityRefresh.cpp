@@ -0,0 +1,251 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/SecurityRefresh/SecurityRefresh.h"
+#include "include/NVMHelpers.h"
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace NVM;
+
+SecurityRefresh::SecurityRefresh( )
+{
+    numSubregions = 1;
+    subregionLines = 1;
+    innerInterval = 64;
+    outerInterval = 128;
+}
+
+
+SecurityRefresh::~SecurityRefresh( )
+{
+
+}
+
+
+void SecurityRefresh::SetConfig( Config *config, bool createChildren )
+{
+    WearLevelingDecoder::SetConfig( config, createChildren );
+
+    numSubregions = 32;
+    config->GetValueUL( "SecurityRefreshSubregions", numSubregions );
+
+    innerInterval = 64;
+    config->GetValueUL( "SecurityRefreshInnerInterval", innerInterval );
+
+    outerInterval = 128;
+    config->GetValueUL( "SecurityRefreshOuterInterval", outerInterval );
+
+    /* Keys are XORed into row numbers, so all sizes are powers of two. */
+    if( numSubregions == 0 || numSubregions > numLines
+        || (1ULL << NVM::mlog2( static_cast<int>(numLines) )) != numLines
+        || (1ULL << NVM::mlog2( static_cast<int>(numSubregions) )) != numSubregions
+        || innerInterval == 0 || outerInterval == 0 )
+    {
+        std::cerr << "SecurityRefresh: Error: ROWS and SecurityRefreshSubregions must be "
+                  << "powers of two and the refresh intervals must be nonzero." << std::endl;
+        exit(1);
+    }
+
+    subregionLines = numLines / numSubregions;
+
+    ncounter_t bankCount = numRanks * numBanks;
+    states.resize( bankCount * (numSubregions + 1) );
+    writes.assign( states.size( ), 0 );
+    queued.assign( states.size( ), false );
+
+    for( size_t i = 0; i < states.size( ); i++ )
+    {
+        uint64_t domain = (i < bankCount * numSubregions) ? subregionLines : numLines;
+
+        states[i].previousKey = NextRandom( ) % domain;
+        states[i].currentKey = NextRandom( ) % domain;
+        states[i].pointer = 0;
+    }
+}
+
+
+uint64_t SecurityRefresh::OuterId( uint64_t bankKey )
+{
+    return numRanks * numBanks * numSubregions + bankKey;
+}
+
+
+/* Rows below the refresh pointer, or whose partner is, use the new key. */
+uint64_t SecurityRefresh::Map( RefreshState& state, uint64_t line )
+{
+    uint64_t partner = line ^ state.previousKey ^ state.currentKey;
+
+    if( line < state.pointer || partner < state.pointer )
+        return line ^ state.currentKey;
+
+    return line ^ state.previousKey;
+}
+
+
+uint64_t SecurityRefresh::Unmap( RefreshState& state, uint64_t line )
+{
+    uint64_t candidate = line ^ state.currentKey;
+
+    if( Map( state, candidate ) == line )
+        return candidate;
+
+    return line ^ state.previousKey;
+}
+
+
+uint64_t SecurityRefresh::Remap( uint64_t bankKey, uint64_t line )
+{
+    uint64_t intermediate = Map( states[OuterId( bankKey )], line );
+    uint64_t subregion = intermediate / subregionLines;
+    uint64_t offset = intermediate % subregionLines;
+
+    return subregion * subregionLines 
+         + Map( states[bankKey * numSubregions + subregion], offset );
+}
+
+
+void SecurityRefresh::Count( uint64_t id, ncounter_t threshold )
+{
+    writes[id]++;
+
+    if( writes[id] >= threshold && !queued[id] )
+    {
+        pendingSteps.push_back( id );
+        queued[id] = true;
+    }
+}
+
+
+void SecurityRefresh::CountWrite( uint64_t bankKey, uint64_t line )
+{
+    uint64_t intermediate = Map( states[OuterId( bankKey )], line );
+
+    Count( OuterId( bankKey ), outerInterval );
+    Count( bankKey * numSubregions + intermediate / subregionLines, innerInterval );
+}
+
+
+void SecurityRefresh::StepLines( uint64_t step, std::vector<std::pair<uint64_t, uint64_t> >& lines )
+{
+    RefreshState& state = states[step];
+    uint64_t partner = state.pointer ^ state.previousKey ^ state.currentKey;
+
+    /* Pairs are swapped once, when the pointer reaches the lower of the two. */
+    if( partner <= state.pointer )
+        return;
+
+    if( step >= OuterId( 0 ) )
+    {
+        uint64_t bankKey = step - OuterId( 0 );
+
+        lines.push_back( std::make_pair( bankKey, state.pointer ) );
+        lines.push_back( std::make_pair( bankKey, partner ) );
+    }
+    else
+    {
+        uint64_t bankKey = step / numSubregions;
+        uint64_t base = (step % numSubregions) * subregionLines;
+        RefreshState& outer = states[OuterId( bankKey )];
+
+        lines.push_back( std::make_pair( bankKey, Unmap( outer, base + state.pointer ) ) );
+        lines.push_back( std::make_pair( bankKey, Unmap( outer, base + partner ) ) );
+    }
+}
+
+
+void SecurityRefresh::ApplyStep( uint64_t step )
+{
+    RefreshState& state = states[step];
+    bool outer = (step >= OuterId( 0 ));
+    uint64_t domain = outer ? numLines : subregionLines;
+    ncounter_t threshold = outer ? outerInterval : innerInterval;
+
+    state.pointer++;
+
+    /* The round is over once every row was visited; Draw a new key. */
+    if( state.pointer == domain )
+    {
+        state.previousKey = state.currentKey;
+        state.currentKey = NextRandom( ) % domain;
+        state.pointer = 0;
+    }
+
+    writes[step] -= threshold;
+    queued[step] = false;
+
+    if( writes[step] >= threshold )
+    {
+        pendingSteps.push_back( step );
+        queued[step] = true;
+    }
+}
+
+
+void SecurityRefresh::WriteState( CheckpointWriter& cpt )
+{
+    cpt.Write( static_cast<uint64_t>(states.size( )) );
+
+    for( size_t i = 0; i < states.size( ); i++ )
+    {
+        cpt.Write( states[i].previousKey );
+        cpt.Write( states[i].currentKey );
+        cpt.Write( states[i].pointer );
+        cpt.Write( writes[i] );
+        cpt.Write( static_cast<uint8_t>(queued[i]) );
+    }
+}
+
+
+bool SecurityRefresh::ReadState( CheckpointReader& cpt )
+{
+    uint64_t stateCount = 0;
+
+    if( !cpt.Read( stateCount ) || stateCount != states.size( ) )
+        return false;
+
+    for( size_t i = 0; i < states.size( ); i++ )
+    {
+        uint8_t wasQueued = 0;
+
+        if( !cpt.Read( states[i].previousKey ) || !cpt.Read( states[i].currentKey )
+            || !cpt.Read( states[i].pointer ) || !cpt.Read( writes[i] )
+            || !cpt.Read( wasQueued ) )
+            return false;
+
+        queued[i] = (wasQueued != 0);
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SECURITY_REFRESH_H__
+#define __SECURITY_REFRESH_H__
+
+#include "Decoders/WearLevelingDecoder/WearLevelingDecoder.h"
+
+namespace NVM
+{
+
+/*
+ *  Two-level Security Refresh (Seong et al., ISCA 2010). Rows are XORed with
+ *  a key which is replaced one row at a time: every refresh step swaps a row
+ *  with its partner under the new key. The outer level remaps rows over the
+ *  whole bank, the inner level remaps rows inside each subregion, and each
+ *  level refreshes after its own number of writes.
+ */
+class SecurityRefresh : public WearLevelingDecoder
+{
+  public:
+    SecurityRefresh( );
+    ~SecurityRefresh( );
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+  protected:
+    uint64_t Remap( uint64_t bankKey, uint64_t line );
+    void CountWrite( uint64_t bankKey, uint64_t line );
+    void StepLines( uint64_t step, std::vector<std::pair<uint64_t, uint64_t> >& lines );
+    void ApplyStep( uint64_t step );
+
+    void WriteState( CheckpointWriter& cpt );
+    bool ReadState( CheckpointReader& cpt );
+
+  private:
+    struct RefreshState
+    {
+        uint64_t previousKey;
+        uint64_t currentKey;
+        uint64_t pointer;
+    };
+
+    ncounter_t numSubregions, subregionLines;
+    ncounter_t innerInterval, outerInterval;
+
+    /* Inner states are per subregion, followed by one outer state per bank. */
+    std::vector<RefreshState> states;
+    std::vector<ncounter_t> writes;
+    std::vector<bool> queued;
+
+    uint64_t OuterId( uint64_t bankKey );
+    uint64_t Map( RefreshState& state, uint64_t line );
+    uint64_t Unmap( RefreshState& state, uint64_t line );
+    void Count( uint64_t id, ncounter_t threshold );
+};
+
+};
+
+#endif
@@ -0,0 +1,263 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/StartGap/StartGap.h"
+#include "include/NVMHelpers.h"
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace NVM;
+
+StartGap::StartGap( )
+{
+    numRegions = 1;
+    regionLines = 2;
+    interval = 100;
+    randomize = true;
+    halfBits = 0;
+}
+
+
+StartGap::~StartGap( )
+{
+
+}
+
+
+void StartGap::SetConfig( Config *config, bool createChildren )
+{
+    WearLevelingDecoder::SetConfig( config, createChildren );
+
+    numRegions = 32;
+    config->GetValueUL( "StartGapRegions", numRegions );
+
+    interval = 100;
+    config->GetValueUL( "StartGapInterval", interval );
+
+    randomize = true;
+    config->GetBool( "StartGapRandomize", randomize );
+
+    if( numRegions == 0 || numLines % numRegions != 0 || numLines / numRegions < 2 || interval == 0 )
+    {
+        std::cerr << "StartGap: Error: StartGapRegions must divide ROWS into regions "
+                  << "of at least two rows and StartGapInterval must be nonzero." << std::endl;
+        exit(1);
+    }
+
+    /* 
+     *  The last row of every region is the spare gap row, so one row per
+     *  region is lost to leveling. The logical row which would occupy it
+     *  aliases onto the first row of the region instead.
+     */
+    regionLines = numLines / numRegions;
+
+    ncounter_t totalRegions = numRanks * numBanks * numRegions;
+    start.assign( totalRegions, 0 );
+    gap.assign( totalRegions, regionLines - 1 );
+    regionWrites.assign( totalRegions, 0 );
+    queued.assign( totalRegions, false );
+
+    unsigned int lineBits = NVM::mlog2( static_cast<int>(numLines) );
+    halfBits = (lineBits + 1) / 2;
+
+    for( int i = 0; i < 3; i++ )
+        feistelKeys[i] = NextRandom( );
+}
+
+
+uint64_t StartGap::Feistel( uint64_t value, bool inverse )
+{
+    uint64_t halfMask = (1ULL << halfBits) - 1;
+    uint64_t left = (value >> halfBits) & halfMask;
+    uint64_t right = value & halfMask;
+
+    for( int i = 0; i < 3; i++ )
+    {
+        uint64_t key = feistelKeys[inverse ? 2 - i : i];
+        uint64_t mix;
+
+        if( !inverse )
+        {
+            mix = (right ^ key) * 0x9E3779B97F4A7C15ULL;
+            uint64_t next = left ^ ((mix ^ (mix >> 29)) & halfMask);
+            left = right;
+            right = next;
+        }
+        else
+        {
+            mix = (left ^ key) * 0x9E3779B97F4A7C15ULL;
+            uint64_t prev = right ^ ((mix ^ (mix >> 29)) & halfMask);
+            right = left;
+            left = prev;
+        }
+    }
+
+    return (left << halfBits) | right;
+}
+
+
+/* Cycle walking keeps the permutation inside of the row range. */
+uint64_t StartGap::Scramble( uint64_t line )
+{
+    if( !randomize )
+        return line;
+
+    do
+    {
+        line = Feistel( line, false );
+    } while( line >= numLines );
+
+    return line;
+}
+
+
+uint64_t StartGap::Unscramble( uint64_t line )
+{
+    if( !randomize )
+        return line;
+
+    do
+    {
+        line = Feistel( line, true );
+    } while( line >= numLines );
+
+    return line;
+}
+
+
+uint64_t StartGap::Remap( uint64_t bankKey, uint64_t line )
+{
+    uint64_t scrambled = Scramble( line );
+    uint64_t region = scrambled / regionLines;
+    uint64_t offset = scrambled % regionLines;
+    uint64_t usableLines = regionLines - 1;
+    uint64_t id = bankKey * numRegions + region;
+
+    if( offset == usableLines )
+        offset = 0;
+
+    uint64_t physical = (offset + start[id]) % usableLines;
+    if( physical >= gap[id] )
+        physical++;
+
+    return region * regionLines + physical;
+}
+
+
+void StartGap::CountWrite( uint64_t bankKey, uint64_t line )
+{
+    uint64_t id = bankKey * numRegions + Scramble( line ) / regionLines;
+
+    regionWrites[id]++;
+
+    if( regionWrites[id] >= interval && !queued[id] )
+    {
+        pendingSteps.push_back( id );
+        queued[id] = true;
+    }
+}
+
+
+void StartGap::StepLines( uint64_t step, std::vector<std::pair<uint64_t, uint64_t> >& lines )
+{
+    uint64_t usableLines = regionLines - 1;
+    uint64_t region = step % numRegions;
+
+    /* The row above the gap moves down; At the top, the last row wraps around. */
+    uint64_t source = (gap[step] == 0) ? usableLines : gap[step] - 1;
+    uint64_t slot = (source < gap[step]) ? source : source - 1;
+    uint64_t offset = (slot + usableLines - start[step]) % usableLines;
+
+    lines.push_back( std::make_pair( step / numRegions, 
+                                     Unscramble( region * regionLines + offset ) ) );
+}
+
+
+void StartGap::ApplyStep( uint64_t step )
+{
+    if( gap[step] == 0 )
+    {
+        gap[step] = regionLines - 1;
+        start[step] = (start[step] + 1) % (regionLines - 1);
+    }
+    else
+    {
+        gap[step]--;
+    }
+
+    regionWrites[step] -= interval;
+    queued[step] = false;
+
+    if( regionWrites[step] >= interval )
+    {
+        pendingSteps.push_back( step );
+        queued[step] = true;
+    }
+}
+
+
+void StartGap::WriteState( CheckpointWriter& cpt )
+{
+    cpt.Write( static_cast<uint64_t>(start.size( )) );
+
+    for( size_t i = 0; i < start.size( ); i++ )
+    {
+        cpt.Write( start[i] );
+        cpt.Write( gap[i] );
+        cpt.Write( regionWrites[i] );
+        cpt.Write( static_cast<uint8_t>(queued[i]) );
+    }
+}
+
+
+bool StartGap::ReadState( CheckpointReader& cpt )
+{
+    uint64_t regionCount = 0;
+
+    if( !cpt.Read( regionCount ) || regionCount != start.size( ) )
+        return false;
+
+    for( size_t i = 0; i < start.size( ); i++ )
+    {
+        uint8_t wasQueued = 0;
+
+        if( !cpt.Read( start[i] ) || !cpt.Read( gap[i] ) 
+            || !cpt.Read( regionWrites[i] ) || !cpt.Read( wasQueued ) )
+            return false;
+
+        queued[i] = (wasQueued != 0);
+    }
+
+    return true;
+}
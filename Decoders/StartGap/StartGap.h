@@ -0,0 +1,86 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __START_GAP_H__
+#define __START_GAP_H__
+
+#include "Decoders/WearLevelingDecoder/WearLevelingDecoder.h"
+
+namespace NVM
+{
+
+/*
+ *  Region-based Start-Gap (Qureshi et al., MICRO 2009). Each bank is split
+ *  into regions which rotate through their rows independently: one row of
+ *  every region is the gap, and after StartGapInterval writes to a region
+ *  its gap moves down by one row. A keyed Feistel network scatters rows
+ *  over the regions first, so spatially hot rows do not share a region.
+ */
+class StartGap : public WearLevelingDecoder
+{
+  public:
+    StartGap( );
+    ~StartGap( );
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+  protected:
+    uint64_t Remap( uint64_t bankKey, uint64_t line );
+    void CountWrite( uint64_t bankKey, uint64_t line );
+    void StepLines( uint64_t step, std::vector<std::pair<uint64_t, uint64_t> >& lines );
+    void ApplyStep( uint64_t step );
+
+    void WriteState( CheckpointWriter& cpt );
+    bool ReadState( CheckpointReader& cpt );
+
+  private:
+    ncounter_t numRegions, regionLines;
+    ncounter_t interval;
+    bool randomize;
+
+    /* Static randomization; The width is rounded up to an even bit count. */
+    unsigned int halfBits;
+    uint64_t feistelKeys[3];
+
+    std::vector<uint64_t> start, gap;
+    std::vector<ncounter_t> regionWrites;
+    std::vector<bool> queued;
+
+    uint64_t Scramble( uint64_t line );
+    uint64_t Unscramble( uint64_t line );
+    uint64_t Feistel( uint64_t value, bool inverse );
+};
+
+};
+
+#endif
@@ -0,0 +1,334 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/WearLevelingDecoder/WearLevelingDecoder.h"
+
+#include <iostream>
+#include <cassert>
+
+using namespace NVM;
+
+WearLevelingDecoder::WearLevelingDecoder( )
+{
+    numBanks = 1;
+    numRanks = 1;
+    numLines = 1;
+    subarrayRows = 1;
+    seed = 1;
+
+    controllerDecoder = false;
+    moving = false;
+    advanced = false;
+    currentStep = 0;
+
+    maxLogicalWrites = 0;
+    maxPhysicalWrites = 0;
+
+    demandWrites = 0;
+    levelingSteps = 0;
+    levelingWrites = 0;
+    levelingWriteOverhead = 0.0;
+    projectedLifetimeGain = 1.0;
+}
+
+
+WearLevelingDecoder::~WearLevelingDecoder( )
+{
+
+}
+
+
+void WearLevelingDecoder::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    numBanks = config->GetValue( "BANKS" );
+    numRanks = config->GetValue( "RANKS" );
+    numLines = config->GetValue( "ROWS" );
+
+    if( config->KeyExists( "MATHeight" ) )
+        subarrayRows = config->GetValue( "MATHeight" );
+    else
+        subarrayRows = numLines;
+
+    /* All instances must agree on the static mapping, so the seed is fixed. */
+    seed = 1;
+    config->GetValueUL( "WearLevelingSeed", seed );
+}
+
+
+/* 
+ *  Every level creates its own decoder, but only the memory controller's
+ *  instance (which decodes with no default field) holds leveling state.
+ */
+void WearLevelingDecoder::SetDefaultField( TranslationField f )
+{
+    AddressTranslator::SetDefaultField( f );
+
+    controllerDecoder = (f == NO_FIELD);
+}
+
+
+void WearLevelingDecoder::RegisterStats( )
+{
+    if( !controllerDecoder )
+        return;
+
+    AddStat(demandWrites);
+    AddStat(levelingSteps);
+    AddStat(levelingWrites);
+    AddStat(levelingWriteOverhead);
+    AddStat(maxLogicalWrites);
+    AddStat(maxPhysicalWrites);
+    AddStat(projectedLifetimeGain);
+}
+
+
+void WearLevelingDecoder::CalculateStats( )
+{
+    levelingWriteOverhead = 0.0;
+    if( demandWrites != 0 )
+        levelingWriteOverhead = static_cast<double>(levelingWrites) 
+                              / static_cast<double>(demandWrites);
+
+    /* 
+     *  Lifetime ends when the most written line wears out. Without leveling
+     *  the hottest logical line takes every write, so the ratio of the two
+     *  maxima is the lifetime relative to no leveling.
+     */
+    projectedLifetimeGain = 1.0;
+    if( maxPhysicalWrites != 0 )
+        projectedLifetimeGain = static_cast<double>(maxLogicalWrites)
+                              / static_cast<double>(maxPhysicalWrites);
+}
+
+
+/* splitmix64, so every instance draws the same keys from the same seed. */
+uint64_t WearLevelingDecoder::NextRandom( )
+{
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+
+void WearLevelingDecoder::Decompose( uint64_t address, uint64_t *bankKey, uint64_t *line )
+{
+    uint64_t row, col, bank, rank, channel, subarray;
+
+    AddressTranslator::Translate( address, &row, &col, &bank, &rank, &channel, &subarray );
+
+    *bankKey = rank * numBanks + bank;
+    *line = subarray * subarrayRows + row;
+}
+
+
+void WearLevelingDecoder::Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank,
+                                     uint64_t *rank, uint64_t *channel, uint64_t *subarray )
+{
+    AddressTranslator::Translate( address, row, col, bank, rank, channel, subarray );
+
+    uint64_t bankKey = *rank * numBanks + *bank;
+    uint64_t line = Remap( bankKey, *subarray * subarrayRows + *row );
+
+    *subarray = line / subarrayRows;
+    *row = line % subarrayRows;
+}
+
+
+bool WearLevelingDecoder::RecordWrite( uint64_t address )
+{
+    uint64_t bankKey, line;
+
+    Decompose( address, &bankKey, &line );
+
+    uint64_t logicalCount = ++logicalWrites[bankKey * numLines + line];
+    uint64_t physicalCount = ++physicalWrites[bankKey * numLines + Remap( bankKey, line )];
+
+    if( logicalCount > maxLogicalWrites )
+        maxLogicalWrites = logicalCount;
+    if( physicalCount > maxPhysicalWrites )
+        maxPhysicalWrites = physicalCount;
+
+    demandWrites++;
+
+    CountWrite( bankKey, line );
+
+    return StepReady( );
+}
+
+
+void WearLevelingDecoder::RecordLevelingWrite( uint64_t address )
+{
+    uint64_t bankKey, line;
+
+    Decompose( address, &bankKey, &line );
+
+    uint64_t physicalCount = ++physicalWrites[bankKey * numLines + Remap( bankKey, line )];
+
+    if( physicalCount > maxPhysicalWrites )
+        maxPhysicalWrites = physicalCount;
+
+    levelingWrites++;
+}
+
+
+bool WearLevelingDecoder::Moving( )
+{
+    return moving;
+}
+
+
+bool WearLevelingDecoder::StepReady( )
+{
+    return (!moving && !pendingSteps.empty( ));
+}
+
+
+void WearLevelingDecoder::BeginMovement( NVMAddress& trigger, std::vector<NVMAddress>& lines )
+{
+    std::vector<std::pair<uint64_t, uint64_t> > stepLines;
+    std::vector<std::pair<uint64_t, uint64_t> >::iterator it;
+
+    assert( !moving && !pendingSteps.empty( ) );
+
+    currentStep = pendingSteps.front( );
+    pendingSteps.pop_front( );
+    moving = true;
+    advanced = false;
+
+    StepLines( currentStep, stepLines );
+
+    /* Hand out addresses which decode to the logical lines being moved. */
+    lines.clear( );
+    for( it = stepLines.begin( ); it != stepLines.end( ); it++ )
+    {
+        uint64_t rank = it->first / numBanks;
+        uint64_t bank = it->first % numBanks;
+        uint64_t subarray = it->second / subarrayRows;
+        uint64_t row = it->second % subarrayRows;
+        uint64_t channel = trigger.GetChannel( );
+
+        NVMAddress lineAddress;
+        lineAddress.SetPhysicalAddress( AddressTranslator::ReverseTranslate( row, 0, bank, 
+                                                           rank, channel, subarray ) );
+        lineAddress.SetTranslatedAddress( row, 0, bank, rank, channel, subarray );
+
+        lines.push_back( lineAddress );
+    }
+}
+
+
+void WearLevelingDecoder::AdvanceMapping( )
+{
+    assert( moving && !advanced );
+
+    ApplyStep( currentStep );
+    advanced = true;
+}
+
+
+void WearLevelingDecoder::EndMovement( )
+{
+    assert( moving );
+
+    if( !advanced )
+        ApplyStep( currentStep );
+
+    moving = false;
+    advanced = false;
+    levelingSteps++;
+}
+
+
+void WearLevelingDecoder::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        /* 
+         *  In-flight movements are not checkpointed. A step whose data was
+         *  not read yet is saved as pending so it is redone after restore.
+         */
+        std::deque<uint64_t> steps = pendingSteps;
+        if( moving && !advanced )
+            steps.push_front( currentStep );
+
+        cpt.Write( seed );
+        cpt.Write( static_cast<uint64_t>(steps.size( )) );
+        for( std::deque<uint64_t>::iterator it = steps.begin( ); it != steps.end( ); it++ )
+            cpt.Write( *it );
+
+        cpt.WriteMap( logicalWrites );
+        cpt.WriteMap( physicalWrites );
+        cpt.Write( maxLogicalWrites );
+        cpt.Write( maxPhysicalWrites );
+
+        WriteState( cpt );
+    }
+}
+
+
+void WearLevelingDecoder::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) );
+
+    if( !cpt.IsOpen( ) )
+        return;
+
+    uint64_t stepCount = 0;
+    bool rv = cpt.Read( seed ) && cpt.Read( stepCount );
+
+    pendingSteps.clear( );
+    for( uint64_t i = 0; rv && i < stepCount; i++ )
+    {
+        uint64_t step;
+        rv = cpt.Read( step );
+        pendingSteps.push_back( step );
+    }
+
+    rv = rv && cpt.ReadMap( logicalWrites ) && cpt.ReadMap( physicalWrites )
+            && cpt.Read( maxLogicalWrites ) && cpt.Read( maxPhysicalWrites )
+            && ReadState( cpt );
+
+    moving = false;
+    advanced = false;
+
+    if( !rv )
+    {
+        std::cout << StatName( ) << ": Warning: Could not restore wear leveling "
+                  << "state from checkpoint." << std::endl;
+    }
+}
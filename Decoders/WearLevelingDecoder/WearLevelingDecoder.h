@@ -0,0 +1,129 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __WEAR_LEVELING_DECODER_H__
+#define __WEAR_LEVELING_DECODER_H__
+
+#include "src/AddressTranslator.h"
+#include "src/Config.h"
+#include "src/Checkpoint.h"
+#include "include/NVMAddress.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace NVM
+{
+
+/*
+ *  Base class for decoders which remap rows inside of each bank to spread
+ *  writes evenly. Subclasses provide the mapping and decide when a remapping
+ *  step is due; the WearLeveler hook moves the data of each step with real
+ *  memory requests and tells the decoder when to switch to the new mapping.
+ *
+ *  Lines are rows of a bank, numbered subarray * MATHeight + row. Each memory
+ *  controller owns its own decoder instance, so leveling state is per channel.
+ */
+class WearLevelingDecoder : public AddressTranslator
+{
+  public:
+    WearLevelingDecoder( );
+    virtual ~WearLevelingDecoder( );
+
+    virtual void SetConfig( Config *config, bool createChildren = true );
+    virtual void SetDefaultField( TranslationField f );
+
+    virtual void Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank, 
+                            uint64_t *rank, uint64_t *channel, uint64_t *subarray );
+    using AddressTranslator::Translate;
+
+    /* Counts a demand write; Returns true if a remapping step can be started. */
+    bool RecordWrite( uint64_t address );
+    /* Counts a write issued to move data for a remapping step. */
+    void RecordLevelingWrite( uint64_t address );
+
+    bool Moving( );
+    bool StepReady( );
+    /* Starts the next step and returns the addresses whose data must move. */
+    void BeginMovement( NVMAddress& trigger, std::vector<NVMAddress>& lines );
+    /* Switches to the mapping after the step. Call once the old data is read. */
+    void AdvanceMapping( );
+    void EndMovement( );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
+  protected:
+    ncounter_t numBanks, numRanks, numLines, subarrayRows;
+    uint64_t seed;
+
+    /* Pending steps; The encoding of a step is left to the subclass. */
+    std::deque<uint64_t> pendingSteps;
+
+    uint64_t NextRandom( );
+
+    virtual uint64_t Remap( uint64_t bankKey, uint64_t line ) = 0;
+    /* Called for each demand write; Queue a step in pendingSteps when due. */
+    virtual void CountWrite( uint64_t bankKey, uint64_t line ) = 0;
+    /* Logical lines (bankKey, line) whose data moves in this step. */
+    virtual void StepLines( uint64_t step, std::vector<std::pair<uint64_t, uint64_t> >& lines ) = 0;
+    virtual void ApplyStep( uint64_t step ) = 0;
+
+    virtual void WriteState( CheckpointWriter& cpt ) = 0;
+    virtual bool ReadState( CheckpointReader& cpt ) = 0;
+
+  private:
+    bool controllerDecoder;
+    bool moving, advanced;
+    uint64_t currentStep;
+
+    std::map<uint64_t, uint64_t> logicalWrites;
+    std::map<uint64_t, uint64_t> physicalWrites;
+    ncounter_t maxLogicalWrites, maxPhysicalWrites;
+
+    ncounter_t demandWrites;
+    ncounter_t levelingSteps;
+    ncounter_t levelingWrites;
+    double levelingWriteOverhead;
+    double projectedLifetimeGain;
+
+    void Decompose( uint64_t address, uint64_t *bankKey, uint64_t *line );
+};
+
+};
+
+#endif
@@ -80,10 +80,13 @@ ncycles_t BitModel::Read( NVMainRequest *request )
     uint64_t partitionCount;
 
     wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
+    wordSize *= p->nominalBURST * p->RATE;
     wordSize /= 8;
 
     rowSize = p->COLS * wordSize; 
+
+    /* Reads of lines with corrected cells pass through the fault model. */
+    rv = CorrectionLatency( row * p->COLS + col );
     
     /* Check each bit to see if it is dead */
     for( uint64_t i = 0; i < wordSize; ++i )
@@ -101,7 +104,7 @@ ncycles_t BitModel::Read( NVMainRequest *request )
             wordkey = row * partitionCount 
                              + (col * wordSize * 8) + i * 8 + j;
 
-            if( IsDead( wordkey ) )
+            if( IsDead( wordkey, row * p->COLS + col, i * 8 + j ) )
             {
                 rv = -(rv + 1);
                 return rv;
@@ -140,7 +143,7 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     uint64_t partitionCount;
 
     wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
+    wordSize *= p->nominalBURST * p->RATE;
     wordSize /= 8;
 
     rowSize = p->COLS * wordSize; 
@@ -189,11 +192,11 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
 
             //std::cout << "Key is " << wordkey << std::endl;
 
-            if( !DecrementLife( wordkey ) )
+            if( !DecrementLife( wordkey, row * p->COLS + col, i * 8 + j ) )
                 rv = -1;
         }
     }
 
-    return rv;
+    return WriteLatency( row * p->COLS + col, rv < 0 );
 }
 
@@ -84,12 +84,15 @@ ncycles_t ByteModel::Read( NVMainRequest *request )
      * This size is in bytes 
      */
     wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
+    wordSize *= p->nominalBURST * p->RATE;
     wordSize /= 8;
 
     /* Size of a row in bytes */
     rowSize = p->COLS * wordSize;
 
+    /* Reads of lines with corrected cells pass through the fault model. */
+    rv = CorrectionLatency( row * p->COLS + col );
+
     /* Check each byte to see if it was modified */
     for( int i = (int)wordSize - 1; i >= 0; --i )
     {
@@ -103,7 +106,7 @@ ncycles_t ByteModel::Read( NVMainRequest *request )
 
         wordkey = row * partitionCount + col * wordSize + i;
       
-        if( IsDead( wordkey ) )
+        if( IsDead( wordkey, row * p->COLS + col, static_cast<uint64_t>(i) ) )
         {
             rv = -(rv + 1);  
             return rv;
@@ -147,7 +150,7 @@ ncycles_t ByteModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
      * This size is in bytes 
      */
     wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
+    wordSize *= p->nominalBURST * p->RATE;
     wordSize /= 8;
 
     /* Size of a row in bytes */
@@ -174,10 +177,10 @@ ncycles_t ByteModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
 
         wordkey = row * partitionCount + col * wordSize + i;
       
-        if( !DecrementLife( wordkey ) )
+        if( !DecrementLife( wordkey, row * p->COLS + col, static_cast<uint64_t>(i) ) )
             rv = -1;  
     }
 
-    return rv;
+    return WriteLatency( row * p->COLS + col, rv < 0 );
 }
 
@@ -113,3 +113,18 @@ uint64_t NormalDistribution::GetEndurance( )
     
     return mean + static_cast<uint64_t>(y1 * static_cast<double>(variance));
 }
+
+/*
+ *  The Box-Muller samples above are scaled by the variance parameter, so
+ *  it is treated as the standard deviation here as well.
+ */
+double NormalDistribution::GetFailureProbability( double writes )
+{
+    double sigma = static_cast<double>(variance);
+
+    if( sigma == 0.0 )
+        return ( writes >= static_cast<double>(mean) ) ? 1.0 : 0.0;
+
+    return 0.5 * erfc( ( static_cast<double>(mean) - writes ) 
+                       / ( sigma * sqrt( 2.0 ) ) );
+}
@@ -46,6 +46,7 @@ class NormalDistribution : public EnduranceDistribution
     ~NormalDistribution( ) { }
 
     uint64_t GetEndurance( );
+    double GetFailureProbability( double writes );
 
     void SetMean( uint64_t m ) { mean = m; }
     void SetVariance( uint64_t var ) { variance = var; }
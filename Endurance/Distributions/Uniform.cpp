@@ -58,3 +58,8 @@ uint64_t UniformDistribution::GetEndurance( )
 {
     return mean;
 }
+
+double UniformDistribution::GetFailureProbability( double writes )
+{
+    return ( writes >= static_cast<double>(mean) ) ? 1.0 : 0.0;
+}
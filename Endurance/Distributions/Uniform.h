@@ -45,6 +45,7 @@ class UniformDistribution : public EnduranceDistribution
     ~UniformDistribution( ) { }
 
     uint64_t GetEndurance( );
+    double GetFailureProbability( double writes );
 
   private:
     Config *config;
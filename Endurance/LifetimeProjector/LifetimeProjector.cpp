@@ -0,0 +1,283 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Endurance/LifetimeProjector/LifetimeProjector.h"
+#include "src/EnduranceModel.h"
+#include "src/SubArray.h"
+#include "include/NVMHelpers.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+
+using namespace NVM;
+
+namespace {
+
+const double secondsPerYear = 365.25 * 24.0 * 3600.0;
+
+};
+
+LifetimeProjector::LifetimeProjector( )
+{
+    levelWrites = false;
+    levelingOverhead = 0.0;
+    curvePoints = 10;
+    horizon = 0.0;
+
+    totalLocations = 0;
+    projectionWindow = 0.0;
+    projectedFirstFailure = -1.0;
+    capacityCurve = "{}";
+}
+
+void LifetimeProjector::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    Params *params = new Params( );
+    params->SetParams( config );
+    SetParams( params );
+
+    if( config->KeyExists( "LifetimeWearLeveling" ) )
+    {
+        std::string leveling = config->GetString( "LifetimeWearLeveling" );
+
+        if( leveling == "Uniform" )
+        {
+            levelWrites = true;
+        }
+        else if( leveling != "None" )
+        {
+            std::cerr << "LifetimeProjector: Unknown LifetimeWearLeveling '"
+                      << leveling << "'. Use None or Uniform." << std::endl;
+            exit(1);
+        }
+    }
+
+    if( config->KeyExists( "LifetimeLevelingOverhead" ) )
+        levelingOverhead = config->GetEnergy( "LifetimeLevelingOverhead" );
+
+    if( config->KeyExists( "LifetimeCurvePoints" ) )
+        curvePoints = config->GetValueUL( "LifetimeCurvePoints" );
+
+    if( config->KeyExists( "LifetimeHorizon" ) )
+        horizon = config->GetEnergy( "LifetimeHorizon" );
+
+    if( levelingOverhead < 0.0 || curvePoints == 0 || horizon < 0.0 )
+    {
+        std::cerr << "LifetimeProjector: LifetimeLevelingOverhead and LifetimeHorizon "
+                  << "may not be negative and LifetimeCurvePoints must be non-zero."
+                  << std::endl;
+        exit(1);
+    }
+}
+
+void LifetimeProjector::RegisterStats( )
+{
+    AddUnitStat(projectionWindow, "s");
+    AddStat(totalLocations);
+    AddUnitStat(projectedFirstFailure, "years");
+    AddStat(capacityCurve);
+}
+
+/*
+ *  The window is the simulated time of this run. Writes restored from a
+ *  checkpoint only show up as reduced remaining life, not as rate.
+ */
+void LifetimeProjector::Project( NVMObject *root, ncycle_t elapsed )
+{
+    std::map<double, double> curve;
+    double firstFailure = std::numeric_limits<double>::infinity( );
+    double end;
+
+    totalLocations = 0;
+    failureTimes.clear( );
+    domains.clear( );
+
+    projectionWindow = static_cast<double>(elapsed) 
+                     / ( static_cast<double>(p->CLK) * 1000000.0 );
+    projectedFirstFailure = -1.0;
+    capacityCurve = "{}";
+
+    if( projectionWindow <= 0.0 )
+        return;
+
+    Collect( root );
+
+    if( levelWrites )
+    {
+        for( std::vector<WearDomain>::iterator it = domains.begin( ); 
+             it != domains.end( ); ++it )
+        {
+            firstFailure = std::min( firstFailure, FirstFailure( *it ) );
+        }
+    }
+    else if( !failureTimes.empty( ) )
+    {
+        std::sort( failureTimes.begin( ), failureTimes.end( ) );
+        firstFailure = failureTimes.front( );
+    }
+
+    /* Nothing was written, so nothing wears out. */
+    if( firstFailure == std::numeric_limits<double>::infinity( ) )
+        return;
+
+    projectedFirstFailure = firstFailure / secondsPerYear;
+
+    end = ( horizon > 0.0 ) ? horizon * secondsPerYear : 2.0 * firstFailure;
+
+    /* Cells worn out during the run fail at 0, so span the later failures. */
+    if( end <= 0.0 && !failureTimes.empty( ) )
+        end = 2.0 * failureTimes.back( );
+
+    if( end <= 0.0 )
+        end = 2.0 * projectionWindow;
+
+    for( ncounter_t point = 1; point <= curvePoints; point++ )
+    {
+        double seconds = end * static_cast<double>(point) 
+                       / static_cast<double>(curvePoints);
+
+        curve[seconds / secondsPerYear] = Capacity( seconds );
+    }
+
+    capacityCurve = PyDictHistogram( curve );
+}
+
+void LifetimeProjector::Collect( NVMObject *object )
+{
+    std::vector<NVMObject_hook *>& children = object->GetChildren( );
+
+    for( std::vector<NVMObject_hook *>::iterator it = children.begin( );
+         it != children.end( ); ++it )
+    {
+        NVMObject *child = (*it)->GetTrampoline( );
+        SubArray *subArray = dynamic_cast<SubArray *>( child );
+
+        if( subArray == NULL )
+            Collect( child );
+        else if( subArray->GetEnduranceModel( ) != NULL )
+            AddDomain( subArray->GetEnduranceModel( ) );
+    }
+}
+
+void LifetimeProjector::AddDomain( EnduranceModel *model )
+{
+    std::vector<std::pair<uint64_t, uint64_t> > profile;
+    uint64_t locations = model->GetLocationCount( );
+    double windowWrites = 0.0;
+
+    model->GetWearProfile( profile );
+    totalLocations += locations;
+
+    for( std::vector<std::pair<uint64_t, uint64_t> >::iterator it = profile.begin( );
+         it != profile.end( ); ++it )
+    {
+        double writes = static_cast<double>(it->first);
+
+        /* Each location keeps its own rate and sampled endurance. */
+        if( !levelWrites )
+            failureTimes.push_back( static_cast<double>(it->second) 
+                                    * projectionWindow / writes );
+
+        windowWrites += writes;
+    }
+
+    if( levelWrites && windowWrites > 0.0 && locations > 0 )
+    {
+        WearDomain domain;
+
+        domain.locations = locations;
+        domain.rate = windowWrites * ( 1.0 + levelingOverhead ) 
+                    / ( projectionWindow * static_cast<double>(locations) );
+        domain.dist = model->GetDistribution( );
+
+        domains.push_back( domain );
+    }
+}
+
+/*
+ *  Time until the expected number of worn out locations in a leveled
+ *  domain reaches one, found by bisection on the endurance distribution.
+ */
+double LifetimeProjector::FirstFailure( WearDomain& domain )
+{
+    double target = 1.0 / static_cast<double>(domain.locations);
+    double low = 0.0, high = 1.0;
+
+    while( domain.dist->GetFailureProbability( high ) < target )
+    {
+        if( high > 1e30 )
+            return std::numeric_limits<double>::infinity( );
+
+        low = high;
+        high *= 2.0;
+    }
+
+    for( int step = 0; step < 100; step++ )
+    {
+        double middle = ( low + high ) / 2.0;
+
+        if( domain.dist->GetFailureProbability( middle ) < target )
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return high / domain.rate;
+}
+
+double LifetimeProjector::Capacity( double seconds )
+{
+    double worn = 0.0;
+
+    if( totalLocations == 0 )
+        return 1.0;
+
+    if( levelWrites )
+    {
+        for( std::vector<WearDomain>::iterator it = domains.begin( ); 
+             it != domains.end( ); ++it )
+        {
+            worn += static_cast<double>(it->locations) 
+                  * it->dist->GetFailureProbability( it->rate * seconds );
+        }
+    }
+    else
+    {
+        worn = static_cast<double>( std::upper_bound( failureTimes.begin( ),
+                   failureTimes.end( ), seconds ) - failureTimes.begin( ) );
+    }
+
+    return 1.0 - worn / static_cast<double>(totalLocations);
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __LIFETIMEPROJECTOR_H__
+#define __LIFETIMEPROJECTOR_H__
+
+#include "src/NVMObject.h"
+#include "src/EnduranceDistribution.h"
+#include <string>
+#include <vector>
+
+namespace NVM {
+
+class Config;
+class EnduranceModel;
+
+/*
+ *  Fast-forwards the wear measured during a detailed run. Each written
+ *  location keeps wearing at the rate it saw in the window until its
+ *  sampled endurance runs out. With LifetimeWearLeveling set to Uniform
+ *  the writes of every subarray are instead spread evenly over all of its
+ *  locations and failures follow the endurance distribution directly.
+ */
+class LifetimeProjector : public NVMObject
+{
+  public:
+    LifetimeProjector( );
+    ~LifetimeProjector( ) { }
+
+    void SetConfig( Config *config, bool createChildren = true );
+    void RegisterStats( );
+
+    /* Projects the wear of every subarray below root after a run of elapsed cycles. */
+    void Project( NVMObject *root, ncycle_t elapsed );
+
+    void Cycle( ncycle_t ) { }
+
+  private:
+    struct WearDomain
+    {
+        uint64_t locations;
+        double rate;
+        EnduranceDistribution *dist;
+    };
+
+    bool levelWrites;
+    double levelingOverhead;
+    ncounter_t curvePoints;
+    double horizon;
+
+    ncounter_t totalLocations;
+    std::vector<double> failureTimes;
+    std::vector<WearDomain> domains;
+
+    double projectionWindow;
+    double projectedFirstFailure;
+    std::string capacityCurve;
+
+    void Collect( NVMObject *object );
+    void AddDomain( EnduranceModel *model );
+    double FirstFailure( WearDomain& domain );
+    double Capacity( double seconds );
+};
+
+};
+
+#endif
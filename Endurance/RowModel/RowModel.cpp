@@ -60,7 +60,7 @@ void RowModel::SetConfig( Config *conf, bool createChildren )
     params->SetParams( conf );
     SetParams( params );
 
-    SetGranularity( p->COLS * 8 );
+    SetGranularity( p->COLS * p->BusWidth * p->nominalBURST * p->RATE );
 
     EnduranceModel::SetConfig( conf, createChildren );
 }
@@ -61,7 +61,7 @@ void WordModel::SetConfig( Config *config, bool createChildren )
     params->SetParams( config );
     SetParams( params );
 
-    SetGranularity( p->BusWidth * 8 );
+    SetGranularity( p->BusWidth * p->nominalBURST * p->RATE );
 
     EnduranceModel::SetConfig( config, createChildren );
 }
@@ -80,7 +80,7 @@ ncycles_t WordModel::Read( NVMainRequest *request )
     uint64_t partitionCount;
 
     wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
+    wordSize *= p->nominalBURST * p->RATE;
     wordSize /= 8;
 
     rowSize = p->COLS * wordSize;
@@ -132,7 +132,7 @@ ncycles_t WordModel::Write( NVMainRequest *request, NVMDataBlock& /*oldData*/ )
     uint64_t partitionCount;
 
     wordSize = p->BusWidth;
-    wordSize *= p->tBURST * p->RATE;
+    wordSize *= p->nominalBURST * p->RATE;
     wordSize /= 8;
 
     rowSize = p->COLS * wordSize;
@@ -31,4 +31,286 @@
 *                     Website: http://www.cse.psu.edu/~poremba/ )
 *******************************************************************************/
 
+#include "FaultModels/ECP/ECP.h"
+#include "src/Checkpoint.h"
+#include "src/EventQueue.h"
+#include "src/Params.h"
+#include <cstdlib>
+#include <iostream>
 
+using namespace NVM;
+
+ECP::ECP( )
+{
+    pointers = 6;
+    correctionLatency = 1;
+    lineCount = 0;
+
+    countBits = 0;
+    pointerBits = 0;
+    entryWords = 0;
+
+    correctedCells = 0;
+    failedLines = 0;
+    capacityLoss = 0.0;
+    correctedReads = 0;
+    correctedWrites = 0;
+    correctionCycles = 0;
+    firstCorrection = 0;
+    firstLineFailure = 0;
+}
+
+void ECP::SetConfig( Config *conf, bool createChildren )
+{
+    Params *params = new Params( );
+    params->SetParams( conf );
+    SetParams( params );
+
+    FaultModel::SetConfig( conf, createChildren );
+
+    if( conf->KeyExists( "ECPPointers" ) )
+        pointers = conf->GetValueUL( "ECPPointers" );
+
+    if( conf->KeyExists( "ECPLatency" ) )
+        correctionLatency = conf->GetValueUL( "ECPLatency" );
+
+    if( pointers == 0 || pointers > 255 )
+    {
+        std::cerr << "ECP: ECPPointers must be between 1 and 255." << std::endl;
+        exit(1);
+    }
+
+    /* One line is one write unit; pointers must be able to name every bit. */
+    uint64_t lineBits = p->BusWidth * p->nominalBURST * p->RATE;
+
+    lineCount = p->MATHeight * p->COLS;
+
+    pointerBits = 1;
+    while( ( 1ULL << pointerBits ) < lineBits )
+        pointerBits++;
+
+    countBits = 1;
+    while( ( 1ULL << countBits ) < pointers + 2 )
+        countBits++;
+
+    entryWords = ( countBits + pointers * pointerBits + 63 ) / 64;
+}
+
+void ECP::RegisterStats( )
+{
+    AddStat(correctedCells);
+    AddStat(failedLines);
+    AddStat(capacityLoss);
+    AddStat(correctedReads);
+    AddStat(correctedWrites);
+    AddStat(correctionCycles);
+    AddStat(firstCorrection);
+    AddStat(firstLineFailure);
+}
+
+void ECP::CalculateStats( )
+{
+    if( lineCount != 0 )
+        capacityLoss = static_cast<double>(failedLines) 
+                     / static_cast<double>(lineCount);
+}
+
+bool ECP::FaultCell( uint64_t line, uint64_t cell )
+{
+    std::map<uint64_t, uint64_t>::iterator it = entries.find( line );
+    uint64_t offset, count;
+
+    if( it == entries.end( ) )
+    {
+        offset = pointerStore.size( );
+        pointerStore.resize( offset + entryWords, 0 );
+        entries.insert( std::make_pair( line, offset ) );
+    }
+    else
+    {
+        offset = it->second;
+    }
+
+    count = GetField( offset, 0, countBits );
+
+    /* Line has already failed. */
+    if( count > pointers )
+        return false;
+
+    for( ncounter_t index = 0; index < count; index++ )
+    {
+        if( GetPointer( offset, index ) == cell )
+            return true;
+    }
+
+    if( count == pointers )
+    {
+        SetField( offset, 0, countBits, pointers + 1 );
+
+        failedLines++;
+        if( firstLineFailure == 0 )
+            firstLineFailure = CurrentCycle( );
+
+        return false;
+    }
+
+    SetField( offset, countBits + count * pointerBits, pointerBits, cell );
+    SetField( offset, 0, countBits, count + 1 );
+
+    correctedCells++;
+    if( firstCorrection == 0 )
+        firstCorrection = CurrentCycle( );
+
+    return true;
+}
+
+bool ECP::IsCorrected( uint64_t line, uint64_t cell )
+{
+    std::map<uint64_t, uint64_t>::iterator it = entries.find( line );
+    bool rv = false;
+
+    if( it != entries.end( ) )
+    {
+        uint64_t count = GetField( it->second, 0, countBits );
+
+        for( ncounter_t index = 0; index < count && count <= pointers; index++ )
+        {
+            if( GetPointer( it->second, index ) == cell )
+                rv = true;
+        }
+    }
+
+    return rv;
+}
+
+/* Reads of lines with replaced cells pass through the correction logic. */
+ncycles_t ECP::ReadLatency( uint64_t line )
+{
+    ncycles_t rv = 0;
+
+    if( entries.count( line ) )
+    {
+        rv = static_cast<ncycles_t>(correctionLatency);
+
+        correctedReads++;
+        correctionCycles += correctionLatency;
+    }
+
+    return rv;
+}
+
+/* Writes of such lines also steer the replaced cells to their pointers. */
+ncycles_t ECP::WriteLatency( uint64_t line )
+{
+    ncycles_t rv = 0;
+
+    if( entries.count( line ) )
+    {
+        rv = static_cast<ncycles_t>(correctionLatency);
+
+        correctedWrites++;
+        correctionCycles += correctionLatency;
+    }
+
+    return rv;
+}
+
+/* Each entry word is saved under ( line << 8 ) | word. */
+void ECP::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    std::map<uint64_t, uint64_t> state;
+    std::map<uint64_t, uint64_t>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); ++it )
+    {
+        for( ncounter_t word = 0; word < entryWords; word++ )
+            state[( it->first << 8 ) | word] = pointerStore[it->second + word];
+    }
+
+    cpt.WriteMap( state );
+}
+
+bool ECP::ReadCheckpoint( CheckpointReader& cpt )
+{
+    std::map<uint64_t, uint64_t> state;
+    std::map<uint64_t, uint64_t>::iterator it;
+    bool rv = cpt.ReadMap( state );
+
+    entries.clear( );
+    pointerStore.clear( );
+    correctedCells = 0;
+    failedLines = 0;
+
+    for( it = state.begin( ); it != state.end( ); ++it )
+    {
+        uint64_t line = it->first >> 8;
+        uint64_t word = it->first & 0xFF;
+
+        if( word >= entryWords )
+            continue;
+
+        if( !entries.count( line ) )
+        {
+            entries[line] = pointerStore.size( );
+            pointerStore.resize( pointerStore.size( ) + entryWords, 0 );
+        }
+
+        pointerStore[entries[line] + word] = it->second;
+    }
+
+    for( it = entries.begin( ); it != entries.end( ); ++it )
+    {
+        uint64_t count = GetField( it->second, 0, countBits );
+
+        if( count > pointers )
+        {
+            correctedCells += pointers;
+            failedLines++;
+        }
+        else
+        {
+            correctedCells += count;
+        }
+    }
+
+    return rv;
+}
+
+uint64_t ECP::GetField( uint64_t offset, uint64_t bit, unsigned int width )
+{
+    uint64_t value = 0;
+
+    for( unsigned int i = 0; i < width; i++ )
+    {
+        uint64_t pos = bit + i;
+
+        if( ( pointerStore[offset + pos / 64] >> ( pos % 64 ) ) & 1ULL )
+            value |= ( 1ULL << i );
+    }
+
+    return value;
+}
+
+void ECP::SetField( uint64_t offset, uint64_t bit, unsigned int width, uint64_t value )
+{
+    for( unsigned int i = 0; i < width; i++ )
+    {
+        uint64_t pos = bit + i;
+        uint64_t mask = 1ULL << ( pos % 64 );
+
+        if( ( value >> i ) & 1ULL )
+            pointerStore[offset + pos / 64] |= mask;
+        else
+            pointerStore[offset + pos / 64] &= ~mask;
+    }
+}
+
+uint64_t ECP::GetPointer( uint64_t offset, ncounter_t index )
+{
+    return GetField( offset, countBits + index * pointerBits, pointerBits );
+}
+
+ncycle_t ECP::CurrentCycle( )
+{
+    return ( GetEventQueue( ) != NULL ) ? GetEventQueue( )->GetCurrentCycle( ) : 0;
+}
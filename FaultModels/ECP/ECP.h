@@ -31,4 +31,68 @@
 *                     Website: http://www.cse.psu.edu/~poremba/ )
 *******************************************************************************/
 
+#ifndef __ECP_H__
+#define __ECP_H__
 
+#include "src/FaultModel.h"
+#include <map>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Error-Correcting Pointers (Schechter et al., ISCA 2010). Every line has
+ *  ECPPointers entries, each naming one worn out cell that is replaced by
+ *  a spare. A line fails once a cell dies after all entries are used.
+ *  Only lines with faults own an entry, which holds the pointer count and
+ *  the pointers packed at their hardware width. Pointers name cells at the
+ *  granularity of the endurance model, so BitModel corrects single bits.
+ */
+class ECP : public FaultModel
+{
+  public:
+    ECP( );
+    ~ECP( ) { }
+
+    void SetConfig( Config *conf, bool createChildren = true );
+    void RegisterStats( );
+    void CalculateStats( );
+
+    bool FaultCell( uint64_t line, uint64_t cell );
+    bool IsCorrected( uint64_t line, uint64_t cell );
+    ncycles_t ReadLatency( uint64_t line );
+    ncycles_t WriteLatency( uint64_t line );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
+  private:
+    ncounter_t pointers;
+    ncycle_t correctionLatency;
+    ncounter_t lineCount;
+
+    /* The count field holds pointers + 1 once a line has failed. */
+    unsigned int countBits, pointerBits;
+    ncounter_t entryWords;
+
+    std::map<uint64_t, uint64_t> entries;
+    std::vector<uint64_t> pointerStore;
+
+    ncounter_t correctedCells;
+    ncounter_t failedLines;
+    double capacityLoss;
+    ncounter_t correctedReads;
+    ncounter_t correctedWrites;
+    ncounter_t correctionCycles;
+    ncycle_t firstCorrection;
+    ncycle_t firstLineFailure;
+
+    uint64_t GetField( uint64_t offset, uint64_t bit, unsigned int width );
+    void SetField( uint64_t offset, uint64_t bit, unsigned int width, uint64_t value );
+    uint64_t GetPointer( uint64_t offset, ncounter_t index );
+    ncycle_t CurrentCycle( );
+};
+
+};
+
+#endif
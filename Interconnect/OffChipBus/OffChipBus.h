@@ -59,6 +59,7 @@ class OffChipBus : public Interconnect
   private:
     bool configSet;
     ncounter_t numRanks;
+    ncounter_t dataBuses;
     ncycle_t offChipDelay;
     double syncValue;
 
@@ -46,6 +46,7 @@ OnChipBus::OnChipBus( )
     conf = NULL;
     configSet = false;
     numRanks = 0;
+    dataBuses = 1;
     syncValue = 0.0f;
 }
 
@@ -64,6 +65,16 @@ void OnChipBus::SetConfig( Config *c, bool createChildren )
 
     numRanks = p->RANKS;
 
+    /* Rank r is on data bus r % ( SubChannels * PseudoChannels ). */
+    dataBuses = p->SubChannels * p->PseudoChannels;
+
+    if( dataBuses == 0 || numRanks % dataBuses != 0 )
+    {
+        std::cerr << "NVMain Error: SubChannels * PseudoChannels (" << dataBuses 
+            << ") must divide the number of ranks (" << numRanks << ")." << std::endl;
+        exit(1);
+    }
+
     if( createChildren )
     {
         /* When selecting a child, use the rank field from the decoder. */
@@ -114,7 +125,8 @@ bool OnChipBus::IssueCommand( NVMainRequest *req )
     if( success )
     {
         for( ncounter_t childIdx = 0; childIdx < GetChildCount( ); childIdx++ )
-          if( GetChild( req ) != GetChild( childIdx ) )
+          if( GetChild( req ) != GetChild( childIdx ) 
+              && childIdx % dataBuses == opRank % dataBuses )
             GetChild( childIdx )->Notify( req );
     }
 
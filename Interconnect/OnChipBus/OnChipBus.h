@@ -60,6 +60,7 @@ class OnChipBus : public Interconnect
  private:
     bool configSet;
     ncounter_t numRanks;
+    ncounter_t dataBuses;
     double syncValue;
 
     Config *conf;
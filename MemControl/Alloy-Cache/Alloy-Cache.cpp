@@ -0,0 +1,292 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "MemControl/Alloy-Cache/Alloy-Cache.h"
+#include "NVM/nvmain.h"
+#include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+
+#include <iostream>
+#include <sstream>
+#include <cassert>
+
+
+using namespace NVM;
+
+
+Alloy_Cache::Alloy_Cache( )
+{
+    predictor = NULL;
+
+    alloy_true_hits = 0;
+    alloy_true_misses = 0;
+    alloy_false_hits = 0;
+    alloy_false_misses = 0;
+    alloy_parallel_reads = 0;
+    alloy_wasted_reads = 0;
+    alloy_latency_saved = 0;
+    alloy_predictor_accuracy = 0.0;
+    alloy_average_latency_saved = 0.0;
+}
+
+Alloy_Cache::~Alloy_Cache( )
+{
+    delete predictor;
+}
+
+void Alloy_Cache::SetConfig( Config *conf, bool createChildren )
+{
+    LO_Cache::SetConfig( conf, createChildren );
+
+    std::stringstream formatter;
+
+    formatter << StatName( ) << ".MAPIPredictor";
+
+    predictor = new MAPIPredictor( );
+    predictor->SetParent( this );
+    predictor->StatName( formatter.str( ) );
+    predictor->SetConfig( conf, createChildren );
+
+    SetDebugName( "Alloy-Cache", conf );
+}
+
+void Alloy_Cache::RegisterStats( )
+{
+    AddStat(alloy_true_hits);
+    AddStat(alloy_true_misses);
+    AddStat(alloy_false_hits);
+    AddStat(alloy_false_misses);
+    AddStat(alloy_predictor_accuracy);
+    AddStat(alloy_parallel_reads);
+    AddStat(alloy_wasted_reads);
+    AddStat(alloy_latency_saved);
+    AddStat(alloy_average_latency_saved);
+
+    LO_Cache::RegisterStats( );
+}
+
+bool Alloy_Cache::IssueCommand( NVMainRequest *req )
+{
+    /* 
+     *  Reads predicted to miss go to main memory right away. The probe is
+     *  still needed to find dirty data and to fill on a miss.
+     */
+    if( (req->type == READ || req->type == READ_PRECHARGE) && req->owner != this
+        && predictor->PredictMiss( req ) )
+    {
+        NVMainRequest *memReq = new NVMainRequest( );
+
+        *memReq = *req;
+        memReq->owner = this;
+        memReq->tag = DRC_MEMREAD;
+        memReq->type = READ;
+        memReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
+
+        ParallelRead& pr = parallelReads[memReq];
+
+        pr.original = req;
+        pr.probeDone = pr.probeHit = pr.memDone = false;
+        pr.probeCycle = pr.memDoneCycle = 0;
+        pr.memIssueCycle = GetEventQueue()->GetCurrentCycle();
+
+        assert( pendingProbes.count( req ) == 0 );
+        pendingProbes[req] = memReq;
+
+        if (mainMemory->IsIssuable( memReq, NULL )) {
+            mainMemory->IssueCommand( memReq );
+        } else {
+            mainMemory->EnqueuePendingMemoryRequests( memReq );
+        }
+
+        alloy_parallel_reads++;
+    }
+
+    return LO_Cache::IssueCommand( req );
+}
+
+bool Alloy_Cache::RequestComplete( NVMainRequest *req )
+{
+    bool rv = false;
+
+    if( req->owner == this && req->tag == DRC_MEMREAD 
+        && parallelReads.count( req ) )
+    {
+        ParallelMemReadComplete( req );
+        rv = true;
+    }
+    else if( req->owner != this 
+             && (req->type == READ || req->type == READ_PRECHARGE) )
+    {
+        ProbeComplete( req );
+        rv = false;
+    }
+    else
+    {
+        rv = LO_Cache::RequestComplete( req );
+    }
+
+    return rv;
+}
+
+/* The TAD of a read came back from the DRAM cache. */
+void Alloy_Cache::ProbeComplete( NVMainRequest *req )
+{
+    uint64_t rank, bank;
+
+    req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+    bool hit = functionalCache[rank][bank]->Present( req->address );
+    bool predictedMiss = (pendingProbes.count( req ) > 0);
+
+    predictor->Train( req, predictedMiss, hit );
+
+    if( hit && !predictedMiss ) alloy_true_hits++;
+    else if( !hit && predictedMiss ) alloy_true_misses++;
+    else if( hit ) alloy_false_misses++;
+    else alloy_false_hits++;
+
+    /* Serial path: the controller issues the miss to main memory itself. */
+    if( !predictedMiss )
+    {
+        (void)LO_Cache::RequestComplete( req );
+        return;
+    }
+
+    NVMainRequest *memReq = pendingProbes[req];
+    ParallelRead& pr = parallelReads[memReq];
+
+    pendingProbes.erase( req );
+
+    pr.probeDone = true;
+    pr.probeHit = hit;
+    pr.probeCycle = GetEventQueue()->GetCurrentCycle();
+
+    if( hit )
+    {
+        /* The line is served from the cache; the memory read was wasted. */
+        pr.original = NULL;
+        GetParent( )->RequestComplete( req );
+        drc_hits++;
+        alloy_wasted_reads++;
+
+        if( pr.memDone )
+        {
+            parallelReads.erase( memReq );
+            delete memReq;
+        }
+    }
+    else if( pr.memDone )
+    {
+        FinishParallelMiss( memReq );
+    }
+}
+
+void Alloy_Cache::ParallelMemReadComplete( NVMainRequest *memReq )
+{
+    ParallelRead& pr = parallelReads[memReq];
+
+    pr.memDone = true;
+    pr.memDoneCycle = GetEventQueue()->GetCurrentCycle();
+
+    if( pr.probeDone && pr.probeHit )
+    {
+        parallelReads.erase( memReq );
+        delete memReq;
+    }
+    else if( pr.probeDone )
+    {
+        FinishParallelMiss( memReq );
+    }
+}
+
+/* 
+ *  Both the probe and the memory read of a miss are done. Fill and respond
+ *  through the regular miss path. Serially, the memory read would have
+ *  started when the probe finished.
+ */
+void Alloy_Cache::FinishParallelMiss( NVMainRequest *memReq )
+{
+    ParallelRead pr = parallelReads[memReq];
+    ncycle_t memLatency = pr.memDoneCycle - pr.memIssueCycle;
+    ncycle_t serialDone = pr.probeCycle + memLatency;
+    ncycle_t parallelDone = MAX( pr.probeCycle, pr.memDoneCycle );
+
+    alloy_latency_saved += serialDone - parallelDone;
+    drc_miss++;
+
+    parallelReads.erase( memReq );
+
+    outstandingFills.insert( std::pair<NVMainRequest*, NVMainRequest*>( memReq, pr.original ) );
+    (void)LO_Cache::RequestComplete( memReq );
+}
+
+void Alloy_Cache::CalculateStats( )
+{
+    ncounter_t predictions = alloy_true_hits + alloy_true_misses 
+                           + alloy_false_hits + alloy_false_misses;
+
+    alloy_predictor_accuracy = 0.0;
+    if( predictions > 0 )
+        alloy_predictor_accuracy = static_cast<double>(alloy_true_hits + alloy_true_misses)
+                                 / static_cast<double>(predictions);
+
+    alloy_average_latency_saved = 0.0;
+    if( alloy_true_misses > 0 )
+        alloy_average_latency_saved = static_cast<double>(alloy_latency_saved) 
+                                    / static_cast<double>(alloy_true_misses);
+
+    LO_Cache::CalculateStats( );
+}
+
+void Alloy_Cache::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, statName + "_mapi" );
+
+    if( cpt.IsOpen( ) )
+        predictor->WriteCheckpoint( cpt );
+
+    LO_Cache::CreateCheckpoint( dir );
+}
+
+void Alloy_Cache::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, statName + "_mapi" );
+
+    if( cpt.IsOpen( ) && !predictor->ReadCheckpoint( cpt ) )
+    {
+        std::cout << "Alloy_Cache: Warning: Could not restore checkpoint " 
+                  << statName << "_mapi." << std::endl;
+    }
+
+    LO_Cache::RestoreCheckpoint( dir );
+}
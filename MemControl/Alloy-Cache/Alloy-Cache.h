@@ -0,0 +1,103 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __MEMCONTROL_ALLOYCACHE_H__
+#define __MEMCONTROL_ALLOYCACHE_H__
+
+
+#include "MemControl/LO-Cache/LO-Cache.h"
+#include "Utils/AccessPredictor/MAPIPredictor/MAPIPredictor.h"
+
+
+#include <map>
+
+
+namespace NVM {
+
+
+/*
+ *  Alloy cache (Qureshi and Loh, MICRO 2012). The cache is direct mapped
+ *  and each line is stored as a tag-and-data (TAD) unit, so one burst from
+ *  the DRAM cache returns both the tag and the line. A MAP-I predictor
+ *  decides per read whether to access main memory in parallel with the
+ *  cache probe instead of after a detected miss.
+ */
+class Alloy_Cache : public LO_Cache
+{
+  public:
+    Alloy_Cache( );
+    virtual ~Alloy_Cache( );
+
+    void SetConfig( Config *conf, bool createChildren = true );
+
+    bool IssueCommand( NVMainRequest *req );
+    bool RequestComplete( NVMainRequest *req );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
+  private:
+    /* 
+     *  A main memory read started together with a cache probe. It can
+     *  outlive the original request if the probe hits.
+     */
+    struct ParallelRead
+    {
+        NVMainRequest *original;
+        bool probeDone, probeHit, memDone;
+        ncycle_t probeCycle, memIssueCycle, memDoneCycle;
+    };
+
+    MAPIPredictor *predictor;
+    std::map<NVMainRequest *, ParallelRead> parallelReads;
+    std::map<NVMainRequest *, NVMainRequest *> pendingProbes;
+
+    ncounter_t alloy_true_hits, alloy_true_misses;
+    ncounter_t alloy_false_hits, alloy_false_misses;
+    ncounter_t alloy_parallel_reads, alloy_wasted_reads;
+    ncounter_t alloy_latency_saved;
+    double alloy_predictor_accuracy, alloy_average_latency_saved;
+
+    void ProbeComplete( NVMainRequest *req );
+    void ParallelMemReadComplete( NVMainRequest *memReq );
+    void FinishParallelMiss( NVMainRequest *memReq );
+};
+
+
+};
+
+
+#endif
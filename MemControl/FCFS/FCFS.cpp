@@ -103,6 +103,10 @@ void FCFS::RegisterStats( )
 
 bool FCFS::RequestComplete( NVMainRequest * request )
 {
+    /* The decompression delay is part of the read latency. */
+    if( DelayDecompression( request ) )
+        return true;
+
     /* 
      * Only reads and writes are sent back to NVMain and 
      * checked for in the transaction queue. 
@@ -274,6 +274,10 @@ bool FRFCFS_WQF::IssueCommand( NVMainRequest *request )
 
 bool FRFCFS_WQF::RequestComplete( NVMainRequest * request )
 {
+    /* The decompression delay is part of the read latency. */
+    if( DelayDecompression( request ) )
+        return true;
+
     if( request->type == WRITE || request->type == WRITE_PRECHARGE )
     {
         /* 
@@ -170,6 +170,10 @@ bool FRFCFS::IssueCommand( NVMainRequest *req )
 
 bool FRFCFS::RequestComplete( NVMainRequest * request )
 {
+    /* The decompression delay is part of the read latency. */
+    if( DelayDecompression( request ) )
+        return true;
+
     if( request->type == WRITE || request->type == WRITE_PRECHARGE )
     {
         /* 
@@ -32,11 +32,15 @@
 *******************************************************************************/
 
 #include "MemControl/LH-Cache/LH-Cache.h"
+#include "MemControl/MissMap/MissMap.h"
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicyFactory.h"
 
 #include <iostream>
+#include <sstream>
 #include <set>
 #include <assert.h>
 
@@ -47,11 +51,6 @@ LH_Cache::LH_Cache( )
 {
     //translator->GetTranslationMethod( )->SetOrder( 5, 1, 4, 3, 2, 6 );
 
-    std::cout << "This Memory Controller is no longer maintained in favor of LO-Cache and is in a non-working state." << std::endl;
-    std::cout << "This code is only provided for reference." << std::endl;
-
-    exit(1);
-
     averageHitLatency = 0.0;
     averageHitQueueLatency = 0.0;
     averageMissLatency = 0.0;
@@ -85,6 +84,22 @@ LH_Cache::LH_Cache( )
 
     starvation_precharges = 0;
 
+    tagCache = NULL;
+    tagCacheLatency = 2;
+    tagCacheHits = 0;
+    tagCacheMisses = 0;
+    tagReadsSaved = 0;
+    measuredTagReadLatencies = 0;
+    averageTagReadLatency = 0.0;
+    tagCacheHitRate = 0.0;
+    tagCacheLatencySaved = 0.0;
+
+    drcPolicy = "LRU";
+    drcPolicyHits = 0;
+    drcPolicyFills = 0;
+    drcPolicyEvicts = 0;
+    drcPolicyHitrate = 0.0;
+
     psInterval = 0;
 
     InitQueues( 2 );
@@ -102,6 +117,7 @@ LH_Cache::LH_Cache( )
 
 LH_Cache::~LH_Cache( )
 {
+    delete tagCache;
 }
 
 void LH_Cache::SetConfig( Config *conf, bool createChildren )
@@ -122,6 +138,22 @@ void LH_Cache::SetConfig( Config *conf, bool createChildren )
     if( conf->KeyExists( "UseWriteBuffer" ) 
             && conf->GetString( "UseWriteBuffer" ) == "false" )
         useWriteBuffer = false;
+    if( conf->KeyExists( "DRCReplacementPolicy" ) )
+        drcPolicy = conf->GetString( "DRCReplacementPolicy" );
+
+    /* Optional on-chip tag cache, disabled unless sets are given. */
+    if( conf->KeyExists( "TagCacheSets" ) && conf->GetValue( "TagCacheSets" ) > 0 )
+    {
+        uint64_t tagCacheSets, tagCacheAssoc = 8;
+
+        tagCacheSets = static_cast<uint64_t>( conf->GetValue( "TagCacheSets" ) );
+        if( conf->KeyExists( "TagCacheAssoc" ) )
+            tagCacheAssoc = static_cast<uint64_t>( conf->GetValue( "TagCacheAssoc" ) );
+        if( conf->KeyExists( "TagCacheLatency" ) )
+            tagCacheLatency = static_cast<uint64_t>( conf->GetValue( "TagCacheLatency" ) );
+
+        tagCache = new TagCache( tagCacheSets, tagCacheAssoc );
+    }
     
     /*
      *  Lock banks between tag read and access. Initialize locks here.
@@ -132,6 +164,10 @@ void LH_Cache::SetConfig( Config *conf, bool createChildren )
     ranks = static_cast<ncounter_t>( conf->GetValue( "RANKS" ) );
     banks = static_cast<ncounter_t>( conf->GetValue( "BANKS" ) );
 
+    /* Line data is only kept when the simulation carries data. */
+    bool storeData = !( conf->KeyExists( "IgnoreData" ) 
+                        && conf->GetString( "IgnoreData" ) == "true" );
+
     bankLocked = new bool*[ranks];
     functionalCache = new CacheBank**[ranks];
     for( i = 0; i < ranks; i++ )
@@ -143,7 +179,12 @@ void LH_Cache::SetConfig( Config *conf, bool createChildren )
         {
             bankLocked[i][j] = false;
             functionalCache[i][j] = new CacheBank( 
-                                         conf->GetValue( "ROWS" ), 1, 29, 64 );
+                                         conf->GetValue( "ROWS" ), 1, 29, 64,
+                                         storeData );
+
+            ReplacementPolicy *policy = ReplacementPolicyFactory::CreateReplacementPolicy( drcPolicy );
+            policy->SetConfig( conf );
+            functionalCache[i][j]->SetReplacementPolicy( policy );
         }
     }
 
@@ -165,6 +206,19 @@ void LH_Cache::RegisterStats( )
 
     AddStat(starvation_precharges);
 
+    AddStat(tagCacheHits);
+    AddStat(tagCacheMisses);
+    AddStat(tagCacheHitRate);
+    AddStat(tagReadsSaved);
+    AddStat(averageTagReadLatency);
+    AddStat(tagCacheLatencySaved);
+
+    AddStat(drcPolicy);
+    AddStat(drcPolicyHits);
+    AddStat(drcPolicyFills);
+    AddStat(drcPolicyEvicts);
+    AddStat(drcPolicyHitrate);
+
     AddStat(averageHitLatency);
     AddStat(measuredHitLatencies);
     AddStat(averageHitQueueLatency);
@@ -218,15 +272,22 @@ bool LH_Cache::IssueAtomic( NVMainRequest *req )
 
     req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
 
-    if( functionalCache[rank][bank]->SetFull( req->address ) ) 
+    /* A resident line is only a hit for the replacement policy. */
+    if( !functionalCache[rank][bank]->Touch( req->address ) )
     {
-        NVMAddress victim;
+        if( functionalCache[rank][bank]->SetFull( req->address ) ) 
+        {
+            NVMAddress victim;
+
+            (void)functionalCache[rank][bank]->ChooseVictim( req->address, &victim );
+            (void)functionalCache[rank][bank]->Evict( victim, &dummy );
+        }
 
-        (void)functionalCache[rank][bank]->ChooseVictim( req->address, &victim );
-        (void)functionalCache[rank][bank]->Evict( victim, &dummy );
+        (void)functionalCache[rank][bank]->Install( req->address, dummy ); 
     }
 
-    (void)functionalCache[rank][bank]->Install( req->address, dummy ); 
+    if( tagCache != NULL )
+        tagCache->Insert( TagCacheKey( req ) );
 
     return true;
 }
@@ -238,6 +299,7 @@ bool LH_Cache::IssueFunctional( NVMainRequest *req )
 
     req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
 
+    /* A probe, e.g., by a predictor, so the replacement state is kept. */
     return functionalCache[rank][bank]->Present( req->address );
 }
 
@@ -271,6 +333,7 @@ bool LH_Cache::IssueCommand( NVMainRequest *req )
      *  to the higher-level caches.
      */
     drcQueue->push_back( req );
+    ScheduleWake( GetEventQueue()->GetCurrentCycle() + 1 );
 
     if( req->type == READ )
         mem_reads++;
@@ -286,7 +349,8 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
 
     req->completionCycle = GetEventQueue()->GetCurrentCycle();
 
-    if( req->tag == DRC_TAGREAD3 )
+    if( req->tag == DRC_TAGREAD3 || req->tag == DRC_TAGCACHE 
+        || req->tag == DRC_TAGCACHEMISS )
     {
         bool miss;
         uint64_t rank, bank;
@@ -295,18 +359,63 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
 
         req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
 
-        /*  Check functional cache for hit or miss status here */
-        miss = true;
-        if( originalRequest->type == WRITE 
-                || functionalCache[rank][bank]->Present( req->address ) )
-            miss = false;
+        /*  
+         *  Check functional cache for hit or miss status here. Tag cache
+         *  lookups were decided when issued, as the bank lock depends on it.
+         */
+        if( req->tag == DRC_TAGREAD3 )
+            miss = !( originalRequest->type == WRITE 
+                      || functionalCache[rank][bank]->Present( req->address ) );
+        else
+            miss = ( req->tag == DRC_TAGCACHEMISS );
 
         /* If it is a hit, issue a request to the bank for the cache line */
         if( !miss )
         {
-            commandQueues[queueId].push_back( MakeDRCRequest( req ) );
+            uint64_t row, col, subarray;
+
+            req->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, &subarray );
+
+            /* 
+             *  A refresh or a fill may have closed the row since the tags
+             *  were read, so reopen it before the data access.
+             */
+            if( !activateQueued[rank][bank] || !activeSubArray[rank][bank][subarray]
+                || effectiveRow[rank][bank][subarray] != row )
+            {
+                if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+                    commandQueues[queueId].push_back( 
+                            MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+
+                starvationCounter[rank][bank][subarray] = 0;
+                activateQueued[rank][bank] = true;
+                activeSubArray[rank][bank][subarray] = true;
+                effectiveRow[rank][bank][subarray] = row;
+                effectiveMuxedRow[rank][bank][subarray] = col / p->RBSize;
+
+                commandQueues[queueId].push_back( MakeActivateRequest( req ) );
+            }
+
+            /* A line dropped by the MissMap is read out of the cache. */
+            if( originalRequest->tag == MISSMAP_FORCE_EVICT )
+            {
+                NVMDataBlock dummy;
+                NVMAddress victim = req->address;
+
+                (void)functionalCache[rank][bank]->Evict( victim, &dummy );
+            }
+            else
+            {
+                functionalCache[rank][bank]->Touch( req->address );
+                drcHits++;
+            }
 
-            drcHits++;
+            commandQueues[queueId].push_back( MakeDRCRequest( req ) );
+        }
+        /* An evicted line that is no longer cached needs no access. */
+        else if( originalRequest->tag == MISSMAP_FORCE_EVICT )
+        {
+            GetParent( )->RequestComplete( originalRequest );
         }
         /* 
          * If it is a miss, issue a request to main memory for the cache line 
@@ -322,8 +431,11 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
 
             mm_reqs++;
 
-            /* TODO: Figure out what to do if this fails. */
-            mainMemory->IssueCommand( memReq );
+            if( mainMemory->IsIssuable( memReq, NULL ) )
+                mainMemory->IssueCommand( memReq );
+            else
+                /* Retried when a main memory request completes. */
+                mainMemory->EnqueuePendingMemoryRequests( memReq );
 
             drcMiss++;
         }
@@ -334,8 +446,23 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
          *  For a miss, we need to go to main memory, so unlock since this is time consuming.
          *  For a hit, we already injected the DRC request into the bank queue, so we can't 
          *             issue anyways.
+         *
+         *  Misses found in the tag cache never locked the bank.
          */
-        bankLocked[rank][bank] = false;
+        if( req->tag != DRC_TAGCACHEMISS )
+            bankLocked[rank][bank] = false;
+
+        /* Tags read from DRAM are now on chip. */
+        if( req->tag == DRC_TAGREAD3 && tagCache != NULL )
+        {
+            tagCache->Insert( TagCacheKey( req ) );
+
+            averageTagReadLatency = ((averageTagReadLatency * static_cast<double>(measuredTagReadLatencies))
+                                  + static_cast<double>(req->completionCycle)
+                                  - static_cast<double>(req->issueCycle))
+                                  / static_cast<double>(measuredTagReadLatencies+1);
+            measuredTagReadLatencies++;
+        }
 
     }
     else if( req->tag == DRC_MEMREAD )
@@ -346,6 +473,7 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
         *fillReq = *req;
         fillReq->owner = this;
         fillReq->tag = DRC_FILL;
+        fillReq->type = WRITE;
         fillReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
 
         /* TODO: Figure out what to do if this is full. */
@@ -354,6 +482,8 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
         else
             drcQueue->push_back( fillReq );
 
+        ScheduleWake( GetEventQueue()->GetCurrentCycle() + 1 );
+
         mm_reads++;
 
         CalculateLatency( req, &averageMMLatency, &measuredMMLatencies );
@@ -362,8 +492,6 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
         /* Mark the original request complete */
         NVMainRequest *originalRequest = static_cast<NVMainRequest *>(req->reqInfo);
 
-        GetParent( )->RequestComplete( originalRequest );
-
         originalRequest->completionCycle = GetEventQueue()->GetCurrentCycle();
 
         CalculateLatency( originalRequest, &averageMissLatency, 
@@ -372,12 +500,16 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
         CalculateQueueLatency( originalRequest, &averageMissQueueLatency, 
                 &measuredMissQueueLatencies );
 
+        /* The parent may free the request, so it is completed last. */
+        GetParent( )->RequestComplete( originalRequest );
     }
     else if( req->tag == DRC_FILL )
     {
         fills++;
 
-        /* Fill complete, just calculate some stats */
+        /* Fill complete, the line is now cached. */
+        IssueAtomic( req );
+
         CalculateLatency( req, &averageFillLatency, 
                 &measuredFillLatencies );
 
@@ -445,7 +577,6 @@ void LH_Cache::Cycle( ncycle_t /*steps*/ )
 {
     NVMainRequest *nextRequest = NULL;
 
-
     /* Check fill queue (write buffering). */
     if( FindStarvedRequest( *fillQueue, &nextRequest, FQF ) )
     {
@@ -512,6 +643,22 @@ void LH_Cache::Cycle( ncycle_t /*steps*/ )
     }
 
     CycleCommandQueues( );
+
+    /* Keep polling while requests wait on locked or busy banks. */
+    if( !drcQueue->empty( ) || !fillQueue->empty( ) )
+        ScheduleWake( GetEventQueue()->GetCurrentCycle() + 1 );
+}
+
+/*
+ *  Requests wait in the DRC and fill queues rather than the transaction
+ *  queues, so the base controller never schedules a cycle for them. Wakes
+ *  are for later cycles since requests may arrive while the event queue is
+ *  processing the current one.
+ */
+void LH_Cache::ScheduleWake( ncycle_t wakeCycle )
+{
+    if( GetEventQueue( )->FindEvent( EventCycle, this, NULL, wakeCycle ) == NULL )
+        GetEventQueue( )->InsertEvent( EventCycle, this, wakeCycle, NULL, transactionQueuePriority );
 }
 
 NVMainRequest *LH_Cache::MakeTagRequest( NVMainRequest *triggerRequest, int tag )
@@ -558,20 +705,119 @@ NVMainRequest *LH_Cache::MakeTagWriteRequest( NVMainRequest *triggerRequest )
     return tagRequest;
 }
 
+/* DRAM cache sets are rows, so a set is named by its rank, bank and row. */
+uint64_t LH_Cache::TagCacheKey( NVMainRequest *req )
+{
+    uint64_t rank, bank, row;
+
+    req->address.GetTranslatedAddress( &row, NULL, &bank, &rank, NULL, NULL );
+
+    return (row * p->RANKS + rank) * p->BANKS + bank;
+}
+
+/*
+ *  The tags are on chip, so hit or miss is known after the tag cache
+ *  latency without any DRAM tag reads. Only a hit needs the row opened
+ *  for the data access, and only then is the bank locked.
+ */
+bool LH_Cache::IssueTagCacheCommands( NVMainRequest *req )
+{
+    bool rv = false;
+    uint64_t rank, bank, row, col, subarray;
+    ncounter_t queueId = GetCommandQueueId( req->address );
+
+    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+
+    ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
+
+    bool hit = (req->type == WRITE || functionalCache[rank][bank]->Present( req->address ));
+
+    if( !hit )
+    {
+        rv = true;
+    }
+    else if( !activateQueued[rank][bank] && commandQueues[queueId].empty() )
+    {
+        /* Any activate will request the starvation counter */
+        starvationCounter[rank][bank][subarray] = 0;
+        activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
+        effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
+
+        commandQueues[queueId].push_back( MakeActivateRequest( req ) );
+        bankLocked[rank][bank] = true;
+
+        rv = true;
+    }
+    else if( activateQueued[rank][bank] 
+             && ( !activeSubArray[rank][bank][subarray] 
+                  || effectiveRow[rank][bank][subarray] != row ) 
+             && commandQueues[queueId].empty() )
+    {
+        /* Close the row still open in this subarray, if any */
+        if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+            commandQueues[queueId].push_back( 
+                    MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+
+        /* Any activate will request the starvation counter */
+        starvationCounter[rank][bank][subarray] = 0;
+        activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
+        effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
+
+        commandQueues[queueId].push_back( MakeActivateRequest( req ) );
+        bankLocked[rank][bank] = true;
+
+        rv = true;
+    }
+    else if( activateQueued[rank][bank] 
+             && activeSubArray[rank][bank][subarray] 
+             && effectiveRow[rank][bank][subarray] == row )
+    {
+        starvationCounter[rank][bank][subarray]++;
+        bankLocked[rank][bank] = true;
+
+        rv = true;
+    }
+
+    if( rv )
+    {
+        req->issueCycle = GetEventQueue()->GetCurrentCycle();
+
+        GetEventQueue( )->InsertEvent( EventResponse, this, 
+                MakeTagRequest( req, (hit ? DRC_TAGCACHE : DRC_TAGCACHEMISS) ),
+                GetEventQueue( )->GetCurrentCycle( ) + tagCacheLatency );
+
+        tagCacheHits++;
+        tagReadsSaved += 3;
+    }
+
+    return rv;
+}
+
 bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
 {
     bool rv = false;
-    uint64_t rank, bank, row, subarray;
+    uint64_t rank, bank, row, col, subarray;
     ncounter_t queueId = GetCommandQueueId( req->address );
 
-    req->address.GetTranslatedAddress( &row, NULL, &bank, &rank, NULL, &subarray );
+    if( tagCache != NULL && tagCache->Lookup( TagCacheKey( req ) ) )
+        return IssueTagCacheCommands( req );
+
+    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+
+    ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
 
     if( !activateQueued[rank][bank] && commandQueues[queueId].empty() )
     {
         /* Any activate will request the starvation counter */
-        starvationCounter[rank][bank] = 0;
+        starvationCounter[rank][bank][subarray] = 0;
         activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
         effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
@@ -583,16 +829,25 @@ bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
 
         rv = true;
     }
-    else if( activateQueued[rank][bank] && effectiveRow[rank][bank][subarray] != row && commandQueues[queueId].empty() )
+    else if( activateQueued[rank][bank] 
+             && ( !activeSubArray[rank][bank][subarray] 
+                  || effectiveRow[rank][bank][subarray] != row ) 
+             && commandQueues[queueId].empty() )
     {
+        /* Close the row still open in this subarray, if any */
+        if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+            commandQueues[queueId].push_back( 
+                    MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+
         /* Any activate will request the starvation counter */
-        starvationCounter[rank][bank] = 0;
+        starvationCounter[rank][bank][subarray] = 0;
         activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
         effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
-        commandQueues[queueId].push_back( MakePrechargeRequest( req ) );
         commandQueues[queueId].push_back( MakeActivateRequest( req ) );
         commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD1 ) );
         commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD2 ) );
@@ -601,9 +856,11 @@ bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
 
         rv = true;
     }
-    else if( activateQueued[rank][bank] && effectiveRow[rank][bank][subarray] == row )
+    else if( activateQueued[rank][bank] 
+             && activeSubArray[rank][bank][subarray] 
+             && effectiveRow[rank][bank][subarray] == row )
     {
-        starvationCounter[rank][bank]++;
+        starvationCounter[rank][bank][subarray]++;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
@@ -619,23 +876,30 @@ bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
         rv = false;
     }
 
+    if( rv && tagCache != NULL )
+        tagCacheMisses++;
+
     return rv;
 }
 
 bool LH_Cache::IssueFillCommands( NVMainRequest *req )
 {
     bool rv = false;
-    uint64_t rank, bank, row, subarray;
+    uint64_t rank, bank, row, col, subarray;
     ncounter_t queueId = GetCommandQueueId( req->address );
 
-    req->address.GetTranslatedAddress( &row, NULL, &bank, &rank, NULL, &subarray );
+    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+
+    ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
 
     if( !activateQueued[rank][bank] && commandQueues[queueId].empty() )
     {
         /* Any activate will request the starvation counter */
-        starvationCounter[rank][bank] = 0;
+        starvationCounter[rank][bank][subarray] = 0;
         activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
         effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
@@ -645,26 +909,36 @@ bool LH_Cache::IssueFillCommands( NVMainRequest *req )
 
         rv = true;
     }
-    else if( activateQueued[rank][bank] && effectiveRow[rank][bank][subarray] != row 
-            && commandQueues[queueId].empty() )
+    else if( activateQueued[rank][bank] 
+             && ( !activeSubArray[rank][bank][subarray] 
+                  || effectiveRow[rank][bank][subarray] != row ) 
+             && commandQueues[queueId].empty() )
     {
+        /* Close the row still open in this subarray, if any */
+        if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+            commandQueues[queueId].push_back( 
+                    MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+
         /* Any activate will request the starvation counter */
-        starvationCounter[rank][bank] = 0;
+        starvationCounter[rank][bank][subarray] = 0;
         activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
         effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
-        commandQueues[queueId].push_back( MakePrechargeRequest( req ) );
         commandQueues[queueId].push_back( MakeActivateRequest( req ) );
         commandQueues[queueId].push_back( MakeTagWriteRequest( req ) );
         commandQueues[queueId].push_back( req );
 
         rv = true;
     }
-    else if( activateQueued[rank][bank] && effectiveRow[rank][bank][subarray] == row )
+    else if( activateQueued[rank][bank] 
+             && activeSubArray[rank][bank][subarray] 
+             && effectiveRow[rank][bank][subarray] == row )
     {
-        starvationCounter[rank][bank]++;
+        starvationCounter[rank][bank][subarray]++;
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
@@ -678,10 +952,86 @@ bool LH_Cache::IssueFillCommands( NVMainRequest *req )
         rv = false;
     }
 
+    /* Tag writes go to DRAM and update the on-chip copy. */
+    if( rv && tagCache != NULL )
+        tagCache->Insert( TagCacheKey( req ) );
+
     return rv;
 }
 
 void LH_Cache::CalculateStats( )
 {
+    tagCacheHitRate = 0.0;
+    if( tagCacheHits + tagCacheMisses > 0 )
+        tagCacheHitRate = static_cast<double>(tagCacheHits) 
+                        / static_cast<double>(tagCacheHits + tagCacheMisses);
+
+    /* Each tag cache hit avoids the DRAM tag read latency. */
+    tagCacheLatencySaved = 0.0;
+    if( averageTagReadLatency > static_cast<double>(tagCacheLatency) )
+        tagCacheLatencySaved = static_cast<double>(tagCacheHits) 
+                             * (averageTagReadLatency - static_cast<double>(tagCacheLatency));
+
+    /* Policy counters are cumulative, so sum them up from scratch. */
+    drcPolicyHits = drcPolicyFills = drcPolicyEvicts = 0;
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS && functionalCache != NULL; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            ReplacementPolicy *policy = functionalCache[rankIdx][bankIdx]->GetReplacementPolicy( );
+
+            drcPolicyHits += policy->GetHits( );
+            drcPolicyFills += policy->GetFills( );
+            drcPolicyEvicts += policy->GetEvictions( );
+        }
+    }
+
+    drcPolicyHitrate = 0.0;
+    if( drcPolicyHits + drcPolicyFills > 0 )
+        drcPolicyHitrate = static_cast<double>(drcPolicyHits) 
+                         / static_cast<double>(drcPolicyHits + drcPolicyFills);
+
     MemoryController::CalculateStats( );
 }
+
+void LH_Cache::CreateCheckpoint( std::string dir )
+{
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            std::stringstream cpt_name;
+            cpt_name << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
+
+            CheckpointWriter cpt( dir, cpt_name.str() );
+
+            if( cpt.IsOpen( ) )
+                functionalCache[rankIdx][bankIdx]->WriteCheckpoint( cpt );
+        }
+    }
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void LH_Cache::RestoreCheckpoint( std::string dir )
+{
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            std::stringstream cpt_name;
+            cpt_name << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
+
+            CheckpointReader cpt( dir, cpt_name.str() );
+
+            if( cpt.IsOpen( ) 
+                && !functionalCache[rankIdx][bankIdx]->ReadCheckpoint( cpt ) )
+            {
+                std::cout << "LH_Cache: Warning: Could not restore checkpoint " 
+                          << cpt_name.str() << "." << std::endl;
+            }
+        }
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
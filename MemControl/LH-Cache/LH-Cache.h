@@ -35,6 +35,7 @@
 #define __MEMCONTROL_BASICDRC_H__
 
 #include "Utils/Caches/CacheBank.h"
+#include "Utils/Caches/TagCache.h"
 #include "MemControl/DRAMCache/AbstractDRAMCache.h"
 
 namespace NVM {
@@ -45,6 +46,8 @@ namespace NVM {
 #define DRC_MEMREAD  tagGen->CreateTag("DRC_MEMREAD")
 #define DRC_FILL     tagGen->CreateTag("DRC_FILL")
 #define DRC_ACCESS   tagGen->CreateTag("DRC_ACCESS")
+#define DRC_TAGCACHE tagGen->CreateTag("DRC_TAGCACHE")
+#define DRC_TAGCACHEMISS tagGen->CreateTag("DRC_TAGCACHEMISS")
 
 class NVMain;
 
@@ -69,6 +72,9 @@ class LH_Cache : public AbstractDRAMCache
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     NVMainRequest *MakeTagRequest( NVMainRequest *triggerRequest, int tag );
     NVMainRequest *MakeTagWriteRequest( NVMainRequest *triggerRequest );
@@ -121,7 +127,10 @@ class LH_Cache : public AbstractDRAMCache
     };
 
     bool IssueDRCCommands( NVMainRequest *req );
+    bool IssueTagCacheCommands( NVMainRequest *req );
+    uint64_t TagCacheKey( NVMainRequest *req );
     bool IssueFillCommands( NVMainRequest *req );
+    void ScheduleWake( ncycle_t wakeCycle );
 
     void CalculateLatency( NVMainRequest *req, double *average, 
             uint64_t *measured );
@@ -148,6 +157,17 @@ class LH_Cache : public AbstractDRAMCache
     uint64_t starvation_precharges;
     uint64_t psInterval;
 
+    TagCache *tagCache;
+    uint64_t tagCacheLatency;
+    uint64_t tagCacheHits, tagCacheMisses, tagReadsSaved;
+    uint64_t measuredTagReadLatencies;
+    double averageTagReadLatency;
+    double tagCacheHitRate, tagCacheLatencySaved;
+
+    std::string drcPolicy;
+    uint64_t drcPolicyHits, drcPolicyFills, drcPolicyEvicts;
+    double drcPolicyHitrate;
+
     uint64_t fillQueueSize, drcQueueSize;
 
     bool **bankLocked;
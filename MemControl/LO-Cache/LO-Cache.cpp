@@ -36,6 +36,8 @@
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicyFactory.h"
 
 #include <iostream>
 #include <sstream>
@@ -67,6 +69,12 @@ LO_Cache::LO_Cache( )
     rb_miss = 0;
     starvation_precharges = 0;
 
+    drc_policy = "LRU";
+    drc_policy_hits = 0;
+    drc_policy_fills = 0;
+    drc_policy_evicts = 0;
+    drc_policy_hitrate = 0.0;
+
     perfectFills = false;
     max_addr = 0;
 
@@ -98,6 +106,8 @@ void LO_Cache::SetConfig( Config *conf, bool createChildren )
     if( conf->KeyExists( "PerfectFills" ) && conf->GetString( "PerfectFills" ) == "true" )
         perfectFills = true;
 
+    if( conf->KeyExists( "DRCReplacementPolicy" ) )
+        drc_policy = conf->GetString( "DRCReplacementPolicy" );
 
     ranks = static_cast<ncounter_t>( conf->GetValue( "RANKS" ) );
     banks = static_cast<ncounter_t>( conf->GetValue( "BANKS" ) );
@@ -115,6 +125,9 @@ void LO_Cache::SetConfig( Config *conf, bool createChildren )
               * static_cast<ncounter_t>( conf->GetValue( "tBURST" ) );
     word_size /= 8;
 
+    /* Line data is only kept when the simulation carries data. */
+    bool storeData = !( conf->KeyExists( "IgnoreData" ) 
+                        && conf->GetString( "IgnoreData" ) == "true" );
 
     functionalCache = new CacheBank**[ranks];
     for( ncounter_t i = 0; i < ranks; i++ )
@@ -132,7 +145,11 @@ void LO_Cache::SetConfig( Config *conf, bool createChildren )
              *  an assoc of 1, and cache line size of 64 bytes.
              */
             lines = (cols * word_size) / 72;
-            functionalCache[i][j] = new CacheBank( rows, lines, 1, 64 );
+            functionalCache[i][j] = new CacheBank( rows, lines, 1, 64, storeData );
+
+            ReplacementPolicy *policy = ReplacementPolicyFactory::CreateReplacementPolicy( drc_policy );
+            policy->SetConfig( conf );
+            functionalCache[i][j]->SetReplacementPolicy( policy );
         }
     }
 
@@ -152,6 +169,11 @@ void LO_Cache::RegisterStats( )
     AddStat(rb_hits);
     AddStat(rb_miss);
     AddStat(starvation_precharges);
+    AddStat(drc_policy);
+    AddStat(drc_policy_hits);
+    AddStat(drc_policy_fills);
+    AddStat(drc_policy_evicts);
+    AddStat(drc_policy_hitrate);
 
     MemoryController::RegisterStats( );
 }
@@ -172,7 +194,8 @@ bool LO_Cache::IssueAtomic( NVMainRequest *req )
     /*
     *  Check for a hit for statistical purposes first.
     */
-    if( req->type == WRITE || req->type == WRITE_PRECHARGE || functionalCache[rank][bank]->Present( req->address ) )
+    if( functionalCache[rank][bank]->Touch( req->address ) 
+        || req->type == WRITE || req->type == WRITE_PRECHARGE )
     {
         drc_hits++;
     }
@@ -213,7 +236,8 @@ bool LO_Cache::IssueFunctional( NVMainRequest *req )
     if( req->type == WRITE || req->type == WRITE_PRECHARGE )
         return true;
 
-    /* Reads hit if they are in the cache. */
+    /* Reads hit if they are in the cache. This is a probe, e.g., by a
+     * predictor, so the replacement state is kept. */
     return functionalCache[rank][bank]->Present( req->address );
 }
 
@@ -381,16 +405,19 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
             bool dirtyEvict = false;
             NVMAddress victim;
 
-            if( functionalCache[rank][bank]->SetFull( req->address )
-                && !functionalCache[rank][bank]->Present( req->address ) )
+            /* A write hit only updates the replacement state. */
+            if( !functionalCache[rank][bank]->Touch( req->address ) )
             {
-                (void)functionalCache[rank][bank]->ChooseVictim( req->address, &victim );
-                dirtyEvict = functionalCache[rank][bank]->Evict( victim, &vicData );
+                if( functionalCache[rank][bank]->SetFull( req->address ) )
+                {
+                    (void)functionalCache[rank][bank]->ChooseVictim( req->address, &victim );
+                    dirtyEvict = functionalCache[rank][bank]->Evict( victim, &vicData );
 
-                drc_evicts++;
-            }
+                    drc_evicts++;
+                }
 
-            (void)functionalCache[rank][bank]->Install( req->address, req->data );
+                (void)functionalCache[rank][bank]->Install( req->address, req->data );
+            }
 
             /* Send back to requestor. */
             GetParent( )->RequestComplete( req );
@@ -431,7 +458,7 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
             req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
 
             /* Check for a hit. */
-            bool hit = functionalCache[rank][bank]->Present( req->address );
+            bool hit = functionalCache[rank][bank]->Touch( req->address );
 
             /* On a miss, send to main memory. */
             if( !hit )
@@ -521,62 +548,46 @@ void LO_Cache::CalculateStats( )
     if( drc_hits+drc_miss > 0 )
         drc_hitrate = static_cast<float>(drc_hits) / static_cast<float>(drc_miss+drc_hits);
 
+    /* Policy counters are cumulative, so sum them up from scratch. */
+    drc_policy_hits = drc_policy_fills = drc_policy_evicts = 0;
+    for( ncounter_t i = 0; i < ranks && functionalCache != NULL; i++ )
+    {
+        for( ncounter_t j = 0; j < banks; j++ )
+        {
+            ReplacementPolicy *policy = functionalCache[i][j]->GetReplacementPolicy( );
+
+            drc_policy_hits += policy->GetHits( );
+            drc_policy_fills += policy->GetFills( );
+            drc_policy_evicts += policy->GetEvictions( );
+        }
+    }
+
+    drc_policy_hitrate = 0.0;
+    if( drc_policy_hits+drc_policy_fills > 0 )
+        drc_policy_hitrate = static_cast<double>(drc_policy_hits) 
+                           / static_cast<double>(drc_policy_hits+drc_policy_fills);
+
     MemoryController::CalculateStats( );
 }
 
 void LO_Cache::CreateCheckpoint( std::string dir )
 {
-    /* Use our statName as the file to write in the checkpoint directory. */
+    /* Use our statName with the rank and bank as the file name. */
     for( ncounter_t rankIdx = 0; rankIdx < ranks; rankIdx++ )
     {
         for( ncounter_t bankIdx = 0; bankIdx < banks; bankIdx++ )
         {
-            std::stringstream cpt_file;
-            cpt_file.str("");
-            cpt_file << dir << "/" << statName << "_r";
-            cpt_file << rankIdx << "_b" << bankIdx;
+            std::stringstream cpt_name;
+            cpt_name << statName << "_r" << rankIdx << "_b" << bankIdx;
 
-            std::ofstream cpt_handle;
-            
-            cpt_handle.open( cpt_file.str().c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
+            CheckpointWriter cpt( dir, cpt_name.str() );
 
-            if( !cpt_handle.is_open( ) )
-            {
-                std::cout << "LO_Cache: Warning: Could not open checkpoint file: " << cpt_file.str() << "!" << std::endl;
-            }
-            else
-            {
-                /* Iterate over cache sets, since they may not be allocated contiguously. */
-                for( uint64_t set = 0; set < functionalCache[rankIdx][bankIdx]->numSets; set++ )
-                {
-                    cpt_handle.write( (const char *)(functionalCache[rankIdx][bankIdx]->cacheEntry[set]), 
-                                      sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc );
-                }
-
-                cpt_handle.close( );
-            }
-
-            /* Write checkpoint information. */
-            /* Note: For future compatability only at the memory. This is not read during restoration. */
-            std::string cpt_info = cpt_file.str() + ".json";
-
-            cpt_handle.open( cpt_info.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
-
-            if( !cpt_handle.is_open() )
-            {
-                std::cout << "LO_Cache: Warning: Could not open checkpoint info file: " << cpt_info << "!" << std::endl;
-            }
-            else
-            {
-                std::string cpt_info_str = "{\n\t\"Version\": 1\n}";
-                cpt_handle.write( cpt_info_str.c_str(), cpt_info_str.length() ); 
-
-                cpt_handle.close();
-            }
+            if( cpt.IsOpen( ) )
+                functionalCache[rankIdx][bankIdx]->WriteCheckpoint( cpt );
         }
     }
 
-    NVMObject::CreateCheckpoint( dir );
+    MemoryController::CreateCheckpoint( dir );
 }
 
 void LO_Cache::RestoreCheckpoint( std::string dir )
@@ -585,46 +596,19 @@ void LO_Cache::RestoreCheckpoint( std::string dir )
     {
         for( ncounter_t bankIdx = 0; bankIdx < banks; bankIdx++ )
         {
-            std::stringstream cpt_file;
-            cpt_file.str("");
-            cpt_file << dir << "/" << statName << "_r";
-            cpt_file << rankIdx << "_b" << bankIdx;
+            std::stringstream cpt_name;
+            cpt_name << statName << "_r" << rankIdx << "_b" << bankIdx;
 
-            std::ifstream cpt_handle;
+            CheckpointReader cpt( dir, cpt_name.str() );
 
-            cpt_handle.open( cpt_file.str().c_str(), std::ifstream::ate | std::ifstream::binary );
-
-            if( !cpt_handle.is_open( ) )
-            {
-                std::cout << "LO_Cache: Warning: Could not open checkpoint file: " << cpt_file.str() << "!" << std::endl;
-            }
-            else
+            if( cpt.IsOpen( ) 
+                && !functionalCache[rankIdx][bankIdx]->ReadCheckpoint( cpt ) )
             {
-                std::streampos expectedSize = sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numSets*functionalCache[rankIdx][bankIdx]->numAssoc;
-                if( cpt_handle.tellg( ) != expectedSize )
-                {
-                    std::cout << "LO_Cache: Warning: Expected checkpoint size differs from DRAM cache configuration. Skipping restore." << std::endl;
-                }
-                else
-                {
-                    cpt_handle.close( );
-
-                    cpt_handle.open( cpt_file.str().c_str(), std::ifstream::in | std::ifstream::binary );
-
-                    /* Iterate over cache sets, since they may not be allocated contiguously. */
-                    for( uint64_t set = 0; set < functionalCache[rankIdx][bankIdx]->numSets; set++ )
-                    {
-                        cpt_handle.read( (char *)(functionalCache[rankIdx][bankIdx]->cacheEntry[set]), 
-                                          sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc );
-                    }
-
-                    cpt_handle.close( );
-
-                    std::cout << "LO_Cache: Checkpoint read " << (sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc*functionalCache[rankIdx][bankIdx]->numSets) << " bytes." << std::endl;
-                }
+                std::cout << "LO_Cache: Warning: Could not restore checkpoint " 
+                          << cpt_name.str() << "." << std::endl;
             }
         }
     }
 
-    NVMObject::RestoreCheckpoint( dir );
+    MemoryController::RestoreCheckpoint( dir );
 }
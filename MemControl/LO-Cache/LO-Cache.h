@@ -77,7 +77,7 @@ class LO_Cache : public AbstractDRAMCache
     void CreateCheckpoint( std::string dir );
     void RestoreCheckpoint( std::string dir );
 
-  private:
+  protected:
     NVMTransactionQueue *drcQueue;
     NVMain *mainMemory;
     Config *mainMemoryConfig;
@@ -93,6 +93,10 @@ class LO_Cache : public AbstractDRAMCache
     ncounter_t rb_hits, rb_miss;
     ncounter_t starvation_precharges;
 
+    std::string drc_policy;
+    ncounter_t drc_policy_hits, drc_policy_fills, drc_policy_evicts;
+    double drc_policy_hitrate;
+
     bool perfectFills;
     uint64_t max_addr;
     double drc_hitrate;
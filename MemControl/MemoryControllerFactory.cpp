@@ -39,7 +39,9 @@
 #include "MemControl/DRAMCache/DRAMCache.h"
 #include "MemControl/LH-Cache/LH-Cache.h"
 #include "MemControl/LO-Cache/LO-Cache.h"
+#include "MemControl/Alloy-Cache/Alloy-Cache.h"
 #include "MemControl/PredictorDRC/PredictorDRC.h"
+#include "MemControl/MissMap/MissMap.h"
 
 #include <iostream>
 
@@ -66,8 +68,12 @@ MemoryController *MemoryControllerFactory::CreateNewController( std::string cont
         memoryController = new LH_Cache( );
     else if( controller == "LO_Cache" )
         memoryController = new LO_Cache( );
+    else if( controller == "Alloy_Cache" )
+        memoryController = new Alloy_Cache( );
     else if( controller == "PredictorDRC" )
         memoryController = new PredictorDRC( );
+    else if( controller == "MissMap" )
+        memoryController = new MissMap( );
 
     if( memoryController == NULL )
         std::cout << "NVMain: Unknown memory controller `" 
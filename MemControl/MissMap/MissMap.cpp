@@ -36,13 +36,21 @@
 #include "MemControl/LH-Cache/LH-Cache.h"
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
+#include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicyFactory.h"
 #include <assert.h>
+#include <sstream>
+#include <cstdlib>
 
 using namespace NVM;
 
 MissMap::MissMap( )
 {
     missMap = NULL;
+    mainMemory = NULL;
+    drcChannels = NULL;
+    numChannels = 0;
 
     missMapAllocations = 0;
     missMapWrites = 0;
@@ -50,6 +58,19 @@ MissMap::MissMap( )
     missMapMisses = 0;
     missMapForceEvicts = 0;
     missMapMemReads = 0;
+    missMapPortStalls = 0;
+    missMapFootprint = 0;
+
+    missMapLatency = 1;
+    missMapPorts = 1;
+    portsUsed = 0;
+    portCycle = 0;
+
+    missMapPolicy = "LRU";
+    missMapPolicyHits = 0;
+    missMapPolicyFills = 0;
+    missMapPolicyEvicts = 0;
+    missMapPolicyHitrate = 0.0;
 
     psInterval = 0;
 }
@@ -77,14 +98,15 @@ void MissMap::SetConfig( Config *conf, bool createChildren )
     if( conf->KeyExists( "MissMapAssoc" ) ) 
         mmAssoc = static_cast<uint64_t>( conf->GetValue( "MissMapAssoc" ) );
 
-    missMapQueueSize = 32;
-    if( conf->KeyExists( "MissMapQueueSize" ) ) 
-        missMapQueueSize = static_cast<uint64_t>( conf->GetValue( "MissMapQueueSize" ) );
-
-    uint64_t missMapLatency = 10;
     if( conf->KeyExists( "MissMapLatency" ) ) 
         missMapLatency = static_cast<uint64_t>( conf->GetValue( "MissMapLatency" ) );
 
+    if( conf->KeyExists( "MissMapPorts" ) ) 
+        missMapPorts = static_cast<ncounter_t>( conf->GetValue( "MissMapPorts" ) );
+
+    if( conf->KeyExists( "MissMapReplacementPolicy" ) ) 
+        missMapPolicy = conf->GetString( "MissMapReplacementPolicy" );
+
     if( createChildren )
     {
         /* Initialize off-chip memory */
@@ -98,40 +120,105 @@ void MissMap::SetConfig( Config *conf, bool createChildren )
         mainMemoryConfig->Read( configFile );
 
         mainMemory = new NVMain( );
-        mainMemory->SetConfig( mainMemoryConfig, "offChipMemory", createChildren );
+        EventQueue *mainMemoryEventQueue = new EventQueue( );
         mainMemory->SetParent( this ); 
+        mainMemory->SetEventQueue( mainMemoryEventQueue );
+        GetGlobalEventQueue( )->AddSystem( mainMemory, mainMemoryConfig );
+        mainMemory->SetConfig( mainMemoryConfig, "offChipMemory", createChildren );
+
+        /* Orphan the interconnect created by NVMain */
+        std::vector<NVMObject_hook *>& childNodes = GetChildren( );
+
+        childNodes.clear();
 
         std::string drcVariant = "LH_Cache";
         if( conf->KeyExists( "DRCVariant" ) ) 
             drcVariant = conf->GetString( "DRCVariant" );
 
+        /* Setup the translation method for DRAM cache decoders. */
+        int channels, ranks, banks, rows, cols, subarrays;
+        
+        if( conf->KeyExists( "MATHeight" ) )
+        {
+            rows = conf->GetValue( "MATHeight" );
+            subarrays = conf->GetValue( "ROWS" ) / conf->GetValue( "MATHeight" );
+        }
+        else
+        {
+            rows = conf->GetValue( "ROWS" );
+            subarrays = 1;
+        }
+
+        cols = conf->GetValue( "COLS" );
+        banks = conf->GetValue( "BANKS" );
+        ranks = conf->GetValue( "RANKS" );
+        channels = static_cast<int>( numChannels );
+
+        TranslationMethod *drcMethod = new TranslationMethod();
+        drcMethod->SetBitWidths( NVM::mlog2( rows ),
+                                 NVM::mlog2( cols ),
+                                 NVM::mlog2( banks ),
+                                 NVM::mlog2( ranks ),
+                                 NVM::mlog2( channels ),
+                                 NVM::mlog2( subarrays )
+                                 );
+        drcMethod->SetCount( rows, cols, banks, ranks, channels, subarrays );
+        drcMethod->SetAddressMappingScheme(conf->GetString("AddressMappingScheme"));
+
+        /* When selecting a child, use the channel field from a DRC decoder. */
+        DRCDecoder *drcDecoder = new DRCDecoder( );
+        drcDecoder->SetConfig( conf, createChildren );
+        drcDecoder->SetTranslationMethod( drcMethod );
+        drcDecoder->SetDefaultField( CHANNEL_FIELD );
+        if( conf->KeyExists( "IgnoreBits" ) )
+            drcDecoder->SetIgnoreBits( conf->GetValue( "IgnoreBits" ) );
+
+        SetDecoder( drcDecoder );
+
         drcChannels = new LH_Cache*[numChannels];
         for( ncounter_t i = 0; i < numChannels; i++ )
         {
+            std::stringstream formatter;
+
             drcChannels[i] = dynamic_cast<LH_Cache *>( 
                     MemoryControllerFactory::CreateNewController( drcVariant ));
 
+            /* The MissMap tracks lines in set-associative LH_Cache channels only. */
+            if( drcChannels[i] == NULL )
+            {
+                std::cerr << "MissMap: DRCVariant must be LH_Cache, not " 
+                          << drcVariant << "." << std::endl;
+                exit(1);
+            }
+
             drcChannels[i]->SetMainMemory( mainMemory );
 
+            formatter << StatName( ) << "." << drcVariant << i;
             drcChannels[i]->SetID( static_cast<unsigned int>(i) );
-            drcChannels[i]->StatName( this->statName ); 
+            drcChannels[i]->StatName( formatter.str() ); 
 
             drcChannels[i]->SetParent( this );
             AddChild( drcChannels[i] );
 
             drcChannels[i]->SetConfig( conf, createChildren );
+            drcChannels[i]->RegisterStats( );
         }
 
-        missMap = new CacheBank( 1, mmSets, mmAssoc, 64 ); 
-        missMap->isMissMap = true;
+        /* Add mainMemory as the last child */
+        AddChild( mainMemory );
+
+        /* One entry per 4KB region with a presence bit per 64B line. */
+        missMap = new RegionPresenceMap( mmSets, mmAssoc, 4096, 64 ); 
 
-        missMap->SetParent( this );
-        AddChild( missMap );
+        ReplacementPolicy *policy = ReplacementPolicyFactory::CreateReplacementPolicy( missMapPolicy );
+        policy->SetConfig( conf );
+        missMap->SetReplacementPolicy( policy );
 
-        missMap->SetReadTime( missMapLatency );
-        missMap->SetWriteTime( missMapLatency );
+        missMapFootprint = missMap->GetFootprint( );
     }
 
+    SetDebugName( "MissMap", conf );
+
     std::cout << "Created a MissMap!" << std::endl;
 }
 
@@ -143,102 +230,119 @@ void MissMap::RegisterStats( )
     AddStat(missMapMisses);
     AddStat(missMapForceEvicts);
     AddStat(missMapMemReads);
+    AddStat(missMapPortStalls);
+    AddUnitStat(missMapFootprint, "B");
+    AddStat(missMapPolicy);
+    AddStat(missMapPolicyHits);
+    AddStat(missMapPolicyFills);
+    AddStat(missMapPolicyEvicts);
+    AddStat(missMapPolicyHitrate);
 }
 
+/* All lookup ports were used this cycle. */
 bool MissMap::QueueFull( NVMainRequest * )
 {
-    return (missMapQueue.size() >= missMapQueueSize);
+    if( portCycle != GetEventQueue( )->GetCurrentCycle( ) )
+    {
+        portCycle = GetEventQueue( )->GetCurrentCycle( );
+        portsUsed = 0;
+    }
+
+    return (portsUsed >= missMapPorts);
 }
 
-bool MissMap::IssueAtomic( NVMainRequest *req )
+bool MissMap::IsIssuable( NVMainRequest *req, FailReason * /*reason*/ )
 {
-    /* Just install in the miss map if the address does not yet exist */
-    uint64_t *lineMap, lineMask, lineOffset;
-    NVMAddress testAddr;
-    NVMDataBlock data;
+    uint64_t chan;
 
-    /* 6 = log2(cacheline size), 12 = log2(segment size) */
-    testAddr.SetPhysicalAddress( (req->address.GetPhysicalAddress( ) >> 6) >> 12 ); 
+    Retranslate( req );
+    req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
+    assert( chan < numChannels );
 
-    /* 6 = log2(cacheline size), 0xFFF = segment size - 1, 64 = 
-     * segment size / cacheline size 
-     */
-    lineOffset = ((req->address.GetPhysicalAddress( ) >> 6) & 0xFFF) / 64; 
-    lineMask = (uint64_t)(1ULL << lineOffset);
-
-    std::cout << "Address 0x" << std::hex << req->address.GetPhysicalAddress() 
-        << " maps to page 0x" << testAddr.GetPhysicalAddress( ) << std::dec 
-        << " with offset " << lineOffset << std::endl;
-    
-    /* Entry exists, so augment the existing bit-vector */
-    if( missMap->Present( testAddr ) )
-    {
-        missMap->Read( req->address, &data );
+    return !QueueFull( req ) && drcChannels[chan]->IsIssuable( req );
+}
+
+void MissMap::Retranslate( NVMainRequest *req )
+{
+    uint64_t col, row, bank, rank, chan, subarray;
 
-        lineMap = reinterpret_cast<uint64_t *>(data.rawData);
+    GetDecoder()->Translate( req->address.GetPhysicalAddress(), &row, &col, &bank, &rank, &chan, &subarray );
+    req->address.SetTranslatedAddress( row, col, bank, rank, chan, subarray );
+}
 
-        if( !((*lineMap) & lineMask) ) // NOT in MissMap.
-        {
-            *lineMap |= lineMask;
-        }
-    }
-    /* Entry doesn't exist. Create a new bit-vector and write it. */
-    else
-    {
-        /* If there is no space, toss something. */
-        if( missMap->SetFull( testAddr ) )
-        {
-            NVMAddress victim;
-            NVMDataBlock dummy;
+/* The channel's tags must agree with the presence bits set for the line. */
+void MissMap::InstallInDRC( NVMainRequest *req )
+{
+    uint64_t chan;
 
-            missMap->ChooseVictim( testAddr, &victim );
-            missMap->Evict( victim, &dummy );
-        }
+    req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
 
-        /* Create a new bit-vector with just this cacheline as the entry. */
-        lineMap = new uint64_t;
+    drcChannels[chan]->IssueAtomic( req );
+}
 
-        *lineMap = lineMask;
-        data.rawData = reinterpret_cast<uint8_t*>(lineMap);
+/* Requests the channel cannot take now are retried as requests complete. */
+void MissMap::IssueToDRC( NVMainRequest *req )
+{
+    uint64_t chan;
 
-        missMap->Install( testAddr, data ); 
-    }
+    Retranslate( req );
+    req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
+    assert( chan < numChannels );
+
+    if( !pendingDRCRequests.empty( ) || !drcChannels[chan]->IssueCommand( req ) )
+        pendingDRCRequests.push( req );
+}
+
+bool MissMap::IssueAtomic( NVMainRequest *req )
+{
+    /* Just install in the miss map if the address does not yet exist */
+    uint64_t victimRegion, victimLines;
+
+    NVMDebug( DEBUG_TRACE ) << "Address 0x" << std::hex 
+        << req->address.GetPhysicalAddress() << std::dec 
+        << " is marked present in the miss map." << std::endl;
+
+    (void)missMap->Insert( req->address.GetPhysicalAddress( ), 
+                           &victimRegion, &victimLines );
+
+    Retranslate( req );
+    InstallInDRC( req );
 
     return true;
 }
 
+/*
+ *  Each port takes one lookup per cycle. The lookup and the update of the
+ *  presence bits happen together when the access completes.
+ */
 bool MissMap::IssueCommand( NVMainRequest *req )
 {
     bool rv = false;
 
-    /* Make sure there is space in the MissMap's queue */
-    if( missMapQueue.size( ) < missMapQueueSize )
+    Retranslate( req );
+
+    if( !QueueFull( req ) )
     {
         NVMainRequest *mmReq = new NVMainRequest( );
-        CacheRequest *creq = new CacheRequest;
 
         *mmReq = *req;
         mmReq->tag = MISSMAP_READ;
-        mmReq->reqInfo = static_cast<void *>( creq );
+        mmReq->reqInfo = static_cast<void *>( req );
         mmReq->owner = this;
 
-        creq->optype = CACHE_READ;
-        creq->address = req->address; 
-
-        /* Use the PAGE ADDRESS for the miss map */
-        creq->address.SetPhysicalAddress( 
-                (creq->address.GetPhysicalAddress( ) >> 6) >> 12 ); 
-        creq->owner = this;
-        creq->originalRequest = req;
+        portsUsed++;
 
-        missMapQueue.push( mmReq );
+        GetEventQueue( )->InsertEvent( EventResponse, this, mmReq, 
+                GetEventQueue( )->GetCurrentCycle( ) + missMapLatency );
 
-#ifdef DBGMISSMAP
-        std::cout << "Enqueued a request to the miss map. " << std::endl;
-#endif
+        NVMDebug( DEBUG_TRACE ) << "Issued a probe to the miss map. " << std::endl;
 
         rv = true;
     }
+    else
+    {
+        missMapPortStalls++;
+    }
 
     return rv;
 }
@@ -247,221 +351,93 @@ bool MissMap::RequestComplete( NVMainRequest *req )
 {
     bool rv = false;
 
-    if( req->owner == this )
+    if( req->type == REFRESH )
+    {
+        ProcessRefreshPulse( req );
+    }
+    else if( req->owner == this )
     {
         if( req->tag == MISSMAP_READ )
         {
-            CacheRequest *cacheReq = static_cast<CacheRequest *>( req->reqInfo );
+            NVMainRequest *originalRequest = static_cast<NVMainRequest *>( req->reqInfo );
+            uint64_t address = originalRequest->address.GetPhysicalAddress( );
 
-#ifdef DBGMISSMAP
-            std::cout << "MissMap read complete. Hit = " 
-                << cacheReq->hit << std::endl;
-#endif
-
-            /* Found miss map entry for this page. */
-            if( cacheReq->hit )
+            /* Check MissMap entry for this cacheline. */
+            if( missMap->LinePresent( address ) )
             {
-                /* Check MissMap entry for this cacheline. */
-                uint64_t *lineMap;
-                uint64_t lineMask;
-                uint64_t lineOffset; 
+                NVMDebug( DEBUG_TRACE ) << "Found cacheline in miss map, "
+                    << "issuing to DRC." << std::endl;
 
-                lineOffset = ((req->address.GetPhysicalAddress( ) >> 6) & 0xFFF) / 64;
-                lineMap = reinterpret_cast<uint64_t *>(cacheReq->data.rawData);
-                lineMask = (uint64_t)(1ULL << lineOffset);
+                /* In DRC -- Issue to DRC. */
+                IssueToDRC( originalRequest );
 
-                /* Check for this bit corresponding to this cache line. */
-                if( (*lineMap) & lineMask )
-                {
-#ifdef DBGMISSMAP
-                    std::cout << "Found cacheline in miss map, issuing to DRC." 
-                        << std::endl;
-#endif
-
-                    /* In DRC -- Issue to DRC. */
-                    uint64_t chan;
-
-                    cacheReq->originalRequest->address.GetTranslatedAddress( 
-                            NULL, NULL, NULL, NULL, &chan, NULL );
-
-                    assert( chan < numChannels );
-
-                    drcChannels[chan]->IssueCommand( cacheReq->originalRequest );
-
-                    missMapHits++;
-                }
-                else
-                {
-#ifdef DBGMISSMAP
-                    std::cout << "Did not find cacheline; issuing to main memory." 
-                        << std::endl;
-#endif
-
-                    /* 
-                     *  Not in DRC -- Issue to main memory.
-                     *  Writes go to DRC since they don't miss.
-                     */
-                    if( cacheReq->originalRequest->type == READ )
-                    {
-                        cacheReq->originalRequest->tag = MISSMAP_MEMREAD;
-                        mainMemory->IssueCommand( cacheReq->originalRequest );
-                    }
-                    else
-                    {
-                        uint64_t chan;
-
-                        cacheReq->originalRequest->address.GetTranslatedAddress( 
-                                NULL, NULL, NULL, NULL, &chan, NULL );
-
-                        drcChannels[chan]->IssueCommand( cacheReq->originalRequest );
-                    }
-
-                    /* Write the new miss map line as well. */
-                    NVMainRequest *mmFill = new NVMainRequest( );
-                    CacheRequest *fillCReq = new CacheRequest( );
-
-                    *lineMap |= (uint64_t)(1ULL << lineOffset);
-                    fillCReq->data.rawData = reinterpret_cast<uint8_t *>( lineMap );
-
-                    fillCReq->optype = CACHE_WRITE;
-                    fillCReq->address = req->address; 
-                    /* Use the PAGE ADDRESS for the miss map */
-                    fillCReq->address.SetPhysicalAddress( 
-                            (fillCReq->address.GetPhysicalAddress( ) >> 6) >> 12 ); 
-                    fillCReq->owner = this;
-                    fillCReq->originalRequest = NULL;
-
-                    *mmFill = *req;
-                    mmFill->owner = this;
-                    mmFill->reqInfo = static_cast<void *>( fillCReq );
-                    mmFill->tag = MISSMAP_WRITE;
-
-                    missMapWrites++;
-                    missMapMisses++;
-
-                    missMapFillQueue.push( mmFill );
-
-#ifdef DBGMISSMAP
-                    std::cout << "Updating miss map entry 0x" 
-                        << fillCReq->address.GetPhysicalAddress( )
-                        << " with bit vector 0x" << std::hex << (*lineMap) 
-                        << std::dec << std::endl;
-#endif
-                }
+                missMapHits++;
             }
-            /* No miss map entry for this page. */
             else
             {
+                uint64_t victimRegion, victimLines;
+
+                NVMDebug( DEBUG_TRACE ) << "Did not find cacheline; "
+                    << "issuing to main memory." << std::endl;
+
                 /* 
                  *  Not in DRC -- Issue to main memory.
                  *  Writes go to DRC since they don't miss.
                  */
-                if( cacheReq->originalRequest->type == READ )
+                if( originalRequest->type == READ )
                 {
-                    cacheReq->originalRequest->tag = MISSMAP_MEMREAD;
-                    mainMemory->IssueCommand( cacheReq->originalRequest );
+                    originalRequest->tag = MISSMAP_MEMREAD;
+
+                    if( mainMemory->IsIssuable( originalRequest, NULL ) )
+                        mainMemory->IssueCommand( originalRequest );
+                    else
+                        mainMemory->EnqueuePendingMemoryRequests( originalRequest );
                 }
                 else
                 {
-                    uint64_t chan;
-
-                    cacheReq->originalRequest->address.GetTranslatedAddress( 
-                            NULL, NULL, NULL, NULL, &chan, NULL );
-
-                    drcChannels[chan]->IssueCommand( cacheReq->originalRequest );
+                    IssueToDRC( originalRequest );
+                    InstallInDRC( originalRequest );
                 }
 
-                /* Install this line to MissMap. */
-                NVMainRequest *mmFill = new NVMainRequest( );
-                CacheRequest *fillCReq = new CacheRequest( );
-                uint64_t lineOffset = ((req->address.GetPhysicalAddress( ) >> 6) & 0xFFF) / 64;
-                uint64_t *lineMap = new uint64_t;
-
-                *lineMap = 0;
-                *lineMap |= (uint64_t)(1ULL << lineOffset);
-                fillCReq->data.rawData = reinterpret_cast<uint8_t *>(lineMap);
-
-                fillCReq->optype = CACHE_WRITE;
-                fillCReq->address = req->address; 
-                /* Use the PAGE ADDRESS for the miss map */
-                fillCReq->address.SetPhysicalAddress( 
-                        (fillCReq->address.GetPhysicalAddress( ) >> 6) >> 12 ); 
-                fillCReq->owner = this;
-                fillCReq->originalRequest = NULL;
-
-                *mmFill = *req;
-                mmFill->owner = this;
-                mmFill->reqInfo = static_cast<void *>( fillCReq );
-                mmFill->tag = MISSMAP_WRITE;
-
-                missMapAllocations++;
-                missMapWrites++;
-                missMapMisses++;
-
-                missMapFillQueue.push( mmFill );
-
-#ifdef DBGMISSMAP
-                std::cout << "Adding new miss map entry 0x" 
-                    << fillCReq->address.GetPhysicalAddress( )
-                    << " with bit vector 0x" << std::hex << (*lineMap) 
-                    << std::dec << std::endl;
-#endif
-            }
+                if( !missMap->RegionPresent( address ) )
+                    missMapAllocations++;
 
-            delete cacheReq;
-        }
-        else if( req->tag == MISSMAP_WRITE )
-        {
-            /* Just delete the cache request struct. */
-            CacheRequest *creq = static_cast<CacheRequest *>( req->reqInfo );
-
-#ifdef DBGMISSMAP
-            std::cout << "Wrote to the miss map." << std::endl;
-#endif
-
-            /* Check if there was an eviction. */
-            if( creq->optype == CACHE_EVICT )
-            {
-                /* Ensure consistency in DRC by evicting any cachelines in this miss map entry. */
-                uint64_t chan;
+                /* Mark the line present, which may displace another region. */
+                if( missMap->Insert( address, &victimRegion, &victimLines ) )
+                {
+                    NVMDebug( DEBUG_TRACE ) << "Miss map evicted region 0x" 
+                        << std::hex << victimRegion << std::dec << std::endl;
 
-                req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
-                assert( chan < numChannels );
+                    /* 
+                     *  Ensure consistency in DRC by evicting every cacheline
+                     *  the victim region marked present.
+                     */
+                    uint64_t lineSize = missMap->GetRegionSize( ) 
+                                      / missMap->GetLinesPerRegion( );
 
-                NVMainRequest *evictReq = new NVMainRequest( );
+                    for( uint64_t line = 0; line < missMap->GetLinesPerRegion( ); line++ )
+                    {
+                        if( (victimLines & (1ULL << line)) == 0 )
+                            continue;
 
-                *evictReq = *req;
-                evictReq->owner = this;
-                evictReq->tag = MISSMAP_FORCE_EVICT;
+                        NVMainRequest *evictReq = new NVMainRequest( );
 
-#ifdef DBGMISSMAP
-                std::cout << "Miss map evicted a line.." << std::endl;
-#endif
+                        *evictReq = *req;
+                        evictReq->address.SetPhysicalAddress( victimRegion + lineSize * line );
+                        evictReq->type = READ;
+                        evictReq->owner = this;
+                        evictReq->reqInfo = NULL;
+                        evictReq->tag = MISSMAP_FORCE_EVICT;
 
-                /* Count the number of cachelines being evicted. */
-                uint64_t *lineMap = reinterpret_cast<uint64_t *>(creq->data.rawData);
-                uint64_t lineCount = 0;
+                        IssueToDRC( evictReq );
 
-                for( int i = 0; i < 64; i++ )
-                {
-                    if( *lineMap & 0x1 )
-                        lineCount++;
-
-                    *lineMap >>= 1;
+                        missMapForceEvicts++;
+                    }
                 }
 
-                missMapForceEvicts += lineCount;
-
-                /* 
-                 * We should be able to delete this allocated memory at this 
-                 * point. 
-                 */
-                delete lineMap;
-
-                drcChannels[chan]->IssueCommand( evictReq );
+                missMapWrites++;
+                missMapMisses++;
             }
-
-            delete creq;
         }
 
         delete req;
@@ -473,62 +449,127 @@ bool MissMap::RequestComplete( NVMainRequest *req )
      */
     else if( req->tag == MISSMAP_MEMREAD )
     {
-        uint64_t chan;
+        /* The read is done, and a copy of the line fills the DRAM cache. */
+        NVMainRequest *fillReq = new NVMainRequest( );
 
-        req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
+        *fillReq = *req;
+        fillReq->type = WRITE;
+        fillReq->tag = 0;
+        fillReq->owner = this;
+        fillReq->reqInfo = NULL;
 
-        // This is now a fill request.
-        req->type = WRITE;
-        req->tag = 0;
-
-#ifdef DBGMISSMAP
-        std::cout << "MissMap memory access returned, filling DRAM cache. " 
+        NVMDebug( DEBUG_TRACE ) << "MissMap memory access returned, filling DRAM cache. " 
             << std::endl;
-#endif
 
-        drcChannels[chan]->IssueCommand( req );
+        IssueToDRC( fillReq );
+        InstallInDRC( fillReq );
 
         missMapMemReads++;
 
-        rv = false;
+        req->tag = 0;
+        rv = GetParent( )->RequestComplete( req );
     }
-
-    return rv;
-}
-
-void MissMap::Cycle( ncycle_t )
-{
-    /* Issue MissMap commands */
-    if( missMap && (!missMapQueue.empty( ) || !missMapFillQueue.empty()) )
+    else
     {
-        /* Give priority to write to install new miss map entires */
-        if( !missMapFillQueue.empty() )
+        /* 
+         *  Requests owned by a DRAM cache channel (e.g. its main memory
+         *  reads) go back to it, all others are done.
+         */
+        bool drcRequest = false;
+
+        for( ncounter_t i = 0; i < numChannels; i++ )
         {
-            if( missMap->IsIssuable( missMapFillQueue.front(), NULL ) )
+            if( req->owner == drcChannels[i] )
             {
-                missMap->IssueCommand( missMapFillQueue.front() );
-                missMapFillQueue.pop( );
-
-#ifdef DBGMISSMAP
-                std::cout << "Issued a fill to the miss map." << std::endl;
-#endif
+                drcRequest = true;
+                break;
             }
         }
-        else
+
+        if( drcRequest )
         {
-            if( missMap->IsIssuable( missMapQueue.front(), NULL ) )
-            {
-                missMap->IssueCommand( missMapQueue.front() );
-                missMapQueue.pop( );
+            uint64_t chan;
 
-#ifdef DBGMISSMAP
-                std::cout << "Issued a probe to the miss map." << std::endl;
-#endif
-            }
+            /* Retranslate incase the request was rerouted. */
+            Retranslate( req );
+            req->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
+
+            rv = drcChannels[chan]->RequestComplete( req );
+        }
+        else
+        {
+            rv = GetParent( )->RequestComplete( req );
         }
     }
+
+    /* Completions free up the DRAM cache queues. */
+    while( !pendingDRCRequests.empty( ) )
+    {
+        NVMainRequest *pendingReq = pendingDRCRequests.front( );
+        uint64_t chan;
+
+        pendingReq->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, &chan, NULL );
+
+        if( !drcChannels[chan]->IssueCommand( pendingReq ) )
+            break;
+
+        pendingDRCRequests.pop( );
+    }
+
+    return rv;
+}
+
+void MissMap::Cycle( ncycle_t )
+{
+    /* Lookups are scheduled as events when they are issued. */
 }
 
 void MissMap::CalculateStats( )
 {
+    if( missMap == NULL )
+        return;
+
+    for( ncounter_t i = 0; i < numChannels; i++ )
+        drcChannels[i]->CalculateStats( );
+
+    mainMemory->CalculateStats( );
+
+    ReplacementPolicy *policy = missMap->GetReplacementPolicy( );
+
+    missMapPolicyHits = policy->GetHits( );
+    missMapPolicyFills = policy->GetFills( );
+    missMapPolicyEvicts = policy->GetEvictions( );
+
+    missMapPolicyHitrate = 0.0;
+    if( missMapPolicyHits + missMapPolicyFills > 0 )
+        missMapPolicyHitrate = static_cast<double>(missMapPolicyHits) 
+                             / static_cast<double>(missMapPolicyHits + missMapPolicyFills);
+}
+
+/* 
+ *  MissMap is not configured as a regular controller, so only the MissMap
+ *  tags are saved here. The DRAM cache channels and the off-chip memory
+ *  are children and checkpoint themselves.
+ */
+void MissMap::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) + "_missmap" );
+
+    if( cpt.IsOpen( ) && missMap != NULL )
+        missMap->WriteCheckpoint( cpt );
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void MissMap::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) + "_missmap" );
+
+    if( cpt.IsOpen( ) && missMap != NULL && !missMap->ReadCheckpoint( cpt ) )
+    {
+        std::cout << "MissMap: Warning: Could not restore checkpoint " 
+                  << StatName( ) << "_missmap." << std::endl;
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
 }
@@ -34,10 +34,11 @@
 #ifndef __UTILS_MISSMAP_H__
 #define __UTILS_MISSMAP_H__
 
-#include "Utils/Caches/CacheBank.h"
+#include "Utils/Caches/RegionPresenceMap.h"
 #include "src/Config.h"
 #include "src/MemoryController.h"
 #include "MemControl/MemoryControllerFactory.h"
+
 #include <queue>
 
 namespace NVM {
@@ -59,6 +60,7 @@ class MissMap : public MemoryController
     void SetConfig( Config *conf, bool createChildren = true );
 
     bool QueueFull( NVMainRequest *request );
+    bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
 
     bool IssueAtomic( NVMainRequest *req );
     bool IssueCommand( NVMainRequest *req );
@@ -69,21 +71,37 @@ class MissMap : public MemoryController
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
-    CacheBank *missMap;
-    std::queue<NVMainRequest *> missMapQueue;
-    std::queue<NVMainRequest *> missMapFillQueue;
-    uint64_t missMapQueueSize;
+    RegionPresenceMap *missMap;
+    uint64_t missMapLatency;
+    ncounter_t missMapPorts, portsUsed;
+    ncycle_t portCycle;
 
     NVMain *mainMemory;
     LH_Cache **drcChannels;
     ncounter_t numChannels;
 
+    /* DRAM cache requests waiting for room in their channel's queue. */
+    std::queue<NVMainRequest *> pendingDRCRequests;
+
+    void Retranslate( NVMainRequest *req );
+    void IssueToDRC( NVMainRequest *req );
+    void InstallInDRC( NVMainRequest *req );
+
     /* Stats. */
     uint64_t missMapAllocations, missMapWrites;
     uint64_t missMapHits, missMapMisses;
     uint64_t missMapForceEvicts;
     uint64_t missMapMemReads;
+    uint64_t missMapPortStalls;
+    uint64_t missMapFootprint;
+
+    std::string missMapPolicy;
+    uint64_t missMapPolicyHits, missMapPolicyFills, missMapPolicyEvicts;
+    double missMapPolicyHitrate;
 };
 
 };
@@ -45,6 +45,8 @@
 #include "include/NVMainRequest.h"
 #include "include/NVMHelpers.h"
 #include "Prefetchers/PrefetcherFactory.h"
+#include "Endurance/LifetimeProjector/LifetimeProjector.h"
+#include "src/Checkpoint.h"
 
 #include <sstream>
 #include <cassert>
@@ -64,6 +66,7 @@ NVMain::NVMain( )
     totalWriteRequests = 0;
 
     prefetcher = NULL;
+    lifetimeProjector = NULL;
     successfulPrefetches = 0;
     unsuccessfulPrefetches = 0;
 }
@@ -87,6 +90,9 @@ NVMain::~NVMain( )
     if( translator )
         delete translator;
 
+    if( lifetimeProjector )
+        delete lifetimeProjector;
+
     if( channelConfig )
     {
         for( unsigned int i = 0; i < numChannels; i++ )
@@ -248,6 +254,16 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             preTracer->SetEcho( true );
     }
 
+    /* Projected when the statistics are calculated at the end of the run. */
+    if( config->KeyExists( "LifetimeProjection" ) && config->GetBool( "LifetimeProjection" ) )
+    {
+        lifetimeProjector = new LifetimeProjector( );
+        lifetimeProjector->SetConfig( config, createChildren );
+        lifetimeProjector->SetStats( GetStats( ) );
+        lifetimeProjector->StatName( StatName( ) + ".lifetime" );
+        lifetimeProjector->RegisterStats( );
+    }
+
     RegisterStats( );
 }
 
@@ -526,6 +542,9 @@ void NVMain::CalculateStats( )
 {
     for( unsigned int i = 0; i < numChannels; i++ )
         memoryControllers[i]->CalculateStats( );
+
+    if( lifetimeProjector )
+        lifetimeProjector->Project( this, GetEventQueue( )->GetCurrentCycle( ) );
 }
 
 void NVMain::EnqueuePendingMemoryRequests( NVMainRequest *req )
@@ -533,3 +552,55 @@ void NVMain::EnqueuePendingMemoryRequests( NVMainRequest *req )
     pendingMemoryRequests.push(req);
 }
 
+/*
+ *  Checkpoints are restored into a freshly configured memory, so only the
+ *  cycle the checkpoint was taken at is recorded here. Pending events and
+ *  requests are not saved; the memory should be drained first.
+ */
+void NVMain::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        ncycle_t currentCycle = GetEventQueue( )->GetCurrentCycle( );
+        uint64_t channels = numChannels;
+
+        if( !pendingMemoryRequests.empty( ) || !prefetchBuffer.empty( ) )
+        {
+            std::cout << StatName( ) << ": Warning: Pending requests are not "
+                      << "checkpointed. Drain the memory first." << std::endl;
+        }
+
+        cpt.Write( currentCycle );
+        cpt.Write( channels );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void NVMain::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        ncycle_t checkpointCycle = 0;
+        uint64_t channels = 0;
+
+        cpt.Read( checkpointCycle );
+        cpt.Read( channels );
+
+        if( channels != numChannels )
+        {
+            std::cout << StatName( ) << ": Warning: Checkpoint has " << channels
+                      << " channels, but " << numChannels << " are configured." 
+                      << std::endl;
+        }
+
+        std::cout << StatName( ) << ": Restoring checkpoint taken at memory cycle "
+                  << checkpointCycle << "." << std::endl;
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
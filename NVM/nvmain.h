@@ -53,6 +53,7 @@ class Interconnect;
 class AddressTranslator;
 class SimInterface;
 class NVMainRequest;
+class LifetimeProjector;
 
 class NVMain : public NVMObject
 {
@@ -80,6 +81,9 @@ class NVMain : public NVMObject
 
     void EnqueuePendingMemoryRequests( NVMainRequest *request );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     Config *config;
     Config **channelConfig;
@@ -95,6 +99,7 @@ class NVMain : public NVMObject
     double syncValue;
 
     Prefetcher *prefetcher;
+    LifetimeProjector *lifetimeProjector;
     std::list<NVMainRequest *> prefetchBuffer;
     std::queue<NVMainRequest *> pendingMemoryRequests;
 
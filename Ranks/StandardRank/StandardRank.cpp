@@ -36,10 +36,12 @@
 #include "Ranks/StandardRank/StandardRank.h"
 #include "src/EventQueue.h"
 #include "Banks/BankFactory.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <cstdlib>
 
 using namespace NVM;
 
@@ -52,9 +54,11 @@ StandardRank::StandardRank( )
     fastExitActiveCycles = 0;
     fastExitPrechargeCycles = 0;
     slowExitCycles = 0;
+    selfRefreshCycles = 0;
 
     totalEnergy = 0.0;
     backgroundEnergy = 0.0;
+    powerDownEnergySaved = 0.0;
     activateEnergy = 0.0;
     burstEnergy = 0.0;
     refreshEnergy = 0.0;
@@ -80,12 +84,24 @@ StandardRank::StandardRank( )
     fawWaitTotal = 0;
     fawWaitAverage = 0.0;
 
+    busWaits = 0;
+    busWaitTotal = 0;
+    rrdLWaits = 0;
+    rrdLWaitTotal = 0;
+    ccdLWaits = 0;
+    ccdLWaitTotal = 0;
+    wtrLWaits = 0;
+    wtrLWaitTotal = 0;
+
+    bankGroups = 1;
+
     lastActivate = NULL;
     RAWindex = 0;
 
     conf = NULL;
 
     state = STANDARDRANK_CLOSED;
+    lastStateChange = 0;
     backgroundEnergy = 0.0f;
 
     psInterval = 0;
@@ -130,6 +146,14 @@ void StandardRank::SetConfig( Config *c, bool createChildren )
     }
 
     bankCount = p->BANKS;
+    bankGroups = p->BankGroups;
+
+    if( bankGroups == 0 || bankCount % bankGroups != 0 )
+    {
+        std::cerr << "NVMain Error: BankGroups (" << bankGroups << ") must divide "
+            << "the number of banks (" << bankCount << ")." << std::endl;
+        exit(1);
+    }
 
     if( createChildren )
     {
@@ -179,6 +203,11 @@ void StandardRank::SetConfig( Config *c, bool createChildren )
     nextActivate = p->tCMD;
     nextPrecharge = p->tCMD;
 
+    groupNextActivate.assign( bankGroups, p->tCMD );
+    groupNextReadCCD.assign( bankGroups, p->tCMD );
+    groupNextReadWTR.assign( bankGroups, p->tCMD );
+    groupNextWrite.assign( bankGroups, p->tCMD );
+
     fawWaits = 0;
     rrdWaits = 0;
     actWaits = 0;
@@ -190,13 +219,14 @@ void StandardRank::SetConfig( Config *c, bool createChildren )
 
 void StandardRank::RegisterStats( )
 {
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         AddUnitStat(totalEnergy, "mA*t");
         AddUnitStat(backgroundEnergy, "mA*t");
         AddUnitStat(activateEnergy, "mA*t");
         AddUnitStat(burstEnergy, "mA*t");
         AddUnitStat(refreshEnergy, "mA*t");
+        AddUnitStat(powerDownEnergySaved, "mA*t");
     }
     else
     {
@@ -205,6 +235,7 @@ void StandardRank::RegisterStats( )
         AddUnitStat(activateEnergy, "nJ");
         AddUnitStat(burstEnergy, "nJ");
         AddUnitStat(refreshEnergy, "nJ");
+        AddUnitStat(powerDownEnergySaved, "nJ");
     }
 
     AddUnitStat(totalPower, "W");
@@ -221,6 +252,7 @@ void StandardRank::RegisterStats( )
     AddStat(fastExitActiveCycles);
     AddStat(fastExitPrechargeCycles);
     AddStat(slowExitCycles);
+    AddStat(selfRefreshCycles);
 
     AddStat(actWaits);
     AddStat(actWaitTotal); 
@@ -233,6 +265,20 @@ void StandardRank::RegisterStats( )
     AddStat(fawWaits);
     AddStat(fawWaitTotal);
     AddStat(fawWaitAverage);
+
+    /* Cycles lost to the data bus (tCCD_S, tWTR_S, rank switching) and bank groups. */
+    AddStat(busWaits);
+    AddStat(busWaitTotal);
+
+    if( bankGroups > 1 )
+    {
+        AddStat(rrdLWaits);
+        AddStat(rrdLWaitTotal);
+        AddStat(ccdLWaits);
+        AddStat(ccdLWaitTotal);
+        AddStat(wtrLWaits);
+        AddStat(wtrLWaitTotal);
+    }
 }
 
 bool StandardRank::Idle( )
@@ -274,13 +320,16 @@ bool StandardRank::Activate( NVMainRequest *request )
         GetChild( request )->IssueCommand( request );
 
         if( state == STANDARDRANK_CLOSED )
-            state = STANDARDRANK_OPEN;
+            SetState( STANDARDRANK_OPEN );
 
         /* move to the next counter */
         RAWindex = (RAWindex + 1) % rawNum;
         lastActivate[RAWindex] = GetEventQueue()->GetCurrentCycle();
         nextActivate = MAX( nextActivate, 
                             GetEventQueue()->GetCurrentCycle() + p->tRRDR );
+        groupNextActivate[activateBank % bankGroups] = MAX( 
+                            groupNextActivate[activateBank % bankGroups],
+                            GetEventQueue()->GetCurrentCycle() + p->tRRD_L );
     }
     else
     {
@@ -293,6 +342,7 @@ bool StandardRank::Activate( NVMainRequest *request )
 
 bool StandardRank::Read( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     uint64_t readBank;
 
     request->address.GetTranslatedAddress( NULL, NULL, &readBank, NULL, NULL, NULL );
@@ -317,12 +367,16 @@ bool StandardRank::Read( NVMainRequest *request )
     /* Even though the command may be READ_PRECHARGE, it still works */
     nextRead = MAX( nextRead, 
                     GetEventQueue()->GetCurrentCycle() 
-                    + MAX( p->tBURST, p->tCCD ) * request->burstCount );
+                    + MAX( burst, p->tCCD ) * request->burstCount );
 
     nextWrite = MAX( nextWrite, 
                      GetEventQueue()->GetCurrentCycle() 
-                     + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                     + p->tCAS + p->tBURST + p->tRTRS - p->tCWD ); 
+                     + MAX( burst, p->tCCD ) * (request->burstCount - 1)
+                     + p->tCAS + burst + p->tRTRS - p->tCWD ); 
+
+    groupNextReadCCD[readBank % bankGroups] = MAX( groupNextReadCCD[readBank % bankGroups],
+                    GetEventQueue()->GetCurrentCycle() 
+                    + MAX( burst, p->tCCD_L ) * request->burstCount );
 
     /* if it has implicit precharge, insert the precharge to close the rank */ 
     if( request->type == READ_PRECHARGE )
@@ -332,7 +386,7 @@ bool StandardRank::Read( NVMainRequest *request )
         dupPRE->owner = this;
 
         GetEventQueue( )->InsertEvent( EventResponse, this, dupPRE, 
-            MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
+            MAX( burst, p->tCCD ) * (request->burstCount - 1)
             + GetEventQueue( )->GetCurrentCycle( ) + p->tAL + p->tRTP );
     }
 
@@ -348,6 +402,7 @@ bool StandardRank::Read( NVMainRequest *request )
 
 bool StandardRank::Write( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     uint64_t writeBank;
 
     request->address.GetTranslatedAddress( NULL, NULL, &writeBank, NULL, NULL, NULL );
@@ -372,12 +427,21 @@ bool StandardRank::Write( NVMainRequest *request )
     /* Even though the command may be WRITE_PRECHARGE, it still works */
     nextRead = MAX( nextRead, 
                     GetEventQueue()->GetCurrentCycle() 
-                    + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                    + p->tCWD + p->tBURST + p->tWTR );
+                    + MAX( burst, p->tCCD ) * (request->burstCount - 1)
+                    + p->tCWD + burst + p->tWTR );
 
     nextWrite = MAX( nextWrite, 
                      GetEventQueue()->GetCurrentCycle() 
-                     + MAX( p->tBURST, p->tCCD ) * request->burstCount );
+                     + MAX( burst, p->tCCD ) * request->burstCount );
+
+    groupNextReadWTR[writeBank % bankGroups] = MAX( groupNextReadWTR[writeBank % bankGroups],
+                    GetEventQueue()->GetCurrentCycle() 
+                    + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                    + p->tCWD + burst + p->tWTR_L );
+
+    groupNextWrite[writeBank % bankGroups] = MAX( groupNextWrite[writeBank % bankGroups],
+                    GetEventQueue()->GetCurrentCycle() 
+                    + MAX( burst, p->tCCD_L ) * request->burstCount );
 
     /* if it has implicit precharge, insert the precharge to close the rank */ 
     if( request->type == WRITE_PRECHARGE )
@@ -388,8 +452,8 @@ bool StandardRank::Write( NVMainRequest *request )
 
         GetEventQueue( )->InsertEvent( EventResponse, this, dupPRE, 
                         GetEventQueue( )->GetCurrentCycle( ) 
-                        + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                        + p->tAL + p->tCWD + p->tBURST + p->tWR );
+                        + MAX( burst, p->tCCD ) * (request->burstCount - 1)
+                        + p->tAL + p->tCWD + burst + p->tWR );
     }
 
     if( success == false )
@@ -422,7 +486,7 @@ bool StandardRank::Precharge( NVMainRequest *request )
     bool success = GetChild( request )->IssueCommand( request );
 
     if( Idle( ) )
-        state = STANDARDRANK_CLOSED;
+        SetState( STANDARDRANK_CLOSED );
 
     nextPrecharge = MAX( nextPrecharge, 
                          GetEventQueue()->GetCurrentCycle() + p->tPPD );
@@ -474,15 +538,19 @@ bool StandardRank::PowerDown( NVMainRequest *request )
     switch( request->type )
     {
         case POWERDOWN_PDA:
-            state = STANDARDRANK_PDA;
+            SetState( STANDARDRANK_PDA );
             break;
 
         case POWERDOWN_PDPF:
-            state = STANDARDRANK_PDPF;
+            SetState( STANDARDRANK_PDPF );
             break;
 
         case POWERDOWN_PDPS:
-            state = STANDARDRANK_PDPS;
+            SetState( STANDARDRANK_PDPS );
+            break;
+
+        case POWERDOWN_SREF:
+            SetState( STANDARDRANK_SREF );
             break;
 
         default:
@@ -541,18 +609,23 @@ bool StandardRank::PowerUp( NVMainRequest *request )
     switch( state )
     {
         case STANDARDRANK_PDA:
-            state = STANDARDRANK_OPEN;
+            SetState( STANDARDRANK_OPEN );
             puTimer = p->tXP;
             break;
 
         case STANDARDRANK_PDPF:
             puTimer = p->tXP;
-            state = STANDARDRANK_CLOSED;
+            SetState( STANDARDRANK_CLOSED );
             break;
 
         case STANDARDRANK_PDPS:
             puTimer = p->tXPDLL;
-            state = STANDARDRANK_CLOSED;
+            SetState( STANDARDRANK_CLOSED );
+            break;
+
+        case STANDARDRANK_SREF:
+            puTimer = p->tXSDLL;
+            SetState( STANDARDRANK_CLOSED );
             break;
 
         default:
@@ -588,7 +661,7 @@ bool StandardRank::Refresh( NVMainRequest *request )
         GetChild( refreshBankGroupHead+i )->IssueCommand( refReq );
     }
 
-    state = STANDARDRANK_REFRESHING;
+    SetState( STANDARDRANK_REFRESHING );
 
     request->owner = this;
     GetEventQueue( )->InsertEvent( EventResponse, this, request, 
@@ -613,9 +686,12 @@ ncycle_t StandardRank::NextIssuable( NVMainRequest *request )
 
     request->address.GetTranslatedAddress( NULL, NULL, &bank, NULL, NULL, NULL );
 
-    if( request->type == ACTIVATE || request->type == REFRESH ) nextCompare = MAX( nextActivate, lastActivate[(RAWindex+1)%rawNum] + p->tRAW );
-    else if( request->type == READ || request->type == READ_PRECHARGE ) nextCompare = nextRead;
-    else if( request->type == WRITE || request->type == WRITE_PRECHARGE ) nextCompare = nextWrite;
+    ncounter_t group = bank % bankGroups;
+
+    if( request->type == ACTIVATE ) nextCompare = MAX( MAX( nextActivate, groupNextActivate[group] ), lastActivate[(RAWindex+1)%rawNum] + p->tRAW );
+    else if( request->type == REFRESH ) nextCompare = MAX( nextActivate, lastActivate[(RAWindex+1)%rawNum] + p->tRAW );
+    else if( request->type == READ || request->type == READ_PRECHARGE ) nextCompare = MAX( nextRead, MAX( groupNextReadCCD[group], groupNextReadWTR[group] ) );
+    else if( request->type == WRITE || request->type == WRITE_PRECHARGE ) nextCompare = MAX( nextWrite, groupNextWrite[group] );
     else if( request->type == PRECHARGE || request->type == PRECHARGE_ALL ) nextCompare = nextPrecharge;
     else assert(false);
         
@@ -631,9 +707,12 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
 
     rv = true;
 
+    ncounter_t group = opBank % bankGroups;
+
     if( req->type == ACTIVATE )
     {
         if( nextActivate > GetEventQueue( )->GetCurrentCycle( ) 
+            || groupNextActivate[group] > GetEventQueue( )->GetCurrentCycle( ) 
             || ( lastActivate[(RAWindex + 1) % rawNum] + p->tRAW ) 
                 > GetEventQueue()->GetCurrentCycle() )  
         {
@@ -669,16 +748,25 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
                 fawWaitTotal += ( lastActivate[( RAWindex + 1 ) % rawNum] + 
                     p->tRAW - GetEventQueue( )->GetCurrentCycle( ) );
             }
+            if( groupNextActivate[group] > GetEventQueue( )->GetCurrentCycle( ) )
+            {
+                rrdLWaits++;
+                rrdLWaitTotal += groupNextActivate[group] - GetEventQueue( )->GetCurrentCycle( );
+            }
         }
     }
     else if( req->type == READ || req->type == READ_PRECHARGE )
     {
-        if( nextRead > GetEventQueue( )->GetCurrentCycle( ) )
+        if( nextRead > GetEventQueue( )->GetCurrentCycle( ) 
+            || groupNextReadCCD[group] > GetEventQueue( )->GetCurrentCycle( ) 
+            || groupNextReadWTR[group] > GetEventQueue( )->GetCurrentCycle( ) )
         {
             rv = false;
 
             if( reason ) 
                 reason->reason = RANK_TIMING;
+
+            CountColumnWaits( req, group );
         }
         else
         {
@@ -687,12 +775,15 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
     }
     else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
     {
-        if( nextWrite > GetEventQueue( )->GetCurrentCycle( ) )
+        if( nextWrite > GetEventQueue( )->GetCurrentCycle( ) 
+            || groupNextWrite[group] > GetEventQueue( )->GetCurrentCycle( ) )
         {
             rv = false;
 
             if( reason ) 
                 reason->reason = RANK_TIMING;
+
+            CountColumnWaits( req, group );
         }
         else
         {
@@ -715,7 +806,8 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
     }
     else if( req->type == POWERDOWN_PDA 
             || req->type == POWERDOWN_PDPF 
-            || req->type == POWERDOWN_PDPS )
+            || req->type == POWERDOWN_PDPS
+            || req->type == POWERDOWN_SREF )
     {
         rv = CanPowerDown( req );
 
@@ -762,6 +854,35 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
     return rv;
 }
 
+/* 
+ *  Attributes a blocked column command to the constraint that holds it
+ *  longest: the shared data bus or, within a bank group, tCCD_L or tWTR_L.
+ */
+void StandardRank::CountColumnWaits( NVMainRequest *request, ncounter_t group )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    bool isRead = ( request->type == READ || request->type == READ_PRECHARGE );
+    ncycle_t busReady = isRead ? nextRead : nextWrite;
+    ncycle_t ccdReady = isRead ? groupNextReadCCD[group] : groupNextWrite[group];
+    ncycle_t wtrReady = isRead ? groupNextReadWTR[group] : 0;
+
+    if( busReady >= ccdReady && busReady >= wtrReady )
+    {
+        busWaits++;
+        busWaitTotal += busReady - now;
+    }
+    else if( ccdReady >= wtrReady )
+    {
+        ccdLWaits++;
+        ccdLWaitTotal += ccdReady - now;
+    }
+    else
+    {
+        wtrLWaits++;
+        wtrLWaitTotal += wtrReady - now;
+    }
+}
+
 bool StandardRank::IssueCommand( NVMainRequest *req )
 {
     bool rv = false;
@@ -802,6 +923,7 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
             case POWERDOWN_PDA:
             case POWERDOWN_PDPF: 
             case POWERDOWN_PDPS: 
+            case POWERDOWN_SREF: 
                 rv = this->PowerDown( req );
                 break;
 
@@ -813,6 +935,10 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
                 rv = this->Refresh( req );
                 break;
 
+            case SUBARRAY_SELECT:
+                rv = GetChild( req )->IssueCommand( req );
+                break;
+
             default:
                 std::cout << "NVMain: Rank: Unknown operation in command queue! " 
                     << req->type << std::endl;
@@ -829,24 +955,25 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
  */
 void StandardRank::Notify( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     OpType op = request->type;
 
     /* We only care if other ranks are reading/writing (to avoid bus contention) */
     if( op == READ || op == READ_PRECHARGE )
     {
         nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() 
-                                    + p->tBURST + p->tRTRS );
+                                    + burst + p->tRTRS );
 
         nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() 
-                                    + p->tCAS + p->tBURST + p->tRTRS - p->tCWD);
+                                    + p->tCAS + burst + p->tRTRS - p->tCWD);
     }
     else if( op == WRITE || op == WRITE_PRECHARGE )
     {
         nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() 
-                                    + p->tBURST + p->tOST );
+                                    + burst + p->tOST );
 
         nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle()
-                                    + p->tBURST + p->tCWD + p->tRTRS - p->tCAS );
+                                    + burst + p->tCWD + p->tRTRS - p->tCAS );
     }
 }
 
@@ -864,7 +991,7 @@ bool StandardRank::RequestComplete( NVMainRequest* req )
             case REFRESH:
                 {
                     if( Idle( ) )
-                        state = STANDARDRANK_CLOSED;
+                        SetState( STANDARDRANK_CLOSED );
 
                     break;
                 }
@@ -884,6 +1011,26 @@ void StandardRank::Cycle( ncycle_t steps )
 {
     for( ncounter_t childIdx = 0; childIdx < GetChildCount( ); childIdx++ )
         GetChild( childIdx )->Cycle( steps );
+}
+
+/*
+ *  Background energy is integrated over the time spent in each state, so it
+ *  is updated whenever the state changes and before it is read.
+ */
+void StandardRank::SetState( StandardRank_State newState )
+{
+    IntegrateBackground( );
+
+    state = newState;
+}
+
+void StandardRank::IntegrateBackground( )
+{
+    ncycle_t steps = GetEventQueue()->GetCurrentCycle() - lastStateChange;
+    lastStateChange = GetEventQueue()->GetCurrentCycle();
+
+    if( steps == 0 )
+        return;
 
     /* Count cycle numbers and calculate background energy for each state */
     switch( state )
@@ -891,35 +1038,68 @@ void StandardRank::Cycle( ncycle_t steps )
         /* active powerdown */
         case STANDARDRANK_PDA:
             fastExitActiveCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
+            {
                 backgroundEnergy += ( p->EIDD3P * (double)steps ) * (double)deviceCount;  
+                powerDownEnergySaved += ( ( p->EIDD3N - p->EIDD3P ) * (double)steps ) * (double)deviceCount;
+            }
             else
+            {
                 backgroundEnergy += ( p->Epda * (double)steps );  
+                powerDownEnergySaved += ( ( p->Eactstdby - p->Epda ) * (double)steps );
+            }
             break;
 
         /* precharge powerdown fast exit */
         case STANDARDRANK_PDPF:
             fastExitPrechargeCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
+            {
                 backgroundEnergy += ( p->EIDD2P1 * (double)steps ) * (double)deviceCount;
+                powerDownEnergySaved += ( ( p->EIDD2N - p->EIDD2P1 ) * (double)steps ) * (double)deviceCount;
+            }
             else 
+            {
                 backgroundEnergy += ( p->Epdpf * (double)steps );  
+                powerDownEnergySaved += ( ( p->Eprestdby - p->Epdpf ) * (double)steps );
+            }
             break;
 
         /* precharge powerdown slow exit */
         case STANDARDRANK_PDPS:
             slowExitCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
+            {
                 backgroundEnergy += ( p->EIDD2P0 * (double)steps ) * (double)deviceCount;  
+                powerDownEnergySaved += ( ( p->EIDD2N - p->EIDD2P0 ) * (double)steps ) * (double)deviceCount;
+            }
             else 
+            {
                 backgroundEnergy += ( p->Epdps * (double)steps );  
+                powerDownEnergySaved += ( ( p->Eprestdby - p->Epdps ) * (double)steps );
+            }
+            break;
+
+        /* self-refresh */
+        case STANDARDRANK_SREF:
+            selfRefreshCycles += steps;
+            if( p->energyModel == EnergyModel_Current )
+            {
+                backgroundEnergy += ( p->EIDD6 * (double)steps ) * (double)deviceCount;  
+                powerDownEnergySaved += ( ( p->EIDD2N - p->EIDD6 ) * (double)steps ) * (double)deviceCount;
+            }
+            else 
+            {
+                backgroundEnergy += ( p->Esref * (double)steps );  
+                powerDownEnergySaved += ( ( p->Eprestdby - p->Esref ) * (double)steps );
+            }
             break;
 
         /* active standby */
         case STANDARDRANK_REFRESHING:
         case STANDARDRANK_OPEN:
             activeCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD3N * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Eactstdby * (double)steps );  
@@ -928,14 +1108,14 @@ void StandardRank::Cycle( ncycle_t steps )
         /* precharge standby */
         case STANDARDRANK_CLOSED:
             standbyCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD2N * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Eprestdby * (double)steps );  
             break;
 
         default:
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD2N * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Eprestdby * (double)steps );  
@@ -943,6 +1123,36 @@ void StandardRank::Cycle( ncycle_t steps )
     }
 }
 
+/* Energy of the whole rank so far, in the units of the energy stats. */
+void StandardRank::GetEnergy( double& background, double& activate, double& burst, double& refresh )
+{
+    IntegrateBackground( );
+
+    background = backgroundEnergy;
+    activate = burst = refresh = 0.0;
+
+    for( ncounter_t i = 0; i < bankCount; i++ )
+    {
+        Bank *bank = dynamic_cast<Bank *>( GetChild( i )->GetTrampoline( ) );
+        double bankTotal, bankActivate, bankBurst, bankRefresh;
+
+        assert( bank != NULL );
+        bank->GetEnergy( bankTotal, bankActivate, bankBurst, bankRefresh );
+
+        activate += bankActivate;
+        burst += bankBurst;
+        refresh += bankRefresh;
+    }
+
+    /* Current mode is measured on a per-device basis. */
+    if( p->energyModel == EnergyModel_Current )
+    {
+        activate *= (double)deviceCount;
+        burst *= (double)deviceCount;
+        refresh *= (double)deviceCount;
+    }
+}
+
 void StandardRank::CalculateStats( )
 {
     NVMObject::CalculateStats( );
@@ -951,30 +1161,30 @@ void StandardRank::CalculateStats( )
     totalPower = backgroundPower = activatePower = burstPower = refreshPower = 0.0;
     reads = writes = 0;
 
+    IntegrateBackground( );
+
     for( ncounter_t i = 0; i < bankCount; i++ )
     {
-        StatType bankEstat = GetStat( GetChild(i), "bankEnergy" );
-        StatType actEstat =  GetStat( GetChild(i), "activeEnergy" );
-        StatType bstEstat =  GetStat( GetChild(i), "burstEnergy" );
-        StatType refEstat =  GetStat( GetChild(i), "refreshEnergy" );
+        Bank *bank = dynamic_cast<Bank *>( GetChild( i )->GetTrampoline( ) );
+        double bankTotal, bankActivate, bankBurst, bankRefresh;
 
-        totalEnergy += CastStat( bankEstat, double );
-        activateEnergy += CastStat( actEstat, double );
-        burstEnergy += CastStat( bstEstat, double );
-        refreshEnergy += CastStat( refEstat, double );
+        assert( bank != NULL );
+        bank->GetEnergy( bankTotal, bankActivate, bankBurst, bankRefresh );
 
-        StatType readCount = GetStat( GetChild(i), "reads" );
-        StatType writeCount = GetStat( GetChild(i), "writes" );
+        totalEnergy += bankTotal;
+        activateEnergy += bankActivate;
+        burstEnergy += bankBurst;
+        refreshEnergy += bankRefresh;
 
-        reads += CastStat( readCount, ncounter_t );
-        writes += CastStat( writeCount, ncounter_t );
+        reads += bank->GetReads( );
+        writes += bank->GetWrites( );
     }
 
 
     /* Get simulation time in nanoseconds (ns). Since energy is in nJ, energy / ns = W */
     double simulationTime = 1.0;
     
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         simulationTime = GetEventQueue()->GetCurrentCycle() - lastReset;
     }
@@ -987,7 +1197,7 @@ void StandardRank::CalculateStats( )
     if( simulationTime != 0 )
     {
         /* power in W */
-        if( p->EnergyModel == "current" )
+        if( p->energyModel == EnergyModel_Current )
         {
             backgroundPower = ( backgroundEnergy / (double)deviceCount * p->Voltage ) / (double)simulationTime / 1000.0; 
             activatePower = ( activateEnergy * p->Voltage ) / (double)simulationTime / 1000.0; 
@@ -1004,7 +1214,7 @@ void StandardRank::CalculateStats( )
     }
 
     /* Current mode is measured on a per-device basis. */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* energy breakdown. device is in lockstep within a rank */
         activateEnergy *= (double)deviceCount;
@@ -1030,3 +1240,38 @@ void StandardRank::ResetStats( )
     lastReset = GetEventQueue()->GetCurrentCycle();
 }
 
+void StandardRank::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        /* A refresh finishes before the checkpoint is used. */
+        StandardRank_State savedState = state;
+
+        if( savedState == STANDARDRANK_REFRESHING )
+            savedState = STANDARDRANK_CLOSED;
+
+        cpt.Write( savedState );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void StandardRank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        IntegrateBackground( );
+
+        if( !cpt.Read( state ) )
+        {
+            std::cout << StatName( ) << ": Warning: Checkpoint is incomplete." 
+                      << std::endl;
+        }
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
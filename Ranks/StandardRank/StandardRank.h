@@ -42,6 +42,7 @@
 #include <cstdint>
 #include <list>
 #include <iostream>
+#include <vector>
 
 namespace NVM {
 
@@ -66,7 +67,8 @@ enum StandardRank_State
     STANDARDRANK_REFRESHING,/***< some banks in the rank are refreshing */
     STANDARDRANK_PDPF,      /***< Rank is in precharge powered down, fast exit mode */
     STANDARDRANK_PDA,       /***< Rank is in active powered down mode */
-    STANDARDRANK_PDPS       /***< Rank is in precharge powered down, slow exit mode */
+    STANDARDRANK_PDPS,      /***< Rank is in precharge powered down, slow exit mode */
+    STANDARDRANK_SREF       /***< Rank is in self-refresh */
 };
 
 class StandardRank : public Rank
@@ -89,10 +91,16 @@ class StandardRank : public Rank
 
     void Cycle( ncycle_t steps );
 
+    void GetEnergy( double& background, double& activate, double& burst, double& refresh );
+    void IntegrateBackground( );
+
     void RegisterStats( );
     void CalculateStats( );
     void ResetStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     Config *conf;
     ncounter_t stateTimeout;
@@ -113,12 +121,25 @@ class StandardRank : public Rank
     ncycle_t nextActivate;
     ncycle_t nextPrecharge;
 
+    /* 
+     *  Bank groups (DDR4/DDR5): bank b is in group b % bankGroups. The
+     *  rank-wide next* times above use the short timings, these the long
+     *  timings between banks of one group.
+     */
+    ncounter_t bankGroups;
+    std::vector<ncycle_t> groupNextActivate;
+    std::vector<ncycle_t> groupNextReadCCD;
+    std::vector<ncycle_t> groupNextReadWTR;
+    std::vector<ncycle_t> groupNextWrite;
+
     ncounter_t activeCycles;
     ncounter_t standbyCycles;
     ncounter_t fastExitActiveCycles;
     ncounter_t fastExitPrechargeCycles;
     ncounter_t slowExitCycles;
+    ncounter_t selfRefreshCycles;
     ncycle_t lastReset;
+    ncycle_t lastStateChange;
 
     ncounter_t rrdWaits;
     ncounter_t rrdWaitTotal;
@@ -129,12 +150,25 @@ class StandardRank : public Rank
     ncounter_t actWaits;
     ncounter_t actWaitTotal;
     double actWaitAverage;
+    ncounter_t busWaits;
+    ncounter_t busWaitTotal;
+    ncounter_t rrdLWaits;
+    ncounter_t rrdLWaitTotal;
+    ncounter_t ccdLWaits;
+    ncounter_t ccdLWaitTotal;
+    ncounter_t wtrLWaits;
+    ncounter_t wtrLWaitTotal;
 
     ncounter_t reads, writes;
 
     double totalEnergy, backgroundEnergy, activateEnergy, burstEnergy, refreshEnergy;
+    double powerDownEnergySaved;
     double totalPower, backgroundPower, activatePower, burstPower, refreshPower;
 
+    void CountColumnWaits( NVMainRequest *request, ncounter_t group );
+
+    void SetState( StandardRank_State newState );
+
     bool Activate( NVMainRequest *request );
     bool Read( NVMainRequest *request );
     bool Write( NVMainRequest *request );
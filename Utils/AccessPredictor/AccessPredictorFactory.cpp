@@ -35,6 +35,7 @@
 
 #include "Utils/AccessPredictor/PerfectPredictor/PerfectPredictor.h"
 #include "Utils/AccessPredictor/VariablePredictor/VariablePredictor.h"
+#include "Utils/AccessPredictor/MAPIPredictor/MAPIPredictor.h"
 
 
 #include <cstdlib>
@@ -50,6 +51,7 @@ AccessPredictor *AccessPredictorFactory::CreateAccessPredictor( std::string name
 
     if( name == "PerfectPredictor" ) predictor = new PerfectPredictor( );
     else if( name == "VariablePredictor" ) predictor = new VariablePredictor( );
+    else if( name == "MAPIPredictor" ) predictor = new MAPIPredictor( );
 
     if( predictor == NULL )
     {
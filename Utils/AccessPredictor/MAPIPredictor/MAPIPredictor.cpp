@@ -0,0 +1,176 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#include "Utils/AccessPredictor/MAPIPredictor/MAPIPredictor.h"
+#include "src/Checkpoint.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+
+
+
+using namespace NVM;
+
+
+
+MAPIPredictor::MAPIPredictor( )
+{
+    /* Per-core table size and counter width from the paper. */
+    tableEntries = 256;
+    counterMax = 7;
+    missThreshold = 4;
+
+    truePredictions = 0;
+    falsePredictions = 0;
+}
+
+
+MAPIPredictor::~MAPIPredictor( )
+{
+
+}
+
+
+void MAPIPredictor::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    if( config->KeyExists( "MAPIEntries" ) )
+        tableEntries = static_cast<ncounter_t>( config->GetValue( "MAPIEntries" ) );
+
+    if( config->KeyExists( "MAPICounterBits" ) )
+    {
+        int bits = config->GetValue( "MAPICounterBits" );
+
+        if( bits < 1 || bits > 8 )
+        {
+            std::cout << "Error: MAPICounterBits must be between 1 and 8." << std::endl;
+            exit(1);
+        }
+
+        counterMax = static_cast<uint8_t>( (1 << bits) - 1 );
+        missThreshold = static_cast<uint8_t>( 1 << (bits - 1) );
+    }
+
+    if( tableEntries == 0 )
+    {
+        std::cout << "Error: MAPIEntries must be non-zero." << std::endl;
+        exit(1);
+    }
+
+    AddStat(truePredictions);
+    AddStat(falsePredictions);
+}
+
+/* Tables are added as new thread IDs show up; the PC is folded into an index. */
+uint8_t& MAPIPredictor::Counter( NVMainRequest *request )
+{
+    uint64_t pc = request->programCounter;
+    ncounter_t core = request->threadId;
+
+    if( core >= counters.size( ) )
+        counters.resize( core + 1, std::vector<uint8_t>( tableEntries, 0 ) );
+
+    pc = pc ^ (pc >> 8) ^ (pc >> 16) ^ (pc >> 32);
+
+    return counters[core][pc % tableEntries];
+}
+
+bool MAPIPredictor::PredictMiss( NVMainRequest *request )
+{
+    return (Counter( request ) >= missThreshold);
+}
+
+void MAPIPredictor::Train( NVMainRequest *request, bool predictedMiss, bool hit )
+{
+    uint8_t& counter = Counter( request );
+
+    if( hit && counter > 0 )
+        counter--;
+    else if( !hit && counter < counterMax )
+        counter++;
+
+    if( predictedMiss != hit )
+        truePredictions++;
+    else
+        falsePredictions++;
+}
+
+uint64_t MAPIPredictor::Translate( NVMainRequest *request )
+{
+    /* Write always hits, no prediction should be done. */
+    if( request->type == WRITE || request->type == WRITE_PRECHARGE )
+        return GetHitDestination( );
+
+    assert( parent != NULL );
+
+    bool predictedMiss = PredictMiss( request );
+    bool hit = GetParent()->GetTrampoline()->GetChild(GetHitDestination())->IssueFunctional(request);
+
+    Train( request, predictedMiss, hit );
+
+    return (predictedMiss ? GetMissDestination( ) : GetHitDestination( ));
+}
+
+void MAPIPredictor::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    cpt.Write( tableEntries );
+    cpt.Write( static_cast<uint64_t>( counters.size( ) ) );
+
+    for( ncounter_t core = 0; core < counters.size( ); core++ )
+        cpt.WriteBytes( &counters[core][0], tableEntries );
+}
+
+bool MAPIPredictor::ReadCheckpoint( CheckpointReader& cpt )
+{
+    ncounter_t entries = 0;
+    uint64_t cores = 0;
+
+    cpt.Read( entries );
+    cpt.Read( cores );
+
+    if( entries != tableEntries || cores * entries > cpt.Remaining( ) )
+    {
+        std::cout << "MAPIPredictor: Warning: Checkpoint table size " << entries
+                  << " differs from the configured " << tableEntries 
+                  << ". Skipping restore." << std::endl;
+        return false;
+    }
+
+    counters.assign( cores, std::vector<uint8_t>( tableEntries, 0 ) );
+
+    for( ncounter_t core = 0; core < cores; core++ )
+        cpt.ReadBytes( &counters[core][0], tableEntries );
+
+    return cpt.Good( );
+}
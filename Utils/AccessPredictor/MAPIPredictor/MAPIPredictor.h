@@ -0,0 +1,86 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __UTILS_MAPIPREDICTOR_H__
+#define __UTILS_MAPIPREDICTOR_H__
+
+
+#include "Utils/AccessPredictor/AccessPredictor.h"
+
+#include <vector>
+
+
+namespace NVM {
+
+
+class CheckpointWriter;
+class CheckpointReader;
+
+/*
+ *  MAP-I memory access predictor (Qureshi and Loh, MICRO 2012). Each core
+ *  has a small table of saturating counters indexed by a hash of the PC of
+ *  the request. Counters move up on DRAM cache misses and down on hits, and
+ *  a request is predicted to miss if its counter is in the upper half.
+ */
+class MAPIPredictor : public AccessPredictor
+{
+  public:
+    MAPIPredictor( );
+    ~MAPIPredictor( );
+
+    void SetConfig( Config *conf, bool createChildren );
+
+    using AccessPredictor::Translate;
+    uint64_t Translate( NVMainRequest *request );
+
+    bool PredictMiss( NVMainRequest *request );
+    void Train( NVMainRequest *request, bool predictedMiss, bool hit );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
+  private:
+    ncounter_t tableEntries;
+    uint8_t counterMax, missThreshold;
+    std::vector< std::vector<uint8_t> > counters;
+
+    ncounter_t truePredictions, falsePredictions;
+
+    uint8_t& Counter( NVMainRequest *request );
+};
+
+
+};
+
+
+#endif
@@ -34,29 +34,48 @@
 #include "Utils/Caches/CacheBank.h"
 #include "include/NVMHelpers.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "Utils/Caches/ReplacementPolicy/LRUPolicy/LRUPolicy.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <cassert>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace NVM;
 
-CacheBank::CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize )
+CacheBank::CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, 
+                      uint64_t lineSize, bool storeData )
 {
-    uint64_t r, i, j;
+    uint64_t entries = rows * sets * assoc;
+
+    tags = new uint64_t[ entries ];
+    flags = new uint8_t[ entries ];
 
-    cacheEntry = new CacheEntry** [ rows ];
-    for( r = 0; r < rows; r++ )
+    for( uint64_t i = 0; i < entries; i++ )
     {
-        cacheEntry[r] = new CacheEntry* [ sets ];
-        for( i = 0; i < sets; i++ )
-        {
-            cacheEntry[r][i] = new CacheEntry[ assoc ];
-            for( j = 0; j < assoc; j++ )
-            {
-                /* Clear valid bit, dirty bit, etc. */
-                cacheEntry[r][i][j].flags = CACHE_ENTRY_NONE;
-            }
-        }
+        /* Clear valid bit, dirty bit, etc. */
+        tags[i] = CACHE_TAG_INVALID;
+        flags[i] = CACHE_ENTRY_NONE;
+    }
+
+    /* Without data, only the tags and flags above are allocated. */
+    this->storeData = storeData;
+    dataArena = NULL;
+    dataSizes = NULL;
+
+    if( storeData )
+    {
+        dataArena = new uint8_t[ entries * lineSize ];
+        dataSizes = new uint64_t[ entries ];
+
+        memset( dataArena, 0, entries * lineSize );
+        memset( dataSizes, 0, entries * sizeof(uint64_t) );
     }
 
     numRows = rows;
@@ -75,23 +94,17 @@ CacheBank::CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lin
     readTime = 1; // 1 cycle
     writeTime = 1;  // 1 cycle
 
-    isMissMap = false;
+    replacementPolicy = NULL;
+    SetReplacementPolicy( new LRUPolicy( ) );
 }
 
 CacheBank::~CacheBank( )
 {
-    uint64_t i, r;
-
-    for( r = 0; r < numRows; r++ )
-    {
-        for( i = 0; i < numSets; i++ )
-        {
-            delete [] cacheEntry[r][i];
-        }
-        delete [] cacheEntry[r];
-    }
-
-    delete [] cacheEntry;
+    delete [] tags;
+    delete [] flags;
+    delete [] dataArena;
+    delete [] dataSizes;
+    delete replacementPolicy;
 }
 
 void CacheBank::SetDecodeFunction( NVMObject *dcClass, CacheSetDecoder dcFunc )
@@ -100,6 +113,19 @@ void CacheBank::SetDecodeFunction( NVMObject *dcClass, CacheSetDecoder dcFunc )
     decodeFunc = dcFunc;
 }
 
+void CacheBank::SetReplacementPolicy( ReplacementPolicy *policy )
+{
+    delete replacementPolicy;
+
+    replacementPolicy = policy;
+    replacementPolicy->Init( numRows * numSets, numAssoc );
+}
+
+ReplacementPolicy *CacheBank::GetReplacementPolicy( )
+{
+    return replacementPolicy;
+}
+
 uint64_t CacheBank::DefaultDecoder( NVMAddress &addr )
 {
     return addr.GetCol() % numSets;
@@ -114,79 +140,124 @@ uint64_t CacheBank::SetID( NVMAddress& addr )
      */
     uint64_t setID;
 
-    //if( isMissMap )
-    //    setID = (addr.GetPhysicalAddress( )) % numSets;
-
     setID = (decodeClass->*decodeFunc)( addr );
 
     return setID;
 }
 
-CacheEntry *CacheBank::FindSet( NVMAddress& addr )
+/* Index of way 0 of the set holding addr in the flat arrays. */
+uint64_t CacheBank::SetBase( NVMAddress& addr )
 {
-    /*
-     *  By default we'll just chop off the bits for the cacheline and use the
-     *  least significant bits as the set address, and the remaining bits are 
-     *  the tag bits.
-     */
-    uint64_t setID = SetID( addr );
-
-    return cacheEntry[addr.GetRow()][setID];
+    return ( addr.GetRow( ) * numSets + SetID( addr ) ) * numAssoc;
 }
 
-bool CacheBank::Present( NVMAddress& addr )
+/*
+ *  Return the way holding tag, or numAssoc if there is none. Invalid ways
+ *  hold CACHE_TAG_INVALID, so a match needs no separate valid check and two
+ *  ways can be compared at once.
+ */
+uint64_t CacheBank::FindWay( uint64_t base, uint64_t tag )
 {
-    CacheEntry *set = FindSet( addr );
-    bool found = false;
+    const uint64_t *setTags = tags + base;
+    uint64_t way = 0;
+
+#ifdef __SSE2__
+    /* SSE2 has no 64-bit compare; both 32-bit halves must match. */
+    const __m128i key = _mm_set1_epi64x( static_cast<long long>( tag ) );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    for( ; way + 2 <= numAssoc; way += 2 )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( ) 
-            && (set[i].flags & CACHE_ENTRY_VALID ) )
-        {
-            found = true;
+        __m128i ways = _mm_loadu_si128( 
+                reinterpret_cast<const __m128i *>( setTags + way ) );
+        __m128i halves = _mm_cmpeq_epi32( ways, key );
+        __m128i match = _mm_and_si128( halves, 
+                _mm_shuffle_epi32( halves, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        int mask = _mm_movemask_pd( _mm_castsi128_pd( match ) );
+
+        if( mask != 0 )
+            return way + ( ( mask & 1 ) ? 0 : 1 );
+    }
+#endif
+
+    for( ; way < numAssoc; way++ )
+    {
+        if( setTags[way] == tag )
             break;
-        }
     }
 
-    return found;
+    return way;
 }
 
-bool CacheBank::SetFull( NVMAddress& addr )
+void CacheBank::StoreData( uint64_t slot, NVMDataBlock& data )
+{
+    if( !storeData )
+        return;
+
+    uint64_t size = std::min( data.GetSize( ), cachelineSize );
+
+    if( data.rawData != NULL && size > 0 )
+        memcpy( dataArena + slot * cachelineSize, data.rawData, size );
+
+    dataSizes[slot] = size;
+}
+
+void CacheBank::LoadData( uint64_t slot, NVMDataBlock *data )
+{
+    if( !storeData || data == NULL )
+        return;
+
+    uint64_t size = dataSizes[slot];
+
+    if( data->rawData == NULL )
+        data->SetSize( size );
+
+    memcpy( data->rawData, dataArena + slot * cachelineSize, 
+            std::min( size, data->GetSize( ) ) );
+    data->SetValid( true );
+}
+
+bool CacheBank::Present( NVMAddress& addr )
+{
+    return ( FindWay( SetBase( addr ), addr.GetPhysicalAddress( ) ) < numAssoc );
+}
+
+bool CacheBank::Touch( NVMAddress& addr )
 {
-    CacheEntry *set = FindSet( addr );
-    bool rv = true;
+    uint64_t base = SetBase( addr );
+    uint64_t way = FindWay( base, addr.GetPhysicalAddress( ) );
+    bool rv = false;
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way < numAssoc )
     {
-        /* If there is an invalid entry (e.g., not used) the set isn't full. */
-        if( !(set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            rv = false;
-            break;
-        }
+        replacementPolicy->Hit( base / numAssoc, way );
+        rv = true;
     }
 
     return rv;
 }
 
+bool CacheBank::SetFull( NVMAddress& addr )
+{
+    /* If there is an invalid entry (e.g., not used) the set isn't full. */
+    return ( FindWay( SetBase( addr ), CACHE_TAG_INVALID ) == numAssoc );
+}
+
 bool CacheBank::Install( NVMAddress& addr, NVMDataBlock& data )
 {
-    CacheEntry *set = FindSet( addr );
+    uint64_t base = SetBase( addr );
+    uint64_t way = FindWay( base, CACHE_TAG_INVALID );
     bool rv = false;
 
     //assert( !Present( addr ) );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way < numAssoc )
     {
-        if( !(set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            set[i].address = addr;
-            set[i].data = data;
-            set[i].flags |= CACHE_ENTRY_VALID; 
-            rv = true;
-            break;
-        }
+        tags[base + way] = addr.GetPhysicalAddress( );
+        flags[base + way] |= CACHE_ENTRY_VALID; 
+        StoreData( base + way, data );
+        replacementPolicy->Insert( base / numAssoc, way, 
+                                   addr.GetPhysicalAddress( ) );
+        rv = true;
     }
 
     return rv;
@@ -194,37 +265,18 @@ bool CacheBank::Install( NVMAddress& addr, NVMDataBlock& data )
 
 bool CacheBank::Read( NVMAddress& addr, NVMDataBlock *data )
 {
-    CacheEntry *set = FindSet( addr );
+    uint64_t base = SetBase( addr );
+    uint64_t way = FindWay( base, addr.GetPhysicalAddress( ) );
     bool rv = false;
 
-    assert( Present( addr ) );
+    assert( way < numAssoc );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way < numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( ) 
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            *data = set[i].data;
-            rv = true;
-
-            /* Move cache entry to MRU position */
-            CacheEntry tmp;
-
-            tmp.flags = set[i].flags;
-            tmp.address = set[i].address;
-            tmp.data = set[i].data;
-
-            for( uint64_t j = i; j > 0; j-- )
-            {
-                set[j].flags = set[j-1].flags;
-                set[j].address = set[j-1].address;
-                set[j].data = set[j-1].data;
-            }
+        LoadData( base + way, data );
+        rv = true;
 
-            set[0].flags = tmp.flags;
-            set[0].address = tmp.address;
-            set[0].data = tmp.data;
-        }
+        replacementPolicy->Hit( base / numAssoc, way );
     }
 
     return rv;
@@ -232,79 +284,63 @@ bool CacheBank::Read( NVMAddress& addr, NVMDataBlock *data )
 
 bool CacheBank::Write( NVMAddress& addr, NVMDataBlock& data )
 {
-    CacheEntry *set = FindSet( addr );
+    uint64_t base = SetBase( addr );
+    uint64_t way = FindWay( base, addr.GetPhysicalAddress( ) );
     bool rv = false;
 
-    assert( Present( addr ) );
+    assert( way < numAssoc );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way < numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( )
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            set[i].data = data;
-            set[i].flags |= CACHE_ENTRY_DIRTY;
-            rv = true;
-
-            /* Move cache entry to MRU position */
-            CacheEntry tmp;
-
-            tmp.flags = set[i].flags;
-            tmp.address = set[i].address;
-            tmp.data = set[i].data;
-
-            for( uint64_t j = i; j > 1; j-- )
-            {
-                set[j].flags = set[j-1].flags;
-                set[j].address = set[j-1].address;
-                set[j].data = set[j-1].data;
-            }
+        StoreData( base + way, data );
+        flags[base + way] |= CACHE_ENTRY_DIRTY;
+        rv = true;
 
-            set[0].flags = tmp.flags;
-            set[0].address = tmp.address;
-            set[0].data = tmp.data;
-        }
+        replacementPolicy->Hit( base / numAssoc, way );
     }
 
     return rv;
 }
 
 /* 
- *  Updates data without changing dirty bit or LRU position
+ *  Updates data without changing dirty bit or replacement state
  *  Returns true if the block was found and updated.
  */
 bool CacheBank::UpdateData( NVMAddress& addr, NVMDataBlock& data )
 {
-    CacheEntry *set = FindSet( addr );
+    uint64_t base = SetBase( addr );
+    uint64_t way = FindWay( base, addr.GetPhysicalAddress( ) );
     bool rv = false;
 
-    assert( Present( addr ) );
+    assert( way < numAssoc );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way < numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( )
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            set[i].data = data;
-            rv = true;
-        }
+        StoreData( base + way, data );
+        rv = true;
     }
 
     return rv;
 }
 
-/* Return true if the victim data is dirty. */
+/* 
+ *  Return true if the victim data is dirty. Only the physical address is 
+ *  kept per way, so the victim takes the translated fields of addr, which 
+ *  map to the same set. Memory retranslates the address on issue.
+ */
 bool CacheBank::ChooseVictim( NVMAddress& addr, NVMAddress *victim )
 {
     bool rv = false;
-    CacheEntry *set = FindSet( addr );
+    uint64_t base = SetBase( addr );
+    uint64_t slot = base + replacementPolicy->Victim( base / numAssoc );
 
     assert( SetFull( addr ) );
-    assert( set[numAssoc-1].flags & CACHE_ENTRY_VALID );
+    assert( flags[slot] & CACHE_ENTRY_VALID );
 
-    *victim = set[numAssoc-1].address;
+    *victim = addr;
+    victim->SetPhysicalAddress( tags[slot] );
     
-    if( set[numAssoc-1].flags & CACHE_ENTRY_DIRTY )
+    if( flags[slot] & CACHE_ENTRY_DIRTY )
         rv = true;
 
     return rv;
@@ -314,32 +350,24 @@ bool CacheBank::ChooseVictim( NVMAddress& addr, NVMAddress *victim )
 bool CacheBank::Evict( NVMAddress& addr, NVMDataBlock *data )
 {
     bool rv;
-    CacheEntry *set = FindSet( addr );
+    uint64_t base = SetBase( addr );
+    uint64_t way = FindWay( base, addr.GetPhysicalAddress( ) );
 
-    assert( Present( addr ) );
+    assert( way < numAssoc );
 
     rv = false; 
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way < numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( ) 
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            if( set[i].flags & CACHE_ENTRY_DIRTY )
-            {
-                *data = set[i].data;
-                rv = true;
-            }
-            else
-            {
-                *data = set[i].data;
-                rv = false;
-            }
+        LoadData( base + way, data );
 
-            set[i].flags = CACHE_ENTRY_NONE;
+        if( flags[base + way] & CACHE_ENTRY_DIRTY )
+            rv = true;
 
-            break;
-        }
+        tags[base + way] = CACHE_TAG_INVALID;
+        flags[base + way] = CACHE_ENTRY_NONE;
+
+        replacementPolicy->Invalidate( base / numAssoc, way );
     }
 
     return rv;
@@ -388,18 +416,10 @@ double CacheBank::GetCacheOccupancy( )
     valid = 0;
     total = numRows*numSets*numAssoc;
 
-    for( uint64_t rowIdx = 0; rowIdx < numRows; rowIdx++ )
+    for( uint64_t entryIdx = 0; entryIdx < total; entryIdx++ )
     {
-        for( uint64_t setIdx = 0; setIdx < numSets; setIdx++ )
-        {
-            CacheEntry *set = cacheEntry[rowIdx][setIdx];
-
-            for( uint64_t assocIdx = 0; assocIdx < numAssoc; assocIdx++ )
-            {
-                if( set[assocIdx].flags & CACHE_ENTRY_VALID )
-                    valid++;
-            }
-        }
+        if( flags[entryIdx] & CACHE_ENTRY_VALID )
+            valid++;
     }
 
     occupancy = static_cast<double>(valid) / static_cast<double>(total);
@@ -499,3 +519,90 @@ bool CacheBank::RequestComplete( NVMainRequest *req )
 void CacheBank::Cycle( ncycle_t /*steps*/ )
 {
 }
+
+void CacheBank::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    uint64_t entries = numRows * numSets * numAssoc;
+
+    cpt.Write( numRows );
+    cpt.Write( numSets );
+    cpt.Write( numAssoc );
+    cpt.Write( cachelineSize );
+    cpt.Write( storeData );
+
+    cpt.WriteBytes( tags, entries * sizeof(uint64_t) );
+    cpt.WriteBytes( flags, entries * sizeof(uint8_t) );
+
+    if( storeData )
+    {
+        cpt.WriteBytes( dataSizes, entries * sizeof(uint64_t) );
+        cpt.WriteBytes( dataArena, entries * cachelineSize );
+    }
+
+    cpt.Write( replacementPolicy->GetName( ).size( ) );
+    cpt.WriteBytes( replacementPolicy->GetName( ).data( ), 
+                    replacementPolicy->GetName( ).size( ) );
+    replacementPolicy->WriteCheckpoint( cpt );
+}
+
+bool CacheBank::ReadCheckpoint( CheckpointReader& cpt )
+{
+    uint64_t rows = 0, sets = 0, assoc = 0, lineSize = 0;
+    uint64_t entries = numRows * numSets * numAssoc;
+    bool hasData = false;
+    std::string::size_type nameLength = 0;
+    std::string policyName;
+
+    cpt.Read( rows );
+    cpt.Read( sets );
+    cpt.Read( assoc );
+    cpt.Read( lineSize );
+    cpt.Read( hasData );
+
+    if( rows != numRows || sets != numSets || assoc != numAssoc 
+        || lineSize != cachelineSize )
+    {
+        std::cout << "CacheBank: Warning: Checkpoint geometry " << rows << "x"
+                  << sets << "x" << assoc << " differs from the configured "
+                  << numRows << "x" << numSets << "x" << numAssoc 
+                  << ". Skipping restore." << std::endl;
+        return false;
+    }
+
+    cpt.ReadBytes( tags, entries * sizeof(uint64_t) );
+    cpt.ReadBytes( flags, entries * sizeof(uint8_t) );
+
+    /* Data is restored only if both the checkpoint and this cache hold it. */
+    if( hasData && storeData )
+    {
+        cpt.ReadBytes( dataSizes, entries * sizeof(uint64_t) );
+        cpt.ReadBytes( dataArena, entries * cachelineSize );
+    }
+    else if( hasData )
+    {
+        std::vector<uint8_t> skipped( entries * (sizeof(uint64_t) + cachelineSize) );
+
+        cpt.ReadBytes( &skipped[0], skipped.size( ) );
+    }
+
+    /* Policy state only makes sense to the policy that wrote it. */
+    cpt.Read( nameLength );
+    if( nameLength > cpt.Remaining( ) )
+        return false;
+
+    policyName.resize( nameLength );
+    cpt.ReadBytes( &policyName[0], nameLength );
+
+    if( policyName != replacementPolicy->GetName( ) )
+    {
+        std::cout << "CacheBank: Warning: Checkpoint replacement policy " 
+                  << policyName << " differs from the configured " 
+                  << replacementPolicy->GetName( ) 
+                  << ". Replacement state is reset." << std::endl;
+        return cpt.Good( );
+    }
+
+    replacementPolicy->ReadCheckpoint( cpt );
+
+    return cpt.Good( );
+}
@@ -39,9 +39,13 @@
 #include "include/NVMDataBlock.h"
 #include "src/NVMObject.h"
 #include "src/AddressTranslator.h"
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicy.h"
 
 namespace NVM {
 
+class CheckpointWriter;
+class CheckpointReader;
+
 typedef uint64_t (NVMObject::*CacheSetDecoder)(NVMAddress&);
 
 enum CacheState { CACHE_IDLE, CACHE_BUSY };
@@ -66,22 +70,22 @@ enum { CACHE_ENTRY_NONE = 0,
        CACHE_ENTRY_EXAMPLE = 4
 };
 
-struct CacheEntry
-{
-    uint64_t flags;
-    NVMAddress address;
-    NVMDataBlock data;
-};
+/* Tag of an unused way. Never matches a real physical address. */
+#define CACHE_TAG_INVALID (~static_cast<uint64_t>(0))
 
 class CacheBank : public NVMObject
 {
   public:
-    CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize );
+    CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize,
+               bool storeData = true );
     ~CacheBank( );
 
     /* Return true if the address is in the cache. */
     bool Present( NVMAddress& addr );
 
+    /* As Present, but a hit also updates the replacement state. */
+    bool Touch( NVMAddress& addr );
+
     /* Return true if the address was placed in the cache. */
     bool Install( NVMAddress& addr, NVMDataBlock& data );
 
@@ -118,19 +122,42 @@ class CacheBank : public NVMObject
 
     void SetDecodeFunction( NVMObject *dcClass, CacheSetDecoder dcFunc );
 
+    /* Takes ownership of policy. LRU is used unless another one is set. */
+    void SetReplacementPolicy( ReplacementPolicy *policy );
+    ReplacementPolicy *GetReplacementPolicy( );
+
+    /* Save or restore the tag store and data. Returns false on a mismatch. */
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
     uint64_t numRows, numSets, numAssoc, cachelineSize;
-    CacheEntry ***cacheEntry;
     uint64_t accessTime, stateTimer;
     uint64_t readTime, writeTime;
     CacheState state;
 
-    CacheEntry *FindSet( NVMAddress& addr );
     uint64_t SetID( NVMAddress& addr );
-    bool isMissMap;
 
     CacheSetDecoder decodeFunc;
     NVMObject *decodeClass;
     uint64_t DefaultDecoder( NVMAddress& addr );
+
+  private:
+    /*
+     *  The tag store is kept as flat arrays indexed by (row, set, way) so
+     *  that a set is a contiguous run of tags and flags. Line data lives in
+     *  a separate arena that is only allocated if the cache stores data.
+     */
+    uint64_t *tags;
+    uint8_t *flags;
+    uint8_t *dataArena;
+    uint64_t *dataSizes;
+    bool storeData;
+    ReplacementPolicy *replacementPolicy;
+
+    uint64_t SetBase( NVMAddress& addr );
+    uint64_t FindWay( uint64_t base, uint64_t tag );
+    void StoreData( uint64_t slot, NVMDataBlock& data );
+    void LoadData( uint64_t slot, NVMDataBlock *data );
 };
 
 }; 
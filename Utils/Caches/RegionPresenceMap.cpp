@@ -0,0 +1,255 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/RegionPresenceMap.h"
+#include "Utils/Caches/ReplacementPolicy/LRUPolicy/LRUPolicy.h"
+#include "src/Checkpoint.h"
+#include "include/NVMHelpers.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+
+using namespace NVM;
+
+/* Tag of an unused way. Region numbers never reach it. */
+#define REGION_TAG_INVALID (~static_cast<uint64_t>(0))
+
+RegionPresenceMap::RegionPresenceMap( uint64_t sets, uint64_t assoc, 
+                                      uint64_t regionSize, uint64_t lineSize )
+{
+    numSets = sets;
+    numAssoc = assoc;
+
+    regionShift = mlog2( static_cast<int>( regionSize ) );
+    lineShift = mlog2( static_cast<int>( lineSize ) );
+
+    if( regionSize != (1ULL << regionShift) || lineSize != (1ULL << lineShift)
+        || regionShift < lineShift || regionShift - lineShift > 6 )
+    {
+        std::cout << "Error: RegionPresenceMap needs power of two region and "
+                  << "line sizes with at most 64 lines per region." << std::endl;
+        exit(1);
+    }
+
+    tags = new uint64_t[ sets * assoc ];
+    lines = new uint64_t[ sets * assoc ];
+
+    for( uint64_t i = 0; i < sets * assoc; i++ )
+    {
+        tags[i] = REGION_TAG_INVALID;
+        lines[i] = 0;
+    }
+
+    replacementPolicy = NULL;
+    SetReplacementPolicy( new LRUPolicy( ) );
+}
+
+RegionPresenceMap::~RegionPresenceMap( )
+{
+    delete [] tags;
+    delete [] lines;
+    delete replacementPolicy;
+}
+
+void RegionPresenceMap::SetReplacementPolicy( ReplacementPolicy *policy )
+{
+    delete replacementPolicy;
+
+    replacementPolicy = policy;
+    replacementPolicy->Init( numSets, numAssoc );
+}
+
+ReplacementPolicy *RegionPresenceMap::GetReplacementPolicy( )
+{
+    return replacementPolicy;
+}
+
+uint64_t RegionPresenceMap::Region( uint64_t address )
+{
+    return address >> regionShift;
+}
+
+uint64_t RegionPresenceMap::LineMask( uint64_t address )
+{
+    uint64_t lineOffset = (address >> lineShift) 
+                        & ((1ULL << (regionShift - lineShift)) - 1);
+
+    return (1ULL << lineOffset);
+}
+
+/* Return the way holding region in set, or numAssoc if there is none. */
+uint64_t RegionPresenceMap::FindWay( uint64_t set, uint64_t region )
+{
+    const uint64_t *setTags = tags + set * numAssoc;
+    uint64_t way;
+
+    for( way = 0; way < numAssoc; way++ )
+    {
+        if( setTags[way] == region )
+            break;
+    }
+
+    return way;
+}
+
+bool RegionPresenceMap::RegionPresent( uint64_t address )
+{
+    uint64_t region = Region( address );
+
+    return ( FindWay( region % numSets, region ) < numAssoc );
+}
+
+bool RegionPresenceMap::LinePresent( uint64_t address )
+{
+    uint64_t region = Region( address );
+    uint64_t set = region % numSets;
+    uint64_t way = FindWay( set, region );
+
+    if( way == numAssoc )
+        return false;
+
+    replacementPolicy->Hit( set, way );
+
+    return ( (lines[set * numAssoc + way] & LineMask( address )) != 0 );
+}
+
+bool RegionPresenceMap::Insert( uint64_t address, uint64_t *victimRegion, 
+                                uint64_t *victimLines )
+{
+    uint64_t region = Region( address );
+    uint64_t set = region % numSets;
+    uint64_t way = FindWay( set, region );
+    bool evicted = false;
+
+    if( way == numAssoc )
+    {
+        way = FindWay( set, REGION_TAG_INVALID );
+
+        if( way == numAssoc )
+        {
+            way = replacementPolicy->Victim( set );
+
+            *victimRegion = tags[set * numAssoc + way] << regionShift;
+            *victimLines = lines[set * numAssoc + way];
+            evicted = true;
+
+            replacementPolicy->Invalidate( set, way );
+        }
+
+        tags[set * numAssoc + way] = region;
+        lines[set * numAssoc + way] = 0;
+
+        replacementPolicy->Insert( set, way, address );
+    }
+
+    lines[set * numAssoc + way] |= LineMask( address );
+
+    return evicted;
+}
+
+void RegionPresenceMap::Remove( uint64_t address )
+{
+    uint64_t region = Region( address );
+    uint64_t set = region % numSets;
+    uint64_t way = FindWay( set, region );
+
+    if( way < numAssoc )
+        lines[set * numAssoc + way] &= ~LineMask( address );
+}
+
+uint64_t RegionPresenceMap::GetRegionSize( )
+{
+    return (1ULL << regionShift);
+}
+
+uint64_t RegionPresenceMap::GetLinesPerRegion( )
+{
+    return (1ULL << (regionShift - lineShift));
+}
+
+/* Bytes of host memory used by the tag and presence arrays. */
+uint64_t RegionPresenceMap::GetFootprint( )
+{
+    return numSets * numAssoc * 2 * sizeof(uint64_t);
+}
+
+void RegionPresenceMap::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    cpt.Write( numSets );
+    cpt.Write( numAssoc );
+    cpt.Write( regionShift );
+
+    cpt.WriteBytes( tags, numSets * numAssoc * sizeof(uint64_t) );
+    cpt.WriteBytes( lines, numSets * numAssoc * sizeof(uint64_t) );
+
+    cpt.Write( replacementPolicy->GetName( ).size( ) );
+    cpt.WriteBytes( replacementPolicy->GetName( ).data( ), 
+                    replacementPolicy->GetName( ).size( ) );
+    replacementPolicy->WriteCheckpoint( cpt );
+}
+
+bool RegionPresenceMap::ReadCheckpoint( CheckpointReader& cpt )
+{
+    uint64_t sets = 0, assoc = 0, shift = 0;
+    std::string::size_type nameLength = 0;
+    std::string policyName;
+
+    cpt.Read( sets );
+    cpt.Read( assoc );
+    cpt.Read( shift );
+
+    if( sets != numSets || assoc != numAssoc || shift != regionShift )
+    {
+        std::cout << "RegionPresenceMap: Warning: Checkpoint geometry " << sets 
+                  << "x" << assoc << " differs from the configured " << numSets 
+                  << "x" << numAssoc << ". Skipping restore." << std::endl;
+        return false;
+    }
+
+    cpt.ReadBytes( tags, numSets * numAssoc * sizeof(uint64_t) );
+    cpt.ReadBytes( lines, numSets * numAssoc * sizeof(uint64_t) );
+
+    cpt.Read( nameLength );
+    if( nameLength > cpt.Remaining( ) )
+        return false;
+
+    policyName.resize( nameLength );
+    cpt.ReadBytes( &policyName[0], nameLength );
+
+    /* Policy state only makes sense to the policy that wrote it. */
+    if( policyName == replacementPolicy->GetName( ) )
+        replacementPolicy->ReadCheckpoint( cpt );
+
+    return cpt.Good( );
+}
@@ -0,0 +1,100 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_CACHES_REGIONPRESENCEMAP_H__
+#define __NVMAIN_UTILS_CACHES_REGIONPRESENCEMAP_H__
+
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicy.h"
+
+#include <stdint.h>
+
+namespace NVM {
+
+class CheckpointWriter;
+class CheckpointReader;
+
+/*
+ *  Set-associative map of memory regions to per-line presence bits, as used
+ *  by a MissMap. Each entry is a region tag plus one bit per cache line of
+ *  the region, so a region may hold at most 64 lines.
+ */
+class RegionPresenceMap
+{
+  public:
+    RegionPresenceMap( uint64_t sets, uint64_t assoc, 
+                       uint64_t regionSize = 4096, uint64_t lineSize = 64 );
+    ~RegionPresenceMap( );
+
+    /* Takes ownership of policy. LRU is used unless another one is set. */
+    void SetReplacementPolicy( ReplacementPolicy *policy );
+    ReplacementPolicy *GetReplacementPolicy( );
+
+    /* Return true if the region of address has an entry. */
+    bool RegionPresent( uint64_t address );
+
+    /* Return true if the line at address is marked present. */
+    bool LinePresent( uint64_t address );
+
+    /*
+     *  Mark the line at address present, allocating its region if needed.
+     *  Returns true if another region was evicted for it, in which case its
+     *  base address and presence bits are returned in the last arguments.
+     */
+    bool Insert( uint64_t address, uint64_t *victimRegion, uint64_t *victimLines );
+
+    /* Clear the line at address, e.g. after the DRAM cache evicted it. */
+    void Remove( uint64_t address );
+
+    uint64_t GetRegionSize( );
+    uint64_t GetLinesPerRegion( );
+    uint64_t GetFootprint( );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
+  private:
+    uint64_t numSets, numAssoc;
+    uint64_t regionShift, lineShift;
+
+    uint64_t *tags;
+    uint64_t *lines;
+    ReplacementPolicy *replacementPolicy;
+
+    uint64_t Region( uint64_t address );
+    uint64_t LineMask( uint64_t address );
+    uint64_t FindWay( uint64_t set, uint64_t region );
+};
+
+};
+
+#endif
@@ -0,0 +1,129 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/ReplacementPolicy/LRUPolicy/LRUPolicy.h"
+#include "src/Checkpoint.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace NVM;
+
+LRUPolicy::LRUPolicy( )
+{
+    name = "LRU";
+}
+
+LRUPolicy::~LRUPolicy( )
+{
+}
+
+void LRUPolicy::Init( uint64_t sets, uint64_t assoc )
+{
+    ReplacementPolicy::Init( sets, assoc );
+
+    if( assoc > 256 )
+    {
+        std::cout << "Error: LRU supports up to 256 ways, but " << assoc 
+                  << " were configured!" << std::endl;
+        exit(1);
+    }
+
+    ranks.resize( sets * assoc );
+
+    for( uint64_t set = 0; set < sets; set++ )
+    {
+        for( uint64_t way = 0; way < assoc; way++ )
+            ranks[set * assoc + way] = static_cast<uint8_t>( way );
+    }
+}
+
+/* Move way to rank and shift the ways in between by one to keep the order. */
+void LRUPolicy::SetRank( uint64_t set, uint64_t way, uint8_t rank )
+{
+    uint8_t *setRanks = &ranks[set * numAssoc];
+    uint8_t oldRank = setRanks[way];
+
+    for( uint64_t i = 0; i < numAssoc; i++ )
+    {
+        if( rank < oldRank && setRanks[i] >= rank && setRanks[i] < oldRank )
+            setRanks[i]++;
+        else if( rank > oldRank && setRanks[i] > oldRank && setRanks[i] <= rank )
+            setRanks[i]--;
+    }
+
+    setRanks[way] = rank;
+}
+
+void LRUPolicy::OnHit( uint64_t set, uint64_t way )
+{
+    SetRank( set, way, 0 );
+}
+
+void LRUPolicy::OnInsert( uint64_t set, uint64_t way, uint64_t /*address*/ )
+{
+    SetRank( set, way, 0 );
+}
+
+/* Invalid ways are reused first, so they become least recently used. */
+void LRUPolicy::OnInvalidate( uint64_t set, uint64_t way )
+{
+    SetRank( set, way, static_cast<uint8_t>( numAssoc - 1 ) );
+}
+
+uint64_t LRUPolicy::SelectVictim( uint64_t set )
+{
+    const uint8_t *setRanks = &ranks[set * numAssoc];
+    uint64_t victim = 0;
+
+    for( uint64_t way = 0; way < numAssoc; way++ )
+    {
+        if( setRanks[way] == numAssoc - 1 )
+        {
+            victim = way;
+            break;
+        }
+    }
+
+    return victim;
+}
+
+void LRUPolicy::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    cpt.WriteBytes( &ranks[0], ranks.size( ) );
+}
+
+bool LRUPolicy::ReadCheckpoint( CheckpointReader& cpt )
+{
+    return cpt.ReadBytes( &ranks[0], ranks.size( ) );
+}
@@ -0,0 +1,146 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/ReplacementPolicy/RRIPPolicy/RRIPPolicy.h"
+#include "src/Checkpoint.h"
+
+#include <algorithm>
+
+using namespace NVM;
+
+/* BRRIP inserts at distant RRPV except once every this many fills. */
+#define BRRIP_LONG_INTERVAL 32
+/* Number of leader sets per policy, and the PSEL counter width. */
+#define DRRIP_LEADER_SETS 32
+#define DRRIP_PSEL_MAX 1023
+
+RRIPPolicy::RRIPPolicy( bool dynamic )
+{
+    this->dynamic = dynamic;
+    name = (dynamic ? "DRRIP" : "SRRIP");
+
+    duelPeriod = 2;
+    bimodalCount = 0;
+    psel = (DRRIP_PSEL_MAX + 1) / 2;
+}
+
+RRIPPolicy::~RRIPPolicy( )
+{
+}
+
+void RRIPPolicy::Init( uint64_t sets, uint64_t assoc )
+{
+    ReplacementPolicy::Init( sets, assoc );
+
+    rrpv.assign( sets * assoc, maxRRPV );
+
+    duelPeriod = std::max<uint64_t>( 2, sets / DRRIP_LEADER_SETS );
+}
+
+/*
+ *  Set (period * k) leads for SRRIP and set (period * k + 1) for BRRIP.
+ *  Misses in a leader set vote against its policy.
+ */
+bool RRIPPolicy::UseBimodal( uint64_t set )
+{
+    if( !dynamic )
+        return false;
+
+    uint64_t slot = set % duelPeriod;
+
+    if( slot == 0 )
+    {
+        if( psel < DRRIP_PSEL_MAX )
+            psel++;
+        return false;
+    }
+    else if( slot == 1 )
+    {
+        if( psel > 0 )
+            psel--;
+        return true;
+    }
+
+    return (psel > DRRIP_PSEL_MAX / 2);
+}
+
+void RRIPPolicy::OnHit( uint64_t set, uint64_t way )
+{
+    rrpv[set * numAssoc + way] = 0;
+}
+
+void RRIPPolicy::OnInsert( uint64_t set, uint64_t way, uint64_t /*address*/ )
+{
+    uint8_t insertRRPV = maxRRPV - 1;
+
+    if( UseBimodal( set ) )
+    {
+        bimodalCount++;
+        if( bimodalCount % BRRIP_LONG_INTERVAL != 0 )
+            insertRRPV = maxRRPV;
+    }
+
+    rrpv[set * numAssoc + way] = insertRRPV;
+}
+
+/* Age the whole set at once until some way reaches the distant RRPV. */
+uint64_t RRIPPolicy::SelectVictim( uint64_t set )
+{
+    uint8_t *setRRPV = &rrpv[set * numAssoc];
+    uint8_t oldest = *std::max_element( setRRPV, setRRPV + numAssoc );
+    uint64_t victim = 0;
+
+    if( oldest < maxRRPV )
+    {
+        for( uint64_t way = 0; way < numAssoc; way++ )
+            setRRPV[way] = static_cast<uint8_t>( setRRPV[way] + maxRRPV - oldest );
+    }
+
+    while( setRRPV[victim] != maxRRPV )
+        victim++;
+
+    return victim;
+}
+
+void RRIPPolicy::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    cpt.WriteBytes( &rrpv[0], rrpv.size( ) );
+    cpt.Write( bimodalCount );
+    cpt.Write( psel );
+}
+
+bool RRIPPolicy::ReadCheckpoint( CheckpointReader& cpt )
+{
+    return cpt.ReadBytes( &rrpv[0], rrpv.size( ) )
+           && cpt.Read( bimodalCount ) && cpt.Read( psel );
+}
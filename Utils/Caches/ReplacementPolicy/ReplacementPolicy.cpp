@@ -0,0 +1,106 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicy.h"
+
+#include <cassert>
+
+using namespace NVM;
+
+ReplacementPolicy::ReplacementPolicy( )
+{
+    name = "";
+    numSets = 0;
+    numAssoc = 0;
+
+    hits = 0;
+    fills = 0;
+    evictions = 0;
+}
+
+ReplacementPolicy::~ReplacementPolicy( )
+{
+}
+
+void ReplacementPolicy::Init( uint64_t sets, uint64_t assoc )
+{
+    numSets = sets;
+    numAssoc = assoc;
+}
+
+void ReplacementPolicy::Hit( uint64_t set, uint64_t way )
+{
+    hits++;
+    OnHit( set, way );
+}
+
+void ReplacementPolicy::Insert( uint64_t set, uint64_t way, uint64_t address )
+{
+    fills++;
+    OnInsert( set, way, address );
+}
+
+void ReplacementPolicy::Invalidate( uint64_t set, uint64_t way )
+{
+    evictions++;
+    OnInvalidate( set, way );
+}
+
+uint64_t ReplacementPolicy::Victim( uint64_t set )
+{
+    uint64_t way = SelectVictim( set );
+
+    assert( way < numAssoc );
+
+    return way;
+}
+
+std::string ReplacementPolicy::GetName( )
+{
+    return name;
+}
+
+ncounter_t ReplacementPolicy::GetHits( )
+{
+    return hits;
+}
+
+ncounter_t ReplacementPolicy::GetFills( )
+{
+    return fills;
+}
+
+ncounter_t ReplacementPolicy::GetEvictions( )
+{
+    return evictions;
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __UTILS_CACHES_REPLACEMENTPOLICY_H__
+#define __UTILS_CACHES_REPLACEMENTPOLICY_H__
+
+#include "include/NVMTypes.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace NVM {
+
+class Config;
+class CheckpointWriter;
+class CheckpointReader;
+
+/*
+ *  Chooses victims for a CacheBank. Replacement state is kept by the policy
+ *  per (set, way), apart from the tags, so a hit only updates the policy's
+ *  few bits for that way. Sets are numbered across all rows of the bank.
+ */
+class ReplacementPolicy
+{
+  public:
+    ReplacementPolicy( );
+    virtual ~ReplacementPolicy( );
+
+    virtual void SetConfig( Config * /*conf*/ ) { }
+    virtual void Init( uint64_t sets, uint64_t assoc );
+
+    /* A resident line was read or written. */
+    void Hit( uint64_t set, uint64_t way );
+    /* A line was placed in an invalid way after a miss. */
+    void Insert( uint64_t set, uint64_t way, uint64_t address );
+    /* A line was evicted or invalidated. */
+    void Invalidate( uint64_t set, uint64_t way );
+    /* Choose the way to evict from a full set. */
+    uint64_t Victim( uint64_t set );
+
+    virtual void WriteCheckpoint( CheckpointWriter& /*cpt*/ ) { }
+    virtual bool ReadCheckpoint( CheckpointReader& /*cpt*/ ) { return true; }
+
+    std::string GetName( );
+    ncounter_t GetHits( );
+    ncounter_t GetFills( );
+    ncounter_t GetEvictions( );
+
+  protected:
+    virtual void OnHit( uint64_t set, uint64_t way ) = 0;
+    virtual void OnInsert( uint64_t set, uint64_t way, uint64_t address ) = 0;
+    virtual void OnInvalidate( uint64_t /*set*/, uint64_t /*way*/ ) { }
+    virtual uint64_t SelectVictim( uint64_t set ) = 0;
+
+    std::string name;
+    uint64_t numSets, numAssoc;
+
+  private:
+    ncounter_t hits, fills, evictions;
+};
+
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/ReplacementPolicy/SHiPPolicy/SHiPPolicy.h"
+#include "src/Checkpoint.h"
+
+using namespace NVM;
+
+/* 16K-entry signature history counter table of 3-bit counters. */
+#define SHIP_SHCT_BITS 14
+#define SHIP_SHCT_MAX 7
+/* Signatures are taken from 4KB regions. */
+#define SHIP_REGION_SHIFT 12
+
+SHiPPolicy::SHiPPolicy( ) : RRIPPolicy( false )
+{
+    name = "SHiP";
+}
+
+SHiPPolicy::~SHiPPolicy( )
+{
+}
+
+void SHiPPolicy::Init( uint64_t sets, uint64_t assoc )
+{
+    RRIPPolicy::Init( sets, assoc );
+
+    /* Start weakly reused so a cold table does not bypass everything. */
+    shct.assign( 1 << SHIP_SHCT_BITS, 1 );
+    signatures.assign( sets * assoc, 0 );
+    reused.assign( sets * assoc, 0 );
+}
+
+void SHiPPolicy::OnHit( uint64_t set, uint64_t way )
+{
+    uint64_t index = set * numAssoc + way;
+
+    reused[index] = 1;
+    if( shct[signatures[index]] < SHIP_SHCT_MAX )
+        shct[signatures[index]]++;
+
+    rrpv[index] = 0;
+}
+
+void SHiPPolicy::OnInsert( uint64_t set, uint64_t way, uint64_t address )
+{
+    uint64_t index = set * numAssoc + way;
+    uint64_t region = address >> SHIP_REGION_SHIFT;
+    uint16_t signature = static_cast<uint16_t>( 
+        (region ^ (region >> SHIP_SHCT_BITS)) & ((1 << SHIP_SHCT_BITS) - 1) );
+
+    signatures[index] = signature;
+    reused[index] = 0;
+
+    rrpv[index] = (shct[signature] == 0) ? maxRRPV : maxRRPV - 1;
+}
+
+void SHiPPolicy::OnInvalidate( uint64_t set, uint64_t way )
+{
+    uint64_t index = set * numAssoc + way;
+
+    if( !reused[index] && shct[signatures[index]] > 0 )
+        shct[signatures[index]]--;
+
+    reused[index] = 0;
+    rrpv[index] = maxRRPV;
+}
+
+void SHiPPolicy::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    RRIPPolicy::WriteCheckpoint( cpt );
+
+    cpt.WriteBytes( &shct[0], shct.size( ) );
+    cpt.WriteBytes( &signatures[0], signatures.size( ) * sizeof(uint16_t) );
+    cpt.WriteBytes( &reused[0], reused.size( ) );
+}
+
+bool SHiPPolicy::ReadCheckpoint( CheckpointReader& cpt )
+{
+    return RRIPPolicy::ReadCheckpoint( cpt )
+           && cpt.ReadBytes( &shct[0], shct.size( ) )
+           && cpt.ReadBytes( &signatures[0], signatures.size( ) * sizeof(uint16_t) )
+           && cpt.ReadBytes( &reused[0], reused.size( ) );
+}
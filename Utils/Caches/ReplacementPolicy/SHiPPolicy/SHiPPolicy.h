@@ -0,0 +1,73 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __UTILS_CACHES_SHIPPOLICY_H__
+#define __UTILS_CACHES_SHIPPOLICY_H__
+
+#include "Utils/Caches/ReplacementPolicy/RRIPPolicy/RRIPPolicy.h"
+
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Signature-based hit prediction (Wu et al., MICRO 2011) on top of SRRIP.
+ *  The cache banks never see a PC, so this is the SHiP-Mem flavour: the
+ *  signature is a hash of the memory region a line belongs to. Lines from
+ *  regions that have not been re-referenced lately are inserted distant.
+ */
+class SHiPPolicy : public RRIPPolicy
+{
+  public:
+    SHiPPolicy( );
+    ~SHiPPolicy( );
+
+    void Init( uint64_t sets, uint64_t assoc );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
+  protected:
+    void OnHit( uint64_t set, uint64_t way );
+    void OnInsert( uint64_t set, uint64_t way, uint64_t address );
+    void OnInvalidate( uint64_t set, uint64_t way );
+
+  private:
+    std::vector<uint8_t> shct;
+    std::vector<uint16_t> signatures;
+    std::vector<uint8_t> reused;
+};
+
+};
+
+#endif
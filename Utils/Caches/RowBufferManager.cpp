@@ -0,0 +1,246 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/RowBufferManager.h"
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicyFactory.h"
+#include "include/NVMHelpers.h"
+#include "src/Config.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace NVM;
+
+RowBufferManager::RowBufferManager( )
+{
+    replacementPolicy = NULL;
+    policyName = "LRU";
+    bufferCount = 4;
+    bufferSize = 32;
+    readOnly = true;
+
+    allocations = 0;
+    writebacks = 0;
+}
+
+RowBufferManager::~RowBufferManager( )
+{
+    delete replacementPolicy;
+}
+
+void RowBufferManager::SetConfig( Config *config )
+{
+    /* Assume entire row is cached if CachedRowSize is unset. */
+    if( config->KeyExists( "COLS" ) )
+        bufferSize = config->GetValueUL( "COLS" );
+
+    if( config->KeyExists( "CachedRowsReadOnly" ) )
+        readOnly = config->GetBool( "CachedRowsReadOnly" );
+    if( config->KeyExists( "CachedRowSize" ) )
+        bufferSize = config->GetValueUL( "CachedRowSize" );
+    if( config->KeyExists( "CachedRowCount" ) )
+        bufferCount = config->GetValueUL( "CachedRowCount" );
+    if( config->KeyExists( "CachedRowPolicy" ) )
+        policyName = config->GetString( "CachedRowPolicy" );
+
+    if( bufferCount == 0 || bufferSize == 0 )
+    {
+        std::cerr << "NVMain Error: CachedRowCount and CachedRowSize must be "
+                  << "non-zero." << std::endl;
+        exit(1);
+    }
+
+    buffers.resize( bufferCount );
+    for( ncounter_t bufferIdx = 0; bufferIdx < bufferCount; bufferIdx++ )
+    {
+        buffers[bufferIdx].used = false;
+        buffers[bufferIdx].dirty.assign( bufferSize, false );
+        buffers[bufferIdx].reads = 0;
+        buffers[bufferIdx].writes = 0;
+    }
+
+    delete replacementPolicy;
+    replacementPolicy = ReplacementPolicyFactory::CreateReplacementPolicy( policyName );
+    replacementPolicy->SetConfig( config );
+    replacementPolicy->Init( 1, bufferCount );
+}
+
+ncounter_t RowBufferManager::Find( NVMAddress& address )
+{
+    ncounter_t bufferIdx;
+
+    for( bufferIdx = 0; bufferIdx < bufferCount; bufferIdx++ )
+    {
+        if( buffers[bufferIdx].used
+            && buffers[bufferIdx].row == address.GetRow( )
+            && buffers[bufferIdx].subarray == address.GetSubArray( )
+            && address.GetCol( ) >= buffers[bufferIdx].colStart
+            && address.GetCol( ) <  buffers[bufferIdx].colEnd )
+        {
+            break;
+        }
+    }
+
+    return bufferIdx;
+}
+
+bool RowBufferManager::Contains( NVMAddress& address )
+{
+    return ( Find( address ) < bufferCount );
+}
+
+ncounter_t RowBufferManager::Allocate( NVMAddress& address )
+{
+    ncounter_t bufferIdx = Find( address );
+    ncounter_t dirtyCount = 0;
+
+    /* The segment is already buffered; the activate only refreshes it. */
+    if( bufferIdx < bufferCount )
+    {
+        replacementPolicy->Hit( 0, bufferIdx );
+        return 0;
+    }
+
+    for( bufferIdx = 0; bufferIdx < bufferCount; bufferIdx++ )
+    {
+        if( !buffers[bufferIdx].used )
+            break;
+    }
+
+    if( bufferIdx == bufferCount )
+    {
+        bufferIdx = replacementPolicy->Victim( 0 );
+        dirtyCount = Evict( bufferIdx );
+    }
+
+    RowBuffer& buffer = buffers[bufferIdx];
+
+    buffer.used = true;
+    buffer.address = address;
+    buffer.row = address.GetRow( );
+    buffer.subarray = address.GetSubArray( );
+    buffer.colStart = address.GetCol( ) - ( address.GetCol( ) % bufferSize );
+    buffer.colEnd = buffer.colStart + bufferSize;
+    buffer.reads = 0;
+    buffer.writes = 0;
+
+    replacementPolicy->Insert( 0, bufferIdx, address.GetPhysicalAddress( ) );
+    allocations++;
+
+    assert( !( readOnly && dirtyCount > 0 ) );
+
+    return dirtyCount;
+}
+
+ncounter_t RowBufferManager::Evict( ncounter_t bufferIdx )
+{
+    RowBuffer& buffer = buffers[bufferIdx];
+    ncounter_t dirtyCount = 0;
+
+    allocationReadsMap[buffer.reads]++;
+    allocationWritesMap[buffer.writes]++;
+
+    for( ncounter_t dirtyIdx = 0; dirtyIdx < bufferSize; dirtyIdx++ )
+    {
+        if( buffer.dirty[dirtyIdx] )
+            dirtyCount++;
+
+        buffer.dirty[dirtyIdx] = false;
+    }
+
+    buffer.used = false;
+    writebacks += dirtyCount;
+
+    replacementPolicy->Invalidate( 0, bufferIdx );
+
+    return dirtyCount;
+}
+
+void RowBufferManager::Read( ncounter_t bufferIdx )
+{
+    assert( bufferIdx < bufferCount && buffers[bufferIdx].used );
+
+    buffers[bufferIdx].reads++;
+    replacementPolicy->Hit( 0, bufferIdx );
+}
+
+void RowBufferManager::Write( ncounter_t bufferIdx, NVMAddress& address )
+{
+    assert( bufferIdx < bufferCount && buffers[bufferIdx].used );
+    assert( !readOnly );
+
+    buffers[bufferIdx].dirty[address.GetCol( ) - buffers[bufferIdx].colStart] = true;
+    buffers[bufferIdx].writes++;
+    replacementPolicy->Hit( 0, bufferIdx );
+}
+
+ncounter_t RowBufferManager::GetCount( )
+{
+    return bufferCount;
+}
+
+ncounter_t RowBufferManager::GetSize( )
+{
+    return bufferSize;
+}
+
+bool RowBufferManager::IsReadOnly( )
+{
+    return readOnly;
+}
+
+ncounter_t RowBufferManager::GetAllocations( )
+{
+    return allocations;
+}
+
+ncounter_t RowBufferManager::GetWritebacks( )
+{
+    return writebacks;
+}
+
+std::string RowBufferManager::GetPolicyName( )
+{
+    return policyName;
+}
+
+std::string RowBufferManager::GetReadsHistogram( )
+{
+    return PyDictHistogram<uint64_t, uint64_t>( allocationReadsMap );
+}
+
+std::string RowBufferManager::GetWritesHistogram( )
+{
+    return PyDictHistogram<uint64_t, uint64_t>( allocationWritesMap );
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_CACHES_ROWBUFFERMANAGER_H__
+#define __NVMAIN_UTILS_CACHES_ROWBUFFERMANAGER_H__
+
+#include "include/NVMAddress.h"
+#include "include/NVMTypes.h"
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicy.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace NVM {
+
+class Config;
+
+struct RowBuffer
+{
+    bool used;
+    NVMAddress address;
+    ncounter_t row;
+    ncounter_t subarray;
+    ncounter_t colStart;
+    ncounter_t colEnd;
+    std::vector<bool> dirty;
+    ncounter_t reads;
+    ncounter_t writes;
+};
+
+/*
+ *  A set of row buffers in front of a bank. Each buffer caches a segment of
+ *  RowBufferSize columns of one row, so several rows (or several segments of
+ *  one row) can be served without an activate. The buffers form a single
+ *  fully-associative set whose victims are chosen by a ReplacementPolicy.
+ *  Timing is left to the owning bank.
+ */
+class RowBufferManager
+{
+  public:
+    RowBufferManager( );
+    ~RowBufferManager( );
+
+    /* Reads CachedRowCount, CachedRowSize, CachedRowsReadOnly and CachedRowPolicy. */
+    void SetConfig( Config *config );
+
+    /* Return the buffer holding the column of address, or GetCount( ). */
+    ncounter_t Find( NVMAddress& address );
+    bool Contains( NVMAddress& address );
+
+    /* 
+     *  Bind a buffer to the segment holding address, evicting a victim when
+     *  all buffers are used. Returns the number of dirty columns the victim
+     *  must write back to the bank.
+     */
+    ncounter_t Allocate( NVMAddress& address );
+
+    void Read( ncounter_t buffer );
+    void Write( ncounter_t buffer, NVMAddress& address );
+
+    ncounter_t GetCount( );
+    ncounter_t GetSize( );
+    bool IsReadOnly( );
+
+    ncounter_t GetAllocations( );
+    ncounter_t GetWritebacks( );
+    std::string GetPolicyName( );
+    std::string GetReadsHistogram( );
+    std::string GetWritesHistogram( );
+
+  private:
+    std::vector<RowBuffer> buffers;
+    ReplacementPolicy *replacementPolicy;
+    std::string policyName;
+    ncounter_t bufferCount;
+    ncounter_t bufferSize;
+    bool readOnly;
+
+    ncounter_t allocations;
+    ncounter_t writebacks;
+    std::map<uint64_t, uint64_t> allocationReadsMap;
+    std::map<uint64_t, uint64_t> allocationWritesMap;
+
+    ncounter_t Evict( ncounter_t buffer );
+};
+
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/TagCache.h"
+#include "Utils/Caches/ReplacementPolicy/LRUPolicy/LRUPolicy.h"
+
+using namespace NVM;
+
+/* Key of an unused way. Never names a real set. */
+#define TAGCACHE_KEY_INVALID (~static_cast<uint64_t>(0))
+
+TagCache::TagCache( uint64_t sets, uint64_t assoc )
+{
+    numSets = sets;
+    numAssoc = assoc;
+
+    keys = new uint64_t[ sets * assoc ];
+
+    for( uint64_t i = 0; i < sets * assoc; i++ )
+        keys[i] = TAGCACHE_KEY_INVALID;
+
+    replacementPolicy = new LRUPolicy( );
+    replacementPolicy->Init( sets, assoc );
+}
+
+TagCache::~TagCache( )
+{
+    delete [] keys;
+    delete replacementPolicy;
+}
+
+uint64_t TagCache::FindWay( uint64_t set, uint64_t key )
+{
+    const uint64_t *setKeys = keys + set * numAssoc;
+    uint64_t way;
+
+    for( way = 0; way < numAssoc; way++ )
+    {
+        if( setKeys[way] == key )
+            break;
+    }
+
+    return way;
+}
+
+bool TagCache::Lookup( uint64_t key )
+{
+    uint64_t set = key % numSets;
+    uint64_t way = FindWay( set, key );
+
+    if( way == numAssoc )
+        return false;
+
+    replacementPolicy->Hit( set, way );
+
+    return true;
+}
+
+void TagCache::Insert( uint64_t key )
+{
+    uint64_t set = key % numSets;
+    uint64_t way = FindWay( set, key );
+
+    if( way < numAssoc )
+    {
+        replacementPolicy->Hit( set, way );
+        return;
+    }
+
+    way = FindWay( set, TAGCACHE_KEY_INVALID );
+
+    if( way == numAssoc )
+    {
+        way = replacementPolicy->Victim( set );
+        replacementPolicy->Invalidate( set, way );
+    }
+
+    keys[set * numAssoc + way] = key;
+    replacementPolicy->Insert( set, way, key );
+}
+
+void TagCache::Invalidate( uint64_t key )
+{
+    uint64_t set = key % numSets;
+    uint64_t way = FindWay( set, key );
+
+    if( way < numAssoc )
+    {
+        keys[set * numAssoc + way] = TAGCACHE_KEY_INVALID;
+        replacementPolicy->Invalidate( set, way );
+    }
+}
@@ -0,0 +1,73 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_CACHES_TAGCACHE_H__
+#define __NVMAIN_UTILS_CACHES_TAGCACHE_H__
+
+#include "Utils/Caches/ReplacementPolicy/ReplacementPolicy.h"
+
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  Small set-associative SRAM cache of DRAM cache tag blocks. Entries are
+ *  only keys naming a DRAM cache set; the tags themselves stay in the
+ *  functional cache, so this decides timing, not hit or miss.
+ */
+class TagCache
+{
+  public:
+    TagCache( uint64_t sets, uint64_t assoc );
+    ~TagCache( );
+
+    /* Return true if the tags of set key are cached. */
+    bool Lookup( uint64_t key );
+
+    /* Cache the tags of set key, e.g. after they were read or written. */
+    void Insert( uint64_t key );
+
+    /* Drop the tags of set key. */
+    void Invalidate( uint64_t key );
+
+  private:
+    uint64_t numSets, numAssoc;
+    uint64_t *keys;
+    ReplacementPolicy *replacementPolicy;
+
+    uint64_t FindWay( uint64_t set, uint64_t key );
+};
+
+};
+
+#endif
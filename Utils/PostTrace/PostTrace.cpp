@@ -163,7 +163,8 @@ bool PostTrace::IssueAtomic( NVMainRequest *request )
 bool PostTrace::IssueCommand( NVMainRequest *request )
 {
     bool isPowerCommand = (request->type == POWERDOWN_PDA || request->type == POWERDOWN_PDPF ||
-                           request->type == POWERDOWN_PDPS || request->type == POWERUP );
+                           request->type == POWERDOWN_PDPS || request->type == POWERDOWN_SREF ||
+                           request->type == POWERUP );
     /*
      *  Filter out everything but bank issues here.
      */
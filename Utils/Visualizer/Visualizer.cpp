@@ -145,6 +145,7 @@ bool Visualizer::IssueCommand( NVMainRequest *req )
             case POWERDOWN_PDA:
             case POWERDOWN_PDPF:
             case POWERDOWN_PDPS:
+            case POWERDOWN_SREF:
                 graphSymbol[graphId] = 'D';
                 break;
 
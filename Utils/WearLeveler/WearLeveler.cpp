@@ -0,0 +1,299 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/WearLeveler/WearLeveler.h"
+#include "Decoders/WearLevelingDecoder/WearLevelingDecoder.h"
+#include "NVM/nvmain.h"
+
+#include <iostream>
+#include <cassert>
+
+using namespace NVM;
+
+WearLeveler::WearLeveler( )
+{
+    /* 
+     *  Moves are retried after other requests are queued, so the request
+     *  which the issuer found issuable is never pushed out of the queue.
+     */
+    SetHookType( NVMHOOK_POSTISSUE );
+
+    numCols = 1;
+    warned = false;
+
+    savedParent = NULL;
+
+    levelingReads = 0;
+    levelingWrites = 0;
+    levelingQueueWaits = 0;
+}
+
+
+WearLeveler::~WearLeveler( )
+{
+
+}
+
+
+void WearLeveler::Init( Config *config )
+{
+    /* Rows are moved whole, one burst per column. */
+    numCols = config->GetValue( "COLS" );
+
+    AddStat(levelingReads);
+    AddStat(levelingWrites);
+    AddStat(levelingQueueWaits);
+}
+
+
+/* The memory controller's decoder instance holds the leveling state. */
+WearLevelingDecoder *WearLeveler::FindDecoder( NVMainRequest *request )
+{
+    NVMObject *controller = parent->GetTrampoline( )->GetChild( request )->GetTrampoline( );
+    WearLevelingDecoder *decoder = dynamic_cast<WearLevelingDecoder *>(controller->GetDecoder( ));
+
+    if( decoder == NULL && !warned )
+    {
+        std::cout << "WearLeveler: Warning: Decoder is not a wear leveling decoder. "
+                  << "Set Decoder to StartGap or SecurityRefresh." << std::endl;
+        warned = true;
+    }
+
+    return decoder;
+}
+
+
+bool WearLeveler::IssueAtomic( NVMainRequest *request )
+{
+    if( NVMTypeMatches(NVMain) && request->type == WRITE )
+    {
+        WearLevelingDecoder *decoder = FindDecoder( request );
+
+        if( decoder == NULL || !decoder->RecordWrite( request->address.GetPhysicalAddress( ) ) )
+            return true;
+
+        /* No timing in atomic mode; Only the wear of the moves is counted. */
+        while( decoder->StepReady( ) )
+        {
+            std::vector<NVMAddress> lines;
+            std::vector<NVMAddress>::iterator it;
+
+            decoder->BeginMovement( request->address, lines );
+            decoder->AdvanceMapping( );
+
+            for( it = lines.begin( ); it != lines.end( ); it++ )
+                decoder->RecordLevelingWrite( it->GetPhysicalAddress( ) );
+
+            decoder->EndMovement( );
+        }
+    }
+
+    return true;
+}
+
+
+bool WearLeveler::IssueCommand( NVMainRequest * /*request*/ )
+{
+    /* 
+     *  Writes are counted on completion, so rejected requests are not
+     *  counted. Here we only retry moves the queue rejected earlier.
+     */
+    if( NVMTypeMatches(NVMain) )
+        IssueUnissued( );
+
+    return true;
+}
+
+
+bool WearLeveler::RequestComplete( NVMainRequest *request )
+{
+    if( !NVMTypeMatches(NVMain) )
+        return true;
+
+    if( request->owner == parent->GetTrampoline( ) 
+        && (request->tag == WL_READ_TAG || request->tag == WL_WRITE_TAG) )
+    {
+        WearLevelingDecoder *decoder = FindDecoder( request );
+
+        assert( moves.count( decoder ) != 0 );
+        LevelingMove& move = moves[decoder];
+
+        if( request->tag == WL_READ_TAG )
+        {
+            assert( move.outstandingReads > 0 );
+            move.outstandingReads--;
+
+            /* The old copies are buffered; Write them to their new rows. */
+            if( move.outstandingReads == 0 )
+            {
+                decoder->AdvanceMapping( );
+                IssueMovement( move, WRITE );
+            }
+        }
+        else
+        {
+            assert( move.outstandingWrites > 0 );
+            move.outstandingWrites--;
+
+            decoder->RecordLevelingWrite( request->address.GetPhysicalAddress( ) );
+
+            if( move.outstandingWrites == 0 )
+            {
+                NVMAddress trigger = move.lines.front( );
+
+                decoder->EndMovement( );
+                moves.erase( decoder );
+
+                /* Steps which came due during the move start right away. */
+                StartMovement( decoder, trigger );
+            }
+        }
+    }
+    else
+    {
+        if( request->type == WRITE )
+        {
+            WearLevelingDecoder *decoder = FindDecoder( request );
+
+            /* While the decoder is moving, the step waits for the move to end. */
+            if( decoder != NULL && decoder->RecordWrite( request->address.GetPhysicalAddress( ) ) )
+                StartMovement( decoder, request->address );
+        }
+
+        IssueUnissued( );
+    }
+
+    return true;
+}
+
+
+void WearLeveler::StartMovement( WearLevelingDecoder *decoder, NVMAddress& trigger )
+{
+    /* 
+     *  Note: once IssueCommand is called, this hook may receive a different
+     *  parent, so save a pointer to the NVMain class we are issuing to.
+     */
+    savedParent = parent->GetTrampoline( );
+
+    while( decoder->StepReady( ) )
+    {
+        LevelingMove move;
+
+        decoder->BeginMovement( trigger, move.lines );
+
+        /* Some steps move no data (e.g., a pair swapped earlier in the round). */
+        if( move.lines.empty( ) )
+        {
+            decoder->EndMovement( );
+            continue;
+        }
+
+        move.outstandingReads = 0;
+        move.outstandingWrites = 0;
+        move.queueWaited = false;
+
+        moves[decoder] = move;
+        IssueMovement( moves[decoder], READ );
+        break;
+    }
+}
+
+
+void WearLeveler::IssueMovement( LevelingMove& move, OpType type )
+{
+    std::vector<NVMAddress>::iterator it;
+
+    for( it = move.lines.begin( ); it != move.lines.end( ); it++ )
+    {
+        NVMainRequest *moveRequest = new NVMainRequest( );
+
+        moveRequest->address = *it;
+        moveRequest->type = type;
+        moveRequest->tag = (type == READ) ? WL_READ_TAG : WL_WRITE_TAG;
+        moveRequest->burstCount = numCols;
+        moveRequest->owner = savedParent;
+
+        move.unissued.push_back( moveRequest );
+    }
+
+    if( type == READ )
+    {
+        move.outstandingReads = move.lines.size( );
+        levelingReads += move.lines.size( );
+    }
+    else
+    {
+        move.outstandingWrites = move.lines.size( );
+        levelingWrites += move.lines.size( );
+    }
+
+    IssueUnissued( move );
+}
+
+
+/* 
+ *  Requests the transaction queue rejected are retried after each request
+ *  is issued, so moves are not starved by a stream of writes.
+ */
+void WearLeveler::IssueUnissued( )
+{
+    std::map<WearLevelingDecoder *, LevelingMove>::iterator it;
+
+    for( it = moves.begin( ); it != moves.end( ); it++ )
+        IssueUnissued( it->second );
+}
+
+
+void WearLeveler::IssueUnissued( LevelingMove& move )
+{
+    while( !move.unissued.empty( ) )
+    {
+        if( !savedParent->IssueCommand( move.unissued.front( ) ) )
+        {
+            /* Count each move once, not every retry. */
+            if( !move.queueWaited )
+                levelingQueueWaits++;
+
+            move.queueWaited = true;
+            break;
+        }
+
+        move.unissued.pop_front( );
+    }
+}
+
+
+void WearLeveler::Cycle( ncycle_t /*steps*/ )
+{
+
+}
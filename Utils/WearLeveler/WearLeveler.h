@@ -0,0 +1,99 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_WEARLEVELER_H__
+#define __NVMAIN_UTILS_WEARLEVELER_H__
+
+#include "src/NVMObject.h"
+#include "include/NVMainRequest.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+namespace NVM {
+
+#define WL_READ_TAG GetTagGenerator( )->CreateTag("WLREAD")
+#define WL_WRITE_TAG GetTagGenerator( )->CreateTag("WLWRITE")
+
+class WearLevelingDecoder;
+
+/*
+ *  Drives the remapping steps of a wear leveling decoder (StartGap or
+ *  SecurityRefresh). Every moved row is read and written back through the
+ *  memory controller, so leveling costs bandwidth, latency, and wear.
+ */
+class WearLeveler : public NVMObject
+{
+  public:
+    WearLeveler( );
+    ~WearLeveler( );
+
+    void Init( Config *config );
+
+    bool IssueAtomic( NVMainRequest *request );
+    bool IssueCommand( NVMainRequest *request );
+    bool RequestComplete( NVMainRequest *request );
+
+    void Cycle( ncycle_t steps );
+
+  private:
+    ncounter_t numCols;
+    bool warned;
+
+    /* A step in progress; Each decoder (channel) moves independently. */
+    struct LevelingMove
+    {
+        std::vector<NVMAddress> lines;
+        std::list<NVMainRequest *> unissued;
+        ncounter_t outstandingReads, outstandingWrites;
+        bool queueWaited;
+    };
+
+    NVMObject *savedParent;
+    std::map<WearLevelingDecoder *, LevelingMove> moves;
+
+    ncounter_t levelingReads;
+    ncounter_t levelingWrites;
+    ncounter_t levelingQueueWaits;
+
+    WearLevelingDecoder *FindDecoder( NVMainRequest *request );
+    void StartMovement( WearLevelingDecoder *decoder, NVMAddress& trigger );
+    void IssueMovement( LevelingMove& move, OpType type );
+    void IssueUnissued( );
+    void IssueUnissued( LevelingMove& move );
+};
+
+};
+
+#endif
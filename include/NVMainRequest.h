@@ -61,7 +61,9 @@ enum OpType
     BUS_READ,       /* Data bus read burst */
     BUS_WRITE,      /* Data bus write burst */ 
     CACHED_READ,    /* Check if read is cached anywhere in hierarchy. */
-    CACHED_WRITE    /* Check if write is cached anywhere in hierarchy. */
+    CACHED_WRITE,   /* Check if write is cached anywhere in hierarchy. */
+    POWERDOWN_SREF, /* Self-refresh, left with PowerUp */
+    SUBARRAY_SELECT /* Designate the subarray for column commands (MASA) */
 };
 
 enum MemRequestStatus 
@@ -132,6 +134,7 @@ class NVMainRequest
         isPrefetch = false; 
         programCounter = 0; 
         burstCount = 1;
+        burstBeats = 0;
         writeProgress = 0;
         cancellations = 0;
         owner = NULL;
@@ -156,6 +159,7 @@ class NVMainRequest
     NVMAddress pfTrigger;          //< Address that triggered this prefetch
     uint64_t programCounter;       //< Program counter of CPU issuing request
     ncounter_t burstCount;         //< Number of bursts (used for variable-size requests.
+    ncounter_t burstBeats;         //< Beats per burst if shortened, e.g., by compression (0 = all)
     NVMObject *owner;              //< Pointer to the object that created this request
 
     ncycle_t arrivalCycle;         //< When the request arrived at the memory controller
@@ -179,6 +183,7 @@ class NVMainRequest
         FLAG_FORCED = 32,               // This write can not be paused or cancelled
         FLAG_PRIORITY = 64,             // Request (or precursor) that takes priority over write
         FLAG_ISSUED = 128,              // Request has left the command queue
+        FLAG_CACHED = 256,              // Queued without an activate, served from a buffer
         FLAG_COUNT
     };
 
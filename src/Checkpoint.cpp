@@ -0,0 +1,312 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Checkpoint.h"
+
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace NVM;
+
+/* 64-bit FNV-1a over the payload. */
+static const uint64_t checksumBasis = 0xcbf29ce484222325ULL;
+static const uint64_t checksumPrime = 0x100000001b3ULL;
+
+uint64_t NVM::CheckpointChecksum( uint64_t checksum, const void *data, uint64_t size )
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>( data );
+
+    for( uint64_t i = 0; i < size; i++ )
+    {
+        checksum ^= bytes[i];
+        checksum *= checksumPrime;
+    }
+
+    return checksum;
+}
+
+CheckpointWriter::CheckpointWriter( std::string dir, std::string name )
+{
+    fileName = dir + "/" + name + ".cpt";
+
+    memset( &header, 0, sizeof(header) );
+    /* The magic string fills the field, including its terminating NUL. */
+    memcpy( header.magic, NVMAIN_CHECKPOINT_MAGIC, sizeof(header.magic) );
+    header.version = NVMAIN_CHECKPOINT_VERSION;
+    header.headerSize = sizeof(header);
+    header.payloadSize = 0;
+    header.checksum = checksumBasis;
+
+    /* Create the checkpoint directory on first use; it may already exist. */
+    mkdir( dir.c_str( ), 0755 );
+
+    cptFile.open( fileName.c_str( ), std::ofstream::out | std::ofstream::trunc 
+                                   | std::ofstream::binary );
+
+    if( !cptFile.is_open( ) )
+    {
+        std::cout << "Checkpoint: Warning: Could not open checkpoint file: " 
+                  << fileName << std::endl;
+        return;
+    }
+
+    /* Placeholder, the final header is written by Close( ). */
+    cptFile.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+}
+
+CheckpointWriter::~CheckpointWriter( )
+{
+    Close( );
+}
+
+bool CheckpointWriter::IsOpen( )
+{
+    return cptFile.is_open( );
+}
+
+void CheckpointWriter::Close( )
+{
+    if( !cptFile.is_open( ) )
+        return;
+
+    cptFile.seekp( 0 );
+    cptFile.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+    cptFile.close( );
+}
+
+void CheckpointWriter::WriteBytes( const void *data, uint64_t size )
+{
+    if( !cptFile.is_open( ) || size == 0 )
+        return;
+
+    cptFile.write( static_cast<const char *>( data ), size );
+
+    header.payloadSize += size;
+    header.checksum = CheckpointChecksum( header.checksum, data, size );
+}
+
+void CheckpointWriter::WriteMap( const std::map<uint64_t, uint64_t>& values )
+{
+    uint64_t count = values.size( );
+    std::map<uint64_t, uint64_t>::const_iterator it;
+
+    Write( count );
+
+    for( it = values.begin( ); it != values.end( ); it++ )
+    {
+        Write( it->first );
+        Write( it->second );
+    }
+}
+
+void CheckpointWriter::WriteSet( const std::set<uint64_t>& values )
+{
+    uint64_t count = values.size( );
+    std::set<uint64_t>::const_iterator it;
+
+    Write( count );
+
+    for( it = values.begin( ); it != values.end( ); it++ )
+        Write( *it );
+}
+
+CheckpointReader::CheckpointReader( std::string dir, std::string name )
+{
+    struct stat fileStat;
+
+    fileName = dir + "/" + name + ".cpt";
+    fd = -1;
+    mapping = NULL;
+    mappingSize = 0;
+    payload = NULL;
+    payloadSize = 0;
+    position = 0;
+    good = false;
+
+    fd = open( fileName.c_str( ), O_RDONLY );
+
+    if( fd < 0 )
+    {
+        std::cout << "Checkpoint: Warning: Could not open checkpoint file: " 
+                  << fileName << std::endl;
+        return;
+    }
+
+    if( fstat( fd, &fileStat ) != 0 
+        || static_cast<uint64_t>( fileStat.st_size ) < sizeof(CheckpointHeader) )
+    {
+        std::cout << "Checkpoint: Warning: Checkpoint file " << fileName 
+                  << " is truncated. Skipping restore." << std::endl;
+        return;
+    }
+
+    mappingSize = fileStat.st_size;
+    void *addr = mmap( NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    if( addr == MAP_FAILED )
+    {
+        std::cout << "Checkpoint: Warning: Could not map checkpoint file: " 
+                  << fileName << std::endl;
+        mappingSize = 0;
+        return;
+    }
+
+    mapping = static_cast<uint8_t *>( addr );
+
+    CheckpointHeader header;
+    memcpy( &header, mapping, sizeof(header) );
+
+    if( strncmp( header.magic, NVMAIN_CHECKPOINT_MAGIC, sizeof(header.magic) ) != 0 )
+    {
+        std::cout << "Checkpoint: Warning: " << fileName 
+                  << " is not an NVMain checkpoint. Skipping restore." << std::endl;
+    }
+    else if( header.version != NVMAIN_CHECKPOINT_VERSION )
+    {
+        std::cout << "Checkpoint: Warning: " << fileName << " has version " 
+                  << header.version << ", expected " << NVMAIN_CHECKPOINT_VERSION 
+                  << ". Skipping restore." << std::endl;
+    }
+    else if( header.headerSize + header.payloadSize != mappingSize )
+    {
+        std::cout << "Checkpoint: Warning: Checkpoint file " << fileName 
+                  << " is truncated. Skipping restore." << std::endl;
+    }
+    else if( CheckpointChecksum( checksumBasis, mapping + header.headerSize, 
+                                 header.payloadSize ) != header.checksum )
+    {
+        std::cout << "Checkpoint: Warning: Checksum mismatch in " << fileName 
+                  << ". Skipping restore." << std::endl;
+    }
+    else
+    {
+        payload = mapping + header.headerSize;
+        payloadSize = header.payloadSize;
+        good = true;
+    }
+}
+
+CheckpointReader::~CheckpointReader( )
+{
+    if( mapping != NULL )
+        munmap( mapping, mappingSize );
+
+    if( fd >= 0 )
+        close( fd );
+}
+
+bool CheckpointReader::IsOpen( )
+{
+    return ( payload != NULL );
+}
+
+/*
+ *  False once a read went past the end of the payload. Callers should check
+ *  this before committing restored state.
+ */
+bool CheckpointReader::Good( )
+{
+    return good;
+}
+
+uint64_t CheckpointReader::Remaining( )
+{
+    return payloadSize - position;
+}
+
+bool CheckpointReader::ReadBytes( void *data, uint64_t size )
+{
+    if( !good || size > payloadSize - position )
+    {
+        good = false;
+        return false;
+    }
+
+    memcpy( data, payload + position, size );
+    position += size;
+
+    return true;
+}
+
+bool CheckpointReader::ReadMap( std::map<uint64_t, uint64_t>& values )
+{
+    uint64_t count = 0;
+
+    if( !Read( count ) || count > Remaining( ) / ( 2 * sizeof(uint64_t) ) )
+    {
+        good = false;
+        return false;
+    }
+
+    values.clear( );
+
+    for( uint64_t i = 0; i < count; i++ )
+    {
+        uint64_t key = 0, value = 0;
+
+        Read( key );
+        Read( value );
+
+        /* Entries were written in order, so hint at the end. */
+        values.insert( values.end( ), std::pair<uint64_t, uint64_t>( key, value ) );
+    }
+
+    return good;
+}
+
+bool CheckpointReader::ReadSet( std::set<uint64_t>& values )
+{
+    uint64_t count = 0;
+
+    if( !Read( count ) || count > Remaining( ) / sizeof(uint64_t) )
+    {
+        good = false;
+        return false;
+    }
+
+    values.clear( );
+
+    for( uint64_t i = 0; i < count; i++ )
+    {
+        uint64_t value = 0;
+
+        Read( value );
+        values.insert( values.end( ), value );
+    }
+
+    return good;
+}
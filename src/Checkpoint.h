@@ -0,0 +1,127 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SRC_CHECKPOINT_H__
+#define __SRC_CHECKPOINT_H__
+
+#include <stdint.h>
+#include <string>
+#include <fstream>
+#include <map>
+#include <set>
+
+namespace NVM {
+
+/*
+ *  Checkpoint files hold one object each and are named <dir>/<name>.cpt.
+ *  The header records a magic string, the format version, the payload size
+ *  and a checksum of the payload, so stale or truncated checkpoints are
+ *  rejected instead of being restored as garbage.
+ */
+#define NVMAIN_CHECKPOINT_MAGIC   "NVMCKPT"
+#define NVMAIN_CHECKPOINT_VERSION 4
+
+struct CheckpointHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t payloadSize;
+    uint64_t checksum;
+};
+
+class CheckpointWriter
+{
+  public:
+    CheckpointWriter( std::string dir, std::string name );
+    ~CheckpointWriter( );
+
+    bool IsOpen( );
+    void Close( );
+
+    void WriteBytes( const void *data, uint64_t size );
+
+    template<typename T> void Write( const T& value )
+    {
+        WriteBytes( &value, sizeof(T) );
+    }
+
+    void WriteMap( const std::map<uint64_t, uint64_t>& values );
+    void WriteSet( const std::set<uint64_t>& values );
+
+  private:
+    std::string fileName;
+    std::ofstream cptFile;
+    CheckpointHeader header;
+};
+
+/*
+ *  Reads a checkpoint by mapping the file into memory, so restoring large
+ *  structures is a copy out of the page cache rather than many small reads.
+ */
+class CheckpointReader
+{
+  public:
+    CheckpointReader( std::string dir, std::string name );
+    ~CheckpointReader( );
+
+    bool IsOpen( );
+    bool Good( );
+    uint64_t Remaining( );
+
+    bool ReadBytes( void *data, uint64_t size );
+
+    template<typename T> bool Read( T& value )
+    {
+        return ReadBytes( &value, sizeof(T) );
+    }
+
+    bool ReadMap( std::map<uint64_t, uint64_t>& values );
+    bool ReadSet( std::set<uint64_t>& values );
+
+  private:
+    std::string fileName;
+    int fd;
+    uint8_t *mapping;
+    uint64_t mappingSize;
+    const uint8_t *payload;
+    uint64_t payloadSize;
+    uint64_t position;
+    bool good;
+};
+
+uint64_t CheckpointChecksum( uint64_t checksum, const void *data, uint64_t size );
+
+};
+
+#endif
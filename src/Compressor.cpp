@@ -0,0 +1,328 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Compressor.h"
+#include "src/Checkpoint.h"
+#include "src/EventQueue.h"
+#include "src/Params.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace NVM;
+
+Compressor::Compressor( )
+{
+    config = NULL;
+
+    burstBytes = 64;
+    beatBytes = 8;
+    beatsPerBurst = 8;
+
+    cacheSets = 0;
+    cacheAssoc = 8;
+    linesPerEntry = 64;
+    cacheAccesses = 0;
+    missPolicy = MISS_FULL;
+    metadataLatency = 0;
+
+    compressedReads = 0;
+    compressedWrites = 0;
+    lineBytes = 0;
+    storedBytes = 0;
+    uncompressedBusCycles = 0;
+    transferredBusCycles = 0;
+    metadataHits = 0;
+    metadataMisses = 0;
+    reads = 0;
+    decompressionCycles = 0;
+    readDelayCycles = 0;
+    compressionRatio = 1.0;
+    bandwidthGain = 1.0;
+    averageReadDelay = 0.0;
+}
+
+Compressor::~Compressor( )
+{
+}
+
+void Compressor::SetConfig( Config *conf, bool /*createChildren*/ )
+{
+    ncounter_t cacheEntries = 0;
+
+    config = conf;
+
+    Params *params = new Params( );
+    params->SetParams( conf );
+    SetParams( params );
+
+    /* One burst moves BusWidth bits per beat for the nominal tBURST cycles. */
+    beatBytes = p->BusWidth / 8;
+    beatsPerBurst = p->nominalBURST * p->RATE;
+    burstBytes = beatBytes * beatsPerBurst;
+    metadataLatency = p->tRCD + p->tCAS + p->tBURST;
+
+    if( conf->KeyExists( "CompressionMetadataCacheEntries" ) )
+        cacheEntries = conf->GetValueUL( "CompressionMetadataCacheEntries" );
+
+    if( conf->KeyExists( "CompressionMetadataCacheAssoc" ) )
+        cacheAssoc = conf->GetValueUL( "CompressionMetadataCacheAssoc" );
+
+    if( conf->KeyExists( "CompressionMetadataLines" ) )
+        linesPerEntry = conf->GetValueUL( "CompressionMetadataLines" );
+
+    if( conf->KeyExists( "CompressionMetadataLatency" ) )
+        metadataLatency = conf->GetValueUL( "CompressionMetadataLatency" );
+
+    if( conf->KeyExists( "CompressionMetadataMiss" ) )
+    {
+        if( conf->GetString( "CompressionMetadataMiss" ) == "Full" )
+        {
+            missPolicy = MISS_FULL;
+        }
+        else if( conf->GetString( "CompressionMetadataMiss" ) == "Fetch" )
+        {
+            missPolicy = MISS_FETCH;
+        }
+        else
+        {
+            std::cerr << "Compressor: Unknown CompressionMetadataMiss policy '" 
+                      << conf->GetString( "CompressionMetadataMiss" ) 
+                      << "'. Use Full or Fetch." << std::endl;
+            exit(1);
+        }
+    }
+
+    if( burstBytes == 0 || beatBytes == 0 || linesPerEntry == 0 || cacheAssoc == 0 )
+    {
+        std::cerr << "Compressor: The burst size, CompressionMetadataLines and "
+                  << "CompressionMetadataCacheAssoc must be non-zero." << std::endl;
+        exit(1);
+    }
+
+    /* Without a metadata cache every lookup hits. */
+    if( cacheEntries != 0 )
+    {
+        if( cacheAssoc > cacheEntries )
+            cacheAssoc = cacheEntries;
+
+        cacheSets = cacheEntries / cacheAssoc;
+        cacheTags.assign( cacheSets * cacheAssoc, 0 );
+        cacheLastUse.assign( cacheSets * cacheAssoc, 0 );
+    }
+}
+
+void Compressor::RegisterStats( )
+{
+    AddStat(compressedReads);
+    AddStat(compressedWrites);
+    AddUnitStat(lineBytes, "B");
+    AddUnitStat(storedBytes, "B");
+    AddStat(compressionRatio);
+    AddStat(uncompressedBusCycles);
+    AddStat(transferredBusCycles);
+    AddStat(bandwidthGain);
+    AddStat(metadataHits);
+    AddStat(metadataMisses);
+    AddStat(decompressionCycles);
+    AddStat(averageReadDelay);
+}
+
+void Compressor::CalculateStats( )
+{
+    if( storedBytes != 0 )
+        compressionRatio = static_cast<double>(lineBytes) 
+                         / static_cast<double>(storedBytes);
+
+    if( transferredBusCycles != 0 )
+        bandwidthGain = static_cast<double>(uncompressedBusCycles) 
+                      / static_cast<double>(transferredBusCycles);
+
+    if( reads != 0 )
+        averageReadDelay = static_cast<double>(readDelayCycles) 
+                         / static_cast<double>(reads);
+}
+
+ncounter_t Compressor::CompressedSize( const uint8_t * /*line*/, ncounter_t bytes, 
+                                      ncycle_t& latency )
+{
+    latency = 0;
+
+    return bytes;
+}
+
+bool Compressor::AccessMetadata( uint64_t line )
+{
+    if( cacheSets == 0 )
+    {
+        metadataHits++;
+        return true;
+    }
+
+    /* Tags are stored off by one so that zero marks an empty way. */
+    uint64_t tag = line / linesPerEntry + 1;
+    ncounter_t set = static_cast<ncounter_t>( ( tag - 1 ) % cacheSets );
+    ncounter_t base = set * cacheAssoc;
+    ncounter_t victim = base;
+
+    cacheAccesses++;
+
+    for( ncounter_t way = base; way < base + cacheAssoc; way++ )
+    {
+        if( cacheTags[way] == tag )
+        {
+            cacheLastUse[way] = cacheAccesses;
+            metadataHits++;
+            return true;
+        }
+
+        if( cacheLastUse[way] < cacheLastUse[victim] )
+            victim = way;
+    }
+
+    cacheTags[victim] = tag;
+    cacheLastUse[victim] = cacheAccesses;
+    metadataMisses++;
+
+    return false;
+}
+
+ncycle_t Compressor::Compress( NVMainRequest *request )
+{
+    bool isRead = ( request->type == READ || request->type == READ_PRECHARGE );
+    bool isWrite = ( request->type == WRITE || request->type == WRITE_PRECHARGE );
+    ncounter_t bytes = request->data.GetSize( );
+    ncycle_t delay = 0;
+
+    /* Multi-line transfers (e.g., migrations) and requests without data are left as is. */
+    if( ( !isRead && !isWrite ) || request->burstCount != 1 
+        || bytes == 0 || request->data.rawData == NULL )
+    {
+        return 0;
+    }
+
+    uint64_t line = request->address.GetPhysicalAddress( ) / bytes;
+    ncounter_t fullBursts = ( bytes + burstBytes - 1 ) / burstBytes;
+    ncounter_t size;
+    ncycle_t latency = 0;
+    std::map<uint64_t, uint64_t>::iterator it = metadata.find( line );
+
+    /* Lines read before they are written hold the data given with the read. */
+    if( isWrite || it == metadata.end( ) )
+    {
+        size = CompressedSize( request->data.rawData, bytes, latency );
+
+        if( size >= bytes )
+        {
+            size = bytes;
+            latency = 0;
+        }
+
+        metadata[line] = static_cast<uint64_t>(size) 
+                       | ( static_cast<uint64_t>(latency) << 32 );
+    }
+    else
+    {
+        size = static_cast<ncounter_t>( it->second & 0xFFFFFFFFULL );
+        latency = static_cast<ncycle_t>( it->second >> 32 );
+    }
+
+    /* The beats are spread over as few bursts as hold them. */
+    ncounter_t bursts = ( size + burstBytes - 1 ) / burstBytes;
+
+    if( bursts == 0 )
+        bursts = 1;
+
+    ncounter_t beats = ( ( size + beatBytes - 1 ) / beatBytes + bursts - 1 ) / bursts;
+
+    if( beats == 0 )
+        beats = 1;
+
+    /* Uncompressed lines keep the full bursts of the baseline. */
+    if( size >= bytes )
+        beats = beatsPerBurst;
+
+    if( isRead )
+    {
+        /* Without the metadata the size is unknown until it is fetched. */
+        if( !AccessMetadata( line ) )
+        {
+            if( missPolicy == MISS_FULL )
+            {
+                bursts = fullBursts;
+                beats = beatsPerBurst;
+            }
+            else
+            {
+                delay += metadataLatency;
+            }
+        }
+
+        if( size < bytes )
+            compressedReads++;
+
+        delay += latency;
+        decompressionCycles += latency;
+        readDelayCycles += delay;
+        reads++;
+    }
+    else
+    {
+        /* Writes update the metadata off the critical path. */
+        AccessMetadata( line );
+
+        if( size < bytes )
+            compressedWrites++;
+    }
+
+    lineBytes += bytes;
+    storedBytes += size;
+    uncompressedBusCycles += fullBursts * p->nominalBURST;
+    transferredBusCycles += bursts * ( ( beats + p->RATE - 1 ) / p->RATE );
+
+    request->burstCount = bursts;
+    request->burstBeats = ( beats < beatsPerBurst ) ? beats : 0;
+
+    return delay;
+}
+
+/* Only the line metadata is saved; the metadata cache restarts cold. */
+void Compressor::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    cpt.WriteMap( metadata );
+}
+
+bool Compressor::ReadCheckpoint( CheckpointReader& cpt )
+{
+    return cpt.ReadMap( metadata );
+}
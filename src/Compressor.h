@@ -0,0 +1,113 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __COMPRESSOR_H__
+#define __COMPRESSOR_H__
+
+#include "src/Config.h"
+#include "src/NVMObject.h"
+#include "include/NVMainRequest.h"
+
+#include <map>
+#include <vector>
+
+namespace NVM {
+
+class CheckpointWriter;
+class CheckpointReader;
+
+/*
+ *  Memory-side line compression. The memory controller passes every line
+ *  request through Compress before its commands are queued. Compressed
+ *  lines are stored in as few beats as possible, so the request is sent
+ *  with fewer or shorter bursts. The compressed size of each line is kept
+ *  as metadata; reads that miss in the metadata cache either fetch the
+ *  whole line or wait for the metadata.
+ */
+class Compressor : public NVMObject
+{
+  public:
+    Compressor( );
+    virtual ~Compressor( );
+
+    virtual void SetConfig( Config *conf, bool createChildren = true );
+    virtual void RegisterStats( );
+    virtual void CalculateStats( );
+
+    /* Sets the bursts and beats of the request and returns the extra read latency. */
+    ncycle_t Compress( NVMainRequest *request );
+
+    /* 
+     *  Size of the compressed line in bytes (bytes if incompressible) and
+     *  the cycles needed to decompress it. The base class stores lines
+     *  uncompressed, which gives the baseline bus cycles.
+     */
+    virtual ncounter_t CompressedSize( const uint8_t *line, ncounter_t bytes, 
+                                       ncycle_t& latency );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
+    void Cycle( ncycle_t ) { }
+
+  protected:
+    Config *config;
+
+  private:
+    enum MetadataMissPolicy { MISS_FULL, MISS_FETCH };
+
+    ncounter_t burstBytes, beatBytes, beatsPerBurst;
+
+    /* Metadata per line: compressed bytes in the low and latency in the high word. */
+    std::map<uint64_t, uint64_t> metadata;
+
+    ncounter_t cacheSets, cacheAssoc, linesPerEntry;
+    std::vector<uint64_t> cacheTags;
+    std::vector<ncounter_t> cacheLastUse;
+    ncounter_t cacheAccesses;
+    MetadataMissPolicy missPolicy;
+    ncycle_t metadataLatency;
+
+    ncounter_t compressedReads, compressedWrites;
+    ncounter_t lineBytes, storedBytes;
+    ncounter_t uncompressedBusCycles, transferredBusCycles;
+    ncounter_t metadataHits, metadataMisses;
+    ncounter_t reads, decompressionCycles, readDelayCycles;
+    double compressionRatio, bandwidthGain, averageReadDelay;
+
+    bool AccessMetadata( uint64_t line );
+};
+
+};
+
+#endif
@@ -43,6 +43,8 @@ namespace NVM {
 
 class Config;
 class NVMainRequest;
+class CheckpointWriter;
+class CheckpointReader;
 
 class DataEncoder : public NVMObject
 {
@@ -57,6 +59,10 @@ class DataEncoder : public NVMObject
 
     virtual void PrintStats( ) { }
 
+    /* Encoder state is saved in the owning subarray's checkpoint. */
+    virtual void WriteCheckpoint( CheckpointWriter& /*cpt*/ ) { }
+    virtual bool ReadCheckpoint( CheckpointReader& /*cpt*/ ) { return true; }
+
     virtual void Cycle( ncycle_t steps );
 
 };
@@ -35,8 +35,32 @@
 
 #include "src/Debug.h"
 
+#include <iostream>
+#include <string>
+
 using namespace NVM;
 
+DebugLevel NVM::ParseDebugLevel( std::string level )
+{
+    DebugLevel rv = DEBUG_TRACE;
+
+    if( level == "None" )
+        rv = DEBUG_NONE;
+    else if( level == "Error" )
+        rv = DEBUG_ERROR;
+    else if( level == "Warning" )
+        rv = DEBUG_WARNING;
+    else if( level == "Info" )
+        rv = DEBUG_INFO;
+    else if( level == "Trace" )
+        rv = DEBUG_TRACE;
+    else
+        std::cout << "NVMain: Warning: Unknown DebugLevel '" << level 
+                  << "'. Using 'Trace'." << std::endl;
+
+    return rv;
+}
+
 
 
 
@@ -39,9 +39,34 @@
 
 #include <iosfwd>
 #include <fstream>
+#include <string>
+
+/*
+ *  Debug prints are compiled out of fast and prof builds (NDEBUG) unless
+ *  NVMAIN_DEBUG_LOGGING is set to 1 on the command line.
+ */
+#ifndef NVMAIN_DEBUG_LOGGING
+#ifdef NDEBUG
+#define NVMAIN_DEBUG_LOGGING 0
+#else
+#define NVMAIN_DEBUG_LOGGING 1
+#endif
+#endif
 
 namespace NVM {
 
+/* Messages up to the configured DebugLevel are printed. */
+enum DebugLevel 
+{
+    DEBUG_NONE = 0,
+    DEBUG_ERROR,
+    DEBUG_WARNING,
+    DEBUG_INFO,
+    DEBUG_TRACE
+};
+
+DebugLevel ParseDebugLevel( std::string level );
+
 class nullstream : public std::ostream {};
 
 
@@ -54,6 +79,16 @@ static nullstream nvmainDebugInhibitor;
 
 };
 
+/*
+ *  Usage inside an NVMObject: NVMDebug( DEBUG_TRACE ) << ... << std::endl;
+ *  When logging is compiled out the condition is constant and the stream
+ *  expression, including its arguments, is never evaluated. Otherwise the
+ *  cost of a disabled message is a single compare against debugLevel.
+ */
+#define NVMDebug( level ) \
+    if( !NVMAIN_DEBUG_LOGGING || (level) > debugLevel ) ; \
+    else *debugStream
+
 
 #endif
 
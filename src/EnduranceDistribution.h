@@ -46,6 +46,9 @@ class EnduranceDistribution
 
      virtual uint64_t GetEndurance( ) = 0;
 
+     /* Fraction of locations worn out after the given number of writes. */
+     virtual double GetFailureProbability( double writes ) = 0;
+
 };
 
 };
@@ -33,7 +33,9 @@
 
 #include "src/EnduranceModel.h"
 #include "Endurance/EnduranceDistributionFactory.h"
+#include "FaultModels/FaultModelFactory.h"
 #include "src/FaultModel.h"
+#include "src/Checkpoint.h"
 #include <iostream>
 #include <limits>
 
@@ -44,12 +46,48 @@ EnduranceModel::EnduranceModel( )
     life.clear( );
 
     granularity = 0;
+    enduranceDist = NULL;
+    faultModel = NULL;
+}
+
+EnduranceModel::~EnduranceModel( )
+{
+    if( faultModel )
+        delete faultModel;
 }
 
 void EnduranceModel::SetConfig( Config *config, bool /*createChildren*/ )
 {
     enduranceDist = EnduranceDistributionFactory::CreateEnduranceDistribution( 
             config->GetString( "EnduranceDist" ), config );
+
+    if( config->KeyExists( "FaultModel" ) )
+    {
+        faultModelName = config->GetString( "FaultModel" );
+        faultModel = FaultModelFactory::CreateFaultModel( faultModelName );
+
+        if( faultModel )
+        {
+            faultModel->SetEventQueue( GetEventQueue( ) );
+            faultModel->SetConfig( config );
+        }
+    }
+}
+
+void EnduranceModel::RegisterStats( )
+{
+    if( faultModel )
+    {
+        faultModel->SetStats( GetStats( ) );
+        faultModel->StatName( StatName( ) + "." + faultModelName );
+        faultModel->RegisterStats( );
+    }
+}
+
+void EnduranceModel::CalculateStats( )
+{
+    if( faultModel )
+        faultModel->CalculateStats( );
 }
 
 /*
@@ -98,6 +136,8 @@ bool EnduranceModel::DecrementLife( uint64_t addr )
     std::map<uint64_t, uint64_t>::iterator i = life.find( addr );
     bool rv = true;
 
+    writes[addr]++;
+
     if( i == life.end( ) )
     {
           /* Generate a random number using the specified distribution */
@@ -119,6 +159,37 @@ bool EnduranceModel::DecrementLife( uint64_t addr )
     return rv;
 }
 
+/*
+ *  Number of wear locations in the owning subarray. The granularity is
+ *  the number of bits tracked by one key of the life map.
+ */
+uint64_t EnduranceModel::GetLocationCount( )
+{
+    uint64_t rowBits;
+
+    if( granularity == 0 )
+        return 0;
+
+    rowBits = p->COLS * p->BusWidth * p->nominalBURST * p->RATE;
+
+    return ( p->MATHeight * rowBits ) / granularity;
+}
+
+/*
+ *  Returns the number of writes seen during this run and the remaining
+ *  life for each location that was written. Writes restored from a
+ *  checkpoint are already accounted for in the remaining life.
+ */
+void EnduranceModel::GetWearProfile( std::vector<std::pair<uint64_t, uint64_t> >& profile )
+{
+    std::map<uint64_t, uint64_t>::iterator i;
+
+    profile.clear( );
+
+    for( i = writes.begin( ); i != writes.end( ); i++ )
+        profile.push_back( std::make_pair( i->second, life[i->first] ) );
+}
+
 bool EnduranceModel::IsDead( uint64_t addr )
 {
     std::map<uint64_t, uint64_t>::iterator i = life.find( addr );
@@ -132,6 +203,42 @@ bool EnduranceModel::IsDead( uint64_t addr )
     return rv;
 }
 
+bool EnduranceModel::DecrementLife( uint64_t addr, uint64_t line, uint64_t cell )
+{
+    if( faultModel == NULL )
+        return DecrementLife( addr );
+
+    /* The write that wears out the cell already needs the correction. */
+    if( DecrementLife( addr ) && !IsDead( addr ) )
+        return true;
+
+    return ( faultModel != NULL && faultModel->FaultCell( line, cell ) );
+}
+
+bool EnduranceModel::IsDead( uint64_t addr, uint64_t line, uint64_t cell )
+{
+    if( !IsDead( addr ) )
+        return false;
+
+    return ( faultModel == NULL || !faultModel->IsCorrected( line, cell ) );
+}
+
+ncycles_t EnduranceModel::CorrectionLatency( uint64_t line )
+{
+    return ( faultModel != NULL ) ? faultModel->ReadLatency( line ) : 0;
+}
+
+/*
+ *  Writes to lines with corrected cells pass through the fault model as
+ *  reads do. Errors are encoded as -(latency + 1) so that 0 stays valid.
+ */
+ncycles_t EnduranceModel::WriteLatency( uint64_t line, bool hardError )
+{
+    ncycles_t latency = ( faultModel != NULL ) ? faultModel->WriteLatency( line ) : 0;
+
+    return hardError ? -( latency + 1 ) : latency;
+}
+
 void EnduranceModel::SetGranularity( uint64_t bits )
 {
     granularity = bits;
@@ -147,3 +254,37 @@ uint64_t EnduranceModel::GetGranularity( )
 void EnduranceModel::Cycle( ncycle_t )
 {
 }
+
+void EnduranceModel::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    cpt.WriteMap( life );
+
+    if( faultModel )
+    {
+        faultModel->WriteCheckpoint( cpt );
+    }
+    else
+    {
+        FaultModel noFaults;
+
+        noFaults.WriteCheckpoint( cpt );
+    }
+}
+
+bool EnduranceModel::ReadCheckpoint( CheckpointReader& cpt )
+{
+    bool rv = cpt.ReadMap( life );
+
+    if( faultModel )
+    {
+        rv = faultModel->ReadCheckpoint( cpt ) && rv;
+    }
+    else
+    {
+        FaultModel noFaults;
+
+        rv = noFaults.ReadCheckpoint( cpt ) && rv;
+    }
+
+    return rv;
+}
@@ -36,6 +36,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdint.h>
 #include "src/Config.h"
 #include "src/Params.h"
@@ -48,12 +49,14 @@
 namespace NVM {
 
 class FaultModel;
+class CheckpointWriter;
+class CheckpointReader;
 
 class EnduranceModel : public NVMObject
 {
   public:
     EnduranceModel( );
-    ~EnduranceModel( ) {}
+    ~EnduranceModel( );
 
     /* Return -(latency+1) on error, or the additional number of cycles needed by the model otherwise. */
     virtual ncycles_t Read( NVMainRequest *request ) = 0;
@@ -65,22 +68,43 @@ class EnduranceModel : public NVMObject
     uint64_t GetWorstLife( );
     uint64_t GetAverageLife( );
 
+    /* Wear seen during this run, used to project the lifetime. */
+    uint64_t GetLocationCount( );
+    void GetWearProfile( std::vector<std::pair<uint64_t, uint64_t> >& profile );
+    EnduranceDistribution *GetDistribution( ) { return enduranceDist; }
+
     virtual void PrintStats( ) { }
+    void RegisterStats( );
+    void CalculateStats( );
+
+    /* Endurance state is saved in the owning subarray's checkpoint. */
+    virtual void WriteCheckpoint( CheckpointWriter& cpt );
+    virtual bool ReadCheckpoint( CheckpointReader& cpt );
 
     void Cycle( ncycle_t steps );
 
   protected:
     EnduranceDistribution *enduranceDist;
+    FaultModel *faultModel;
     std::map<uint64_t, uint64_t> life;
+    std::map<uint64_t, uint64_t> writes;
     
     bool DecrementLife( uint64_t addr );
     bool IsDead( uint64_t addr );
 
+    /* As above, but dead cells are handed to the fault model for correction. */
+    bool DecrementLife( uint64_t addr, uint64_t line, uint64_t cell );
+    bool IsDead( uint64_t addr, uint64_t line, uint64_t cell );
+    ncycles_t CorrectionLatency( uint64_t line );
+    /* Return value of Write: the correction latency, negated on a hard error. */
+    ncycles_t WriteLatency( uint64_t line, bool hardError );
+
     void SetGranularity( uint64_t bits );
     uint64_t GetGranularity( );
 
   private:
     uint64_t granularity;
+    std::string faultModelName;
 
 };
 
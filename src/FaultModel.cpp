@@ -32,12 +32,14 @@
 *******************************************************************************/
 
 #include "src/FaultModel.h"
+#include "src/Checkpoint.h"
 
 using namespace NVM;
 
 FaultModel::FaultModel( )
 {
     config = NULL;
+    endurance = NULL;
 }
 
 FaultModel::~FaultModel( )
@@ -63,6 +65,39 @@ bool FaultModel::Fault( NVMAddress /*faultAddr*/ )
     return false;
 }
 
+bool FaultModel::FaultCell( uint64_t /*line*/, uint64_t /*cell*/ )
+{
+    return false;
+}
+
+bool FaultModel::IsCorrected( uint64_t /*line*/, uint64_t /*cell*/ )
+{
+    return false;
+}
+
+ncycles_t FaultModel::ReadLatency( uint64_t /*line*/ )
+{
+    return 0;
+}
+
+ncycles_t FaultModel::WriteLatency( uint64_t /*line*/ )
+{
+    return 0;
+}
+
+void FaultModel::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    std::map<uint64_t, uint64_t> state;
+
+    cpt.WriteMap( state );
+}
+
+bool FaultModel::ReadCheckpoint( CheckpointReader& cpt )
+{
+    std::map<uint64_t, uint64_t> state;
+
+    return cpt.ReadMap( state );
+}
 
 void FaultModel::Cycle( ncycle_t )
 {
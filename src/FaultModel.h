@@ -41,6 +41,8 @@
 namespace NVM {
 
 class EnduranceModel;
+class CheckpointWriter;
+class CheckpointReader;
 
 class FaultModel : public NVMObject
 {
@@ -51,6 +53,21 @@ class FaultModel : public NVMObject
     /* Fault returns true if the fault could be fixed. */
     virtual bool Fault( NVMAddress faultAddr ); 
 
+    /* 
+     *  Worn out cells are reported per line (one write unit). FaultCell
+     *  returns true if the cell could be corrected, IsCorrected whether a
+     *  dead cell is already covered and ReadLatency/WriteLatency the
+     *  extra cycles needed to correct a read or write of the line.
+     */
+    virtual bool FaultCell( uint64_t line, uint64_t cell );
+    virtual bool IsCorrected( uint64_t line, uint64_t cell );
+    virtual ncycles_t ReadLatency( uint64_t line );
+    virtual ncycles_t WriteLatency( uint64_t line );
+
+    /* Fault state is saved as a single map so it can always be skipped. */
+    virtual void WriteCheckpoint( CheckpointWriter& cpt );
+    virtual bool ReadCheckpoint( CheckpointReader& cpt );
+
     virtual void SetConfig( Config *conf, bool createChildren = true );
     Config *GetConfig( );
 
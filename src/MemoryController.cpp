@@ -41,6 +41,9 @@
 #include "src/Rank.h"
 #include "src/SubArray.h"
 #include "include/NVMHelpers.h"
+#include "src/Checkpoint.h"
+#include "src/Compressor.h"
+#include "Compressors/CompressorFactory.h"
 
 #include <sstream>
 #include <cassert>
@@ -75,6 +78,57 @@ MemoryController::MemoryController( )
     activeSubArray = NULL;
 
     delayedRefreshCounter = NULL;
+
+    compressor = NULL;
+
+    lastColumnRank = std::numeric_limits<ncounter_t>::max( );
+    lastColumnGroup = std::numeric_limits<ncounter_t>::max( );
+
+    commandBusCount = 1;
+    lastConflictCycle = std::numeric_limits<ncycle_t>::max( );
+    rowCommands = 0;
+    columnCommands = 0;
+    dataBusCycles = 0;
+    commandBusConflicts = 0;
+    commandBusUtilization = 0.0;
+    rowBusUtilization = 0.0;
+    columnBusUtilization = 0.0;
+    dataBusUtilization = 0.0;
+
+    outOfOrderRefreshes = 0;
+    elasticRefreshes = 0;
+    refreshPauses = 0;
+    refreshDelayedReads = 0;
+    refreshReadDelay = 0;
+    averageRefreshReadDelay = 0.0;
+    refreshDelayedReadsHisto = "";
+    refreshReadDelayHisto = "";
+
+    activePowerDowns = 0;
+    fastExitPowerDowns = 0;
+    slowExitPowerDowns = 0;
+    selfRefreshes = 0;
+    powerUps = 0;
+    proactiveWakeups = 0;
+    powerDownMispredictions = 0;
+    wakeupPenalty = 0;
+    averageWakeupPenalty = 0.0;
+
+    pagePredictions = 0;
+    mispredictedPrecharges = 0;
+    mispredictedOpenRows = 0;
+    pagePredictorAccuracy = 0.0;
+
+    lastPowerTrace = 0;
+
+    dvfsPoint = 0;
+    dvfsPointStart = 0;
+    relockUntil = 0;
+    dvfsEpochDataBusCycles = 0;
+    dvfsSwitches = 0;
+    dvfsRelockCycles = 0;
+    averageFrequency = 0.0;
+    dvfsResidencyHisto = "";
     
     curQueue = 0;
     nextRefreshRank = 0;
@@ -112,6 +166,7 @@ MemoryController::~MemoryController( )
     delete [] activeSubArray;
     delete [] bankNeedRefresh;
     delete [] rankPowerDown;
+    delete compressor;
     
     if( p->UseRefresh )
     {
@@ -191,6 +246,32 @@ void MemoryController::Enqueue( ncounter_t queueNum, NVMainRequest *request )
     assert( queueNum < transactionQueueCount );
 
     transactionQueues[queueNum].push_back( request );
+
+    /* Track reads that arrive while their bank is (about to be) refreshed. */
+    if( p->UseRefresh )
+    {
+        ncounter_t refreshGroup = bank / p->BanksPerRefresh;
+
+        if( ( request->type == READ || request->type == READ_PRECHARGE )
+            && ( bankNeedRefresh[rank][bank] || refreshQueued[rank][bank]
+                 || refreshSegmentEnd[rank][refreshGroup] > GetEventQueue()->GetCurrentCycle() ) )
+        {
+            refreshBlockedReads[request] = GetEventQueue()->GetCurrentCycle();
+        }
+
+        refreshGroupAccess[rank][refreshGroup] = GetEventQueue()->GetCurrentCycle();
+    }
+
+    /* Start waking a powered down rank before its commands are queued. */
+    if( rankPowerDown[rank] && p->UseLowPower 
+        && ( p->lowPowerPolicy == LowPowerPolicy_Timeout 
+             || p->lowPowerPolicy == LowPowerPolicy_Predictive ) )
+    {
+        if( rankDemandSince[rank] == std::numeric_limits<ncycle_t>::max( ) )
+            rankDemandSince[rank] = GetEventQueue()->GetCurrentCycle();
+
+        ScheduleLowPowerWake( GetEventQueue()->GetCurrentCycle() );
+    }
     
     /* If this command queue is empty, we can schedule a new transaction right away. */
     ncounter_t queueId = GetCommandQueueId( request->address );
@@ -289,6 +370,173 @@ void MemoryController::RefreshCallback( void *data )
     GetChild( )->Cycle( realSteps );
 }
 
+void MemoryController::LowPowerCallback( void * /*data*/ )
+{
+    ncycle_t realSteps = GetEventQueue( )->GetCurrentCycle( ) - lastCommandWake;
+    lastCommandWake = GetEventQueue( )->GetCurrentCycle( );
+    wakeupCount++;
+
+    ManageLowPower( );
+
+    /* Catch up the rest of the system. */
+    GetChild( )->Cycle( realSteps );
+}
+
+void MemoryController::PowerTraceCallback( void * /*data*/ )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+
+    WritePowerTrace( );
+
+    GetEventQueue( )->InsertCallback( this, 
+                      (CallbackPtr)&MemoryController::PowerTraceCallback,
+                      now + p->PowerTraceInterval, NULL, cleanupPriority );
+}
+
+/*
+ *  Writes the average power (W) of each rank and the whole channel over the
+ *  last interval, from the energy the ranks accumulated since the last call.
+ */
+void MemoryController::WritePowerTrace( )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    ncycle_t interval = now - lastPowerTrace;
+    std::vector<double> channelPower( 4, 0.0 );
+
+    if( interval == 0 )
+        return;
+
+    for( ncounter_t rankId = 0; rankId < p->RANKS; rankId++ )
+    {
+        std::vector<double> energy( 4, 0.0 );
+
+        FindRank( rankId )->GetEnergy( energy[0], energy[1], energy[2], energy[3] );
+
+        powerTrace << now << "," << rankId;
+
+        double totalPower = 0.0;
+        for( ncounter_t i = 0; i < 4; i++ )
+        {
+            double power = IntervalPower( energy[i] - powerTraceEnergy[rankId][i], interval );
+
+            powerTrace << "," << power;
+            channelPower[i] += power;
+            totalPower += power;
+        }
+
+        powerTrace << "," << totalPower << std::endl;
+        powerTraceEnergy[rankId] = energy;
+    }
+
+    powerTrace << now << ",channel" << GetID( );
+    for( ncounter_t i = 0; i < 4; i++ )
+        powerTrace << "," << channelPower[i];
+    powerTrace << "," << ( channelPower[0] + channelPower[1] + channelPower[2] 
+                           + channelPower[3] ) << std::endl;
+
+    lastPowerTrace = now;
+}
+
+/* Energy is in mA*t with the current model and in nJ otherwise. */
+double MemoryController::IntervalPower( const double energy, const ncycle_t cycles )
+{
+    if( cycles == 0 )
+        return 0.0;
+
+    if( p->energyModel == EnergyModel_Current )
+        return ( energy * p->Voltage ) / static_cast<double>( cycles ) / 1000.0;
+
+    return energy / ( static_cast<double>( cycles ) * 1000.0 / static_cast<double>( p->CLK ) );
+}
+
+/*
+ *  Once per DVFSEpoch, the data bus utilization of the last epoch selects the
+ *  operating point of the next one.
+ */
+void MemoryController::DVFSCallback( void * /*data*/ )
+{
+    double busCycles = static_cast<double>( dataBusCycles - dvfsEpochDataBusCycles );
+    double utilization = busCycles / static_cast<double>( p->DVFSEpoch * p->SubChannels 
+                                                          * p->PseudoChannels );
+
+    dvfsEpochDataBusCycles = dataBusCycles;
+
+    ncounter_t point = SelectOperatingPoint( utilization );
+
+    if( point != dvfsPoint )
+        SetOperatingPoint( point );
+
+    GetEventQueue( )->InsertCallback( this, 
+                      (CallbackPtr)&MemoryController::DVFSCallback,
+                      GetEventQueue( )->GetCurrentCycle( ) + p->DVFSEpoch, 
+                      NULL, cleanupPriority );
+}
+
+/* Step one operating point up or down. Point 0 is the highest frequency. */
+ncounter_t MemoryController::SelectOperatingPoint( double utilization )
+{
+    if( utilization > p->DVFSUpThreshold && dvfsPoint > 0 )
+        return dvfsPoint - 1;
+
+    if( utilization < p->DVFSDownThreshold && dvfsPoint + 1 < p->dvfsFrequencies.size( ) )
+        return dvfsPoint + 1;
+
+    return dvfsPoint;
+}
+
+/*
+ *  Switch the channel to an operating point. Commands already issued keep
+ *  their timing, new commands wait for the DLL to relock.
+ */
+void MemoryController::SetOperatingPoint( const ncounter_t point )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    ncounter_t frequency = static_cast<ncounter_t>( p->dvfsFrequencies[dvfsPoint] );
+
+    dvfsResidencyMap[frequency] += now - dvfsPointStart;
+
+    /* Background energy so far is charged at the old currents. */
+    for( ncounter_t rankId = 0; rankId < p->RANKS; rankId++ )
+        FindRank( rankId )->IntegrateBackground( );
+
+    RetimeModule( this, p->dvfsFrequencies[point] );
+
+    dvfsPoint = point;
+    dvfsPointStart = now;
+    dvfsSwitches++;
+
+    relockUntil = now + p->DVFSRelockLatency;
+    dvfsRelockCycles += p->DVFSRelockLatency;
+
+    if( !GetEventQueue()->FindCallback( this, (CallbackPtr)&MemoryController::CommandQueueCallback,
+                                        relockUntil, NULL, commandQueuePriority ) )
+    {
+        GetEventQueue()->InsertCallback( this, (CallbackPtr)&MemoryController::CommandQueueCallback,
+                                         relockUntil, NULL, commandQueuePriority );
+    }
+}
+
+/* Every module of the channel has its own copy of the parameters. */
+void MemoryController::RetimeModule( NVMObject *module, const double frequency )
+{
+    if( module->GetParams( ) != NULL )
+        module->GetParams( )->SetOperatingPoint( frequency );
+
+    for( ncounter_t childIdx = 0; childIdx < module->GetChildCount( ); childIdx++ )
+        RetimeModule( module->GetChild( childIdx )->GetTrampoline( ), frequency );
+}
+
+Rank *MemoryController::FindRank( const ncounter_t rankId )
+{
+    NVMainRequest rankRequest;
+    rankRequest.address.SetTranslatedAddress( 0, 0, 0, rankId, id, 0 );
+
+    NVMObject *child = NULL;
+    FindChildType( &rankRequest, Rank, child );
+
+    return dynamic_cast<Rank *>( child );
+}
+
 void MemoryController::CleanupCallback( void * /*data*/ )
 {
     for( ncycle_t queueId = 0; queueId < commandQueueCount; queueId++ )
@@ -301,6 +549,11 @@ void MemoryController::CleanupCallback( void * /*data*/ )
             commandQueues[queueId].end()
         );        
     }
+
+    /* A rank whose queues just drained may start its idle period. */
+    if( p->UseLowPower && ( p->lowPowerPolicy == LowPowerPolicy_Timeout 
+                            || p->lowPowerPolicy == LowPowerPolicy_Predictive ) )
+        ManageLowPower( );
 }
 
 bool MemoryController::RequestComplete( NVMainRequest *request )
@@ -318,6 +571,41 @@ bool MemoryController::RequestComplete( NVMainRequest *request )
     }
     else
     {
+        std::map<NVMainRequest *, ncycle_t>::iterator blocked = refreshBlockedReads.find( request );
+
+        /* The read waited until the refresh of its bank group finished. */
+        if( blocked != refreshBlockedReads.end( ) )
+        {
+            ncounter_t rank = request->address.GetRank( );
+            ncounter_t bank = request->address.GetBank( );
+            ncycle_t refreshEnd = MIN( GetEventQueue()->GetCurrentCycle(),
+                                       refreshSegmentEnd[rank][bank / p->BanksPerRefresh] );
+
+            if( refreshEnd > blocked->second )
+            {
+                ncounter_t bankId = rank * p->BANKS + bank;
+
+                refreshDelayedReads++;
+                refreshReadDelay += refreshEnd - blocked->second;
+                refreshDelayedReadsMap[bankId]++;
+                refreshReadDelayMap[bankId] += refreshEnd - blocked->second;
+            }
+
+            refreshBlockedReads.erase( blocked );
+        }
+
+        std::map<NVMainRequest *, ncycle_t>::iterator it = decompressionDelays.find( request );
+
+        /* Compressed reads of the other controllers are returned once decompressed. */
+        if( it != decompressionDelays.end( ) )
+        {
+            GetEventQueue( )->InsertEvent( EventResponse, GetParent( ), request, 
+                    GetEventQueue( )->GetCurrentCycle( ) + it->second );
+            decompressionDelays.erase( it );
+
+            return true;
+        }
+
         return GetParent( )->RequestComplete( request );
     }
 
@@ -400,6 +688,50 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
         memory->RegisterStats( );
         
         SetMappingScheme( );
+
+        if( conf->KeyExists( "Compression" ) && conf->GetString( "Compression" ) != "None" )
+        {
+            compressor = CompressorFactory::CreateCompressor( conf->GetString( "Compression" ) );
+
+            if( compressor )
+            {
+                compressor->SetParent( this );
+                compressor->StatName( StatName( ) + ".compression" );
+                compressor->SetConfig( conf, createChildren );
+                compressor->RegisterStats( );
+            }
+        }
+    }
+
+    if( p->PowerTraceInterval > 0 )
+    {
+        std::stringstream traceName;
+        traceName << p->PowerTraceFile << ".channel" << GetID( );
+
+        powerTrace.open( traceName.str( ).c_str( ) );
+
+        if( !powerTrace.is_open( ) )
+        {
+            std::cerr << "NVMain Error: Could not open power trace " 
+                      << traceName.str( ) << std::endl;
+            exit(1);
+        }
+
+        powerTrace << "cycle,rank,background,activate,burst,refresh,total" << std::endl;
+        powerTraceEnergy.assign( p->RANKS, std::vector<double>( 4, 0.0 ) );
+
+        GetEventQueue( )->InsertCallback( this, 
+                          (CallbackPtr)&MemoryController::PowerTraceCallback,
+                          GetEventQueue( )->GetCurrentCycle( ) + p->PowerTraceInterval, 
+                          NULL, cleanupPriority );
+    }
+
+    if( p->dvfsPolicy != DVFSPolicy_None && p->dvfsFrequencies.size( ) > 1 )
+    {
+        GetEventQueue( )->InsertCallback( this, 
+                          (CallbackPtr)&MemoryController::DVFSCallback,
+                          GetEventQueue( )->GetCurrentCycle( ) + p->DVFSEpoch, 
+                          NULL, cleanupPriority );
     }
 
     /*
@@ -408,7 +740,7 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
      *  number of devices = bus width / device width
      *  Total channel size is: loglcal bank size * BANKS * RANKS
      */
-    std::cout << StatName( ) << " capacity is " << ((p->ROWS * p->COLS * p->tBURST * p->RATE * p->BusWidth * p->BANKS * p->RANKS) / (8*1024*1024)) << " MB." << std::endl;
+    std::cout << StatName( ) << " capacity is " << ((p->ROWS * p->COLS * p->nominalBURST * p->RATE * p->BusWidth * p->BANKS * p->RANKS) / (8*1024*1024)) << " MB." << std::endl;
 
     if( conf->KeyExists( "MATHeight" ) )
     {
@@ -419,6 +751,13 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
         subArrayNum = 1;
     }
 
+    /* 
+     *  Each sub-channel has its own command bus, pseudo-channels share one.
+     *  With a split command bus, row and column commands can issue together.
+     */
+    commandBusCount = p->SubChannels * ( p->SplitCommandBus ? 2 : 1 );
+    commandBusIssueCycle.assign( commandBusCount, 0 );
+
     /* Determine number of command queues. Assume per-bank queues as this was the default for older nvmain versions. */
     queueModel = PerBankQueues;
     commandQueueCount = p->RANKS * p->BANKS;
@@ -442,6 +781,17 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
         /* Add your custom types here. */
     }
 
+    /* Closing a subarray for another must not overtake its queued commands. */
+    if( queueModel == PerSubArrayQueues 
+        && p->subArrayParallelism != SubArrayParallelism_Ideal
+        && p->subArrayParallelism != SubArrayParallelism_MASA )
+    {
+        std::cout << "NVMain Warning: SubArrayParallelism " << p->SubArrayParallelism
+                  << " keeps one row open per bank. Using PerBank queues." << std::endl;
+        queueModel = PerBankQueues;
+        commandQueueCount = p->RANKS * p->BANKS;
+    }
+
     std::cout << "Creating " << commandQueueCount << " command queues." << std::endl;
     
     commandQueues = new std::deque<NVMainRequest *> [commandQueueCount];
@@ -453,6 +803,23 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
     activeSubArray = new ncounter_t ** [p->RANKS];
     rankPowerDown = new bool [p->RANKS];
 
+    rankPowerMode.assign( p->RANKS, ( p->UseLowPower && p->InitPD ) ? POWERDOWN_PDPF : POWERUP );
+    rankIdleStart.assign( p->RANKS, std::numeric_limits<ncycle_t>::max( ) );
+    rankDemandSince.assign( p->RANKS, std::numeric_limits<ncycle_t>::max( ) );
+    rankIdlePrediction.assign( p->RANKS, p->PowerDownTimeout );
+    rankPowerDownThreshold.assign( p->RANKS, 0 );
+
+    /* Counters start weakly predicting a hit, i.e., open-page behavior. */
+    pageHistory.assign( p->RANKS, std::vector<ncounter_t>( p->BANKS, 0 ) );
+    pagePatternTable.assign( p->RANKS, std::vector< std::vector<uint8_t> >( p->BANKS, 
+                             std::vector<uint8_t>( 1ULL << p->PagePredictorHistory, 2 ) ) );
+    lastPageRow.assign( p->RANKS, std::vector<ncounter_t>( p->BANKS, p->ROWS ) );
+    lastPageSubArray.assign( p->RANKS, std::vector<ncounter_t>( p->BANKS, 0 ) );
+    lastPageClosed.assign( p->RANKS, std::vector<bool>( p->BANKS, false ) );
+
+    /* No subarray is known to be selected, so the first column command selects. */
+    designatedSubArray.assign( p->RANKS, std::vector<ncounter_t>( p->BANKS, subArrayNum ) );
+
     for( ncounter_t i = 0; i < p->RANKS; i++ )
     {
         activateQueued[i] = new bool[p->BANKS];
@@ -512,6 +879,10 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
         assert( p->BanksPerRefresh != 0 );
 
         m_refreshBankNum = p->BANKS / p->BanksPerRefresh;
+
+        refreshSegmentEnd.assign( p->RANKS, std::vector<ncycle_t>( m_refreshBankNum, 0 ) );
+        refreshGroupAccess.assign( p->RANKS, std::vector<ncycle_t>( m_refreshBankNum, 0 ) );
+        refreshPaused.assign( p->RANKS, std::vector<bool>( m_refreshBankNum, false ) );
         
         /* first, calculate the tREFI */
         m_tREFI = p->tREFW / (p->ROWS / p->RefreshRows );
@@ -560,6 +931,68 @@ void MemoryController::RegisterStats( )
 {
     AddStat(simulation_cycles);
     AddStat(wakeupCount);
+
+    AddStat(rowCommands);
+    AddStat(columnCommands);
+    if( p->SplitCommandBus )
+    {
+        AddStat(rowBusUtilization);
+        AddStat(columnBusUtilization);
+    }
+    else
+    {
+        AddStat(commandBusUtilization);
+    }
+    AddStat(dataBusCycles);
+    AddStat(dataBusUtilization);
+    if( commandBusCount > 1 )
+        AddStat(commandBusConflicts);
+
+    if( p->UseRefresh )
+    {
+        if( p->OutOfOrderRefresh )
+            AddStat(outOfOrderRefreshes);
+        if( p->ElasticRefresh )
+            AddStat(elasticRefreshes);
+        if( p->RefreshPausing )
+            AddStat(refreshPauses);
+        AddStat(refreshDelayedReads);
+        AddStat(refreshReadDelay);
+        AddStat(averageRefreshReadDelay);
+        AddStat(refreshDelayedReadsHisto);
+        AddStat(refreshReadDelayHisto);
+    }
+
+    if( p->UseLowPower && ( p->lowPowerPolicy == LowPowerPolicy_Timeout 
+                            || p->lowPowerPolicy == LowPowerPolicy_Predictive ) )
+    {
+        AddStat(activePowerDowns);
+        AddStat(fastExitPowerDowns);
+        AddStat(slowExitPowerDowns);
+        AddStat(selfRefreshes);
+        AddStat(powerUps);
+        AddStat(proactiveWakeups);
+        AddStat(wakeupPenalty);
+        AddStat(averageWakeupPenalty);
+        if( p->lowPowerPolicy == LowPowerPolicy_Predictive )
+            AddStat(powerDownMispredictions);
+    }
+
+    if( p->ClosePage == 3 )
+    {
+        AddStat(pagePredictions);
+        AddStat(mispredictedPrecharges);
+        AddStat(mispredictedOpenRows);
+        AddStat(pagePredictorAccuracy);
+    }
+
+    if( p->dvfsPolicy != DVFSPolicy_None )
+    {
+        AddStat(dvfsSwitches);
+        AddStat(dvfsRelockCycles);
+        AddStat(averageFrequency);
+        AddStat(dvfsResidencyHisto);
+    }
 }
 
 /* 
@@ -577,7 +1010,7 @@ bool MemoryController::NeedRefresh( const ncounter_t bank, const uint64_t rank )
 
     if( p->UseRefresh )
         if( delayedRefreshCounter[rank][bank/p->BanksPerRefresh] 
-                >= p->DelayedRefreshThreshold )
+                >= p->DelayedRefreshThreshold * p->RefreshPauseSegments )
             rv = true;
         
     return rv;
@@ -623,14 +1056,15 @@ void MemoryController::ResetRefreshQueued( const ncounter_t bank, const ncounter
 }
 
 /* 
- * Increment the delayedRefreshCounter by 1 in a given bank group
+ * Increment the delayedRefreshCounter by one refresh in a given bank group.
+ * The counter is kept in refresh segments when refresh pausing is used.
  */
 void MemoryController::IncrementRefreshCounter( const ncounter_t bank, const uint64_t rank )
 {
     /* get the bank group ID */
     ncounter_t bankGroupID = bank / p->BanksPerRefresh;
 
-    delayedRefreshCounter[rank][bankGroupID]++;
+    delayedRefreshCounter[rank][bankGroupID] += p->RefreshPauseSegments;
 }
 
 /* 
@@ -650,72 +1084,61 @@ void MemoryController::DecrementRefreshCounter( const ncounter_t bank, const uin
  */
 bool MemoryController::HandleRefresh( )
 {
-    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    /*
+     *  Due refreshes are handled round-robin (pass 1). Out-of-order refresh
+     *  first looks for an idle bank group with any pending refresh (pass 0).
+     *  Paused and postponed refreshes of idle bank groups are pulled in last
+     *  (pass 2).
+     */
+    ncycle_t currentCycle = GetEventQueue()->GetCurrentCycle();
+
+    for( ncounter_t pass = 0; pass < 3; pass++ )
     {
-        ncounter_t i = (nextRefreshRank + rankIdx) % p->RANKS;
+        if( pass == 0 && !p->OutOfOrderRefresh )
+            continue;
 
-        for( ncounter_t bankIdx = 0; bankIdx < m_refreshBankNum; bankIdx++ )
+        if( pass == 2 && !p->ElasticRefresh && !p->RefreshPausing )
+            continue;
+
+        bool skippedDue = false;
+
+        for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
         {
-            ncounter_t j = (nextRefreshBank + bankIdx * p->BanksPerRefresh) % p->BANKS;
-            FailReason fail;
+            ncounter_t i = (nextRefreshRank + rankIdx) % p->RANKS;
 
-            if( NeedRefresh( j, i ) /*&& IsRefreshBankQueueEmpty( j , i )*/ )
+            for( ncounter_t bankIdx = 0; bankIdx < m_refreshBankNum; bankIdx++ )
             {
-                /* create a refresh command that will be sent to ranks */
-                NVMainRequest* cmdRefresh = MakeRefreshRequest( 0, 0, j, i, 0 );
+                ncounter_t j = (nextRefreshBank + bankIdx * p->BanksPerRefresh) % p->BANKS;
+                bool candidate = false;
 
-                /* Always check if precharge is needed, even if REF is issublable. */
-                if( p->UsePrecharge )
+                if( pass == 0 )
                 {
-                    for( ncounter_t tmpBank = 0; tmpBank < p->BanksPerRefresh; tmpBank++ ) 
-                    {
-                        /* Use modulo to allow for an odd number of banks per refresh. */
-                        ncounter_t refBank = (tmpBank + j) % p->BANKS;
-                        ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, refBank, i /*rank*/, 0, 0 ) );
-
-                        /* Precharge all active banks and active subarrays */
-                        // TODO: Will this empty() need to be effectively empty?
-                        if( activateQueued[i][refBank] == true /*&& commandQueues[queueId].empty()*/ )
-                        {
-                            /* issue a PRECHARGE_ALL command to close all subarrays */
-                            // TODO: The PRECHARGE_ALL request generated here is meant to precharge all
-                            // subarrays -- We will need a different command for precharging all banks
-                            NVMainRequest *cmdRefPre = MakePrechargeAllRequest( 0, 0, refBank, i, 0 );
-
-                            commandQueues[queueId].push_back( cmdRefPre );
-
-                            /* clear all active subarrays */
-                            for( ncounter_t sa = 0; sa < subArrayNum; sa++ )
-                            {
-                                activeSubArray[i][refBank][sa] = false; 
-                                effectiveRow[i][refBank][sa] = p->ROWS;
-                                effectiveMuxedRow[i][refBank][sa] = p->ROWS;
-                            }
-                            activateQueued[i][refBank] = false;
-                        }
-                    }
-                }
-
-                ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, j, i, 0, 0 ) );
+                    candidate = IsRefreshReady( j, i ) && IsRefreshBankIdle( j, i, false );
 
-                /* send the refresh command to the rank */
-                cmdRefresh->issueCycle = GetEventQueue()->GetCurrentCycle();
-                commandQueues[queueId].push_back( cmdRefresh );
-
-                for( ncounter_t tmpBank = 0; tmpBank < p->BanksPerRefresh; tmpBank++ )
+                    if( NeedRefresh( j, i ) && !candidate )
+                        skippedDue = true;
+                }
+                else if( pass == 1 )
                 {
-                    ncounter_t refBank = (tmpBank + j) % p->BANKS;
-
-                    /* Disallow queuing commands to non-bank-head queues. */
-                    refreshQueued[i][refBank] = true;
+                    candidate = NeedRefresh( j, i ) /*&& IsRefreshBankQueueEmpty( j , i )*/;
+                }
+                else
+                {
+                    candidate = ( RefreshPullInCycle( j, i ) <= currentCycle );
                 }
 
-                /* decrement the corresponding counter by 1 */
-                DecrementRefreshCounter( j, i );
+                if( !candidate )
+                    continue;
+
+                if( pass == 0 && ( skippedDue || !NeedRefresh( j, i ) ) )
+                    outOfOrderRefreshes++;
 
-                /* if do not need refresh anymore, reset the refresh flag */
-                if( !NeedRefresh( j, i ) )
-                    ResetRefresh( j, i );
+                /* A new refresh pulled in early, rather than the next segment of a paused one. */
+                if( pass == 2 && delayedRefreshCounter[i][j / p->BanksPerRefresh] 
+                                 % p->RefreshPauseSegments == 0 )
+                    elasticRefreshes++;
+
+                QueueRefresh( j, i );
 
                 /* round-robin */
                 nextRefreshBank += p->BanksPerRefresh;
@@ -728,7 +1151,7 @@ bool MemoryController::HandleRefresh( )
                         nextRefreshRank = 0;
                 }
 
-                handledRefresh = GetEventQueue()->GetCurrentCycle();
+                handledRefresh = currentCycle;
 
                 ScheduleCommandWake( );
 
@@ -737,9 +1160,161 @@ bool MemoryController::HandleRefresh( )
             }
         }
     }
+
     return false;
 }
 
+/*
+ *  Queues a refresh for the bank group of the given bank, closing any open
+ *  rows first.
+ */
+void MemoryController::QueueRefresh( const ncounter_t j, const ncounter_t i )
+{
+    /* create a refresh command that will be sent to ranks */
+    NVMainRequest* cmdRefresh = MakeRefreshRequest( 0, 0, j, i, 0 );
+
+    /* Always check if precharge is needed, even if REF is issublable. */
+    if( p->UsePrecharge )
+    {
+        for( ncounter_t tmpBank = 0; tmpBank < p->BanksPerRefresh; tmpBank++ ) 
+        {
+            /* Use modulo to allow for an odd number of banks per refresh. */
+            ncounter_t refBank = (tmpBank + j) % p->BANKS;
+            ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, refBank, i /*rank*/, 0, 0 ) );
+
+            /* Precharge all active banks and active subarrays */
+            // TODO: Will this empty() need to be effectively empty?
+            if( activateQueued[i][refBank] == true /*&& commandQueues[queueId].empty()*/ )
+            {
+                /* issue a PRECHARGE_ALL command to close all subarrays */
+                // TODO: The PRECHARGE_ALL request generated here is meant to precharge all
+                // subarrays -- We will need a different command for precharging all banks
+                NVMainRequest *cmdRefPre = MakePrechargeAllRequest( 0, 0, refBank, i, 0 );
+
+                commandQueues[queueId].push_back( cmdRefPre );
+
+                /* clear all active subarrays */
+                for( ncounter_t sa = 0; sa < subArrayNum; sa++ )
+                {
+                    activeSubArray[i][refBank][sa] = false; 
+                    effectiveRow[i][refBank][sa] = p->ROWS;
+                    effectiveMuxedRow[i][refBank][sa] = p->ROWS;
+                }
+                activateQueued[i][refBank] = false;
+            }
+        }
+    }
+
+    ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, j, i, 0, 0 ) );
+
+    /* send the refresh command to the rank */
+    cmdRefresh->issueCycle = GetEventQueue()->GetCurrentCycle();
+    commandQueues[queueId].push_back( cmdRefresh );
+
+    for( ncounter_t tmpBank = 0; tmpBank < p->BanksPerRefresh; tmpBank++ )
+    {
+        ncounter_t refBank = (tmpBank + j) % p->BANKS;
+
+        /* Disallow queuing commands to non-bank-head queues. */
+        refreshQueued[i][refBank] = true;
+    }
+
+    /* decrement the corresponding counter by 1 */
+    DecrementRefreshCounter( j, i );
+
+    /* if do not need refresh anymore, reset the refresh flag */
+    if( !NeedRefresh( j, i ) )
+        ResetRefresh( j, i );
+
+    refreshPaused[i][j / p->BanksPerRefresh] = false;
+}
+
+/*
+ *  Returns true if the bank group has a pending refresh that is not queued
+ *  and its previous refresh (segment) has finished.
+ */
+bool MemoryController::IsRefreshReady( const ncounter_t bank, const ncounter_t rank )
+{
+    ncounter_t refreshGroup = bank / p->BanksPerRefresh;
+
+    return ( delayedRefreshCounter[rank][refreshGroup] > 0
+             && !refreshQueued[rank][refreshGroup * p->BanksPerRefresh]
+             && refreshSegmentEnd[rank][refreshGroup] <= GetEventQueue()->GetCurrentCycle() );
+}
+
+/*
+ *  Returns true if no commands are queued for the bank group and no
+ *  transactions (only reads if readsOnly is set) are waiting for it.
+ */
+bool MemoryController::IsRefreshBankIdle( const ncounter_t bank, const ncounter_t rank, bool readsOnly )
+{
+    if( !IsRefreshBankQueueEmpty( bank, rank ) )
+        return false;
+
+    ncounter_t refreshGroup = bank / p->BanksPerRefresh;
+
+    for( ncounter_t queueIdx = 0; queueIdx < transactionQueueCount; queueIdx++ )
+    {
+        std::list<NVMainRequest *>::iterator it;
+
+        for( it = transactionQueues[queueIdx].begin( );
+             it != transactionQueues[queueIdx].end( ); it++ )
+        {
+            if( (*it)->address.GetRank( ) != rank
+                || (*it)->address.GetBank( ) / p->BanksPerRefresh != refreshGroup )
+                continue;
+
+            if( !readsOnly || (*it)->type == READ || (*it)->type == READ_PRECHARGE )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ *  Returns the cycle the next segment of a paused refresh, or a postponed
+ *  refresh with elastic refresh, can be issued to the bank group. Refreshes
+ *  that already reached the DelayedRefreshThreshold are handled as usual.
+ */
+ncycle_t MemoryController::RefreshPullInCycle( const ncounter_t bank, const ncounter_t rank )
+{
+    ncounter_t refreshGroup = bank / p->BanksPerRefresh;
+    ncounter_t pending = delayedRefreshCounter[rank][refreshGroup];
+    ncycle_t never = std::numeric_limits<ncycle_t>::max( );
+
+    if( pending == 0 || NeedRefresh( bank, rank ) 
+        || refreshQueued[rank][refreshGroup * p->BanksPerRefresh] )
+    {
+        return never;
+    }
+
+    /* Part of a refresh is done. Reads to the bank group pause the rest. */
+    if( pending % p->RefreshPauseSegments != 0 )
+    {
+        if( !IsRefreshBankIdle( bank, rank, true ) )
+        {
+            if( !refreshPaused[rank][refreshGroup] )
+            {
+                refreshPaused[rank][refreshGroup] = true;
+                refreshPauses++;
+            }
+
+            return never;
+        }
+
+        return MAX( refreshSegmentEnd[rank][refreshGroup], GetEventQueue()->GetCurrentCycle() );
+    }
+
+    if( p->ElasticRefresh && IsRefreshBankIdle( bank, rank, false ) )
+    {
+        return MAX( refreshSegmentEnd[rank][refreshGroup], 
+                    refreshGroupAccess[rank][refreshGroup] + p->ElasticRefreshIdle );
+    }
+
+    return never;
+}
+
 /* 
  * it simply increments the corresponding delayed refresh counter 
  * and re-insert the refresh pulse into event queue
@@ -751,7 +1326,9 @@ void MemoryController::ProcessRefreshPulse( NVMainRequest* refresh )
     ncounter_t rank, bank;
     refresh->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
 
-    IncrementRefreshCounter( bank, rank );
+    /* Ranks in self-refresh refresh themselves. */
+    if( rankPowerMode[rank] != POWERDOWN_SREF )
+        IncrementRefreshCounter( bank, rank );
 
     if( NeedRefresh( bank, rank ) )
         SetRefresh( bank, rank ); 
@@ -884,12 +1461,213 @@ void MemoryController::HandleLowPower( )
     }
 }
 
-Config *MemoryController::GetConfig( )
+/*
+ *  Event-driven power-down manager. Each rank is powered down once it has been
+ *  idle for PowerDownTimeout cycles or, with the predictive policy, when the
+ *  predicted idle period makes a (deeper) power-down mode pay off. A rank is
+ *  woken up as soon as a request for it arrives.
+ */
+void MemoryController::ManageLowPower( )
 {
-    return (this->config);
-}
+    ncycle_t now = GetEventQueue()->GetCurrentCycle();
+    ncycle_t never = std::numeric_limits<ncycle_t>::max( );
 
-void MemoryController::SetID( unsigned int id )
+    for( ncounter_t rankId = 0; rankId < p->RANKS; rankId++ )
+    {
+        bool demand = RankHasDemand( rankId );
+
+        if( rankPowerDown[rankId] )
+        {
+            if( !demand )
+                continue;
+
+            if( rankDemandSince[rankId] == never )
+                rankDemandSince[rankId] = now;
+
+            NVMainRequest *powerupRequest = MakePowerupRequest( rankId );
+
+            if( !GetChild()->IsIssuable( powerupRequest ) )
+            {
+                delete powerupRequest;
+                ScheduleLowPowerWake( now + 1 );
+                continue;
+            }
+
+            /* Woken before any command of the rank was queued. */
+            if( RankQueueEmpty( rankId ) )
+                proactiveWakeups++;
+
+            GetChild()->IssueCommand( powerupRequest );
+            rankPowerDown[rankId] = false;
+            powerUps++;
+
+            ncycle_t exitLatency = p->tXP;
+            if( rankPowerMode[rankId] == POWERDOWN_PDPS )
+                exitLatency = p->tXPDLL;
+            else if( rankPowerMode[rankId] == POWERDOWN_SREF )
+                exitLatency = p->tXSDLL;
+
+            wakeupPenalty += ( now - rankDemandSince[rankId] ) + exitLatency;
+
+            if( rankIdleStart[rankId] != never )
+            {
+                ncycle_t idleCycles = rankDemandSince[rankId] - rankIdleStart[rankId];
+
+                if( idleCycles < rankPowerDownThreshold[rankId] )
+                    powerDownMispredictions++;
+
+                UpdateIdlePrediction( rankId, idleCycles );
+            }
+
+            rankPowerMode[rankId] = POWERUP;
+            rankIdleStart[rankId] = never;
+            rankDemandSince[rankId] = never;
+
+            ScheduleCommandWake( );
+            continue;
+        }
+
+        if( demand )
+        {
+            /* The idle period ended before the rank was powered down. */
+            if( rankIdleStart[rankId] != never )
+            {
+                UpdateIdlePrediction( rankId, now - rankIdleStart[rankId] );
+                rankIdleStart[rankId] = never;
+            }
+
+            continue;
+        }
+
+        if( rankIdleStart[rankId] == never )
+            rankIdleStart[rankId] = now;
+
+        ncycle_t enterAt = now;
+        OpType pdOp = ChooseLowPowerMode( rankId, enterAt );
+
+        if( enterAt > now )
+        {
+            ScheduleLowPowerWake( enterAt );
+            continue;
+        }
+
+        NVMainRequest *powerdownRequest = MakePowerdownRequest( pdOp, rankId );
+
+        if( !GetChild()->IsIssuable( powerdownRequest ) )
+        {
+            delete powerdownRequest;
+            ScheduleLowPowerWake( now + 1 );
+            continue;
+        }
+
+        GetChild()->IssueCommand( powerdownRequest );
+        rankPowerDown[rankId] = true;
+        rankPowerMode[rankId] = pdOp;
+
+        if( pdOp == POWERDOWN_PDA )
+            activePowerDowns++;
+        else if( pdOp == POWERDOWN_PDPF )
+            fastExitPowerDowns++;
+        else if( pdOp == POWERDOWN_PDPS )
+            slowExitPowerDowns++;
+        else
+            selfRefreshes++;
+    }
+}
+
+bool MemoryController::RankHasDemand( const ncounter_t rankId )
+{
+    if( !RankQueueEmpty( rankId ) )
+        return true;
+
+    for( ncounter_t queueIdx = 0; queueIdx < transactionQueueCount; queueIdx++ )
+    {
+        std::list<NVMainRequest *>::iterator it;
+
+        for( it = transactionQueues[queueIdx].begin( );
+             it != transactionQueues[queueIdx].end( ); it++ )
+        {
+            if( (*it)->address.GetRank( ) == rankId )
+                return true;
+        }
+    }
+
+    if( p->UseRefresh )
+    {
+        for( ncounter_t groupIdx = 0; groupIdx < m_refreshBankNum; groupIdx++ )
+        {
+            if( NeedRefresh( groupIdx * p->BanksPerRefresh, rankId ) )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ *  The timeout policy always enters PowerDownMode after PowerDownTimeout idle
+ *  cycles. The predictive policy enters the deepest mode whose threshold the
+ *  predicted idle period covers right away, and falls back to the timeout.
+ */
+OpType MemoryController::ChooseLowPowerMode( const ncounter_t rankId, ncycle_t& enterAt )
+{
+    bool banksClosed = FindRank( rankId )->Idle( );
+
+    OpType shallowOp = ( p->PowerDownMode == "SLOWEXIT" ) ? POWERDOWN_PDPS : POWERDOWN_PDPF;
+    ncycle_t predicted = rankIdlePrediction[rankId];
+
+    enterAt = rankIdleStart[rankId] + p->PowerDownTimeout;
+    rankPowerDownThreshold[rankId] = 0;
+
+    if( p->lowPowerPolicy == LowPowerPolicy_Predictive )
+    {
+        shallowOp = POWERDOWN_PDPF;
+
+        if( banksClosed && p->UseRefresh && predicted >= p->SelfRefreshThreshold )
+        {
+            enterAt = rankIdleStart[rankId];
+            rankPowerDownThreshold[rankId] = p->SelfRefreshThreshold;
+            return POWERDOWN_SREF;
+        }
+        else if( banksClosed && predicted >= p->SlowExitThreshold )
+        {
+            enterAt = rankIdleStart[rankId];
+            rankPowerDownThreshold[rankId] = p->SlowExitThreshold;
+            return POWERDOWN_PDPS;
+        }
+        else if( predicted >= p->PowerDownTimeout )
+        {
+            enterAt = rankIdleStart[rankId];
+            rankPowerDownThreshold[rankId] = p->PowerDownTimeout;
+        }
+    }
+
+    /* Open banks can only use active power-down. */
+    return banksClosed ? shallowOp : POWERDOWN_PDA;
+}
+
+/* Exponential average of the observed idle periods. */
+void MemoryController::UpdateIdlePrediction( const ncounter_t rankId, const ncycle_t idleCycles )
+{
+    rankIdlePrediction[rankId] = ( rankIdlePrediction[rankId] + idleCycles ) / 2;
+}
+
+void MemoryController::ScheduleLowPowerWake( const ncycle_t wakeCycle )
+{
+    if( !GetEventQueue()->FindCallback( this, (CallbackPtr)&MemoryController::LowPowerCallback,
+                                        wakeCycle, NULL, lowPowerPriority ) )
+    {
+        GetEventQueue()->InsertCallback( this, (CallbackPtr)&MemoryController::LowPowerCallback,
+                                         wakeCycle, NULL, lowPowerPriority );
+    }
+}
+
+Config *MemoryController::GetConfig( )
+{
+    return (this->config);
+}
+
+void MemoryController::SetID( unsigned int id )
 {
     this->id = id;
 }
@@ -1071,7 +1849,7 @@ bool MemoryController::IsLastRequest( std::list<NVMainRequest *>& transactionQue
     {
         rv = false;
     }
-    else if( p->ClosePage == 1 )
+    else if( p->ClosePage == 1 || p->ClosePage == 3 )
     {
         ncounter_t mRank, mBank, mRow, mSubArray;
         request->address.GetTranslatedAddress( &mRow, NULL, &mBank, &mRank, NULL, &mSubArray );
@@ -1090,11 +1868,59 @@ bool MemoryController::IsLastRequest( std::list<NVMainRequest *>& transactionQue
                 break;
             }
         }
+
+        /* Adaptive: with no queued hit, keep the row open if a later hit is likely. */
+        if( rv && p->ClosePage == 3 )
+            rv = !PredictRowHit( mRank, mBank );
     }
 
     return rv;
 }
 
+bool MemoryController::PredictRowHit( const ncounter_t rank, const ncounter_t bank )
+{
+    return ( pagePatternTable[rank][bank][pageHistory[rank][bank]] >= 2 );
+}
+
+/*
+ *  The previous access to the bank left its row open or closed it. This
+ *  access tells whether that was right: a hit on a closed row was a
+ *  needless precharge, a conflict on an open row a missed one.
+ */
+void MemoryController::TrainPagePredictor( NVMainRequest *req )
+{
+    ncounter_t rank, bank, row, subarray;
+
+    req->address.GetTranslatedAddress( &row, NULL, &bank, &rank, NULL, &subarray );
+
+    if( lastPageRow[rank][bank] != p->ROWS )
+    {
+        bool hit = ( lastPageRow[rank][bank] == row 
+                     && lastPageSubArray[rank][bank] == subarray );
+        uint8_t& counter = pagePatternTable[rank][bank][pageHistory[rank][bank]];
+
+        pagePredictions++;
+
+        if( hit && lastPageClosed[rank][bank] )
+            mispredictedPrecharges++;
+        else if( !hit && !lastPageClosed[rank][bank] )
+            mispredictedOpenRows++;
+
+        if( hit && counter < 3 )
+            counter++;
+        else if( !hit && counter > 0 )
+            counter--;
+
+        pageHistory[rank][bank] = ( ( pageHistory[rank][bank] << 1 ) | ( hit ? 1 : 0 ) )
+                                & ( ( 1ULL << p->PagePredictorHistory ) - 1 );
+    }
+
+    lastPageRow[rank][bank] = row;
+    lastPageSubArray[rank][bank] = subarray;
+    lastPageClosed[rank][bank] = !activeSubArray[rank][bank][subarray] 
+                               || effectiveRow[rank][bank][subarray] != row;
+}
+
 bool MemoryController::FindStarvedRequest( std::list<NVMainRequest *>& transactionQueue, 
                                            NVMainRequest **starvedRequest )
 {
@@ -1502,12 +2328,16 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
              || effectiveMuxedRow[rank][bank][subarray] != muxLevel ) 
         {
             req->issueCycle = GetEventQueue()->GetCurrentCycle();
+            req->flags |= NVMainRequest::FLAG_CACHED;
 
             // Update starvation ??
             commandQueues[queueId].push_back( req );
 
             delete cachedRequest;
 
+            CompressRequest( req );
+            ScheduleCommandWake( );
+
             return true;
         }
         else
@@ -1575,13 +2405,49 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
                     MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
         }
 
+        /* The open row of another subarray is closed before the activate... */
+        if( p->subArrayParallelism == SubArrayParallelism_None
+            || p->subArrayParallelism == SubArrayParallelism_SALP1 )
+        {
+            CloseOtherSubArrays( queueId, req );
+        }
+
         NVMainRequest *actRequest = MakeActivateRequest( req );
         actRequest->flags |= (writingArray != NULL && writingArray->IsWriting( )) ? NVMainRequest::FLAG_PRIORITY : 0;
         commandQueues[queueId].push_back( actRequest );
-        commandQueues[queueId].push_back( req );
-        activeSubArray[rank][bank][subarray] = true;
-        effectiveRow[rank][bank][subarray] = row;
-        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
+
+        /* ...or, with SALP-2, right after it. */
+        if( p->subArrayParallelism == SubArrayParallelism_SALP2 )
+            CloseOtherSubArrays( queueId, req );
+
+        /* A row conflict may also be the last request to the new row. */
+        if( req->flags & NVMainRequest::FLAG_LAST_REQUEST && p->UsePrecharge )
+        {
+            commandQueues[queueId].push_back( MakeImplicitPrechargeRequest( req ) );
+            activeSubArray[rank][bank][subarray] = false;
+            effectiveRow[rank][bank][subarray] = p->ROWS;
+            effectiveMuxedRow[rank][bank][subarray] = p->ROWS;
+
+            bool idle = true;
+            for( ncounter_t i = 0; i < subArrayNum; i++ )
+            {
+                if( activeSubArray[rank][bank][i] == true )
+                {
+                    idle = false;
+                    break;
+                }
+            }
+
+            if( idle )
+                activateQueued[rank][bank] = false;
+        }
+        else
+        {
+            commandQueues[queueId].push_back( req );
+            activeSubArray[rank][bank][subarray] = true;
+            effectiveRow[rank][bank][subarray] = row;
+            effectiveMuxedRow[rank][bank][subarray] = muxLevel;
+        }
 
         rv = true;
     }
@@ -1639,15 +2505,153 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
     /* Schedule wake event for memory commands if not scheduled. */
     if( rv == true )
     {
+        /* Without precharges there is no open or close decision to learn. */
+        if( p->ClosePage == 3 && p->UsePrecharge )
+            TrainPagePredictor( req );
+
+        CompressRequest( req );
         ScheduleCommandWake( );
     }
 
     return rv;
 }
 
+/*
+ *  Without MASA a bank has one open row for column commands, so the rows
+ *  open in other subarrays are precharged before the new row is used.
+ */
+void MemoryController::CloseOtherSubArrays( const ncounter_t queueId, NVMainRequest *req )
+{
+    ncounter_t rank, bank, subarray;
+
+    req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, &subarray );
+
+    for( ncounter_t sa = 0; sa < subArrayNum; sa++ )
+    {
+        if( sa == subarray || !activeSubArray[rank][bank][sa] )
+            continue;
+
+        commandQueues[queueId].push_back( 
+                MakePrechargeRequest( effectiveRow[rank][bank][sa], 0, bank, rank, sa ) );
+
+        activeSubArray[rank][bank][sa] = false;
+        effectiveRow[rank][bank][sa] = p->ROWS;
+        effectiveMuxedRow[rank][bank][sa] = p->ROWS;
+    }
+}
+
+/*
+ *  MASA keeps several subarrays open, but only the designated one drives the
+ *  global bitlines. A column command to another subarray selects it first.
+ *  This is decided when the command reaches the head of its queue, as only
+ *  the issue order is known to match the bank.
+ */
+void MemoryController::QueueSubArraySelect( const ncounter_t queueId )
+{
+    NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+
+    if( ( queueHead->type != READ && queueHead->type != READ_PRECHARGE
+          && queueHead->type != WRITE && queueHead->type != WRITE_PRECHARGE )
+        || queueHead->flags & NVMainRequest::FLAG_CACHED )
+    {
+        return;
+    }
+
+    ncounter_t rank, bank, subarray;
+
+    queueHead->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, &subarray );
+
+    if( designatedSubArray[rank][bank] == subarray )
+        return;
+
+    NVMainRequest *selectRequest = new NVMainRequest( );
+
+    selectRequest->type = SUBARRAY_SELECT;
+    selectRequest->address = queueHead->address;
+    selectRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
+    selectRequest->owner = this;
+
+    commandQueues[queueId].push_front( selectRequest );
+}
+
+/*
+ *  Reads of lines in a DelayedWrite buffer are queued without an activate.
+ *  If the line was drained before the read reaches the head of its queue,
+ *  the read goes back to the transaction queue (like a cancelled write) and
+ *  is scheduled again with an activate. Returns true if it was requeued.
+ */
+bool MemoryController::RequeueDrainedRead( const ncounter_t queueId )
+{
+    NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+
+    if( queueHead->type != READ || !( queueHead->flags & NVMainRequest::FLAG_CACHED ) )
+        return false;
+
+    SubArray *readArray = FindChild( queueHead, SubArray );
+
+    /* Other cached banks (e.g., CachedDDR3Bank) have no write buffer. */
+    if( readArray == NULL || readArray->GetWriteBuffer( ) == NULL 
+        || readArray->IsBuffered( queueHead ) )
+    {
+        return false;
+    }
+
+    commandQueues[queueId].pop_front( );
+
+    queueHead->flags &= ~NVMainRequest::FLAG_CACHED;
+
+    /* Reads use the first transaction queue in every controller. */
+    Prequeue( 0, queueHead );
+
+    GetEventQueue( )->InsertEvent( EventCycle, this, GetEventQueue( )->GetCurrentCycle( ) + 1,
+                                   NULL, transactionQueuePriority );
+
+    return true;
+}
+
+/*
+ *  Called once per transaction after its commands are queued, before the
+ *  column command issues with the compressed burst count.
+ */
+void MemoryController::CompressRequest( NVMainRequest *req )
+{
+    if( compressor == NULL )
+        return;
+
+    ncycle_t delay = compressor->Compress( req );
+
+    if( delay > 0 )
+        decompressionDelays[req] = delay;
+}
+
+/*
+ *  Controllers that measure latency call this first, so that the read comes
+ *  back to them once it is decompressed. Returns true if it was delayed.
+ */
+bool MemoryController::DelayDecompression( NVMainRequest *req )
+{
+    std::map<NVMainRequest *, ncycle_t>::iterator it = decompressionDelays.find( req );
+
+    if( it == decompressionDelays.end( ) )
+        return false;
+
+    GetEventQueue( )->InsertEvent( EventResponse, this, req, 
+            GetEventQueue( )->GetCurrentCycle( ) + it->second );
+    decompressionDelays.erase( it );
+
+    return true;
+}
+
 void MemoryController::CycleCommandQueues( )
 {
-    //HandleLowPower( );
+    if( p->UseLowPower )
+    {
+        if( p->lowPowerPolicy == LowPowerPolicy_Greedy )
+            HandleLowPower( );
+        else if( p->lowPowerPolicy == LowPowerPolicy_Timeout 
+                 || p->lowPowerPolicy == LowPowerPolicy_Predictive )
+            ManageLowPower( );
+    }
 
     /* If a refresh event schedule for this cycle was handled, we are done. */
     if( handledRefresh == GetEventQueue()->GetCurrentCycle() )
@@ -1655,95 +2659,220 @@ void MemoryController::CycleCommandQueues( )
         return;
     }
 
-    for( ncounter_t queueIdx = 0; queueIdx < commandQueueCount; queueIdx++ )
+    /* No commands are issued while the DLL relocks after a frequency switch. */
+    if( relockUntil > GetEventQueue()->GetCurrentCycle() )
     {
-        /* 
-         * Requests are placed in queues in priority order, so we can simply
-         * iterator over all queues.
-         */
-        ncounter_t queueId = (curQueue + queueIdx) % commandQueueCount;
-        FailReason fail;
+        return;
+    }
 
-        if( !commandQueues[queueId].empty( )
-            && lastIssueCycle != GetEventQueue()->GetCurrentCycle()
-            && GetChild( )->IsIssuable( commandQueues[queueId].at( 0 ), &fail ) )
-        {
-            NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+    /* 
+     *  With bank groups, column commands to the group of the last column
+     *  command are tried only after every other queue (second pass).
+     */
+    ncounter_t passes = ( p->BankGroups > 1 ) ? 2 : 1;
+
+    /* 
+     *  One command can be issued per command bus each cycle. The queue order
+     *  is fixed for this cycle even if several commands are issued.
+     */
+    ncounter_t startQueue = curQueue;
+    ncounter_t issuedCommands = 0;
 
-            *debugStream << GetEventQueue()->GetCurrentCycle() << " MemoryController: Issued request type "
-                         << queueHead->type << " for address 0x" << std::hex 
-                         << queueHead->address.GetPhysicalAddress()
-                         << std::dec << " for queue " << queueId << std::endl;
+    for( ncounter_t pass = 0; pass < passes; pass++ )
+    {
+        for( ncounter_t queueIdx = 0; queueIdx < commandQueueCount; queueIdx++ )
+        {
+            /* 
+             * Requests are placed in queues in priority order, so we can simply
+             * iterator over all queues.
+             */
+            ncounter_t queueId = (startQueue + queueIdx) % commandQueueCount;
+            FailReason fail;
 
-            GetChild( )->IssueCommand( queueHead );
+            if( commandQueues[queueId].empty( ) )
+                continue;
 
-            queueHead->flags |= NVMainRequest::FLAG_ISSUED;
+            /* Already issued this cycle, waiting for cleanup. */
+            if( commandQueues[queueId].at( 0 )->flags & NVMainRequest::FLAG_ISSUED )
+                continue;
 
-            if( queueHead->type == REFRESH )
-                ResetRefreshQueued( queueHead->address.GetBank(),
-                                    queueHead->address.GetRank() );
+            if( passes > 1 
+                && ( pass == 0 ) == IsSameGroupColumn( commandQueues[queueId].at( 0 ) ) )
+            {
+                continue;
+            }
 
-            if( GetEventQueue( )->GetCurrentCycle( ) != lastIssueCycle )
-                lastIssueCycle = GetEventQueue( )->GetCurrentCycle( );
+            if( RequeueDrainedRead( queueId ) )
+                continue;
 
-            /* Get this cleaned this up. */
-            ncycle_t cleanupCycle = GetEventQueue()->GetCurrentCycle() + 1;
-            bool cleanupScheduled = GetEventQueue()->FindCallback( this, 
-                                        (CallbackPtr)&MemoryController::CleanupCallback,
-                                        cleanupCycle, NULL, cleanupPriority );
+            if( p->subArrayParallelism == SubArrayParallelism_MASA )
+                QueueSubArraySelect( queueId );
 
-            if( !cleanupScheduled )
-                GetEventQueue( )->InsertCallback( this, 
-                                  (CallbackPtr)&MemoryController::CleanupCallback,
-                                  cleanupCycle, NULL, cleanupPriority );
+            ncounter_t commandBus = GetCommandBus( commandQueues[queueId].at( 0 ) );
+            bool busFree = ( commandBusIssueCycle[commandBus] != GetEventQueue()->GetCurrentCycle() );
 
-            /* If the bank queue will be empty, we can issue another transaction, so wakeup the system. */
-            if( commandQueues[queueId].size( ) == 1 )
+            if( busFree && GetChild( )->IsIssuable( commandQueues[queueId].at( 0 ), &fail ) )
             {
-                /* If there is a transaction for this command queue, wake immediately. */
-                if( TransactionAvailable( queueId ) )
+                NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+
+                NVMDebug( DEBUG_TRACE ) << GetEventQueue()->GetCurrentCycle() 
+                    << " MemoryController: Issued request type " << queueHead->type 
+                    << " for address 0x" << std::hex 
+                    << queueHead->address.GetPhysicalAddress()
+                    << std::dec << " for queue " << queueId << std::endl;
+
+                GetChild( )->IssueCommand( queueHead );
+
+                queueHead->flags |= NVMainRequest::FLAG_ISSUED;
+
+                if( queueHead->type == READ || queueHead->type == READ_PRECHARGE
+                    || queueHead->type == WRITE || queueHead->type == WRITE_PRECHARGE )
                 {
-                    ncycle_t nextWakeup = GetEventQueue( )->GetCurrentCycle( ) + 1;
+                    lastColumnRank = queueHead->address.GetRank( );
+                    lastColumnGroup = queueHead->address.GetBank( ) % p->BankGroups;
 
-                    GetEventQueue( )->InsertEvent( EventCycle, this, nextWakeup, NULL, transactionQueuePriority );
+                    columnCommands++;
+                    dataBusCycles += p->BurstCycles( queueHead ) * queueHead->burstCount;
+                }
+                else
+                {
+                    rowCommands++;
                 }
-            }
 
-            MoveCurrentQueue( );
+                if( queueHead->type == ACTIVATE || queueHead->type == SUBARRAY_SELECT )
+                {
+                    designatedSubArray[queueHead->address.GetRank( )][queueHead->address.GetBank( )]
+                        = queueHead->address.GetSubArray( );
+                }
 
-            /* we should return since one time only one command can be issued */
-            return;
-        }
-        else if( !commandQueues[queueId].empty( ) )
-        {
-            NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+                if( queueHead->type == REFRESH )
+                {
+                    ResetRefreshQueued( queueHead->address.GetBank(),
+                                        queueHead->address.GetRank() );
+
+                    refreshSegmentEnd[queueHead->address.GetRank()]
+                        [queueHead->address.GetBank() / p->BanksPerRefresh] 
+                        = GetEventQueue()->GetCurrentCycle() + p->tRFC;
+                }
+                else if( p->UseRefresh )
+                {
+                    refreshGroupAccess[queueHead->address.GetRank()]
+                        [queueHead->address.GetBank() / p->BanksPerRefresh] 
+                        = GetEventQueue()->GetCurrentCycle();
+                }
+
+                if( GetEventQueue( )->GetCurrentCycle( ) != lastIssueCycle )
+                    lastIssueCycle = GetEventQueue( )->GetCurrentCycle( );
+
+                commandBusIssueCycle[commandBus] = GetEventQueue( )->GetCurrentCycle( );
+
+                /* Get this cleaned this up. */
+                ncycle_t cleanupCycle = GetEventQueue()->GetCurrentCycle() + 1;
+                bool cleanupScheduled = GetEventQueue()->FindCallback( this, 
+                                            (CallbackPtr)&MemoryController::CleanupCallback,
+                                            cleanupCycle, NULL, cleanupPriority );
+
+                if( !cleanupScheduled )
+                    GetEventQueue( )->InsertCallback( this, 
+                                      (CallbackPtr)&MemoryController::CleanupCallback,
+                                      cleanupCycle, NULL, cleanupPriority );
+
+                /* If the bank queue will be empty, we can issue another transaction, so wakeup the system. */
+                if( commandQueues[queueId].size( ) == 1 )
+                {
+                    /* If there is a transaction for this command queue, wake immediately. */
+                    if( TransactionAvailable( queueId ) )
+                    {
+                        ncycle_t nextWakeup = GetEventQueue( )->GetCurrentCycle( ) + 1;
+
+                        GetEventQueue( )->InsertEvent( EventCycle, this, nextWakeup, NULL, transactionQueuePriority );
+                    }
+                }
 
-            if( ( GetEventQueue()->GetCurrentCycle() - queueHead->issueCycle ) > p->DeadlockTimer )
+                MoveCurrentQueue( );
+
+                /* The last command to a bank group may allow a paused or postponed refresh. */
+                if( p->UseRefresh && ( p->ElasticRefresh || p->RefreshPausing ) )
+                    ScheduleCommandWake( );
+
+                /* Stop once every command bus has been used this cycle. */
+                if( ++issuedCommands == commandBusCount )
+                    return;
+            }
+            else
             {
-                ncounter_t row, col, bank, rank, channel, subarray;
-                queueHead->address.GetTranslatedAddress( &row, &col, &bank, &rank, &channel, &subarray );
-                std::cout << "NVMain Warning: Operation could not be sent to memory after a very long time: "
-                          << std::endl; 
-                std::cout << "         Address: 0x" << std::hex 
-                          << queueHead->address.GetPhysicalAddress( )
-                          << std::dec << " @ Bank " << bank << ", Rank " << rank << ", Channel " << channel
-                          << " Subarray " << subarray << " Row " << row << " Column " << col
-                          << ". Queued time: " << queueHead->arrivalCycle
-                          << ". Issue time: " << queueHead->issueCycle
-                          << ". Current time: " << GetEventQueue()->GetCurrentCycle() << ". Type: " 
-                          << queueHead->type << std::endl;
-
-                // Give the opportunity to attach a debugger here.
+                NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+
+                /* Count cycles where a ready command lost its command bus. */
+                if( !busFree && commandBusCount > 1 
+                    && lastConflictCycle != GetEventQueue()->GetCurrentCycle()
+                    && GetChild( )->IsIssuable( queueHead ) )
+                {
+                    commandBusConflicts++;
+                    lastConflictCycle = GetEventQueue()->GetCurrentCycle();
+                }
+
+                if( ( GetEventQueue()->GetCurrentCycle() - queueHead->issueCycle ) > p->DeadlockTimer )
+                {
+                    ncounter_t row, col, bank, rank, channel, subarray;
+                    queueHead->address.GetTranslatedAddress( &row, &col, &bank, &rank, &channel, &subarray );
+                    std::cout << "NVMain Warning: Operation could not be sent to memory after a very long time: "
+                              << std::endl; 
+                    std::cout << "         Address: 0x" << std::hex 
+                              << queueHead->address.GetPhysicalAddress( )
+                              << std::dec << " @ Bank " << bank << ", Rank " << rank << ", Channel " << channel
+                              << " Subarray " << subarray << " Row " << row << " Column " << col
+                              << ". Queued time: " << queueHead->arrivalCycle
+                              << ". Issue time: " << queueHead->issueCycle
+                              << ". Current time: " << GetEventQueue()->GetCurrentCycle() << ". Type: " 
+                              << queueHead->type << std::endl;
+
+                    // Give the opportunity to attach a debugger here.
 #ifndef NDEBUG
-                raise( SIGSTOP );
+                    raise( SIGSTOP );
 #endif
-                GetStats( )->PrintAll( std::cerr );
-                exit(1);
+                    GetStats( )->PrintAll( std::cerr );
+                    exit(1);
+                }
             }
         }
     }
 }
 
+/*
+ *  Returns the command bus used by a request. Sub-channels have their own
+ *  command buses; a split bus sends column commands on the second bus.
+ */
+ncounter_t MemoryController::GetCommandBus( NVMainRequest *request )
+{
+    ncounter_t commandBus = request->address.GetRank( ) % p->SubChannels;
+
+    if( p->SplitCommandBus )
+    {
+        commandBus *= 2;
+
+        if( request->type == READ || request->type == READ_PRECHARGE
+            || request->type == WRITE || request->type == WRITE_PRECHARGE )
+        {
+            commandBus++;
+        }
+    }
+
+    return commandBus;
+}
+
+bool MemoryController::IsSameGroupColumn( NVMainRequest *request )
+{
+    if( request->type != READ && request->type != READ_PRECHARGE
+        && request->type != WRITE && request->type != WRITE_PRECHARGE )
+    {
+        return false;
+    }
+
+    return ( request->address.GetRank( ) == lastColumnRank
+             && request->address.GetBank( ) % p->BankGroups == lastColumnGroup );
+}
+
 /*
  * Decode command queue in priority order
  *
@@ -1816,6 +2945,28 @@ ncycle_t MemoryController::NextIssuable( NVMainRequest * /*request*/ )
         }
     }
 
+    /* Paused and postponed refreshes are pulled in once their bank group is idle. */
+    if( p->UseRefresh && ( p->ElasticRefresh || p->RefreshPausing ) )
+    {
+        for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+        {
+            for( ncounter_t groupIdx = 0; groupIdx < m_refreshBankNum; groupIdx++ )
+            {
+                ncycle_t pullIn = RefreshPullInCycle( groupIdx * p->BanksPerRefresh, rankIdx );
+
+                if( pullIn > GetEventQueue()->GetCurrentCycle() )
+                    nextWakeup = MIN( nextWakeup, pullIn );
+                else if( lastIssueCycle != GetEventQueue()->GetCurrentCycle() )
+                    HandleRefresh( );
+                else
+                    nextWakeup = GetEventQueue()->GetCurrentCycle() + 1;
+            }
+        }
+    }
+
+    if( relockUntil > GetEventQueue( )->GetCurrentCycle( ) )
+        nextWakeup = MAX( nextWakeup, relockUntil );
+
     if( nextWakeup <= GetEventQueue( )->GetCurrentCycle( ) )
         nextWakeup = GetEventQueue( )->GetCurrentCycle( ) + 1;
 
@@ -1880,6 +3031,202 @@ void MemoryController::CalculateStats( )
 
     simulation_cycles = GetEventQueue()->GetCurrentCycle();
 
+    /* Flush the interval since the last trace line, e.g., at the end of the run. */
+    if( powerTrace.is_open( ) )
+        WritePowerTrace( );
+
+    /* Utilization is averaged over all command and data buses of the channel. */
+    if( simulation_cycles > 0 )
+    {
+        double subChannelCycles = static_cast<double>( simulation_cycles * p->SubChannels );
+        double dataBusTotal = static_cast<double>( simulation_cycles * p->SubChannels * p->PseudoChannels );
+
+        commandBusUtilization = static_cast<double>( rowCommands + columnCommands ) / subChannelCycles;
+        rowBusUtilization = static_cast<double>( rowCommands ) / subChannelCycles;
+        columnBusUtilization = static_cast<double>( columnCommands ) / subChannelCycles;
+        dataBusUtilization = static_cast<double>( dataBusCycles ) / dataBusTotal;
+    }
+
+    /* Residency in cycles at each operating point (MHz). */
+    std::map<ncounter_t, ncycle_t> residency = dvfsResidencyMap;
+    residency[static_cast<ncounter_t>( p->dvfsFrequencies[dvfsPoint] )] 
+        += simulation_cycles - dvfsPointStart;
+
+    double frequencyCycles = 0.0;
+    std::map<ncounter_t, ncycle_t>::iterator it;
+    for( it = residency.begin( ); it != residency.end( ); it++ )
+        frequencyCycles += static_cast<double>( it->first ) * static_cast<double>( it->second );
+
+    if( simulation_cycles > 0 )
+        averageFrequency = frequencyCycles / static_cast<double>( simulation_cycles );
+
+    dvfsResidencyHisto = PyDictHistogram<ncounter_t, ncycle_t>( residency );
+
+    if( pagePredictions > 0 )
+        pagePredictorAccuracy = 1.0 - static_cast<double>( mispredictedPrecharges 
+                                                         + mispredictedOpenRows )
+                                    / static_cast<double>( pagePredictions );
+
+    if( powerUps > 0 )
+        averageWakeupPenalty = static_cast<double>( wakeupPenalty ) 
+                             / static_cast<double>( powerUps );
+
+    if( refreshDelayedReads > 0 )
+        averageRefreshReadDelay = static_cast<double>( refreshReadDelay ) 
+                                / static_cast<double>( refreshDelayedReads );
+
+    /* Keyed by rank * BANKS + bank. */
+    refreshDelayedReadsHisto = PyDictHistogram<ncounter_t, ncounter_t>( refreshDelayedReadsMap );
+    refreshReadDelayHisto = PyDictHistogram<ncounter_t, ncycle_t>( refreshReadDelayMap );
+
     GetChild( )->CalculateStats( );
     GetDecoder( )->CalculateStats( );
+
+    if( compressor )
+        compressor->CalculateStats( );
+}
+
+/*
+ *  Checkpoint the controller's view of the row buffers and power state. Queued
+ *  requests belong to the simulator that issued them and cannot be restored,
+ *  so the memory should be drained before checkpointing.
+ */
+void MemoryController::CreateCheckpoint( std::string dir )
+{
+    /* Wrappers such as the DRAM cache controllers never set up bank state. */
+    if( effectiveRow == NULL )
+    {
+        NVMObject::CreateCheckpoint( dir );
+        return;
+    }
+
+    CheckpointWriter cpt( dir, StatName( ) );
+    ncounter_t refreshGroups = ( p->UseRefresh ? m_refreshBankNum : 0 );
+
+    if( cpt.IsOpen( ) )
+    {
+        ncounter_t queued = 0;
+
+        for( ncounter_t queueIdx = 0; queueIdx < transactionQueueCount; queueIdx++ )
+            queued += transactionQueues[queueIdx].size( );
+
+        for( ncounter_t queueIdx = 0; queueIdx < commandQueueCount; queueIdx++ )
+            queued += commandQueues[queueIdx].size( );
+
+        if( queued > 0 )
+        {
+            std::cout << StatName( ) << ": Warning: " << queued << " queued requests "
+                      << "are not checkpointed. Drain the memory first." << std::endl;
+        }
+
+        cpt.Write( p->RANKS );
+        cpt.Write( p->BANKS );
+        cpt.Write( subArrayNum );
+        cpt.Write( refreshGroups );
+
+        for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+        {
+            cpt.Write( rankPowerDown[rankIdx] );
+
+            for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+            {
+                cpt.Write( activateQueued[rankIdx][bankIdx] );
+
+                for( ncounter_t saIdx = 0; saIdx < subArrayNum; saIdx++ )
+                {
+                    cpt.Write( effectiveRow[rankIdx][bankIdx][saIdx] );
+                    cpt.Write( effectiveMuxedRow[rankIdx][bankIdx][saIdx] );
+                    cpt.Write( activeSubArray[rankIdx][bankIdx][saIdx] );
+                }
+            }
+        }
+
+        /* Refreshes owed to each bank group, so none are lost on restore. */
+        for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+        {
+            for( ncounter_t groupIdx = 0; groupIdx < refreshGroups; groupIdx++ )
+                cpt.Write( delayedRefreshCounter[rankIdx][groupIdx] );
+
+            for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+                cpt.Write( bankNeedRefresh[rankIdx][bankIdx] );
+        }
+
+        if( compressor )
+            compressor->WriteCheckpoint( cpt );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void MemoryController::RestoreCheckpoint( std::string dir )
+{
+    if( effectiveRow == NULL )
+    {
+        NVMObject::RestoreCheckpoint( dir );
+        return;
+    }
+
+    CheckpointReader cpt( dir, StatName( ) );
+    ncounter_t refreshGroups = ( p->UseRefresh ? m_refreshBankNum : 0 );
+
+    if( cpt.IsOpen( ) )
+    {
+        ncounter_t ranks = 0, banks = 0, subArrays = 0, groups = 0;
+
+        cpt.Read( ranks );
+        cpt.Read( banks );
+        cpt.Read( subArrays );
+        cpt.Read( groups );
+
+        if( ranks != p->RANKS || banks != p->BANKS || subArrays != subArrayNum )
+        {
+            std::cout << StatName( ) << ": Warning: Checkpoint geometry differs from "
+                      << "the memory configuration. Skipping restore." << std::endl;
+        }
+        else if( groups != refreshGroups )
+        {
+            std::cout << StatName( ) << ": Warning: Checkpoint refresh groups (" << groups
+                      << ") differ from the memory configuration (" << refreshGroups 
+                      << "). Skipping restore." << std::endl;
+        }
+        else
+        {
+            for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+            {
+                cpt.Read( rankPowerDown[rankIdx] );
+
+                for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+                {
+                    cpt.Read( activateQueued[rankIdx][bankIdx] );
+
+                    for( ncounter_t saIdx = 0; saIdx < subArrayNum; saIdx++ )
+                    {
+                        cpt.Read( effectiveRow[rankIdx][bankIdx][saIdx] );
+                        cpt.Read( effectiveMuxedRow[rankIdx][bankIdx][saIdx] );
+                        cpt.Read( activeSubArray[rankIdx][bankIdx][saIdx] );
+                    }
+                }
+            }
+
+            for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+            {
+                for( ncounter_t groupIdx = 0; groupIdx < refreshGroups; groupIdx++ )
+                    cpt.Read( delayedRefreshCounter[rankIdx][groupIdx] );
+
+                for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+                    cpt.Read( bankNeedRefresh[rankIdx][bankIdx] );
+            }
+
+            if( compressor )
+                compressor->ReadCheckpoint( cpt );
+
+            if( !cpt.Good( ) )
+            {
+                std::cout << StatName( ) << ": Warning: Checkpoint is incomplete." 
+                          << std::endl;
+            }
+        }
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
 }
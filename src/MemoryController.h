@@ -44,12 +44,16 @@
 #include "src/AddressTranslator.h"
 #include "include/NVMainRequest.h"
 #include <deque>
+#include <fstream>
 #include <iostream>
 #include <list>
+#include <map>
 
 
 namespace NVM {
 
+class Compressor;
+class Rank;
 
 enum ProcessorOp { LOAD, STORE };
 enum QueueModel { PerRankQueues, PerBankQueues, PerSubArrayQueues };
@@ -114,9 +118,16 @@ class MemoryController : public NVMObject
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+
     void CommandQueueCallback( void *data );
     void CleanupCallback( void *data );
     void RefreshCallback( void *data );
+    void LowPowerCallback( void *data );
+    void PowerTraceCallback( void *data );
+    void WritePowerTrace( );
+    void DVFSCallback( void *data );
     virtual void Cycle( ncycle_t steps ); 
 
     virtual void SetConfig( Config *conf, bool createChildren = true );
@@ -192,7 +203,22 @@ class MemoryController : public NVMObject
 
 
     bool IssueMemoryCommands( NVMainRequest *req );
+    void CompressRequest( NVMainRequest *req );
+    bool DelayDecompression( NVMainRequest *req );
     void CycleCommandQueues( );
+    bool IsSameGroupColumn( NVMainRequest *request );
+    ncounter_t GetCommandBus( NVMainRequest *request );
+
+    /* Rank and bank group of the last column command, for bank group interleaving. */
+    ncounter_t lastColumnRank, lastColumnGroup;
+
+    /* 
+     *  Command buses of the channel (one per sub-channel, two with separate
+     *  row and column buses) and the last cycle each one was used.
+     */
+    ncounter_t commandBusCount;
+    std::vector<ncycle_t> commandBusIssueCycle;
+    ncycle_t lastConflictCycle;
 
     bool FindStarvedRequest( std::list<NVMainRequest *>& transactionQueue, NVMainRequest **starvedRequest, NVM::SchedulingPredicate& p );
     bool FindCachedAddress( std::list<NVMainRequest *>& transactionQueue, NVMainRequest **accessibleRequest, NVM::SchedulingPredicate& p );
@@ -207,6 +233,26 @@ class MemoryController : public NVMObject
 
     /* IsLastRequest() tells whether no other request has the row buffer hit in the transaction queue */
     virtual bool IsLastRequest( std::list<NVMainRequest *>& transactionQueue, NVMainRequest *request); 
+
+    /* adaptive page policy: predict whether the next access to a bank hits its open row */
+    bool PredictRowHit( const ncounter_t rank, const ncounter_t bank );
+    /* train on the outcome of the previous access to the bank of req */
+    void TrainPagePredictor( NVMainRequest *req );
+
+    /* per bank hit history, 2-bit counters indexed by it and the last access */
+    std::vector< std::vector<ncounter_t> > pageHistory;
+    std::vector< std::vector< std::vector<uint8_t> > > pagePatternTable;
+    std::vector< std::vector<ncounter_t> > lastPageRow, lastPageSubArray;
+    std::vector< std::vector<bool> > lastPageClosed;
+
+    /* SALP: close the other open subarrays of a bank (one open row) */
+    void CloseOtherSubArrays( const ncounter_t queueId, NVMainRequest *req );
+    /* MASA: select the subarray of the column command at the queue head */
+    void QueueSubArraySelect( const ncounter_t queueId );
+    /* DelayedWrite: reschedule a forwarded read whose line was drained */
+    bool RequeueDrainedRead( const ncounter_t queueId );
+    /* subarray connected to the global bitlines of each bank, as issued */
+    std::vector< std::vector<ncounter_t> > designatedSubArray;
     /* curQueue records the starting index for queue round-robin level scheduling */
     ncounter_t curQueue;
     /* MoveCurrentQueue() increment curQueue */
@@ -246,6 +292,21 @@ class MemoryController : public NVMObject
     ncounter_t nextRefreshRank, nextRefreshBank; 
     /* issue REFRESH command if necessary; otherwise do nothing */
     virtual bool HandleRefresh( ); 
+    /* queue the REFRESH (and PRECHARGE_ALL) commands for a given bank group */
+    void QueueRefresh( const ncounter_t bank, const ncounter_t rank );
+    /* return true if the bank group has a pending refresh that can be queued now */
+    bool IsRefreshReady( const ncounter_t bank, const ncounter_t rank );
+    /* return true if the bank group has no queued commands or (read) transactions */
+    bool IsRefreshBankIdle( const ncounter_t bank, const ncounter_t rank, bool readsOnly );
+    /* the cycle a paused or postponed refresh of the bank group may be pulled in */
+    ncycle_t RefreshPullInCycle( const ncounter_t bank, const ncounter_t rank );
+
+    /* end of the last refresh (segment) and last access of each refresh bank group */
+    std::vector< std::vector<ncycle_t> > refreshSegmentEnd;
+    std::vector< std::vector<ncycle_t> > refreshGroupAccess;
+    std::vector< std::vector<bool> > refreshPaused;
+    /* arrival cycle of reads that found their bank refreshing */
+    std::map<NVMainRequest *, ncycle_t> refreshBlockedReads;
 
     /* check whether any all command queues in the rank are empty */
     bool RankQueueEmpty( const ncounter_t& );
@@ -254,6 +315,43 @@ class MemoryController : public NVMObject
     void PowerUp( const ncounter_t& );
     virtual void HandleLowPower( );
 
+    /* event-driven power-down management for the Timeout/Predictive policies */
+    void ManageLowPower( );
+    /* return true if the rank has queued commands, transactions or a due refresh */
+    bool RankHasDemand( const ncounter_t rankId );
+    /* the power-down mode to enter and the earliest cycle to enter it */
+    OpType ChooseLowPowerMode( const ncounter_t rankId, ncycle_t& enterAt );
+    void UpdateIdlePrediction( const ncounter_t rankId, const ncycle_t idleCycles );
+    void ScheduleLowPowerWake( const ncycle_t wakeCycle );
+
+    /* the rank module of the given rank, behind any hooks */
+    Rank *FindRank( const ncounter_t rankId );
+
+    /* per-interval power of each rank and the channel */
+    std::ofstream powerTrace;
+    ncycle_t lastPowerTrace;
+    std::vector< std::vector<double> > powerTraceEnergy;
+    double IntervalPower( const double energy, const ncycle_t cycles );
+
+    /* MemDVFS: pick the operating point for the next epoch */
+    virtual ncounter_t SelectOperatingPoint( double utilization );
+    void SetOperatingPoint( const ncounter_t point );
+    void RetimeModule( NVMObject *module, const double frequency );
+
+    ncounter_t dvfsPoint;
+    ncycle_t dvfsPointStart;
+    ncycle_t relockUntil;
+    ncounter_t dvfsEpochDataBusCycles;
+    std::map<ncounter_t, ncycle_t> dvfsResidencyMap;
+
+    /* per rank power-down mode, idle period start and first demand while powered down */
+    std::vector<OpType> rankPowerMode;
+    std::vector<ncycle_t> rankIdleStart;
+    std::vector<ncycle_t> rankDemandSince;
+    /* predicted idle period and the idle period the current mode needs to pay off */
+    std::vector<ncycle_t> rankIdlePrediction;
+    std::vector<ncycle_t> rankPowerDownThreshold;
+
     /* Check if a command queue is empty or will be cleaned up. */
     bool EffectivelyEmpty( const ncounter_t& );
     
@@ -265,8 +363,39 @@ class MemoryController : public NVMObject
 
     ncounter_t id;
 
+    /* Optional line compression and the extra latency of compressed reads. */
+    Compressor *compressor;
+    std::map<NVMainRequest *, ncycle_t> decompressionDelays;
+
     /* Stats */
     ncounter_t simulation_cycles;
+    ncounter_t rowCommands, columnCommands;
+    ncounter_t dataBusCycles;
+    ncounter_t commandBusConflicts;
+    double commandBusUtilization;
+    double rowBusUtilization, columnBusUtilization;
+    double dataBusUtilization;
+
+    ncounter_t outOfOrderRefreshes, elasticRefreshes, refreshPauses;
+    ncounter_t refreshDelayedReads;
+    ncycle_t refreshReadDelay;
+    double averageRefreshReadDelay;
+    std::map<ncounter_t, ncounter_t> refreshDelayedReadsMap;
+    std::map<ncounter_t, ncycle_t> refreshReadDelayMap;
+    std::string refreshDelayedReadsHisto, refreshReadDelayHisto;
+
+    ncounter_t activePowerDowns, fastExitPowerDowns, slowExitPowerDowns, selfRefreshes;
+    ncounter_t powerUps, proactiveWakeups, powerDownMispredictions;
+    ncycle_t wakeupPenalty;
+    double averageWakeupPenalty;
+
+    ncounter_t pagePredictions, mispredictedPrecharges, mispredictedOpenRows;
+    double pagePredictorAccuracy;
+
+    ncounter_t dvfsSwitches;
+    ncycle_t dvfsRelockCycles;
+    double averageFrequency;
+    std::string dvfsResidencyHisto;
 };
 
 };
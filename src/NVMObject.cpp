@@ -275,7 +275,8 @@ NVMObject::NVMObject( )
     eventQueue = NULL;
     hookType = NVMHOOK_NONE;
     hooks = new std::vector<NVMObject *> [NVMHOOK_COUNT];
-    debugStream = NULL;
+    debugStream = &nvmainDebugInhibitor;
+    debugLevel = DEBUG_NONE;
     tagGen = NULL;
 }
 
@@ -694,22 +695,26 @@ std::vector<NVMObject *>& NVMObject::GetHooks( HookType h )
 
 void NVMObject::SetDebugName( std::string dn, Config *config )
 {
-    Params *params = new Params( );
-    params->SetParams( config );
-
     /* Debugging a parent will add debug prints for all children. */
     if( debugStream == config->GetDebugLog( ) || debugStream == &std::cerr )
         return;
 
+    Params *params = new Params( );
+    params->SetParams( config );
+
     /* Note: This should be called from SetConfig to ensure config was read! */
     if( params->debugOn && params->debugClasses.count( dn ) )
     {
         debugStream = config->GetDebugLog( );
+        debugLevel = params->debugLevel;
     }
     else
     {
         debugStream = &nvmainDebugInhibitor;
+        debugLevel = DEBUG_NONE;
     }
+
+    delete params;
 }
 
 ncycle_t NVMObject::MAX( const ncycle_t a, const ncycle_t b )
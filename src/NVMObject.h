@@ -41,6 +41,7 @@
 #include "Decoders/DecoderFactory.h"
 #include "src/Stats.h"
 #include "src/TagGenerator.h"
+#include "src/Debug.h"
 
 #include <ostream>
 #include <vector>
@@ -235,6 +236,7 @@ class NVMObject
     EventQueue *eventQueue;
     GlobalEventQueue *globalEventQueue;
     std::ostream *debugStream;
+    DebugLevel debugLevel;
     TagGenerator *tagGen;
     HookType hookType, currentHookType;
 
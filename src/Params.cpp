@@ -35,6 +35,7 @@
 
 #include "src/Params.h"
 #include "include/NVMHelpers.h"
+#include "include/NVMainRequest.h"
 
 #include <cmath>
 #include <cstdlib>
@@ -75,6 +76,7 @@ Params::Params( )
     Epda = 0.000000;
     Epdpf = 0.000000;
     Epdps = 0.000000;
+    Esref = 0.000000;
     Voltage = 1.5;
 
     /* 
@@ -103,10 +105,16 @@ Params::Params( )
     EnduranceModel = "NullModel";
     DataEncoder = "default";
     EnergyModel = "current";
+    energyModel = EnergyModel_Current;
 
     UseLowPower = true;
     PowerDownMode = "FASTEXIT";
     InitPD = false;
+    LowPowerPolicy = "None";
+    lowPowerPolicy = LowPowerPolicy_None;
+    PowerDownTimeout = 100;
+    SlowExitThreshold = 0;
+    SelfRefreshThreshold = 0;
 
     PrintGraphs = false;
     PrintAllDevices = false;
@@ -123,6 +131,8 @@ Params::Params( )
     OffChipLatency = 10;
 
     PeriodicStatsInterval = 0;
+    PowerTraceInterval = 0;
+    PowerTraceFile = "nvmain.power";
 
     ROWS = 65536;
     COLS = 32;
@@ -130,6 +140,9 @@ Params::Params( )
     RANKS = 2;
     BANKS = 8;
     RAW = 4;
+    BankGroups = 1;
+    SubChannels = 1;
+    PseudoChannels = 1;
     MATHeight = ROWS;
     RBSize = COLS;
 
@@ -137,6 +150,7 @@ Params::Params( )
     tBURST = 4;
     tCAS = 10;
     tCCD = 4;
+    tCCD_L = 4;
     tCMD = 1;
     tCWD = 7;
     tRAW = 20;
@@ -150,12 +164,14 @@ Params::Params( )
     tRP = 9;
     tRRDR = 5;
     tRRDW = 5;
+    tRRD_L = 5;
     tPPD = 0;
     tRTP = 5;
     tRTRS = 1;
     tWP = 0;
     tWR = 10;
     tWTR = 5;
+    tWTR_L = 5;
     tXP = 6;
     tXPDLL = 17;
     tXS = 5;
@@ -165,11 +181,24 @@ Params::Params( )
     tWRPDEN = 19;
     tWRAPDEN = 22;
     ClosePage = 1;
+    PagePredictorHistory = 4;
+    SubArrayParallelism = "Ideal";
+    subArrayParallelism = SubArrayParallelism_Ideal;
+    tSA = 1;
     ScheduleScheme = 1;
     HighWaterMark = 32;
     LowWaterMark = 16;
     BanksPerRefresh = BANKS;
+    SameBankRefresh = false;
+    SplitCommandBus = false;
     DelayedRefreshThreshold = 1;
+    PerBankRefresh = false;
+    OutOfOrderRefresh = false;
+    ElasticRefresh = false;
+    ElasticRefreshIdle = 0;
+    RefreshPausing = false;
+    RefreshPauseSegments = 4;
+    NonVolatile = false;
     AddressMappingScheme = "R:SA:RK:BK:CH:C";
 
     MemoryPrefetcher = "none";
@@ -177,6 +206,7 @@ Params::Params( )
 
     programMode = ProgramMode_SRMS;
     MLCLevels = 1;
+    cellType = CellType_SLC;
     WPVariance = 1;
     UniformWrites = true; // Disable MLC by default
     WriteAllBits = true;
@@ -198,10 +228,27 @@ Params::Params( )
     MaxCancellations = 4;
     pauseMode = PauseMode_Normal;
 
+    WriteBufferScope = "SubArray";
+    writeBufferScope = WriteBufferScope_SubArray;
+    WriteBufferEntries = 8;
+    WriteBufferHighWater = 6;
+    WriteBufferIdleDelay = 16;
+
     DeadlockTimer = 10000000;
 
     debugOn = false;
     debugClasses.clear();
+    debugLevel = DEBUG_TRACE;
+
+    DVFSPolicy = "None";
+    dvfsPolicy = DVFSPolicy_None;
+    DVFSEpoch = 10000;
+    DVFSUpThreshold = 0.5;
+    DVFSDownThreshold = 0.2;
+    DVFSRelockLatency = 0;
+    DVFSStaticCurrent = 0.5;
+    operatingFrequency = static_cast<double>( CLK );
+    SaveNominalOperatingPoint( );
 }
 
 Params::~Params( )
@@ -280,6 +327,8 @@ void Params::SetParams( Config *c )
     c->GetEnergy( "Epda", Epda );
     c->GetEnergy( "Epdpf", Epdpf );
     c->GetEnergy( "Epdps", Epdps );
+    if( c->KeyExists( "Esref" ) )
+        c->GetEnergy( "Esref", Esref );
     c->GetEnergy( "Voltage", Voltage );
 
     c->GetValue( "Rtt_nom", Rtt_nom );
@@ -293,6 +342,7 @@ void Params::SetParams( Config *c )
     c->GetString( "EnduranceModel", EnduranceModel );
     c->GetString( "DataEncoder", DataEncoder );
     c->GetString( "EnergyModel", EnergyModel );
+    energyModel = ( EnergyModel == "current" ) ? EnergyModel_Current : EnergyModel_Energy;
 
     c->GetBool( "UseLowPower", UseLowPower );
     c->GetString( "PowerDownMode", PowerDownMode );
@@ -314,6 +364,11 @@ void Params::SetParams( Config *c )
 
     c->GetValueUL( "PeriodicStatsInterval", PeriodicStatsInterval );
 
+    if( c->KeyExists( "PowerTraceInterval" ) )
+        PowerTraceInterval = c->GetValueUL( "PowerTraceInterval" );
+    if( c->KeyExists( "PowerTraceFile" ) )
+        PowerTraceFile = c->GetString( "PowerTraceFile" );
+
     c->GetValueUL( "ROWS", ROWS );
     c->GetValueUL( "COLS", COLS );
     c->GetValueUL( "CHANNELS", CHANNELS );
@@ -351,15 +406,158 @@ void Params::SetParams( Config *c )
     ConvertTiming( c, "tXS", tXS );
     ConvertTiming( c, "tXSDLL", tXSDLL );
 
+    /* 
+     *  Timings between banks of the same bank group (DDR4/DDR5). Without
+     *  bank groups they are the plain tCCD, tRRDR and tWTR.
+     */
+    if( c->KeyExists( "BankGroups" ) )
+        BankGroups = c->GetValueUL( "BankGroups" );
+
+    if( c->KeyExists( "SubChannels" ) )
+        SubChannels = c->GetValueUL( "SubChannels" );
+
+    /* HBM pseudo-channels have their own data bus but share the command bus. */
+    if( c->KeyExists( "PseudoChannels" ) )
+        PseudoChannels = c->GetValueUL( "PseudoChannels" );
+
+    if( c->KeyExists( "SplitCommandBus" ) )
+        SplitCommandBus = c->GetBool( "SplitCommandBus" );
+
+    tCCD_L = tCCD;
+    tRRD_L = tRRDR;
+    tWTR_L = tWTR;
+    ConvertTiming( c, "tCCD_L", tCCD_L );
+    ConvertTiming( c, "tRRD_L", tRRD_L );
+    ConvertTiming( c, "tWTR_L", tWTR_L );
+
     c->GetValueUL( "tRDPDEN", tRDPDEN );
     c->GetValueUL( "tWRPDEN", tWRPDEN );
     c->GetValueUL( "tWRAPDEN", tWRAPDEN );
     c->GetValueUL( "ClosePage", ClosePage );
+    if( c->KeyExists( "PagePredictorHistory" ) )
+        PagePredictorHistory = c->GetValueUL( "PagePredictorHistory" );
+
+    if( PagePredictorHistory > 16 )
+    {
+        std::cerr << "NVMain Error: PagePredictorHistory must be at most 16 bits, got "
+                  << PagePredictorHistory << std::endl;
+        exit(1);
+    }
+
+    if( c->KeyExists( "SubArrayParallelism" ) )
+    {
+        SubArrayParallelism = c->GetString( "SubArrayParallelism" );
+
+        if( SubArrayParallelism == "Ideal" )
+            subArrayParallelism = SubArrayParallelism_Ideal;
+        else if( SubArrayParallelism == "None" )
+            subArrayParallelism = SubArrayParallelism_None;
+        else if( SubArrayParallelism == "SALP1" )
+            subArrayParallelism = SubArrayParallelism_SALP1;
+        else if( SubArrayParallelism == "SALP2" )
+            subArrayParallelism = SubArrayParallelism_SALP2;
+        else if( SubArrayParallelism == "MASA" )
+            subArrayParallelism = SubArrayParallelism_MASA;
+        else
+            std::cout << "Unknown SubArrayParallelism: " << SubArrayParallelism
+                      << ". Defaulting to Ideal" << std::endl;
+    }
+
+    ConvertTiming( c, "tSA", tSA );
+
+    if( subArrayParallelism != SubArrayParallelism_Ideal && !UsePrecharge )
+    {
+        std::cerr << "NVMain Error: SubArrayParallelism " << SubArrayParallelism
+                  << " needs UsePrecharge." << std::endl;
+        exit(1);
+    }
     c->GetValue( "ScheduleScheme", ScheduleScheme );
     c->GetValue( "HighWaterMark", HighWaterMark );
     c->GetValue( "LowWaterMark", LowWaterMark );
     c->GetValueUL( "BanksPerRefresh", BanksPerRefresh );
+
+    /* Bank groups are bank % BankGroups, so REFsb refreshes BankGroups consecutive banks. */
+    if( c->KeyExists( "SameBankRefresh" ) )
+        SameBankRefresh = c->GetBool( "SameBankRefresh" );
+
+    if( SameBankRefresh )
+    {
+        BanksPerRefresh = BankGroups;
+        ConvertTiming( c, "tRFCsb", tRFC );
+    }
     c->GetValueUL( "DelayedRefreshThreshold", DelayedRefreshThreshold );
+
+    if( c->KeyExists( "PerBankRefresh" ) )
+        PerBankRefresh = c->GetBool( "PerBankRefresh" );
+
+    if( PerBankRefresh )
+    {
+        BanksPerRefresh = 1;
+        ConvertTiming( c, "tRFCpb", tRFC );
+    }
+
+    if( c->KeyExists( "OutOfOrderRefresh" ) )
+        OutOfOrderRefresh = c->GetBool( "OutOfOrderRefresh" );
+
+    if( c->KeyExists( "ElasticRefresh" ) )
+        ElasticRefresh = c->GetBool( "ElasticRefresh" );
+
+    ElasticRefreshIdle = tRFC;
+    ConvertTiming( c, "ElasticRefreshIdle", ElasticRefreshIdle );
+
+    if( c->KeyExists( "RefreshPausing" ) )
+        RefreshPausing = c->GetBool( "RefreshPausing" );
+
+    if( c->KeyExists( "RefreshPauseSegments" ) )
+        RefreshPauseSegments = c->GetValueUL( "RefreshPauseSegments" );
+
+    /* 
+     *  A pausable refresh is issued as RefreshPauseSegments shorter refreshes,
+     *  so the devices see the time and energy of a single segment.
+     */
+    if( RefreshPausing && RefreshPauseSegments > 1 )
+    {
+        tRFC = ( tRFC + RefreshPauseSegments - 1 ) / RefreshPauseSegments;
+        Eref /= static_cast<double>( RefreshPauseSegments );
+    }
+    else
+    {
+        RefreshPausing = false;
+        RefreshPauseSegments = 1;
+    }
+
+    /* Hybrid channels may inherit UseRefresh from the DRAM configuration. */
+    if( c->KeyExists( "NonVolatile" ) )
+        NonVolatile = c->GetBool( "NonVolatile" );
+
+    if( NonVolatile )
+        UseRefresh = false;
+
+    if( c->KeyExists( "LowPowerPolicy" ) )
+    {
+        LowPowerPolicy = c->GetString( "LowPowerPolicy" );
+
+        if( LowPowerPolicy == "None" )
+            lowPowerPolicy = LowPowerPolicy_None;
+        else if( LowPowerPolicy == "Greedy" )
+            lowPowerPolicy = LowPowerPolicy_Greedy;
+        else if( LowPowerPolicy == "Timeout" )
+            lowPowerPolicy = LowPowerPolicy_Timeout;
+        else if( LowPowerPolicy == "Predictive" )
+            lowPowerPolicy = LowPowerPolicy_Predictive;
+        else
+            std::cout << "Unknown LowPowerPolicy: " << LowPowerPolicy
+                      << ". Defaulting to None" << std::endl;
+    }
+
+    ConvertTiming( c, "PowerDownTimeout", PowerDownTimeout );
+
+    /* Entering a deeper mode only pays off if the idle period covers its exit. */
+    SlowExitThreshold = 10 * tXPDLL;
+    ConvertTiming( c, "SlowExitThreshold", SlowExitThreshold );
+
+    SelfRefreshThreshold = 10 * tXSDLL;
+    ConvertTiming( c, "SelfRefreshThreshold", SelfRefreshThreshold );
     c->GetString( "AddressMappingScheme", AddressMappingScheme );
 
     c->GetString( "MemoryPrefetcher", MemoryPrefetcher );
@@ -376,6 +574,12 @@ void Params::SetParams( Config *c )
                       << ". Defaulting to SRMS" << std::endl;
     }
     c->GetValueUL( "MLCLevels", MLCLevels );
+    if( MLCLevels == 1 )
+        cellType = CellType_SLC;
+    else if( MLCLevels == 2 )
+        cellType = CellType_MLC2;
+    else
+        cellType = CellType_Other;
     c->GetValueUL( "WPVariance",  WPVariance );
     c->GetBool( "UniformWrites", UniformWrites );
     c->GetBool( "WriteAllBits", WriteAllBits );
@@ -409,6 +613,9 @@ void Params::SetParams( Config *c )
         }
     }
 
+    if( c->KeyExists( "DebugLevel" ) )
+        debugLevel = ParseDebugLevel( c->GetString( "DebugLevel" ) );
+
     c->GetBool( "WritePausing", WritePausing );
     c->GetEnergy( "PauseThreshold", PauseThreshold );
     c->GetValueUL( "MaxCancellations", MaxCancellations );
@@ -424,5 +631,156 @@ void Params::SetParams( Config *c )
             std::cout << "Unknown PauseMode: " << c->GetString( "PauseMode" )
                       << ". Defaulting to Normal" << std::endl;
     }
+
+    if( c->KeyExists( "WriteBufferScope" ) )
+    {
+        WriteBufferScope = c->GetString( "WriteBufferScope" );
+
+        if( WriteBufferScope == "SubArray" )
+            writeBufferScope = WriteBufferScope_SubArray;
+        else if( WriteBufferScope == "Bank" )
+            writeBufferScope = WriteBufferScope_Bank;
+        else
+            std::cout << "Unknown WriteBufferScope: " << WriteBufferScope
+                      << ". Defaulting to SubArray" << std::endl;
+    }
+
+    if( c->KeyExists( "WriteBufferEntries" ) )
+        WriteBufferEntries = c->GetValueUL( "WriteBufferEntries" );
+
+    /* Force drains once three quarters of the buffer are used. */
+    WriteBufferHighWater = ( WriteBufferEntries * 3 + 3 ) / 4;
+    if( c->KeyExists( "WriteBufferHighWater" ) )
+        WriteBufferHighWater = c->GetValueUL( "WriteBufferHighWater" );
+
+    ConvertTiming( c, "WriteBufferIdleDelay", WriteBufferIdleDelay );
+
+    if( WriteBufferEntries == 0 || WriteBufferHighWater > WriteBufferEntries )
+    {
+        std::cerr << "NVMain Error: WriteBufferEntries must be non-zero and at least "
+                  << "WriteBufferHighWater." << std::endl;
+        exit(1);
+    }
+
+    if( c->KeyExists( "DVFSPolicy" ) )
+    {
+        DVFSPolicy = c->GetString( "DVFSPolicy" );
+
+        if( DVFSPolicy == "None" )
+            dvfsPolicy = DVFSPolicy_None;
+        else if( DVFSPolicy == "Utilization" )
+            dvfsPolicy = DVFSPolicy_Utilization;
+        else
+            std::cout << "Unknown DVFSPolicy: " << DVFSPolicy
+                      << ". Defaulting to None" << std::endl;
+    }
+
+    /* Operating points below CLK, highest first. */
+    dvfsFrequencies.clear( );
+    dvfsFrequencies.push_back( static_cast<double>( CLK ) );
+
+    if( c->KeyExists( "DVFSFrequencies" ) )
+    {
+        std::istringstream frequencyStream( c->GetString( "DVFSFrequencies" ) );
+        std::string frequency;
+
+        while( std::getline( frequencyStream, frequency, ',' ) )
+        {
+            double mhz = atof( frequency.c_str( ) );
+
+            if( mhz <= 0.0 || mhz > static_cast<double>( CLK ) )
+            {
+                std::cerr << "NVMain Error: DVFSFrequencies must be between 0 and CLK, got "
+                          << frequency << std::endl;
+                exit(1);
+            }
+
+            if( mhz < dvfsFrequencies.back( ) )
+                dvfsFrequencies.push_back( mhz );
+        }
+    }
+
+    if( c->KeyExists( "DVFSEpoch" ) )
+        DVFSEpoch = c->GetValueUL( "DVFSEpoch" );
+    if( c->KeyExists( "DVFSUpThreshold" ) )
+        DVFSUpThreshold = c->GetEnergy( "DVFSUpThreshold" );
+    if( c->KeyExists( "DVFSDownThreshold" ) )
+        DVFSDownThreshold = c->GetEnergy( "DVFSDownThreshold" );
+    if( c->KeyExists( "DVFSStaticCurrent" ) )
+        DVFSStaticCurrent = c->GetEnergy( "DVFSStaticCurrent" );
+
+    /* Changing the DLL frequency needs a self-refresh exit. */
+    DVFSRelockLatency = tXSDLL;
+    ConvertTiming( c, "DVFSRelockLatency", DVFSRelockLatency );
+
+    operatingFrequency = static_cast<double>( CLK );
+    SaveNominalOperatingPoint( );
+}
+
+void Params::SaveNominalOperatingPoint( )
+{
+    nominalBURST = tBURST;
+    nominalCCD = tCCD;
+    nominalCCD_L = tCCD_L;
+    nominalCMD = tCMD;
+    nominalRTRS = tRTRS;
+    nominalOST = tOST;
+    nominalRDPDEN = tRDPDEN;
+    nominalWRPDEN = tWRPDEN;
+    nominalWRAPDEN = tWRAPDEN;
+    nominalIDD2N = EIDD2N;
+    nominalIDD3N = EIDD3N;
+    nominalIDD4R = EIDD4R;
+    nominalIDD4W = EIDD4W;
+    nominalActstdby = Eactstdby;
+    nominalPrestdby = Eprestdby;
+}
+
+/*
+ *  Re-derive the frequency dependent parameters for an operating point. Bus
+ *  timings are fixed in memory clocks, so they take CLK / frequency times as
+ *  many CLK cycles. The frequency dependent part of the standby and burst
+ *  currents scales linearly with the frequency.
+ */
+void Params::SetOperatingPoint( double frequency )
+{
+    double slowdown = static_cast<double>( CLK ) / frequency;
+    double currentScale = DVFSStaticCurrent 
+                        + ( 1.0 - DVFSStaticCurrent ) / slowdown;
+
+    operatingFrequency = frequency;
+
+    tBURST = static_cast<ncycle_t>( ceil( static_cast<double>( nominalBURST ) * slowdown ) );
+    tCCD = static_cast<ncycle_t>( ceil( static_cast<double>( nominalCCD ) * slowdown ) );
+    tCCD_L = static_cast<ncycle_t>( ceil( static_cast<double>( nominalCCD_L ) * slowdown ) );
+    tCMD = static_cast<ncycle_t>( ceil( static_cast<double>( nominalCMD ) * slowdown ) );
+    tRTRS = static_cast<ncycle_t>( ceil( static_cast<double>( nominalRTRS ) * slowdown ) );
+    tOST = static_cast<ncycle_t>( ceil( static_cast<double>( nominalOST ) * slowdown ) );
+
+    /* The power-down entry delays include the burst. */
+    tRDPDEN = nominalRDPDEN + ( tBURST - nominalBURST );
+    tWRPDEN = nominalWRPDEN + ( tBURST - nominalBURST );
+    tWRAPDEN = nominalWRAPDEN + ( tBURST - nominalBURST );
+
+    EIDD2N = nominalIDD2N * currentScale;
+    EIDD3N = nominalIDD3N * currentScale;
+    EIDD4R = nominalIDD4R * currentScale;
+    EIDD4W = nominalIDD4W * currentScale;
+    Eactstdby = nominalActstdby * currentScale;
+    Eprestdby = nominalPrestdby * currentScale;
+}
+
+/*
+ *  A burst of fewer beats ends early, rounded up to whole cycles. It is
+ *  scaled as tBURST is, so it stays valid at every operating point.
+ */
+ncycle_t Params::BurstCycles( NVMainRequest *request )
+{
+    ncycle_t fullBeats = nominalBURST * RATE;
+
+    if( request->burstBeats == 0 || request->burstBeats >= fullBeats )
+        return tBURST;
+
+    return ( request->burstBeats * tBURST + fullBeats - 1 ) / fullBeats;
 }
 
@@ -42,9 +42,12 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 namespace NVM {
 
+class NVMainRequest;
+
 enum ProgramMode {
     ProgramMode_SRMS,
     ProgramMode_SSMR
@@ -56,6 +59,47 @@ enum PauseMode {
     PauseMode_Optimal   ///< Optimal: Same as IIWC, but consider iteration complete
 };
 
+/* Resolved from EnergyModel and MLCLevels once, so per-command paths compare enums. */
+enum EnergyModelType {
+    EnergyModel_Current,    ///< IDD currents, energy in mA*t per device
+    EnergyModel_Energy      ///< Flat per-command energies in nJ
+};
+
+/* How the controller decides when ranks enter and leave power-down. */
+enum LowPowerPolicyType {
+    LowPowerPolicy_None,        ///< No power-down management
+    LowPowerPolicy_Greedy,      ///< Power down as soon as a rank queue drains
+    LowPowerPolicy_Timeout,     ///< Power down after PowerDownTimeout idle cycles
+    LowPowerPolicy_Predictive   ///< Pick the mode from the predicted idle period
+};
+
+/* How the subarrays of a bank overlap their row commands. */
+enum SubArrayParallelismType {
+    SubArrayParallelism_Ideal,  ///< Subarrays are timed independently
+    SubArrayParallelism_None,   ///< One open row per bank, precharges are not overlapped
+    SubArrayParallelism_SALP1,  ///< Activates may follow the precharge of another subarray at once
+    SubArrayParallelism_SALP2,  ///< Activates may also precede the precharge of another subarray
+    SubArrayParallelism_MASA    ///< Many open subarrays, column commands select their subarray
+};
+
+/* Which subarrays share a DelayedWrite buffer. */
+enum WriteBufferScopeType {
+    WriteBufferScope_SubArray,  ///< One buffer per subarray
+    WriteBufferScope_Bank       ///< One buffer shared by the subarrays of a bank
+};
+
+/* When the controller changes the memory frequency. */
+enum DVFSPolicyType {
+    DVFSPolicy_None,            ///< Always run at CLK
+    DVFSPolicy_Utilization      ///< Step the frequency with data bus utilization
+};
+
+enum CellType {
+    CellType_SLC,           ///< MLCLevels 1
+    CellType_MLC2,          ///< MLCLevels 2
+    CellType_Other          ///< No data-dependent write timing
+};
+
 class Params
 {
   public:
@@ -91,6 +135,7 @@ class Params
     double Epda;
     double Epdpf;
     double Epdps;
+    double Esref;
     double Voltage;
 
     int Rtt_nom;
@@ -104,10 +149,16 @@ class Params
     std::string EnduranceModel;
     std::string DataEncoder;
     std::string EnergyModel;
+    EnergyModelType energyModel;
 
     bool UseLowPower;
     std::string PowerDownMode;
     bool InitPD;
+    std::string LowPowerPolicy;
+    LowPowerPolicyType lowPowerPolicy;
+    ncycle_t PowerDownTimeout; // idle cycles before a rank is powered down
+    ncycle_t SlowExitThreshold; // predicted idle cycles to use slow-exit power-down
+    ncycle_t SelfRefreshThreshold; // predicted idle cycles to use self-refresh
 
     bool PrintGraphs;
     bool PrintAllDevices;
@@ -124,6 +175,8 @@ class Params
     ncounter_t OffChipLatency;
 
     ncounter_t PeriodicStatsInterval;
+    ncycle_t PowerTraceInterval; // cycles between power trace samples, 0 disables
+    std::string PowerTraceFile; // written as <PowerTraceFile>.channel<id>
 
     ncounter_t ROWS;
     ncounter_t COLS;
@@ -131,6 +184,9 @@ class Params
     ncounter_t RANKS;
     ncounter_t BANKS;
     ncounter_t RAW;
+    ncounter_t BankGroups;
+    ncounter_t SubChannels;
+    ncounter_t PseudoChannels;
     ncounter_t MATHeight;
     ncounter_t RBSize;
 
@@ -138,6 +194,7 @@ class Params
     ncycle_t tBURST;
     ncycle_t tCAS;
     ncycle_t tCCD;
+    ncycle_t tCCD_L;
     ncycle_t tCMD;
     ncycle_t tCWD;
     ncycle_t tRAW;
@@ -151,12 +208,14 @@ class Params
     ncycle_t tRP;
     ncycle_t tRRDR;
     ncycle_t tRRDW;
+    ncycle_t tRRD_L;
     ncycle_t tPPD;
     ncycle_t tRTP;
     ncycle_t tRTRS;
     ncycle_t tWP;
     ncycle_t tWR;
     ncycle_t tWTR;
+    ncycle_t tWTR_L;
     ncycle_t tXP;
     ncycle_t tXPDLL;
     ncycle_t tXS;
@@ -166,11 +225,24 @@ class Params
     ncycle_t tWRPDEN; // interval between Write and PowerDown
     ncycle_t tWRAPDEN; // interval between WriteA and PowerDown
     ncycle_t ClosePage; // enable close-page management policy
+    ncounter_t PagePredictorHistory; // row hit history bits of the adaptive page policy
+    std::string SubArrayParallelism;
+    SubArrayParallelismType subArrayParallelism;
+    ncycle_t tSA; // designated-subarray select to column command (MASA)
     int ScheduleScheme; // command scheduling policy 
     int HighWaterMark; // write drain high watermark
     int LowWaterMark; // write drain low watermark
     ncounter_t BanksPerRefresh; // the number of banks in a refresh (in lockstep)
+    bool SameBankRefresh; // DDR5 REFsb: refresh one bank in every bank group
+    bool SplitCommandBus; // HBM: separate row and column command buses
     ncounter_t DelayedRefreshThreshold; // the threshold that indicates how many refresh can be delayed
+    bool PerBankRefresh; // LPDDR REFpb: refresh a single bank using tRFCpb
+    bool OutOfOrderRefresh; // refresh an idle bank group before a busy one
+    bool ElasticRefresh; // issue postponed refreshes when a bank group is idle
+    ncycle_t ElasticRefreshIdle; // idle cycles before a postponed refresh is pulled in
+    bool RefreshPausing; // split refreshes into segments, reads are served between them
+    ncounter_t RefreshPauseSegments; // the number of segments of a pausable refresh
+    bool NonVolatile; // non-volatile channels never refresh
     std::string AddressMappingScheme; // the address mapping scheme
 
     std::string MemoryPrefetcher;
@@ -178,6 +250,7 @@ class Params
 
     ProgramMode programMode;
     ncounter_t MLCLevels;
+    CellType cellType;
     ncounter_t WPVariance;
     bool UniformWrites;
     bool WriteAllBits; // Set false to calculate write energy on a per-bit basis
@@ -203,13 +276,53 @@ class Params
     /* List of debug classes. */
     bool debugOn;
     std::set<std::string> debugClasses;
+    DebugLevel debugLevel;
 
     bool WritePausing;
     double PauseThreshold;
     ncounter_t MaxCancellations;
     PauseMode pauseMode;
 
+    /* SRAM write buffer of the DelayedWrite mode. */
+    std::string WriteBufferScope;
+    WriteBufferScopeType writeBufferScope;
+    ncounter_t WriteBufferEntries;
+    ncounter_t WriteBufferHighWater; // occupancy that forces a drain
+    ncycle_t WriteBufferIdleDelay; // idle cycles before an opportunistic drain
+
+    /* 
+     *  MemDVFS: the event queue keeps running at CLK, the highest operating
+     *  point. At a lower frequency the bus timings take more CLK cycles while
+     *  the core timings (in ns) stay the same.
+     */
+    std::string DVFSPolicy;
+    DVFSPolicyType dvfsPolicy;
+    std::vector<double> dvfsFrequencies; // operating points in MHz, dvfsFrequencies[0] is CLK
+    ncycle_t DVFSEpoch; // cycles between policy decisions
+    double DVFSUpThreshold; // data bus utilization to step up
+    double DVFSDownThreshold; // data bus utilization to step down
+    ncycle_t DVFSRelockLatency; // cycles the channel is stalled by a switch
+    double DVFSStaticCurrent; // fraction of the IDD currents that does not scale
+    double operatingFrequency; // current operating point in MHz
+
+    /* tBURST at CLK. Data sizes are derived from this rather than tBURST. */
+    ncycle_t nominalBURST;
+
+    void SetOperatingPoint( double frequency );
+
+    /* Bus cycles of each burst of the request, e.g., shorter if compressed. */
+    ncycle_t BurstCycles( NVMainRequest *request );
+
   private:
+    void SaveNominalOperatingPoint( );
+
+    /* Values at CLK that are re-derived for each operating point. */
+    ncycle_t nominalCCD, nominalCCD_L, nominalCMD, nominalRTRS, nominalOST;
+    ncycle_t nominalRDPDEN, nominalWRPDEN, nominalWRAPDEN;
+    double nominalIDD2N, nominalIDD3N, nominalIDD4R, nominalIDD4W;
+    double nominalActstdby, nominalPrestdby;
+
+
     void ConvertTiming( Config *conf, std::string param, ncycle_t& value );
     ncycle_t ConvertTiming( Config *conf, std::string param );
 };
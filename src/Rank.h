@@ -66,7 +66,8 @@ enum RankState
     RANK_REFRESHING,/***< some banks in the rank are refreshing */
     RANK_PDPF,      /***< Rank is in precharge powered down, fast exit mode */
     RANK_PDA,       /***< Rank is in active powered down mode */
-    RANK_PDPS       /***< Rank is in precharge powered down, slow exit mode */
+    RANK_PDPS,      /***< Rank is in precharge powered down, slow exit mode */
+    RANK_SREF       /***< Rank is in self-refresh */
 };
 
 class Rank : public NVMObject
@@ -78,6 +79,8 @@ class Rank : public NVMObject
     virtual void SetConfig( Config * /*c*/, bool /*createChildren*/ = true ) { }
 
     virtual bool Idle( );
+    virtual void GetEnergy( double& , double& , double&, double& ) { } 
+    virtual void IntegrateBackground( ) { }
 
 };
 
@@ -48,7 +48,7 @@ int SimInterface::GetDataAtAddress( uint64_t address, NVMDataBlock *data )
     else
     {
         if( data )
-            data = memoryData[ address ];
+            *data = *memoryData[ address ];
         retval = 1;
     }
 
@@ -40,6 +40,7 @@
 #include "Endurance/NullModel/NullModel.h"
 #include "Endurance/Distributions/Normal.h"
 #include "DataEncoders/DataEncoderFactory.h"
+#include "src/Checkpoint.h"
 
 #include <signal.h>
 #include <cassert>
@@ -100,12 +101,28 @@ SubArray::SubArray( )
     nextReadPreWrite = 0;
     nextWritePreWrite = 0;
     nextPowerDownPreWrite = 0;
+    writeBuffer = NULL;
+    ownsWriteBuffer = false;
+    drainRequest = NULL;
+    lastAccessCycle = 0;
+    nextDrainWakeup = 0;
+    lastFullStall = 0;
     idleTimer = 0;
 
     cancelledWrites = 0;
     cancelledWriteTime = 0;
     pausedWrites = 0;
 
+    writeBufferWrites = 0;
+    writeBufferCoalesced = 0;
+    writeBufferReadHits = 0;
+    writeBufferDrains = 0;
+    writeBufferDrainActivates = 0;
+    writeBufferFullStalls = 0;
+    writeBufferMaxOccupancy = 0;
+    writeBufferAverageOccupancy = 0.0;
+    writeBufferCapacity = 0;
+
     averagePausesPerRequest = 0.0;
     measuredPauses = 0;
 
@@ -135,6 +152,8 @@ SubArray::SubArray( )
     averageWriteIterations = 1;
 
     endrModel = NULL;
+    uncorrectableReads = 0;
+    uncorrectableWrites = 0;
     dataEncoder = NULL;
 
     subArrayId = -1;
@@ -144,6 +163,8 @@ SubArray::SubArray( )
 
 SubArray::~SubArray( )
 {
+    if( ownsWriteBuffer )
+        delete writeBuffer;
 }
 
 void SubArray::SetConfig( Config *c, bool createChildren )
@@ -170,6 +191,10 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         {
             writeMode = WRITE_BACK;
         }
+        else if( conf->GetString( "WriteMode" ) == "DelayedWrite" )
+        {
+            writeMode = DELAYED_WRITE;
+        }
         else
         {
             std::cout << "NVMain Warning: Unknown write mode `"
@@ -179,6 +204,16 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         }
     }
 
+    /* Unless the bank shares one, every subarray buffers its own writes. */
+    if( writeMode == DELAYED_WRITE && writeBuffer == NULL )
+    {
+        writeBuffer = new WriteBuffer( p->WriteBufferEntries );
+        ownsWriteBuffer = true;
+    }
+
+    if( writeBuffer != NULL )
+        writeBufferCapacity = writeBuffer->GetCapacity( );
+
     ncounter_t totalWritePulses = p->nWP00 + p->nWP01 + p->nWP10 + p->nWP11;
     averageWriteIterations = static_cast<ncounter_t>( (totalWritePulses+2)/4 );
 
@@ -188,6 +223,8 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         endrModel = EnduranceModelFactory::CreateEnduranceModel( p->EnduranceModel );
         if( endrModel )
         {
+            endrModel->SetEventQueue( GetEventQueue( ) );
+            endrModel->StatName( StatName( ) );
             endrModel->SetConfig( conf, createChildren );
             endrModel->SetStats( GetStats( ) );
         }
@@ -195,6 +232,7 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         dataEncoder = DataEncoderFactory::CreateNewDataEncoder( p->DataEncoder );
         if( dataEncoder )
         {
+            dataEncoder->StatName( StatName( ) + "." + p->DataEncoder );
             dataEncoder->SetConfig( conf, createChildren );
             dataEncoder->SetStats( GetStats( ) );
         }
@@ -213,7 +251,7 @@ void SubArray::RegisterStats( )
         dataEncoder->RegisterStats( );
     }
 
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         AddUnitStat(subArrayEnergy, "mA*t");
         AddUnitStat(activeEnergy, "mA*t");
@@ -233,6 +271,19 @@ void SubArray::RegisterStats( )
     AddStat(cancelledWriteTime);
     AddStat(pausedWrites);
 
+    if( writeMode == DELAYED_WRITE )
+    {
+        AddStat(writeBufferWrites);
+        AddStat(writeBufferCoalesced);
+        AddStat(writeBufferReadHits);
+        AddStat(writeBufferDrains);
+        AddStat(writeBufferDrainActivates);
+        AddStat(writeBufferFullStalls);
+        AddStat(writeBufferMaxOccupancy);
+        AddStat(writeBufferAverageOccupancy);
+        AddStat(writeBufferCapacity);
+    }
+
     AddStat(averagePausesPerRequest);
     AddStat(measuredPauses);
 
@@ -249,6 +300,8 @@ void SubArray::RegisterStats( )
     {
         AddStat(worstCaseEndurance);
         AddStat(averageEndurance);
+        AddStat(uncorrectableReads);
+        AddStat(uncorrectableWrites);
     }
 
     AddStat(actWaits);
@@ -330,7 +383,7 @@ bool SubArray::Activate( NVMainRequest *request )
     lastActivate = GetEventQueue()->GetCurrentCycle();
 
     /* Add to bank's total energy. */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* DRAM Model */
         ncycle_t tRC = p->tRAS + p->tRP;
@@ -360,16 +413,25 @@ bool SubArray::Activate( NVMainRequest *request )
  */
 bool SubArray::Read( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     uint64_t readRow;
 
     request->address.GetTranslatedAddress( &readRow, NULL, NULL, NULL, NULL, NULL );
 
+    /* Buffered lines are forwarded without touching the cells. */
+    bool forwarded = IsBuffered( request );
+
     /* Check if we need to cancel or pause a write to service this request. */
-    CheckWritePausing( );
+    if( !forwarded )
+        CheckWritePausing( );
 
     /* TODO: Can we remove this sanity check and totally trust IsIssuable()? */
     /* sanity check */
-    if( nextRead > GetEventQueue()->GetCurrentCycle() )
+    if( forwarded )
+    {
+        writeBufferReadHits++;
+    }
+    else if( nextRead > GetEventQueue()->GetCurrentCycle() )
     {
         std::cerr << "NVMain Error: Subarray violates READ timing constraint!"
             << std::endl;
@@ -389,14 +451,30 @@ bool SubArray::Read( NVMainRequest *request )
     }
 
     /* Any additional latency for data encoding. */
-    ncycles_t decLat = (dataEncoder ? dataEncoder->Read( request ) : 0);
+    ncycles_t decLat = 0;
+    if( !forwarded && dataEncoder )
+        decLat = dataEncoder->Read( request );
+
+    /* Any additional latency for correcting worn out cells. */
+    if( !forwarded && endrModel )
+    {
+        ncycles_t corrLat = endrModel->Read( request );
+
+        if( corrLat < 0 )
+        {
+            corrLat = -corrLat - 1;
+            uncorrectableReads++;
+        }
+
+        decLat += corrLat;
+    }
 
     /* Update timing constraints */
     if( request->type == READ_PRECHARGE )
     {
         nextActivate = MAX( nextActivate, 
                             GetEventQueue()->GetCurrentCycle()
-                                + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
+                                + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
                                 + p->tAL + p->tRTP + p->tRP + decLat );
 
         nextPrecharge = MAX( nextPrecharge, nextActivate );
@@ -410,30 +488,30 @@ bool SubArray::Read( NVMainRequest *request )
         /* insert the event to issue the implicit precharge */ 
         GetEventQueue( )->InsertEvent( EventResponse, this, preReq, 
                         GetEventQueue()->GetCurrentCycle() + p->tAL + p->tRTP + decLat
-                        + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1) );
+                        + MAX( burst, p->tCCD_L ) * (request->burstCount - 1) );
     }
     else
     {
         nextPrecharge = MAX( nextPrecharge, 
                              GetEventQueue()->GetCurrentCycle() 
-                                 + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                                 + p->tAL + p->tBURST + p->tRTP - p->tCCD + decLat );
+                                 + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                                 + p->tAL + burst + p->tRTP - p->tCCD_L + decLat );
 
         nextRead = MAX( nextRead, 
                         GetEventQueue()->GetCurrentCycle() 
-                            + MAX( p->tBURST, p->tCCD ) * request->burstCount );
+                            + MAX( burst, p->tCCD_L ) * request->burstCount );
 
         nextWrite = MAX( nextWrite, 
                          GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tBURST, p->tCCD ) * (request->burstCount  - 1)
-                             + p->tCAS + p->tBURST + p->tRTRS - p->tCWD + decLat );
+                             + MAX( burst, p->tCCD_L ) * (request->burstCount  - 1)
+                             + p->tCAS + burst + p->tRTRS - p->tCWD + decLat );
     }
 
     /* Read->Powerdown is typical the same for READ and READ_PRECHARGE. */
     nextPowerDown = MAX( nextPowerDown,
                          GetEventQueue()->GetCurrentCycle()
-                            + MAX( p->tBURST, p->tCCD ) * (request->burstCount  - 1)
-                            + p->tCAS + p->tAL + p->tBURST + 1 + decLat );
+                            + MAX( burst, p->tCCD_L ) * (request->burstCount  - 1)
+                            + p->tCAS + p->tAL + burst + 1 + decLat );
 
     /*
      *  Data is placed on the bus starting from tCAS and is complete after tBURST.
@@ -452,16 +530,16 @@ bool SubArray::Read( NVMainRequest *request )
 
     /* Notify owner of read completion as well */
     GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-            GetEventQueue()->GetCurrentCycle() + p->tCAS + p->tBURST + decLat );
+            GetEventQueue()->GetCurrentCycle() + p->tCAS + burst + decLat );
 
 
     /* Calculate energy */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* DRAM Model */
-        subArrayEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        subArrayEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(burst) ) / (double)(p->BANKS);
 
-        burstEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        burstEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(burst) ) / (double)(p->BANKS);
     }
     else
     {
@@ -495,7 +573,7 @@ bool SubArray::Read( NVMainRequest *request )
     }
 
     reads++;
-    dataCycles += p->tBURST;
+    dataCycles += burst;
     
     return true;
 }
@@ -505,6 +583,7 @@ bool SubArray::Read( NVMainRequest *request )
  */
 bool SubArray::Write( NVMainRequest *request )
 {
+    ncycle_t burst = p->BurstCycles( request );
     uint64_t writeRow;
     ncycle_t writeTimer;
     ncycle_t encLat = 0, endrLat = 0;
@@ -520,6 +599,10 @@ bool SubArray::Write( NVMainRequest *request )
             << std::endl;
         return false;
     }
+    else if( IsBuffered( request ) )
+    {
+        /* The write buffer does not need the row. */
+    }
     else if( state != SUBARRAY_OPEN )
     {
         std::cerr << "NVMain Error: try to write a subarray that is not active!"
@@ -533,29 +616,15 @@ bool SubArray::Write( NVMainRequest *request )
         return false;
     }
 
+    if( writeMode == DELAYED_WRITE )
+        return BufferWrite( request );
+
     if( writeMode == WRITE_THROUGH )
     {
         encLat = (dataEncoder ? dataEncoder->Write( request ) : 0);
         endrLat = UpdateEndurance( request );
 
-        /* Count the number of bits modified. */
-        if( !p->WriteAllBits )
-        {
-            uint8_t *bitCountData = new uint8_t[request->data.GetSize()];
-
-            for( uint64_t bitCountByte = 0; bitCountByte < request->data.GetSize(); bitCountByte++ )
-            {
-                bitCountData[bitCountByte] = request->data.GetByte( bitCountByte )
-                                           ^ request->oldData.GetByte( bitCountByte );
-            }
-
-            ncounter_t bitCountWords = request->data.GetSize()/4;
-
-            ncounter_t numChangedBits = CountBitsMLC1( 1, (uint32_t*)bitCountData, bitCountWords );
-
-            assert( request->data.GetSize()*8 >= numChangedBits );
-            numUnchangedBits = request->data.GetSize()*8 - numChangedBits;
-        }
+        numUnchangedBits = CountUnchangedBits( request );
     }
 
     /* Determine the write time. */
@@ -605,8 +674,8 @@ bool SubArray::Write( NVMainRequest *request )
     {
         nextActivate = MAX( nextActivate, 
                             GetEventQueue()->GetCurrentCycle()
-                            + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                            + p->tAL + p->tCWD + p->tBURST 
+                            + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                            + p->tAL + p->tCWD + burst 
                             + writeTimer + p->tWR + p->tRP );
 
         nextPrecharge = MAX( nextPrecharge, nextActivate );
@@ -621,24 +690,24 @@ bool SubArray::Write( NVMainRequest *request )
         /* insert the event to issue the implicit precharge */ 
         GetEventQueue( )->InsertEvent( EventResponse, this, preReq, 
             GetEventQueue()->GetCurrentCycle() 
-            + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-            + p->tAL + p->tCWD + p->tBURST + writeTimer + p->tWR );
+            + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+            + p->tAL + p->tCWD + burst + writeTimer + p->tWR );
     }
     else
     {
         nextPrecharge = MAX( nextPrecharge, 
                              GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                             + p->tAL + p->tCWD + p->tBURST + writeTimer + p->tWR );
+                             + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                             + p->tAL + p->tCWD + burst + writeTimer + p->tWR );
 
         nextRead = MAX( nextRead, 
                         GetEventQueue()->GetCurrentCycle() 
-                        + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                        + p->tCWD + p->tBURST + p->tWTR + writeTimer );
+                        + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                        + p->tCWD + burst + p->tWTR_L + writeTimer );
 
         nextWrite = MAX( nextWrite, 
                          GetEventQueue()->GetCurrentCycle() 
-                         + MAX( p->tBURST, p->tCCD ) * request->burstCount + writeTimer );
+                         + MAX( burst, p->tCCD_L ) * request->burstCount + writeTimer );
     }
 
     nextPowerDown = MAX( nextPowerDown, nextPrecharge );
@@ -650,8 +719,51 @@ bool SubArray::Write( NVMainRequest *request )
     writeStart = GetEventQueue()->GetCurrentCycle();
     writeEnd = GetEventQueue()->GetCurrentCycle() + writeTimer;
     writeEventTime = GetEventQueue()->GetCurrentCycle() + p->tCWD 
-                     + MAX( p->tBURST, p->tCCD ) * request->burstCount + writeTimer;
+                     + MAX( burst, p->tCCD_L ) * request->burstCount + writeTimer;
+
+    writeEvent = CreateWriteEvent( request );
 
+    /* Issue a bus burst request when the burst starts. */
+    NVMainRequest *busReq = new NVMainRequest( );
+    *busReq = *request;
+    busReq->type = BUS_READ;
+    busReq->owner = this;
+
+    GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
+            GetEventQueue()->GetCurrentCycle() + p->tCWD );
+
+    /* Notify owner of write completion as well */
+    GetEventQueue( )->InsertEvent( writeEvent, writeEventTime );
+
+    /* Calculate energy. */
+    if( p->energyModel == EnergyModel_Current )
+    {
+        /* DRAM Model. */
+        subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(burst) ) / (double)(p->BANKS);
+
+        burstEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(burst) ) / (double)(p->BANKS);
+    }
+    else
+    {
+        /* Flat energy model. */
+        subArrayEnergy += p->Ewr - p->Ewrpb * numUnchangedBits;
+
+        burstEnergy += p->Ewr;
+    }
+
+    writeCycle = true;
+
+    writes++;
+    dataCycles += burst;
+    
+    return true;
+}
+
+/*
+ *  The write completion event is kept so a pause or cancel can remove it.
+ */
+NVM::Event *SubArray::CreateWriteEvent( NVMainRequest *request )
+{
     /* The parent has our hook in the children list, we need to find this. */
     std::vector<NVMObject_hook *>& children = GetParent( )->GetTrampoline( )->GetChildren( );
     std::vector<NVMObject_hook *>::iterator it;
@@ -668,10 +780,120 @@ bool SubArray::Write( NVMainRequest *request )
 
     assert( hook != NULL );
 
-    writeEvent = new NVM::Event( );
-    writeEvent->SetType( EventResponse );
-    writeEvent->SetRecipient( hook );
-    writeEvent->SetRequest( request );
+    NVM::Event *event = new NVM::Event( );
+    event->SetType( EventResponse );
+    event->SetRecipient( hook );
+    event->SetRequest( request );
+
+    return event;
+}
+
+/*
+ *  Bits which keep their value are not programmed, so the flat energy model
+ *  credits Ewrpb for each of them.
+ */
+ncounter_t SubArray::CountUnchangedBits( NVMainRequest *request )
+{
+    if( p->WriteAllBits )
+        return 0;
+
+    uint8_t *bitCountData = new uint8_t[request->data.GetSize()];
+
+    for( uint64_t bitCountByte = 0; bitCountByte < request->data.GetSize(); bitCountByte++ )
+    {
+        bitCountData[bitCountByte] = request->data.GetByte( bitCountByte )
+                                   ^ request->oldData.GetByte( bitCountByte );
+    }
+
+    ncounter_t bitCountWords = request->data.GetSize()/4;
+
+    ncounter_t numChangedBits = CountBitsMLC1( 1, (uint32_t*)bitCountData, bitCountWords );
+
+    delete [] bitCountData;
+
+    assert( request->data.GetSize()*8 >= numChangedBits );
+    return request->data.GetSize()*8 - numChangedBits;
+}
+
+/*
+ *  Reads of buffered lines and writes queued without an activate are
+ *  served by the write buffer in DelayedWrite mode. A read is checked when
+ *  it issues, as its line may have been drained since it was queued.
+ */
+bool SubArray::IsBuffered( NVMainRequest *request )
+{
+    if( writeMode != DELAYED_WRITE )
+        return false;
+
+    if( request->type == READ || request->type == READ_PRECHARGE )
+        return writeBuffer->Contains( request );
+
+    return ( request->flags & NVMainRequest::FLAG_CACHED 
+             || writeBuffer->Contains( request ) );
+}
+
+/*
+ *  BufferWrite() completes a write once its data is in the write buffer.
+ *  The cells are programmed later by a drain.
+ */
+bool SubArray::BufferWrite( NVMainRequest *request )
+{
+    ncycle_t burst = p->BurstCycles( request );
+
+    if( !writeBuffer->Insert( request ) )
+        writeBufferCoalesced++;
+
+    ncounter_t occupancy = writeBuffer->GetOccupancy( );
+
+    writeBufferAverageOccupancy = ( ( writeBufferAverageOccupancy * static_cast<double>(writeBufferWrites) )
+                                  + static_cast<double>(occupancy) ) 
+                                / static_cast<double>(writeBufferWrites + 1);
+    writeBufferWrites++;
+
+    if( occupancy > writeBufferMaxOccupancy )
+        writeBufferMaxOccupancy = occupancy;
+
+    /* Update timing constraints */
+    if( request->type == WRITE_PRECHARGE )
+    {
+        nextActivate = MAX( nextActivate, 
+                            GetEventQueue()->GetCurrentCycle()
+                            + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                            + p->tAL + p->tCWD + burst + p->tWR + p->tRP );
+
+        nextPrecharge = MAX( nextPrecharge, nextActivate );
+        nextRead = MAX( nextRead, nextActivate );
+        nextWrite = MAX( nextWrite, nextActivate );
+
+        /* close the subarray */
+        NVMainRequest *preReq = new NVMainRequest( );
+        *preReq = *request;
+        preReq->owner = this;
+
+        /* insert the event to issue the implicit precharge */ 
+        GetEventQueue( )->InsertEvent( EventResponse, this, preReq, 
+            GetEventQueue()->GetCurrentCycle() 
+            + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+            + p->tAL + p->tCWD + burst + p->tWR );
+    }
+    else
+    {
+        nextPrecharge = MAX( nextPrecharge, 
+                             GetEventQueue()->GetCurrentCycle() 
+                             + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                             + p->tAL + p->tCWD + burst + p->tWR );
+
+        nextRead = MAX( nextRead, 
+                        GetEventQueue()->GetCurrentCycle() 
+                        + MAX( burst, p->tCCD_L ) * (request->burstCount - 1)
+                        + p->tCWD + burst + p->tWTR_L );
+
+        nextWrite = MAX( nextWrite, 
+                         GetEventQueue()->GetCurrentCycle() 
+                         + MAX( burst, p->tCCD_L ) * request->burstCount );
+    }
+
+    nextPowerDown = MAX( nextPowerDown, nextPrecharge );
 
     /* Issue a bus burst request when the burst starts. */
     NVMainRequest *busReq = new NVMainRequest( );
@@ -682,31 +904,183 @@ bool SubArray::Write( NVMainRequest *request )
     GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
             GetEventQueue()->GetCurrentCycle() + p->tCWD );
 
-    /* Notify owner of write completion as well */
+    /* The write is complete once the burst is buffered. */
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+            GetEventQueue()->GetCurrentCycle() + p->tCWD 
+            + MAX( burst, p->tCCD_L ) * request->burstCount );
+
+    /* 
+     *  Calculate energy. The flat model's Ewr programs the cells, so it is
+     *  charged once per drain instead of per buffered write.
+     */
+    if( p->energyModel == EnergyModel_Current )
+    {
+        subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(burst) ) / (double)(p->BANKS);
+
+        burstEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(burst) ) / (double)(p->BANKS);
+    }
+
+    writeCycle = true;
+
+    writes++;
+    dataCycles += burst;
+
+    ScheduleDrain( );
+    
+    return true;
+}
+
+/*
+ *  Drains start once the subarray has been idle for WriteBufferIdleDelay
+ *  cycles, or right away when the buffer reaches its high-water mark.
+ */
+void SubArray::ScheduleDrain( )
+{
+    ncycle_t now = GetEventQueue()->GetCurrentCycle();
+
+    if( drainRequest != NULL || !writeBuffer->HasDrain( subArrayId ) )
+        return;
+
+    ncycle_t drainCycle = now + 1;
+
+    if( writeBuffer->GetOccupancy( ) < p->WriteBufferHighWater )
+        drainCycle = MAX( drainCycle, lastAccessCycle + p->WriteBufferIdleDelay );
+
+    drainCycle = MAX( drainCycle, nextActivate );
+
+    /* A pending earlier wakeup checks again. */
+    if( nextDrainWakeup > now && nextDrainWakeup <= drainCycle )
+        return;
+
+    nextDrainWakeup = drainCycle;
+    GetEventQueue( )->InsertCallback( this, (CallbackPtr)&SubArray::DrainCallback,
+                                      drainCycle );
+}
+
+void SubArray::DrainCallback( void * /*data*/ )
+{
+    ncycle_t now = GetEventQueue()->GetCurrentCycle();
+
+    if( drainRequest != NULL )
+        return;
+
+    bool idle = ( now >= lastAccessCycle + p->WriteBufferIdleDelay 
+                  || writeBuffer->GetOccupancy( ) >= p->WriteBufferHighWater );
+
+    if( !idle || isWriting || nextActivate > now
+        || ( state != SUBARRAY_OPEN && state != SUBARRAY_CLOSED ) )
+    {
+        ScheduleDrain( );
+        return;
+    }
+
+    NVMainRequest *request = writeBuffer->NextDrain( subArrayId );
+
+    if( request != NULL )
+        StartDrain( request );
+}
+
+/*
+ *  StartDrain() programs a buffered line into the cells. Drains may be
+ *  paused or cancelled by reads just like regular writes.
+ */
+void SubArray::StartDrain( NVMainRequest *request )
+{
+    ncycle_t now = GetEventQueue()->GetCurrentCycle();
+    ncycle_t encLat = (dataEncoder ? dataEncoder->Write( request ) : 0);
+    ncycle_t endrLat = UpdateEndurance( request );
+
+    ncycle_t writeTimer = WriteCellData( request );
+    if( request->flags & NVMainRequest::FLAG_PAUSED )
+    {
+        writeTimer = request->writeProgress;
+        request->flags &= ~NVMainRequest::FLAG_PAUSED;
+    }
+
+    if( request->flags & NVMainRequest::FLAG_CANCELLED )
+    {
+        request->flags &= ~NVMainRequest::FLAG_CANCELLED;
+    }
+
+    request->writeProgress = writeTimer;
+
+    writeTimer += encLat + endrLat;
+
+    averageWriteTime = ((averageWriteTime * static_cast<double>(measuredWriteTimes)) + static_cast<double>(writeTimer)) 
+                     / (static_cast<double>(measuredWriteTimes) + 1.0);
+    measuredWriteTimes++;
+
+    /* 
+     *  The row of the line is activated for the drain and precharged after
+     *  tWR, unless it is the open row. A row the controller left open is
+     *  closed first and activated again afterwards, as it is still in use.
+     */
+    uint64_t drainRow;
+    ncycle_t openCycles = 0, closeCycles = 0;
+    ncounter_t rowActivates = 0;
+    ncycle_t tRP = ( p->UsePrecharge ? p->tRP : 0 );
+
+    request->address.GetTranslatedAddress( &drainRow, NULL, NULL, NULL, NULL, NULL );
+
+    if( state != SUBARRAY_OPEN || drainRow != openRow )
+    {
+        openCycles = p->tRCD;
+        closeCycles = p->tWR + tRP;
+        rowActivates = 1;
+
+        if( state == SUBARRAY_OPEN )
+        {
+            openCycles += tRP;
+            closeCycles += p->tRCD;
+            rowActivates = 2;
+        }
+    }
+
+    ncycle_t drainCycles = openCycles + writeTimer + closeCycles;
+
+    /* Without write pausing the drain blocks the subarray. */
+    if( !p->WritePausing )
+    {
+        nextActivate = MAX( nextActivate, now + drainCycles );
+        nextPrecharge = MAX( nextPrecharge, now + drainCycles );
+        nextRead = MAX( nextRead, now + drainCycles );
+    }
+
+    nextPowerDown = MAX( nextPowerDown, now + drainCycles );
+
+    isWriting = true;
+    writeRequest = request;
+    drainRequest = request;
+    writeStart = now + openCycles;
+    writeEnd = writeStart + writeTimer;
+    writeEventTime = now + MAX( 1, drainCycles );
+
+    writeEvent = CreateWriteEvent( request );
     GetEventQueue( )->InsertEvent( writeEvent, writeEventTime );
 
-    /* Calculate energy. */
-    if( p->EnergyModel == "current" )
+    /* Calculate energy, with each activate charged as in Activate(). */
+    if( p->energyModel == EnergyModel_Current )
     {
-        /* DRAM Model. */
-        subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        /* DRAM Model */
+        ncycle_t tRC = p->tRAS + p->tRP;
+        double activateEnergy = ( ( p->EIDD0 * (double)tRC ) 
+                                - ( ( p->EIDD3N * (double)(p->tRAS) )
+                                +  ( p->EIDD2N * (double)(p->tRP) ) ) ) / (double)(p->BANKS);
 
-        burstEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        subArrayEnergy += activateEnergy * (double)rowActivates;
+        activeEnergy += activateEnergy * (double)rowActivates;
     }
     else
     {
         /* Flat energy model. */
-        subArrayEnergy += p->Ewr - p->Ewrpb * numUnchangedBits;
+        subArrayEnergy += p->Erd * (double)rowActivates;
+        activeEnergy += p->Erd * (double)rowActivates;
 
+        subArrayEnergy += p->Ewr - p->Ewrpb * CountUnchangedBits( request );
         burstEnergy += p->Ewr;
     }
 
-    writeCycle = true;
-
-    writes++;
-    dataCycles += p->tBURST;
-    
-    return true;
+    writeBufferDrainActivates += rowActivates;
 }
 
 /*
@@ -805,7 +1179,7 @@ bool SubArray::Refresh( NVMainRequest* request )
     /* set the subarray under refreshing */
     state = SUBARRAY_REFRESHING;
 
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* calibrate the refresh energy since we may have fine-grained refresh */
         subArrayEnergy += ( ( p->EIDD5B - p->EIDD3N ) 
@@ -905,12 +1279,15 @@ void SubArray::CheckWritePausing( )
         GetEventQueue( )->InsertEvent( EventResponse, this, writeRequest,
                                     GetEventQueue()->GetCurrentCycle() + 1 );
 
-        /* Restore the old next* state. */
-        nextActivate = nextActivatePreWrite;
-        nextPrecharge = nextPrechargePreWrite;
-        nextWrite = nextWritePreWrite;
-        nextRead = nextReadPreWrite;
-        nextPowerDown = nextPowerDownPreWrite;
+        /* Restore the old next* state. Drains do not hold any back. */
+        if( writeRequest != drainRequest )
+        {
+            nextActivate = nextActivatePreWrite;
+            nextPrecharge = nextPrechargePreWrite;
+            nextWrite = nextWritePreWrite;
+            nextRead = nextReadPreWrite;
+            nextPowerDown = nextPowerDownPreWrite;
+        }
     }
 }
 
@@ -930,7 +1307,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 {
     writeIterationStarts.clear( );
     uint32_t *rawData = reinterpret_cast<uint32_t*>(request->data.rawData);
-    unsigned int memoryWordSize = static_cast<unsigned int>(p->tBURST * p->RATE * p->BusWidth);
+    unsigned int memoryWordSize = static_cast<unsigned int>(p->nominalBURST * p->RATE * p->BusWidth);
     unsigned int writeBytes32 = memoryWordSize / 32;
 
     if( p->UniformWrites )
@@ -961,7 +1338,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
             writeCount1 = 256;
         }
 
-        if( p->EnergyModel != "current" )
+        if( p->energyModel != EnergyModel_Current )
         {
             subArrayEnergy += p->Ereset * writeCount0;
             subArrayEnergy += p->Eset * writeCount1;
@@ -979,12 +1356,12 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
         return p->tWP0;
 
     /* Check the data for the worst-case write time. */
-    if( p->MLCLevels == 1 )
+    if( p->cellType == CellType_SLC )
     {
         ncounter_t writeCount0 = CountBitsMLC1( 0, rawData, writeBytes32 );
         ncounter_t writeCount1 = CountBitsMLC1( 1, rawData, writeBytes32 );
 
-        if( p->EnergyModel != "current" )
+        if( p->energyModel != EnergyModel_Current )
         {
             subArrayEnergy += p->Ereset * writeCount0;
             subArrayEnergy += p->Eset * writeCount1;
@@ -997,7 +1374,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 
         maxDelay = MAX(delay0, delay1);
     }
-    else if( p->MLCLevels == 2 )
+    else if( p->cellType == CellType_MLC2 )
     {
         ncounter_t writeCount00 = CountBitsMLC2( 0, rawData, writeBytes32 );
         ncounter_t writeCount01 = CountBitsMLC2( 1, rawData, writeBytes32 );
@@ -1103,6 +1480,17 @@ ncycle_t SubArray::NextIssuable( NVMainRequest *request )
     else if( request->type == READ ) nextCompare = nextRead;
     else if( request->type == WRITE ) nextCompare = nextWrite;
     else if( request->type == PRECHARGE ) nextCompare = nextPrecharge;
+
+    if( writeMode == DELAYED_WRITE )
+    {
+        /* Forwarded reads do not wait for the cells. */
+        if( request->type == READ && IsBuffered( request ) )
+            nextCompare = 0;
+        /* Writes to a full buffer wait for the current drain. */
+        else if( request->type == WRITE && drainRequest != NULL 
+                 && writeBuffer->IsFull( ) && !writeBuffer->Contains( request ) )
+            nextCompare = MAX( nextCompare, writeEventTime );
+    }
         
     // Should have no children
     return nextCompare;
@@ -1145,7 +1533,11 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
     }
     else if( req->type == READ || req->type == READ_PRECHARGE )
     {
-        if( nextRead > (GetEventQueue()->GetCurrentCycle()) /* if it is too early to read */
+        if( IsBuffered( req ) )
+        {
+            /* Forwarded from the write buffer. */
+        }
+        else if( nextRead > (GetEventQueue()->GetCurrentCycle()) /* if it is too early to read */
             || state != SUBARRAY_OPEN  /* or, the subarray is not active */
             || opRow != openRow        /* or, the target row is not the open row */
             || ( p->WritePausing && isWriting && writeRequest->flags & NVMainRequest::FLAG_FORCED ) ) /* or, write can't be paused. */
@@ -1158,13 +1550,28 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
     else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
     {
         if( nextWrite > (GetEventQueue()->GetCurrentCycle()) /* if it is too early to write */
-            || state != SUBARRAY_OPEN  /* or, the subarray is not active */          
-            || opRow != openRow )      /* or, the target row is not the open row */
+            || ( !IsBuffered( req )           /* or, the write needs the row and */
+                 && ( state != SUBARRAY_OPEN  /* the subarray is not active */          
+                      || opRow != openRow ) ) ) /* or, the target row is not the open row */
         {
             rv = false;
             if( reason ) 
                 reason->reason = SUBARRAY_TIMING;
         }
+        else if( writeMode == DELAYED_WRITE && writeBuffer->IsFull( )
+                 && !writeBuffer->Contains( req ) )
+        {
+            rv = false;
+            if( reason ) 
+                reason->reason = SUBARRAY_TIMING;
+
+            /* Count each cycle of back-pressure once. */
+            if( lastFullStall != GetEventQueue()->GetCurrentCycle() )
+            {
+                lastFullStall = GetEventQueue()->GetCurrentCycle();
+                writeBufferFullStalls++;
+            }
+        }
     }
     else if( req->type == PRECHARGE || req->type == PRECHARGE_ALL )
     {
@@ -1179,7 +1586,8 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
     }
     else if( req->type == POWERDOWN_PDA 
              || req->type == POWERDOWN_PDPF 
-             || req->type == POWERDOWN_PDPS )
+             || req->type == POWERDOWN_PDPS
+             || req->type == POWERDOWN_SREF )
     {
         /* Bank doesn't know write time, so we need to check the subarray */
         if( nextPowerDown > (GetEventQueue()->GetCurrentCycle()) || isWriting )
@@ -1196,13 +1604,22 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
     else if( req->type == REFRESH )
     {
         if( nextActivate > ( GetEventQueue()->GetCurrentCycle() ) /* if it is too early to refresh */ 
-            || (state != SUBARRAY_CLOSED && p->UsePrecharge) ) /* or, the subarray is not idle */
+            || (state != SUBARRAY_CLOSED && p->UsePrecharge) /* or, the subarray is not idle */
+            || drainRequest != NULL ) /* or, a buffered write is being drained */
         {
             rv = false;
             if( reason )
               reason->reason = SUBARRAY_TIMING;
         }
     }
+    else if( req->type == CACHED_READ && writeMode == DELAYED_WRITE )
+    {
+        rv = writeBuffer->Contains( req );
+    }
+    else if( req->type == CACHED_WRITE && writeMode == DELAYED_WRITE )
+    {
+        rv = ( writeBuffer->Contains( req ) || !writeBuffer->IsFull( ) );
+    }
     else
     {
         /* 
@@ -1263,6 +1680,9 @@ bool SubArray::IssueCommand( NVMainRequest *req )
                     << "in command queue! " << req->type << std::endl;
                 break;  
         }
+
+        if( rv )
+            lastAccessCycle = GetEventQueue()->GetCurrentCycle();
     }
 
     return rv;
@@ -1270,7 +1690,41 @@ bool SubArray::IssueCommand( NVMainRequest *req )
 
 bool SubArray::RequestComplete( NVMainRequest *req )
 {
-    if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    /* Drains belong to the write buffer and never leave the subarray. */
+    if( req == drainRequest )
+    {
+        isWriting = false;
+        drainRequest = NULL;
+
+        if( req->flags & NVMainRequest::FLAG_PAUSED || req->flags & NVMainRequest::FLAG_CANCELLED )
+        {
+            writeBuffer->DrainStopped( req );
+        }
+        else
+        {
+            averagePausesPerRequest = ((averagePausesPerRequest * static_cast<double>(measuredPauses))
+                                    + req->cancellations) / static_cast<double>(measuredPauses + 1.0);
+            measuredPauses++;
+
+            if( cancelCountMap.count( req->cancellations ) == 0 )
+                cancelCountMap[req->cancellations] = 0;
+            else
+                cancelCountMap[req->cancellations]++;
+
+            /* A line rewritten during the drain is drained again from scratch. */
+            req->flags &= ~NVMainRequest::FLAG_FORCED;
+            req->cancellations = 0;
+
+            writeBuffer->DrainDone( req );
+            writeBufferDrains++;
+        }
+
+        ScheduleDrain( );
+
+        return true;
+    }
+
+    if( ( req->type == WRITE || req->type == WRITE_PRECHARGE ) && writeMode != DELAYED_WRITE )
     {
         /*  
          *  Write-to-write timing causes new writes to come in before the previous completes.
@@ -1387,7 +1841,7 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
             ncycles_t extraLatency;
 
             wordSize = p->BusWidth;
-            wordSize *= p->tBURST * p->RATE;
+            wordSize *= p->nominalBURST * p->RATE;
             wordSize /= 8;
 
             if( request->oldData.IsValid( ) )
@@ -1398,6 +1852,7 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
                      !conf->GetSimInterface( )-> GetDataAtAddress( 
                         request->address.GetPhysicalAddress( ), &oldData ) )
             {
+                oldData.SetSize( wordSize );
                 for( uint64_t i = 0; i < wordSize; i++ )
                   oldData.SetByte( i, 0 );
             }
@@ -1420,13 +1875,7 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
             latency = static_cast<ncycle_t>(extraLatency);
 
             if( hardError )
-            {
-                // TODO: Get extra latency from fault model
-                // latency += ...;
-                std::cout << "WARNING: Write to 0x" << std::hex 
-                    << request->address.GetPhysicalAddress( )
-                    << std::dec << " resulted in a hard error! " << std::endl;
-            }
+                uncorrectableWrites++;
         }
         else
         {
@@ -1466,10 +1915,23 @@ ncounter_t SubArray::GetId( )
     return subArrayId;
 }
 
+/* Energy is accumulated as commands issue, so this is current at any cycle. */
+void SubArray::GetEnergy( double& total, double& activate, double& burst, double& refresh )
+{
+    total = subArrayEnergy;
+    activate = activeEnergy;
+    burst = burstEnergy;
+    refresh = refreshEnergy;
+}
+
 void SubArray::CalculateStats( )
 {
     worstCaseEndurance = endrModel->GetWorstLife( );
     averageEndurance = endrModel->GetAverageLife( );
+    endrModel->CalculateStats( );
+
+    if( dataEncoder )
+        dataEncoder->CalculateStats( );
 
     actWaitAverage = static_cast<double>(actWaitTotal) / static_cast<double>(actWaits);
 
@@ -1561,3 +2023,76 @@ ncounter_t NO_OPT SubArray::CountBitsMLC1( uint8_t value, uint32_t *data, ncount
 
     return count;
 }
+
+/*
+ *  Save the open row along with the endurance and data encoder state. Timing
+ *  is not saved; a restored subarray is ready for any command at once.
+ */
+void SubArray::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        /* Precharges and refreshes complete before the checkpoint is used. */
+        SubArrayState savedState = ( state == SUBARRAY_OPEN ) ? SUBARRAY_OPEN 
+                                                              : SUBARRAY_CLOSED;
+        bool hasEndurance = ( endrModel != NULL );
+        bool hasEncoder = ( dataEncoder != NULL );
+
+        cpt.Write( savedState );
+        cpt.Write( openRow );
+
+        cpt.Write( hasEndurance );
+        if( hasEndurance )
+            endrModel->WriteCheckpoint( cpt );
+
+        cpt.Write( hasEncoder );
+        if( hasEncoder )
+            dataEncoder->WriteCheckpoint( cpt );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void SubArray::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) );
+
+    if( cpt.IsOpen( ) )
+    {
+        SubArrayState savedState = SUBARRAY_CLOSED;
+        bool hasEndurance = false, hasEncoder = false;
+
+        cpt.Read( savedState );
+        cpt.Read( openRow );
+        state = savedState;
+
+        cpt.Read( hasEndurance );
+
+        if( hasEndurance && endrModel == NULL )
+        {
+            /* The encoder state follows and cannot be located without the model. */
+            std::cout << StatName( ) << ": Warning: Checkpoint has endurance state, "
+                      << "but no endurance model is configured. Skipping endurance "
+                      << "and data encoder state." << std::endl;
+        }
+        else
+        {
+            if( hasEndurance )
+                endrModel->ReadCheckpoint( cpt );
+
+            cpt.Read( hasEncoder );
+            if( hasEncoder && dataEncoder != NULL )
+                dataEncoder->ReadCheckpoint( cpt );
+        }
+
+        if( !cpt.Good( ) )
+        {
+            std::cout << StatName( ) << ": Warning: Checkpoint is incomplete." 
+                      << std::endl;
+        }
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
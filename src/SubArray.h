@@ -44,6 +44,7 @@
 #include "include/NVMAddress.h"
 #include "include/NVMainRequest.h"
 #include "src/Params.h"
+#include "src/WriteBuffer.h"
 
 #include <iostream>
 
@@ -102,6 +103,7 @@ class SubArray : public NVMObject
 
     bool Idle( );
     ncycle_t GetDataCycles( ) { return dataCycles; }
+    void GetEnergy( double& total, double& activate, double& burst, double& refresh );
 
     ncycle_t GetNextActivate( ) { return nextActivate; }
     ncycle_t GetNextRead( ) { return nextRead; }
@@ -109,6 +111,7 @@ class SubArray : public NVMObject
     ncycle_t GetNextPrecharge( ) { return nextPrecharge; }
     ncycle_t GetActiveWaits( ) { return actWaits; }
     uint64_t GetOpenRow( ) { return openRow; }
+    EnduranceModel *GetEnduranceModel( ) { return endrModel; }
 
     void SetName( std::string );
     void SetId( ncounter_t );
@@ -116,12 +119,21 @@ class SubArray : public NVMObject
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
     ncounter_t GetId( );
     std::string GetName( );
 
     void Cycle( ncycle_t );
     bool IsWriting( ) { return isWriting; }
 
+    /* A bank-wide buffer shared by all subarrays; must be set before SetConfig. */
+    void SetWriteBuffer( WriteBuffer *buffer ) { writeBuffer = buffer; }
+    WriteBuffer *GetWriteBuffer( ) { return writeBuffer; }
+    bool IsBuffered( NVMainRequest *request );
+    void DrainCallback( void *data );
+
   private:
     Config *conf;
     ncounter_t psInterval;
@@ -154,6 +166,12 @@ class SubArray : public NVMObject
     ncycle_t nextReadPreWrite;
     ncycle_t nextWritePreWrite;
     ncycle_t nextPowerDownPreWrite;
+    WriteBuffer *writeBuffer;
+    bool ownsWriteBuffer;
+    NVMainRequest *drainRequest;
+    ncycle_t lastAccessCycle;
+    ncycle_t nextDrainWakeup;
+    ncycle_t lastFullStall;
     ncounter_t dataCycles;
     ncycle_t worstCaseWrite;
     ncounter_t num00Writes;
@@ -172,6 +190,16 @@ class SubArray : public NVMObject
     ncounter_t cancelledWriteTime;
     ncounter_t pausedWrites;
 
+    ncounter_t writeBufferWrites;
+    ncounter_t writeBufferCoalesced;
+    ncounter_t writeBufferReadHits;
+    ncounter_t writeBufferDrains;
+    ncounter_t writeBufferDrainActivates;
+    ncounter_t writeBufferFullStalls;
+    ncounter_t writeBufferMaxOccupancy;
+    double writeBufferAverageOccupancy;
+    ncounter_t writeBufferCapacity;
+
     ncounter_t actWaits;
     ncounter_t actWaitTotal;
     double actWaitAverage;
@@ -183,6 +211,7 @@ class SubArray : public NVMObject
     double refreshEnergy;
 
     uint64_t worstCaseEndurance, averageEndurance;
+    ncounter_t uncorrectableReads, uncorrectableWrites;
 
     ncounter_t reads, writes, activates, precharges, refreshes;
     ncounter_t idleTimer;
@@ -205,6 +234,12 @@ class SubArray : public NVMObject
 
     ncycle_t WriteCellData( NVMainRequest *request );
     void CheckWritePausing( );
+    NVM::Event *CreateWriteEvent( NVMainRequest *request );
+
+    bool BufferWrite( NVMainRequest *request );
+    void ScheduleDrain( );
+    void StartDrain( NVMainRequest *request );
+    ncounter_t CountUnchangedBits( NVMainRequest *request );
 
     ncycle_t UpdateEndurance( NVMainRequest *request );
 
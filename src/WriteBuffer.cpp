@@ -0,0 +1,188 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/WriteBuffer.h"
+
+#include <cassert>
+
+using namespace NVM;
+
+WriteBuffer::WriteBuffer( ncounter_t entries )
+{
+    capacity = entries;
+}
+
+WriteBuffer::~WriteBuffer( )
+{
+    std::list<WriteBufferEntry>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); it++ )
+        delete it->request;
+}
+
+std::list<WriteBufferEntry>::iterator WriteBuffer::Find( uint64_t address )
+{
+    std::list<WriteBufferEntry>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); it++ )
+    {
+        if( it->request->address.GetPhysicalAddress( ) == address )
+            break;
+    }
+
+    return it;
+}
+
+bool WriteBuffer::Contains( NVMainRequest *request )
+{
+    return ( Find( request->address.GetPhysicalAddress( ) ) != entries.end( ) );
+}
+
+bool WriteBuffer::IsFull( )
+{
+    return ( entries.size( ) >= capacity );
+}
+
+ncounter_t WriteBuffer::GetOccupancy( )
+{
+    return entries.size( );
+}
+
+ncounter_t WriteBuffer::GetCapacity( )
+{
+    return capacity;
+}
+
+bool WriteBuffer::Insert( NVMainRequest *request )
+{
+    std::list<WriteBufferEntry>::iterator it = Find( request->address.GetPhysicalAddress( ) );
+
+    /* Merge; the old data of the first write still describes the cells. */
+    if( it != entries.end( ) )
+    {
+        it->request->data = request->data;
+        if( it->draining )
+            it->rewritten = true;
+
+        return false;
+    }
+
+    assert( !IsFull( ) );
+
+    WriteBufferEntry entry;
+
+    entry.request = new NVMainRequest( );
+    *(entry.request) = *request;
+    entry.request->type = WRITE;
+    entry.request->flags = 0;
+    entry.request->cancellations = 0;
+    entry.request->writeProgress = 0;
+    entry.draining = false;
+    entry.rewritten = false;
+
+    entries.push_back( entry );
+
+    return true;
+}
+
+bool WriteBuffer::HasDrain( ncounter_t subArray )
+{
+    std::list<WriteBufferEntry>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); it++ )
+    {
+        if( !it->draining && it->request->address.GetSubArray( ) == subArray )
+            return true;
+    }
+
+    return false;
+}
+
+NVMainRequest *WriteBuffer::NextDrain( ncounter_t subArray )
+{
+    std::list<WriteBufferEntry>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); it++ )
+    {
+        if( !it->draining && it->request->address.GetSubArray( ) == subArray )
+        {
+            it->draining = true;
+            return it->request;
+        }
+    }
+
+    return NULL;
+}
+
+void WriteBuffer::DrainDone( NVMainRequest *drainRequest )
+{
+    std::list<WriteBufferEntry>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); it++ )
+    {
+        if( it->request == drainRequest )
+            break;
+    }
+
+    assert( it != entries.end( ) );
+
+    if( it->rewritten )
+    {
+        it->draining = false;
+        it->rewritten = false;
+    }
+    else
+    {
+        delete it->request;
+        entries.erase( it );
+    }
+}
+
+void WriteBuffer::DrainStopped( NVMainRequest *drainRequest )
+{
+    std::list<WriteBufferEntry>::iterator it;
+
+    for( it = entries.begin( ); it != entries.end( ); it++ )
+    {
+        if( it->request == drainRequest )
+        {
+            /* Newer data has to be programmed from the start. */
+            if( it->rewritten )
+                it->request->flags &= ~NVMainRequest::FLAG_PAUSED;
+
+            it->draining = false;
+            it->rewritten = false;
+            break;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __WRITEBUFFER_H__
+#define __WRITEBUFFER_H__
+
+#include "include/NVMainRequest.h"
+#include "include/NVMTypes.h"
+
+#include <list>
+
+namespace NVM {
+
+struct WriteBufferEntry
+{
+    NVMainRequest *request;
+    bool draining;
+    bool rewritten;
+};
+
+/*
+ *  SRAM write buffer of the DelayedWrite mode. Writes complete once they
+ *  are buffered and reads of buffered lines are forwarded; each subarray
+ *  drains its own entries to the cells in the background, oldest first.
+ *  A buffer may be private to a subarray or shared by a whole bank.
+ */
+class WriteBuffer
+{
+  public:
+    WriteBuffer( ncounter_t entries );
+    ~WriteBuffer( );
+
+    bool Contains( NVMainRequest *request );
+    bool IsFull( );
+    ncounter_t GetOccupancy( );
+    ncounter_t GetCapacity( );
+
+    /* Buffer a copy of the write. Returns false if it merged into a buffered line. */
+    bool Insert( NVMainRequest *request );
+
+    /* Whether the subarray has entries that are not being drained. */
+    bool HasDrain( ncounter_t subArray );
+    /* Oldest entry of the subarray that is not being drained, or NULL. */
+    NVMainRequest *NextDrain( ncounter_t subArray );
+    /* The cells were programmed; the entry is freed unless it was rewritten meanwhile. */
+    void DrainDone( NVMainRequest *drainRequest );
+    /* The drain was paused or cancelled; the entry stays for a later drain. */
+    void DrainStopped( NVMainRequest *drainRequest );
+
+  private:
+    ncounter_t capacity;
+    std::list<WriteBufferEntry> entries;
+
+    std::list<WriteBufferEntry>::iterator Find( uint64_t address );
+};
+
+};
+
+#endif
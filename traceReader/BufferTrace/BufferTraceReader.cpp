@@ -0,0 +1,171 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/BufferTrace/BufferTraceReader.h"
+#include <cassert>
+
+using namespace NVM;
+
+TraceBuffer::TraceBuffer( )
+{
+}
+
+TraceBuffer::~TraceBuffer( )
+{
+    for( size_t i = 0; i < lines.size( ); i++ )
+        delete lines[i];
+}
+
+/*
+ *  Decode the whole trace from reader. Data is dropped when ignoreData is set
+ *  to keep the buffer small. If lastCycle is non-zero, decoding stops after
+ *  the first line past that cycle since it can never be issued.
+ */
+ncounter_t TraceBuffer::Load( GenericTraceReader *reader, bool ignoreData, 
+                              ncycle_t lastCycle )
+{
+    TraceLine *decoded = new TraceLine( );
+
+    while( reader->GetNextAccess( decoded ) )
+    {
+        TraceLine *line = new TraceLine( );
+
+        if( ignoreData )
+        {
+            NVMDataBlock emptyData, emptyOldData;
+
+            line->SetLine( decoded->GetAddress( ), decoded->get_program_counter( ),
+                           decoded->GetOperation( ), decoded->GetCycle( ),
+                           emptyData, emptyOldData, decoded->GetThreadId( ) );
+        }
+        else
+        {
+            line->SetLine( decoded->GetAddress( ), decoded->get_program_counter( ),
+                           decoded->GetOperation( ), decoded->GetCycle( ),
+                           decoded->GetData( ), decoded->GetOldData( ), 
+                           decoded->GetThreadId( ) );
+        }
+
+        lines.push_back( line );
+
+        if( lastCycle != 0 && decoded->GetCycle( ) > lastCycle )
+            break;
+    }
+
+    delete decoded;
+
+    return lines.size( );
+}
+
+ncounter_t TraceBuffer::GetLineCount( )
+{
+    return lines.size( );
+}
+
+TraceLine *TraceBuffer::GetLine( ncounter_t index )
+{
+    assert( index < lines.size( ) );
+
+    return lines[index];
+}
+
+BufferTraceReader::BufferTraceReader( TraceBuffer *buffer )
+{
+    this->buffer = buffer;
+    position = 0;
+    traceFile = "";
+}
+
+BufferTraceReader::~BufferTraceReader( )
+{
+}
+
+void BufferTraceReader::SetTraceFile( std::string file )
+{
+    /* The trace was already decoded into the buffer. */
+    traceFile = file;
+}
+
+std::string BufferTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+bool BufferTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( position >= buffer->GetLineCount( ) )
+    {
+        NVMAddress nAddress;
+        NVMDataBlock dataBlock, oldDataBlock;
+
+        nextAccess->SetLine( nAddress, 0, NOP, 0, dataBlock, oldDataBlock, 0 );
+        return false;
+    }
+
+    TraceLine *line = buffer->GetLine( position );
+
+    nextAccess->SetLine( line->GetAddress( ), line->get_program_counter( ),
+                         line->GetOperation( ), line->GetCycle( ),
+                         line->GetData( ), line->GetOldData( ), 
+                         line->GetThreadId( ) );
+
+    position++;
+
+    return true;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int BufferTraceReader::GetNextNAccesses( unsigned int N, 
+                                         std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        TraceLine *nextLine = new TraceLine( );
+
+        if( !GetNextAccess( nextLine ) )
+        {
+            delete nextLine;
+            break;
+        }
+
+        nextAccesses->push_back( nextLine );
+        successes++;
+    }
+
+    return successes;
+}
@@ -40,12 +40,16 @@
 
 namespace NVM {
 
+class Config;
+
 class GenericTraceReader
 {
   public:
     GenericTraceReader( ) { }
 
     virtual ~GenericTraceReader( ) { }
+
+    virtual void SetConfig( Config * /*conf*/ ) { }
     virtual void SetTraceFile( std::string file ) = 0;
 
     virtual std::string GetTraceFile( ) = 0;
@@ -105,7 +105,7 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
     {
         NVMAddress nAddress;
         nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
-        nextAccess->SetLine( nAddress, NOP, 0, dataBlock, oldDataBlock, 0 );
+        nextAccess->SetLine( nAddress, 0, NOP, 0, dataBlock, oldDataBlock, 0 );
         std::cout << "NVMainTraceReader: Reached EOF!" << std::endl;
         return false;
     }
@@ -246,7 +246,8 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
 
     nAddress.SetPhysicalAddress( address );
 
-    nextAccess->SetLine( nAddress, operation, cycle, dataBlock, oldDataBlock, threadId );
+    nextAccess->SetLine( nAddress, 0, operation, cycle, dataBlock, 
+                         oldDataBlock, threadId );
 
     return true;
 }
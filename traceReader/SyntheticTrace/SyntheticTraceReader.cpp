@@ -0,0 +1,492 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/SyntheticTrace/SyntheticTraceReader.h"
+#include "src/Config.h"
+#include "src/Params.h"
+#include "src/TranslationMethod.h"
+#include "include/NVMHelpers.h"
+#include <sstream>
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+
+using namespace NVM;
+
+/* Size of one generated access, matching the default translator burst. */
+static const uint64_t syntheticLineSize = 64;
+
+SyntheticTraceReader::SyntheticTraceReader( )
+{
+    traceFile = "";
+
+    pattern = PATTERN_RANDOM;
+    dataMode = DATA_NONE;
+    seed = 1;
+    counter = 0;
+
+    baseAddress = 0;
+    footprintLines = 1 << 20;
+    strideLines = 64;
+    requestLimit = 1000000;
+    requestCount = 0;
+    interArrival = 10;
+    readRatio = 0.7;
+    rowHitRate = -1.0;
+    dataPattern = 0;
+
+    streams = 1;
+
+    zipfAlpha = 0.99;
+    zipfHIntegralX1 = 0.0;
+    zipfHIntegralN = 0.0;
+    zipfS = 0.0;
+
+    translator = NULL;
+    rowCount = 1;
+    colCount = 1;
+
+    streamLine.resize( streams, 0 );
+    lastAddress.resize( streams, 0 );
+    lastValid.resize( streams, false );
+}
+
+SyntheticTraceReader::~SyntheticTraceReader( )
+{
+    if( translator != NULL )
+    {
+        delete translator->GetTranslationMethod( );
+        delete translator;
+    }
+}
+
+void SyntheticTraceReader::SetConfig( Config *conf )
+{
+    Params *params = new Params( );
+    ncounter_t rows, subarrays;
+
+    params->SetParams( conf );
+
+    /* Build the same decoder the memory uses so row locality is exact. */
+    if( conf->KeyExists( "MATHeight" ) )
+    {
+        rows = params->MATHeight;
+        subarrays = params->ROWS / params->MATHeight;
+    }
+    else
+    {
+        rows = params->ROWS;
+        subarrays = 1;
+    }
+
+    TranslationMethod *method = new TranslationMethod( );
+
+    method->SetBitWidths( NVM::mlog2( rows ), 
+                          NVM::mlog2( params->COLS ), 
+                          NVM::mlog2( params->BANKS ), 
+                          NVM::mlog2( params->RANKS ), 
+                          NVM::mlog2( params->CHANNELS ), 
+                          NVM::mlog2( subarrays ) );
+    method->SetCount( rows, params->COLS, params->BANKS, params->RANKS, 
+                      params->CHANNELS, subarrays );
+    method->SetAddressMappingScheme( params->AddressMappingScheme );
+
+    if( translator != NULL )
+    {
+        delete translator->GetTranslationMethod( );
+        delete translator;
+    }
+
+    translator = new AddressTranslator( );
+    translator->SetTranslationMethod( method );
+    translator->SetDefaultField( CHANNEL_FIELD );
+
+    rowCount = rows;
+    colCount = params->COLS;
+    footprintLines = rows * subarrays * params->COLS * params->BANKS 
+                   * params->RANKS * params->CHANNELS;
+
+    delete params;
+
+    if( conf->KeyExists( "SyntheticPattern" ) )
+    {
+        std::string patternName = conf->GetString( "SyntheticPattern" );
+
+        if( patternName == "Sequential" )
+            pattern = PATTERN_SEQUENTIAL;
+        else if( patternName == "Strided" )
+            pattern = PATTERN_STRIDED;
+        else if( patternName == "Random" )
+            pattern = PATTERN_RANDOM;
+        else if( patternName == "Zipf" )
+            pattern = PATTERN_ZIPF;
+        else
+            std::cout << "SyntheticTraceReader: Unknown pattern `" << patternName
+                << "'. Using Random." << std::endl;
+    }
+
+    if( conf->KeyExists( "SyntheticSeed" ) )
+        seed = conf->GetValueUL( "SyntheticSeed" );
+
+    if( conf->KeyExists( "SyntheticRequests" ) )
+        requestLimit = conf->GetValueUL( "SyntheticRequests" );
+
+    if( conf->KeyExists( "SyntheticInterArrival" ) )
+        interArrival = conf->GetValueUL( "SyntheticInterArrival" );
+
+    if( conf->KeyExists( "SyntheticBaseAddress" ) )
+        baseAddress = conf->GetValueUL( "SyntheticBaseAddress" );
+
+    if( conf->KeyExists( "SyntheticFootprint" ) )
+        footprintLines = conf->GetValueUL( "SyntheticFootprint" ) / syntheticLineSize;
+
+    if( conf->KeyExists( "SyntheticStride" ) )
+        strideLines = conf->GetValueUL( "SyntheticStride" ) / syntheticLineSize;
+
+    if( conf->KeyExists( "SyntheticStreams" ) )
+        streams = conf->GetValueUL( "SyntheticStreams" );
+
+    if( conf->KeyExists( "SyntheticReadRatio" ) )
+        readRatio = conf->GetEnergy( "SyntheticReadRatio" );
+
+    if( conf->KeyExists( "SyntheticRowHitRate" ) )
+        rowHitRate = conf->GetEnergy( "SyntheticRowHitRate" );
+
+    if( conf->KeyExists( "SyntheticZipfAlpha" ) )
+        zipfAlpha = conf->GetEnergy( "SyntheticZipfAlpha" );
+
+    if( conf->KeyExists( "SyntheticData" ) )
+    {
+        std::string dataName = conf->GetString( "SyntheticData" );
+
+        if( dataName == "None" )
+        {
+            dataMode = DATA_NONE;
+        }
+        else if( dataName == "Random" )
+        {
+            dataMode = DATA_RANDOM;
+        }
+        else if( dataName == "Pattern" )
+        {
+            dataMode = DATA_PATTERN;
+
+            if( conf->KeyExists( "SyntheticDataPattern" ) )
+            {
+                std::stringstream fmat;
+
+                fmat << std::hex << conf->GetString( "SyntheticDataPattern" );
+                fmat >> dataPattern;
+            }
+        }
+        else
+        {
+            std::cout << "SyntheticTraceReader: Unknown data mode `" << dataName
+                << "'. Using None." << std::endl;
+        }
+    }
+
+    if( footprintLines == 0 )
+        footprintLines = 1;
+    if( strideLines == 0 )
+        strideLines = 1;
+    if( streams == 0 )
+        streams = 1;
+
+    /* Spread the streams evenly over the footprint. */
+    streamLine.assign( streams, 0 );
+    lastAddress.assign( streams, 0 );
+    lastValid.assign( streams, false );
+
+    for( ncounter_t stream = 0; stream < streams; stream++ )
+        streamLine[stream] = ( footprintLines / streams ) * stream;
+
+    InitZipf( );
+}
+
+void SyntheticTraceReader::SetTraceFile( std::string file )
+{
+    /* There is no file to read. The name is only kept for reference. */
+    traceFile = file;
+}
+
+std::string SyntheticTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+/*
+ *  Counter-based generator (SplitMix64 applied to seed + counter). Each value
+ *  depends only on the seed and its index, so runs are reproducible.
+ */
+uint64_t SyntheticTraceReader::Random( )
+{
+    uint64_t z = seed + ( ++counter ) * 0x9E3779B97F4A7C15ULL;
+
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+
+    return z ^ ( z >> 31 );
+}
+
+double SyntheticTraceReader::RandomDouble( )
+{
+    /* Uniform in [0, 1) using the upper 53 bits. */
+    return static_cast<double>( Random( ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+bool SyntheticTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    NVMAddress nAddress;
+    NVMDataBlock dataBlock;
+    NVMDataBlock oldDataBlock;
+
+    if( requestLimit != 0 && requestCount >= requestLimit )
+    {
+        nextAccess->SetLine( nAddress, 0, NOP, 0, dataBlock, oldDataBlock, 0 );
+        return false;
+    }
+
+    ncounter_t stream = requestCount % streams;
+    uint64_t address = baseAddress + NextLine( stream ) * syntheticLineSize;
+
+    address = ApplyRowLocality( stream, address );
+
+    OpType operation = ( RandomDouble( ) < readRatio ) ? READ : WRITE;
+
+    if( dataMode != DATA_NONE )
+    {
+        dataBlock.SetSize( syntheticLineSize );
+        FillData( dataBlock );
+
+        oldDataBlock.SetSize( syntheticLineSize );
+        memset( oldDataBlock.rawData, 0, syntheticLineSize );
+    }
+
+    nAddress.SetPhysicalAddress( address );
+
+    nextAccess->SetLine( nAddress, 0, operation, requestCount * interArrival, 
+                         dataBlock, oldDataBlock, static_cast<ncounters_t>( stream ) );
+
+    requestCount++;
+
+    return true;
+}
+
+/*
+ *  Return the next line index within the footprint for the given stream.
+ */
+uint64_t SyntheticTraceReader::NextLine( ncounter_t stream )
+{
+    uint64_t line = 0;
+
+    switch( pattern )
+    {
+        case PATTERN_SEQUENTIAL:
+            line = streamLine[stream];
+            streamLine[stream] = ( line + 1 ) % footprintLines;
+            break;
+
+        case PATTERN_STRIDED:
+            line = streamLine[stream];
+            streamLine[stream] = ( line + strideLines ) % footprintLines;
+            break;
+
+        case PATTERN_ZIPF:
+            /* Scatter ranks so the hot lines are not all in one row. */
+            line = ( ( SampleZipf( ) - 1 ) * 2654435761ULL ) % footprintLines;
+            break;
+
+        case PATTERN_RANDOM:
+        default:
+            line = Random( ) % footprintLines;
+            break;
+    }
+
+    return line;
+}
+
+/*
+ *  If a row hit rate is set, either keep the row of this stream's previous
+ *  access (choosing a new column) or force a different row, so the fraction
+ *  of same-row accesses per stream matches the target.
+ */
+uint64_t SyntheticTraceReader::ApplyRowLocality( ncounter_t stream, uint64_t address )
+{
+    if( rowHitRate < 0.0 || translator == NULL )
+        return address;
+
+    if( lastValid[stream] )
+    {
+        uint64_t row, col, bank, rank, channel, subarray;
+        uint64_t lastRow, lastCol, lastBank, lastRank, lastChannel, lastSubarray;
+
+        translator->Translate( lastAddress[stream], &lastRow, &lastCol, &lastBank,
+                               &lastRank, &lastChannel, &lastSubarray );
+
+        if( RandomDouble( ) < rowHitRate )
+        {
+            col = Random( ) % colCount;
+            address = translator->ReverseTranslate( lastRow, col, lastBank, lastRank,
+                                                    lastChannel, lastSubarray );
+        }
+        else
+        {
+            translator->Translate( address, &row, &col, &bank, &rank, &channel, &subarray );
+
+            if( row == lastRow && bank == lastBank && rank == lastRank
+                && channel == lastChannel && subarray == lastSubarray )
+            {
+                row = ( row + 1 ) % rowCount;
+                address = translator->ReverseTranslate( row, col, bank, rank,
+                                                        channel, subarray );
+            }
+        }
+    }
+
+    lastAddress[stream] = address;
+    lastValid[stream] = true;
+
+    return address;
+}
+
+void SyntheticTraceReader::FillData( NVMDataBlock& block )
+{
+    uint64_t *rawData = reinterpret_cast<uint64_t*>(block.rawData);
+
+    for( uint64_t word = 0; word < syntheticLineSize / sizeof(uint64_t); word++ )
+    {
+        if( dataMode == DATA_RANDOM )
+            rawData[word] = Random( );
+        else
+            rawData[word] = dataPattern;
+    }
+}
+
+/*
+ *  Zipf sampling uses rejection-inversion (Hormann and Derflinger), which
+ *  needs no per-element table and takes O(1) time for any footprint.
+ */
+void SyntheticTraceReader::InitZipf( )
+{
+    if( zipfAlpha <= 0.0 )
+        return;
+
+    double n = static_cast<double>( footprintLines );
+
+    zipfHIntegralX1 = ZipfHIntegral( 1.5 ) - 1.0;
+    zipfHIntegralN = ZipfHIntegral( n + 0.5 );
+    zipfS = 2.0 - ZipfHIntegralInverse( ZipfHIntegral( 2.5 ) - ZipfH( 2.0 ) );
+}
+
+uint64_t SyntheticTraceReader::SampleZipf( )
+{
+    /* An exponent of zero is a uniform distribution. */
+    if( zipfAlpha <= 0.0 )
+        return ( Random( ) % footprintLines ) + 1;
+
+    while( true )
+    {
+        double u = zipfHIntegralN + RandomDouble( ) * ( zipfHIntegralX1 - zipfHIntegralN );
+        double x = ZipfHIntegralInverse( u );
+        uint64_t k = static_cast<uint64_t>( x + 0.5 );
+
+        if( k < 1 )
+            k = 1;
+        else if( k > footprintLines )
+            k = footprintLines;
+
+        double kd = static_cast<double>( k );
+
+        if( kd - x <= zipfS || u >= ZipfHIntegral( kd + 0.5 ) - ZipfH( kd ) )
+            return k;
+    }
+}
+
+double SyntheticTraceReader::ZipfH( double x )
+{
+    return std::exp( -zipfAlpha * std::log( x ) );
+}
+
+double SyntheticTraceReader::ZipfHIntegral( double x )
+{
+    double logX = std::log( x );
+    double t = ( 1.0 - zipfAlpha ) * logX;
+
+    /* expm1(t)/t, with a series expansion near zero (alpha close to 1). */
+    double helper = ( std::fabs( t ) > 1e-8 ) ? std::expm1( t ) / t 
+                  : 1.0 + t * 0.5 * ( 1.0 + t / 3.0 * ( 1.0 + 0.25 * t ) );
+
+    return helper * logX;
+}
+
+double SyntheticTraceReader::ZipfHIntegralInverse( double x )
+{
+    double t = x * ( 1.0 - zipfAlpha );
+
+    if( t < -1.0 )
+        t = -1.0;
+
+    /* log1p(t)/t, with a series expansion near zero. */
+    double helper = ( std::fabs( t ) > 1e-8 ) ? std::log1p( t ) / t 
+                  : 1.0 - t * ( 0.5 - t * ( 1.0 / 3.0 - 0.25 * t ) );
+
+    return std::exp( helper * x );
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int SyntheticTraceReader::GetNextNAccesses( unsigned int N, 
+                                            std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        TraceLine *nextLine = new TraceLine( );
+
+        if( !GetNextAccess( nextLine ) )
+        {
+            delete nextLine;
+            break;
+        }
+
+        nextAccesses->push_back( nextLine );
+        successes++;
+    }
+
+    return successes;
+}
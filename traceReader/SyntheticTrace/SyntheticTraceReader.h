@@ -0,0 +1,128 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SYNTHETICTRACEREADER_H__
+#define __SYNTHETICTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include "src/AddressTranslator.h"
+#include <string>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Generates memory accesses on the fly instead of reading a trace file. All
+ *  parameters are taken from the configuration file (Synthetic* keys). The
+ *  random stream is a counter-based generator, so a given seed always yields
+ *  the same accesses regardless of how they are consumed.
+ */
+class SyntheticTraceReader : public GenericTraceReader
+{
+  public:
+    SyntheticTraceReader( );
+    ~SyntheticTraceReader( );
+
+    void SetConfig( Config *conf );
+
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+    
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccess );
+  
+  private:
+    enum SyntheticPattern
+    {
+        PATTERN_SEQUENTIAL,
+        PATTERN_STRIDED,
+        PATTERN_RANDOM,
+        PATTERN_ZIPF
+    };
+
+    enum SyntheticData
+    {
+        DATA_NONE,
+        DATA_RANDOM,
+        DATA_PATTERN
+    };
+
+    std::string traceFile;
+
+    SyntheticPattern pattern;
+    SyntheticData dataMode;
+    uint64_t seed;
+    uint64_t counter;
+
+    uint64_t baseAddress;
+    uint64_t footprintLines;
+    uint64_t strideLines;
+    uint64_t requestLimit;
+    uint64_t requestCount;
+    ncycle_t interArrival;
+    double readRatio;
+    double rowHitRate;
+    uint64_t dataPattern;
+
+    ncounter_t streams;
+    std::vector<uint64_t> streamLine;
+    std::vector<uint64_t> lastAddress;
+    std::vector<bool> lastValid;
+
+    /* Zipf rejection-inversion constants. */
+    double zipfAlpha;
+    double zipfHIntegralX1;
+    double zipfHIntegralN;
+    double zipfS;
+
+    AddressTranslator *translator;
+    uint64_t rowCount;
+    uint64_t colCount;
+
+    uint64_t Random( );
+    double RandomDouble( );
+
+    uint64_t NextLine( ncounter_t stream );
+    uint64_t ApplyRowLocality( ncounter_t stream, uint64_t address );
+    void FillData( NVMDataBlock& block );
+
+    void InitZipf( );
+    uint64_t SampleZipf( );
+    double ZipfH( double x );
+    double ZipfHIntegral( double x );
+    double ZipfHIntegralInverse( double x );
+};
+
+};
+
+#endif
@@ -37,6 +37,7 @@
 /* Add your trace reader's include below. */
 #include "traceReader/NVMainTrace/NVMainTraceReader.h"
 #include "traceReader/RubyTrace/RubyTraceReader.h"
+#include "traceReader/SyntheticTrace/SyntheticTraceReader.h"
 
 using namespace NVM;
 
@@ -52,6 +53,8 @@ GenericTraceReader *TraceReaderFactory::CreateNewTraceReader( std::string reader
         tracer = new NVMainTraceReader( );
     else if( reader == "RubyTrace" )
         tracer = new RubyTraceReader( );
+    else if( reader == "SyntheticTrace" )
+        tracer = new SyntheticTraceReader( );
 
     if( tracer == NULL )
         std::cout << "NVMain: Unknown trace reader `" << reader << "'." 
@@ -0,0 +1,505 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceSim/TraceCore.h"
+#include "src/EventQueue.h"
+#include "include/NVMainRequest.h"
+
+#include <cassert>
+#include <limits>
+
+using namespace NVM;
+
+TraceDemultiplexer::TraceDemultiplexer( GenericTraceReader *reader, ncounter_t cores )
+{
+    this->reader = reader;
+    numCores = cores;
+    traceEnded = false;
+
+    pendingLines.resize( numCores );
+}
+
+TraceDemultiplexer::~TraceDemultiplexer( )
+{
+    for( ncounter_t core = 0; core < numCores; core++ )
+    {
+        while( !pendingLines[core].empty( ) )
+        {
+            delete pendingLines[core].front( );
+            pendingLines[core].pop_front( );
+        }
+    }
+}
+
+/*
+ *  Return the next line for the given core. Lines belonging to other cores
+ *  that are read along the way are buffered. If one core lags far behind the
+ *  others this buffer can grow large, so prefer one trace per core for long
+ *  and highly unbalanced workloads.
+ */
+bool TraceDemultiplexer::GetNextAccess( ncounter_t core, TraceLine *nextAccess )
+{
+    assert( core < numCores );
+
+    if( pendingLines[core].empty( ) )
+    {
+        while( !traceEnded )
+        {
+            TraceLine *line = new TraceLine( );
+
+            if( !reader->GetNextAccess( line ) )
+            {
+                delete line;
+                traceEnded = true;
+                break;
+            }
+
+            ncounter_t lineCore = static_cast<ncounter_t>( line->GetThreadId( ) ) % numCores;
+
+            pendingLines[lineCore].push_back( line );
+
+            if( lineCore == core )
+                break;
+        }
+    }
+
+    if( pendingLines[core].empty( ) )
+        return false;
+
+    TraceLine *line = pendingLines[core].front( );
+    pendingLines[core].pop_front( );
+
+    nextAccess->SetLine( line->GetAddress( ), line->get_program_counter( ),
+                         line->GetOperation( ), line->GetCycle( ),
+                         line->GetData( ), line->GetOldData( ), 
+                         line->GetThreadId( ) );
+
+    delete line;
+
+    return true;
+}
+
+CoreTraceReader::CoreTraceReader( TraceDemultiplexer *demux, ncounter_t core )
+{
+    this->demux = demux;
+    coreId = core;
+    traceFile = "";
+}
+
+CoreTraceReader::~CoreTraceReader( )
+{
+}
+
+void CoreTraceReader::SetTraceFile( std::string file )
+{
+    /* The demultiplexer owns the real trace file. */
+    traceFile = file;
+}
+
+std::string CoreTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+bool CoreTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    return demux->GetNextAccess( coreId, nextAccess );
+}
+
+int CoreTraceReader::GetNextNAccesses( unsigned int N, 
+                                       std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        TraceLine *nextLine = new TraceLine( );
+
+        if( !GetNextAccess( nextLine ) )
+        {
+            delete nextLine;
+            break;
+        }
+
+        nextAccesses->push_back( nextLine );
+        successes++;
+    }
+
+    return successes;
+}
+
+TraceCore::TraceCore( ncounter_t id )
+{
+    coreId = id;
+    trace = NULL;
+    nextLine = new TraceLine( );
+    lineValid = false;
+    traceEnded = false;
+    ignoreData = false;
+    ignoreTraceCycle = false;
+
+    mshrCount = 16;
+    robSize = 192;
+    issueWidth = 1;
+    traceIPC = 1.0;
+
+    firstPosition = 0;
+    lastPosition = 0;
+    lastIssueCycle = 0;
+    readyCycle = 0;
+    lastActiveCycle = 0;
+    started = false;
+
+    stallReason = STALL_NONE;
+    stallStart = 0;
+
+    outstanding = 0;
+
+    reads = 0;
+    writes = 0;
+    instructions = 0;
+    elapsedCycles = 0;
+    ipc = 0.0;
+    mshrStallCycles = 0;
+    robStallCycles = 0;
+    memoryStallCycles = 0;
+    peakOutstanding = 0;
+    completedReads = 0;
+    totalReadLatency = 0;
+    averageReadLatency = 0.0;
+}
+
+TraceCore::~TraceCore( )
+{
+    delete nextLine;
+}
+
+void TraceCore::SetConfig( Config *conf )
+{
+    if( conf->KeyExists( "CoreMSHRs" ) )
+        mshrCount = static_cast<ncounter_t>( conf->GetValue( "CoreMSHRs" ) );
+
+    if( conf->KeyExists( "CoreROBSize" ) )
+        robSize = static_cast<ncounter_t>( conf->GetValue( "CoreROBSize" ) );
+
+    if( conf->KeyExists( "CoreIssueWidth" ) )
+        issueWidth = static_cast<ncounter_t>( conf->GetValue( "CoreIssueWidth" ) );
+
+    if( conf->KeyExists( "CoreTraceIPC" ) )
+        traceIPC = conf->GetEnergy( "CoreTraceIPC" );
+
+    if( conf->KeyExists( "IgnoreData" ) && conf->GetString( "IgnoreData" ) == "true" )
+        ignoreData = true;
+
+    if( conf->KeyExists( "IgnoreTraceCycle" ) && conf->GetString( "IgnoreTraceCycle" ) == "true" )
+        ignoreTraceCycle = true;
+
+    assert( mshrCount > 0 && issueWidth > 0 );
+}
+
+void TraceCore::SetTraceReader( GenericTraceReader *reader )
+{
+    trace = reader;
+}
+
+void TraceCore::RegisterStats( )
+{
+    AddStat(reads);
+    AddStat(writes);
+    AddStat(instructions);
+    AddStat(elapsedCycles);
+    AddStat(ipc);
+    AddStat(mshrStallCycles);
+    AddStat(robStallCycles);
+    AddStat(memoryStallCycles);
+    AddStat(peakOutstanding);
+    AddStat(averageReadLatency);
+}
+
+/*
+ *  Read the next line of this core's trace and compute when it is ready to
+ *  issue assuming the compute time between two accesses is unchanged.
+ */
+bool TraceCore::FetchLine( )
+{
+    if( traceEnded )
+        return false;
+
+    if( !trace->GetNextAccess( nextLine ) )
+    {
+        traceEnded = true;
+        return false;
+    }
+
+    ncycle_t position = nextLine->GetCycle( );
+
+    if( ignoreTraceCycle || ( started && position < lastPosition ) )
+        position = lastPosition;
+
+    if( !started )
+    {
+        firstPosition = position;
+        lastPosition = position;
+        lastIssueCycle = position;
+        lastActiveCycle = position;
+        started = true;
+    }
+
+    readyCycle = lastIssueCycle + ( position - lastPosition );
+    lastPosition = position;
+    lineValid = true;
+
+    return true;
+}
+
+TraceCore::StallReason TraceCore::CheckStall( )
+{
+    StallReason rv = STALL_NONE;
+
+    if( outstandingReads.size( ) >= mshrCount )
+    {
+        rv = STALL_MSHR;
+    }
+    else if( !outstandingReads.empty( ) 
+             && static_cast<double>( lastPosition - *outstandingReads.begin( ) ) * traceIPC
+                > static_cast<double>( robSize ) )
+    {
+        rv = STALL_ROB;
+    }
+
+    return rv;
+}
+
+void TraceCore::EndStall( ncycle_t currentCycle )
+{
+    if( stallReason != STALL_NONE && currentCycle > stallStart )
+    {
+        ncycle_t stallCycles = currentCycle - stallStart;
+
+        if( stallReason == STALL_MSHR )
+            mshrStallCycles += stallCycles;
+        else if( stallReason == STALL_ROB )
+            robStallCycles += stallCycles;
+        else if( stallReason == STALL_MEMORY )
+            memoryStallCycles += stallCycles;
+    }
+
+    stallReason = STALL_NONE;
+}
+
+/*
+ *  Issue up to CoreIssueWidth requests this cycle. Returns the number of
+ *  requests sent to memory.
+ */
+ncounter_t TraceCore::Issue( NVMObject_hook *memory, ncycle_t currentCycle )
+{
+    ncounter_t issued = 0;
+
+    while( issued < issueWidth )
+    {
+        if( !lineValid && !FetchLine( ) )
+            break;
+
+        /* Still executing the non-memory instructions before this access. */
+        if( currentCycle < readyCycle )
+            break;
+
+        StallReason reason = CheckStall( );
+        NVMainRequest *request = NULL;
+
+        if( reason == STALL_NONE )
+        {
+            request = new NVMainRequest( );
+
+            request->address = nextLine->GetAddress( );
+            request->type = nextLine->GetOperation( );
+            request->bulkCmd = CMD_NOP;
+            request->threadId = static_cast<ncounters_t>( coreId );
+            request->programCounter = nextLine->get_program_counter( );
+            if( !ignoreData ) request->data = nextLine->GetData( );
+            if( !ignoreData ) request->oldData = nextLine->GetOldData( );
+            request->status = MEM_REQUEST_INCOMPLETE;
+            request->owner = this;
+
+            if( !memory->IsIssuable( request ) )
+            {
+                delete request;
+                request = NULL;
+                reason = STALL_MEMORY;
+            }
+        }
+
+        if( reason != STALL_NONE )
+        {
+            if( stallReason != reason )
+            {
+                EndStall( currentCycle );
+                stallReason = reason;
+                stallStart = currentCycle;
+            }
+
+            break;
+        }
+
+        EndStall( currentCycle );
+
+        if( request->type == READ )
+        {
+            reads++;
+            outstandingReads.insert( lastPosition );
+        }
+        else
+        {
+            writes++;
+        }
+
+        /* The controller reuses issueCycle for its own clock, so keep ours. */
+        inflightPosition.insert( std::pair<NVMainRequest *, ncycle_t>( request, lastPosition ) );
+        inflightIssueCycle.insert( std::pair<NVMainRequest *, ncycle_t>( request, currentCycle ) );
+
+        outstanding++;
+        if( outstanding > peakOutstanding )
+            peakOutstanding = outstanding;
+
+        memory->IssueCommand( request );
+
+        lastIssueCycle = currentCycle;
+        lastActiveCycle = currentCycle;
+        lineValid = false;
+        issued++;
+    }
+
+    return issued;
+}
+
+/*
+ *  Earliest cycle this core may issue again. If the core is waiting on
+ *  memory, the next wakeup is driven by RequestComplete instead.
+ */
+ncycle_t TraceCore::NextIssueCycle( ncycle_t currentCycle )
+{
+    ncycle_t rv = std::numeric_limits<ncycle_t>::max( );
+
+    if( !lineValid )
+    {
+        /* Trace not started or exhausted. */
+        if( !traceEnded )
+            rv = currentCycle + 1;
+    }
+    else if( stallReason == STALL_MEMORY )
+    {
+        /* The controller refused the request; retry next cycle. */
+        rv = currentCycle + 1;
+    }
+    else if( stallReason == STALL_NONE )
+    {
+        rv = ( readyCycle > currentCycle ) ? readyCycle : currentCycle + 1;
+    }
+
+    return rv;
+}
+
+bool TraceCore::Finished( )
+{
+    return ( traceEnded && !lineValid && outstanding == 0 );
+}
+
+bool TraceCore::TraceEnded( )
+{
+    return ( traceEnded && !lineValid );
+}
+
+ncounter_t TraceCore::Outstanding( )
+{
+    return outstanding;
+}
+
+bool TraceCore::RequestComplete( NVMainRequest *request )
+{
+    assert( request->owner == this );
+
+    /* The global event queue runs at the CPU clock the cores run at. */
+    ncycle_t completionCycle = GetGlobalEventQueue( )->GetCurrentCycle( );
+
+    std::map<NVMainRequest *, ncycle_t>::iterator it = inflightPosition.find( request );
+    assert( it != inflightPosition.end( ) );
+
+    if( request->type == READ )
+    {
+        std::multiset<ncycle_t>::iterator readIt = outstandingReads.find( it->second );
+        assert( readIt != outstandingReads.end( ) );
+        outstandingReads.erase( readIt );
+
+        ncycle_t issueCycle = inflightIssueCycle[request];
+
+        if( completionCycle > issueCycle )
+            totalReadLatency += completionCycle - issueCycle;
+        completedReads++;
+    }
+
+    inflightPosition.erase( it );
+    inflightIssueCycle.erase( request );
+
+    assert( outstanding > 0 );
+    outstanding--;
+
+    if( completionCycle > lastActiveCycle )
+        lastActiveCycle = completionCycle;
+
+    delete request;
+
+    return true;
+}
+
+void TraceCore::CalculateStats( )
+{
+    if( !started )
+        return;
+
+    EndStall( lastActiveCycle );
+
+    instructions = static_cast<ncounter_t>( 
+            static_cast<double>( lastPosition - firstPosition ) * traceIPC );
+    elapsedCycles = lastActiveCycle - firstPosition;
+
+    if( elapsedCycles > 0 )
+        ipc = static_cast<double>( instructions ) / static_cast<double>( elapsedCycles );
+
+    if( completedReads > 0 )
+        averageReadLatency = static_cast<double>( totalReadLatency ) 
+                           / static_cast<double>( completedReads );
+}
+
+void TraceCore::Cycle( ncycle_t /*steps*/ )
+{
+}
@@ -0,0 +1,175 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __TRACESIM_TRACECORE_H__
+#define __TRACESIM_TRACECORE_H__
+
+#include "src/NVMObject.h"
+#include "src/Config.h"
+#include "traceReader/GenericTraceReader.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Splits a single trace into per-core streams using the thread ID of each
+ *  trace line. Lines for other cores are buffered until that core asks for
+ *  them, so cores may run ahead or behind each other freely.
+ */
+class TraceDemultiplexer
+{
+  public:
+    TraceDemultiplexer( GenericTraceReader *reader, ncounter_t cores );
+    ~TraceDemultiplexer( );
+
+    bool GetNextAccess( ncounter_t core, TraceLine *nextAccess );
+
+  private:
+    GenericTraceReader *reader;
+    ncounter_t numCores;
+    bool traceEnded;
+    std::vector< std::deque<TraceLine *> > pendingLines;
+};
+
+/*
+ *  Trace reader front-end for one core's share of a demultiplexed trace.
+ */
+class CoreTraceReader : public GenericTraceReader
+{
+  public:
+    CoreTraceReader( TraceDemultiplexer *demux, ncounter_t core );
+    ~CoreTraceReader( );
+
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccesses );
+
+  private:
+    TraceDemultiplexer *demux;
+    ncounter_t coreId;
+    std::string traceFile;
+};
+
+/*
+ *  Closed-loop core model used by the multi-core trace frontend.
+ *
+ *  The trace cycle of each line is treated as the position of the memory
+ *  instruction in the original instruction stream. The gap between two lines
+ *  is replayed as compute time, but an access can only issue when:
+ *
+ *   - fewer than CoreMSHRs reads are outstanding, and
+ *   - it is no more than CoreROBSize instructions younger than the oldest
+ *     incomplete read (the read blocks retirement, so the ROB fills).
+ *
+ *  Writes are posted and hold no MSHR; a controller that buffers writes until
+ *  a watermark would otherwise never see the writes that release the core.
+ *  Memory latency therefore feeds back into issue timing. The ratio of trace
+ *  instructions to elapsed cycles is reported as an IPC proxy.
+ */
+class TraceCore : public NVMObject
+{
+  public:
+    TraceCore( ncounter_t id );
+    ~TraceCore( );
+
+    void SetConfig( Config *conf );
+    void SetTraceReader( GenericTraceReader *reader );
+
+    ncounter_t Issue( NVMObject_hook *memory, ncycle_t currentCycle );
+    ncycle_t NextIssueCycle( ncycle_t currentCycle );
+    bool Finished( );
+    bool TraceEnded( );
+    ncounter_t Outstanding( );
+
+    bool RequestComplete( NVMainRequest *request );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void Cycle( ncycle_t steps );
+
+  private:
+    enum StallReason { STALL_NONE, STALL_MSHR, STALL_ROB, STALL_MEMORY };
+
+    ncounter_t coreId;
+    GenericTraceReader *trace;
+    TraceLine *nextLine;
+    bool lineValid;
+    bool traceEnded;
+    bool ignoreData;
+    bool ignoreTraceCycle;
+
+    ncounter_t mshrCount;
+    ncounter_t robSize;
+    ncounter_t issueWidth;
+    double traceIPC;
+
+    ncycle_t firstPosition;
+    ncycle_t lastPosition;
+    ncycle_t lastIssueCycle;
+    ncycle_t readyCycle;
+    ncycle_t lastActiveCycle;
+    bool started;
+
+    StallReason stallReason;
+    ncycle_t stallStart;
+
+    ncounter_t outstanding;
+    std::multiset<ncycle_t> outstandingReads;
+    std::map<NVMainRequest *, ncycle_t> inflightPosition;
+    std::map<NVMainRequest *, ncycle_t> inflightIssueCycle;
+
+    bool FetchLine( );
+    StallReason CheckStall( );
+    void EndStall( ncycle_t currentCycle );
+
+    /* Stats */
+    ncounter_t reads, writes;
+    ncounter_t instructions;
+    ncycle_t elapsedCycles;
+    double ipc;
+    ncycle_t mshrStallCycles, robStallCycles, memoryStallCycles;
+    ncounter_t peakOutstanding;
+    ncounter_t completedReads;
+    ncycle_t totalReadLatency;
+    double averageReadLatency;
+};
+
+};
+
+#endif
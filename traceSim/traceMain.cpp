@@ -35,6 +35,10 @@
 #include <cmath>
 #include <stdlib.h>
 #include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "src/Interconnect.h"
 #include "Interconnect/InterconnectFactory.h"
@@ -52,38 +56,66 @@
 #include "src/EventQueue.h"
 #include "NVM/nvmain.h"
 #include "traceSim/traceMain.h"
+#include "traceSim/TraceCore.h"
 
 using namespace NVM;
 
 int main( int argc, char *argv[] )
 {
     TraceMain *traceRunner = new TraceMain( );
+    int rv = traceRunner->RunTrace( argc, argv );
+
+    delete traceRunner;
 
-    return traceRunner->RunTrace( argc, argv );
+    return rv;
 }
 
 TraceMain::TraceMain( )
 {
-
+    outstandingRequests = 0;
+    traceSource = NULL;
+    coreDemux = NULL;
+    coreTrace = NULL;
+    sweepBuffer = NULL;
+    nextSweepPoint = 0;
 }
 
 TraceMain::~TraceMain( )
 {
+    for( size_t coreIdx = 0; coreIdx < cores.size( ); coreIdx++ )
+        delete cores[coreIdx];
+
+    for( size_t readerIdx = 0; readerIdx < coreReaders.size( ); readerIdx++ )
+        delete coreReaders[readerIdx];
 
+    delete coreDemux;
+
+    /* A shared trace given by SetTraceSource is freed below. */
+    if( coreTrace != traceSource )
+        delete coreTrace;
+
+    if( traceSource != NULL )
+        delete traceSource;
+}
+
+/*
+ *  Use an already opened trace instead of creating a reader for TRACE_FILE.
+ *  TraceMain takes ownership of the reader.
+ */
+void TraceMain::SetTraceSource( GenericTraceReader *source )
+{
+    traceSource = source;
 }
 
 int TraceMain::RunTrace( int argc, char *argv[] )
 {
     Stats *stats = new Stats( );
     Config *config = new Config( );
-    GenericTraceReader *trace = NULL;
-    TraceLine *tl = new TraceLine( );
     SimInterface *simInterface = new NullInterface( );
     NVMain *nvmain = new NVMain( );
     EventQueue *mainEventQueue = new EventQueue( );
     GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
     TagGenerator *tagGenerator = new TagGenerator( 1000 );
-    bool IgnoreData = false;
 
     uint64_t simulateCycles;
     uint64_t currentCycle;
@@ -128,15 +160,21 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         }
     }
 
-    if( config->KeyExists( "StatsFile" ) )
+    /* Sweeps run each configuration on a separate TraceMain, see RunSweep. */
+    if( traceSource == NULL && config->KeyExists( "SweepFile" ) )
     {
-        statStream.open( config->GetString( "StatsFile" ).c_str(), 
-                         std::ofstream::out | std::ofstream::app );
+        int rv = RunSweep( argc, argv, config );
+
+        delete config;
+        delete stats;
+
+        return rv;
     }
 
-    if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
+    if( config->KeyExists( "StatsFile" ) )
     {
-        IgnoreData = true;
+        statStream.open( config->GetString( "StatsFile" ).c_str(), 
+                         std::ofstream::out | std::ofstream::app );
     }
 
     /*  Add any specified hooks */
@@ -173,19 +211,86 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     std::cout << "traceMain (" << (void*)(this) << ")" << std::endl;
     nvmain->PrintHierarchy( );
 
-    if( config->KeyExists( "TraceReader" ) )
-        trace = TraceReaderFactory::CreateNewTraceReader( 
-                config->GetString( "TraceReader" ) );
-    else
-        trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
-
-    trace->SetTraceFile( argv[2] );
+    /* Warm state (row buffers, caches, wear) from an earlier run. */
+    if( config->KeyExists( "CheckpointDirectory" ) 
+        && config->KeyExists( "CheckpointRestore" ) 
+        && config->GetBool( "CheckpointRestore" ) )
+    {
+        nvmain->RestoreCheckpoint( config->GetString( "CheckpointDirectory" ) );
+    }
 
     if( argc == 3 )
         simulateCycles = 0;
     else
         simulateCycles = atoi( argv[3] );
 
+    /* The closed-loop frontend replays one stream per core with MLP limits. */
+    if( config->KeyExists( "TraceFrontend" ) 
+        && config->GetString( "TraceFrontend" ) == "ClosedLoop" )
+    {
+        currentCycle = RunClosedLoop( config, argv[2], simulateCycles );
+    }
+    else
+    {
+        currentCycle = RunOpenLoop( config, argv[2], simulateCycles );
+    }
+
+    if( config->KeyExists( "CheckpointDirectory" ) 
+        && config->KeyExists( "CheckpointCreate" ) 
+        && config->GetBool( "CheckpointCreate" ) )
+    {
+        if( outstandingRequests > 0 )
+            std::cout << "Warning: Checkpointing with " << outstandingRequests
+                      << " requests in-flight." << std::endl;
+
+        nvmain->CreateCheckpoint( config->GetString( "CheckpointDirectory" ) );
+    }
+
+    GetChild( )->CalculateStats( );
+    std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
+    stats->PrintAll( refStream );
+
+    std::cout << "Exiting at cycle " << currentCycle << " because simCycles " 
+        << simulateCycles << " reached." << std::endl; 
+    if( outstandingRequests > 0 )
+        std::cout << "Note: " << outstandingRequests << " requests still in-flight."
+                  << std::endl;
+
+    delete config;
+    delete stats;
+
+    return 0;
+}
+
+/*
+ *  Replay a single trace open-loop. Requests are issued at their trace cycle
+ *  and the trace only stalls when the memory controller refuses a request.
+ */
+ncycle_t TraceMain::RunOpenLoop( Config *config, std::string traceFile, 
+                                 uint64_t& simulateCycles )
+{
+    GenericTraceReader *trace = NULL;
+    TraceLine *tl = new TraceLine( );
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    bool IgnoreData = false;
+    uint64_t currentCycle;
+
+    if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
+    {
+        IgnoreData = true;
+    }
+
+    if( traceSource != NULL )
+        trace = traceSource;
+    else if( config->KeyExists( "TraceReader" ) )
+        trace = TraceReaderFactory::CreateNewTraceReader( 
+                config->GetString( "TraceReader" ) );
+    else
+        trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+    trace->SetConfig( config );
+    trace->SetTraceFile( traceFile );
+
     std::cout << "*** Simulating " << simulateCycles << " input cycles. (";
 
     /*
@@ -229,6 +334,7 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         request->type = tl->GetOperation( );
         request->bulkCmd = CMD_NOP;
         request->threadId = tl->GetThreadId( );
+        request->programCounter = tl->get_program_counter( );
         if( !IgnoreData ) request->data = tl->GetData( );
         if( !IgnoreData ) request->oldData = tl->GetOldData( );
         request->status = MEM_REQUEST_INCOMPLETE;
@@ -240,8 +346,9 @@ int TraceMain::RunTrace( int argc, char *argv[] )
          */
         if( config->KeyExists( "IgnoreTraceCycle" ) 
                 && config->GetString( "IgnoreTraceCycle" ) == "true" )
-            tl->SetLine( tl->GetAddress( ), tl->GetOperation( ), 0, 
-                         tl->GetData( ), tl->GetOldData( ), tl->GetThreadId( ) );
+            tl->SetLine( tl->GetAddress( ), tl->get_program_counter( ),
+                         tl->GetOperation( ), 0, tl->GetData( ), 
+                         tl->GetOldData( ), tl->GetThreadId( ) );
 
         if( request->type != READ && request->type != WRITE )
             std::cout << "traceMain: Unknown Operation: " << request->type 
@@ -294,24 +401,321 @@ int TraceMain::RunTrace( int argc, char *argv[] )
             if( currentCycle >= simulateCycles && simulateCycles != 0 )
                 break;
         }
-    }       
+    }
 
-    GetChild( )->CalculateStats( );
-    std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
-    stats->PrintAll( refStream );
+    delete tl;
+    if( trace != traceSource )
+        delete trace;
 
-    std::cout << "Exiting at cycle " << currentCycle << " because simCycles " 
-        << simulateCycles << " reached." << std::endl; 
-    if( outstandingRequests > 0 )
-        std::cout << "Note: " << outstandingRequests << " requests still in-flight."
-                  << std::endl;
+    return currentCycle;
+}
 
-    delete config;
-    delete stats;
+/*
+ *  Replay the trace closed-loop on one or more cores. The trace file is either
+ *  a comma separated list with one trace per core, or a single trace that is
+ *  split across TraceCores cores by thread ID. Cycles are given in CPU cycles.
+ */
+ncycle_t TraceMain::RunClosedLoop( Config *config, std::string traceFile, 
+                                   uint64_t& simulateCycles )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    std::vector<std::string> traceFiles;
+    std::string readerName = "NVMainTrace";
+    ncounter_t numCores = 1;
+
+    if( config->KeyExists( "TraceReader" ) )
+        readerName = config->GetString( "TraceReader" );
+
+    std::istringstream traceList( traceFile );
+    std::string fileName;
+
+    while( std::getline( traceList, fileName, ',' ) )
+    {
+        if( fileName != "" )
+            traceFiles.push_back( fileName );
+    }
+
+    if( traceFiles.size( ) > 1 && traceSource == NULL )
+    {
+        numCores = traceFiles.size( );
+
+        for( ncounter_t coreIdx = 0; coreIdx < numCores; coreIdx++ )
+        {
+            GenericTraceReader *reader = TraceReaderFactory::CreateNewTraceReader( readerName );
+            reader->SetConfig( config );
+            reader->SetTraceFile( traceFiles[coreIdx] );
+            coreReaders.push_back( reader );
+        }
+    }
+    else
+    {
+        if( config->KeyExists( "TraceCores" ) )
+            numCores = static_cast<ncounter_t>( config->GetValue( "TraceCores" ) );
+
+        if( traceSource != NULL )
+            coreTrace = traceSource;
+        else
+            coreTrace = TraceReaderFactory::CreateNewTraceReader( readerName );
+
+        coreTrace->SetConfig( config );
+        coreTrace->SetTraceFile( traceFile );
+        coreDemux = new TraceDemultiplexer( coreTrace, numCores );
+
+        for( ncounter_t coreIdx = 0; coreIdx < numCores; coreIdx++ )
+            coreReaders.push_back( new CoreTraceReader( coreDemux, coreIdx ) );
+    }
+
+    for( ncounter_t coreIdx = 0; coreIdx < numCores; coreIdx++ )
+    {
+        std::stringstream coreName;
+        TraceCore *core = new TraceCore( coreIdx );
+
+        coreName << "core" << coreIdx;
+        core->StatName( coreName.str( ) );
+        core->SetParent( this );
+        core->SetConfig( config );
+        core->SetTraceReader( coreReaders[coreIdx] );
+        core->RegisterStats( );
+
+        cores.push_back( core );
+    }
+
+    std::cout << "*** Simulating " << numCores << " closed-loop cores for " 
+        << simulateCycles << " CPU cycles ***" << std::endl;
+
+    ncycle_t currentCycle = globalEventQueue->GetCurrentCycle( );
+    bool draining = false;
+
+    while( currentCycle < simulateCycles || simulateCycles == 0 )
+    {
+        bool finished = true;
+        bool tracesEnded = true;
+        ncycle_t nextWakeup = std::numeric_limits<ncycle_t>::max( );
+
+        for( ncounter_t coreIdx = 0; coreIdx < numCores; coreIdx++ )
+        {
+            cores[coreIdx]->Issue( GetChild( ), currentCycle );
+
+            finished = finished && cores[coreIdx]->Finished( );
+            tracesEnded = tracesEnded && cores[coreIdx]->TraceEnded( );
+            nextWakeup = MIN( nextWakeup, cores[coreIdx]->NextIssueCycle( currentCycle ) );
+        }
+
+        if( finished )
+            break;
+
+        /* Force all modules to drain requests once every trace is consumed. */
+        if( tracesEnded && !draining )
+            draining = Drain( );
+
+        /* Skip ahead to the next core wakeup or memory event. */
+        nextWakeup = MIN( nextWakeup, globalEventQueue->GetNextEvent( ) );
+
+        ncycle_t steps = 1;
+        if( nextWakeup != std::numeric_limits<ncycle_t>::max( ) 
+            && nextWakeup > currentCycle + 1 )
+            steps = nextWakeup - currentCycle;
+
+        if( simulateCycles != 0 && currentCycle + steps > simulateCycles )
+            steps = simulateCycles - currentCycle;
+
+        globalEventQueue->Cycle( steps );
+        currentCycle = globalEventQueue->GetCurrentCycle( );
+    }
+
+    for( ncounter_t coreIdx = 0; coreIdx < numCores; coreIdx++ )
+    {
+        cores[coreIdx]->CalculateStats( );
+        outstandingRequests += cores[coreIdx]->Outstanding( );
+    }
+
+    return currentCycle;
+}
+
+/*
+ *  Run every configuration listed in SweepFile against the same trace. Each
+ *  line of the sweep file holds PARAM=value overrides applied on top of the
+ *  base configuration and command line. The trace is decoded once into a
+ *  shared buffer and the configurations are simulated on SweepThreads
+ *  threads, each with its own TraceMain (and thus its own NVMain, Stats,
+ *  EventQueue and TagGenerator). Stats go to <SweepStatsPrefix>.<N>.stats,
+ *  and <SweepStatsPrefix>.index lists the overrides of each point.
+ */
+int TraceMain::RunSweep( int argc, char *argv[], Config *config )
+{
+    std::string sweepFile = config->GetString( "SweepFile" );
+    std::ifstream sweepStream( sweepFile.c_str( ) );
+    std::string sweepLine;
+
+    if( !sweepStream.is_open( ) )
+    {
+        std::cout << "Error: Could not open sweep file `" << sweepFile 
+            << "'." << std::endl;
+        return 1;
+    }
+
+    while( std::getline( sweepStream, sweepLine ) )
+    {
+        std::istringstream lineStream( sweepLine );
+        std::vector<std::string> overrides;
+        std::string token;
+
+        while( lineStream >> token )
+        {
+            if( token[0] == ';' || token[0] == '#' )
+                break;
+
+            overrides.push_back( token );
+        }
+
+        if( !overrides.empty( ) )
+            sweepPoints.push_back( overrides );
+    }
+
+    if( sweepPoints.empty( ) )
+    {
+        std::cout << "Error: No configurations in sweep file `" << sweepFile 
+            << "'." << std::endl;
+        return 1;
+    }
+
+    for( int curArg = 0; curArg < argc; ++curArg )
+        sweepArgs.push_back( argv[curArg] );
+
+    sweepPrefix = "sweep";
+    if( config->KeyExists( "SweepStatsPrefix" ) )
+        sweepPrefix = config->GetString( "SweepStatsPrefix" );
+
+    size_t numThreads = std::thread::hardware_concurrency( );
+    if( config->KeyExists( "SweepThreads" ) )
+        numThreads = static_cast<size_t>( config->GetValue( "SweepThreads" ) );
+
+    if( numThreads == 0 )
+        numThreads = 1;
+    if( numThreads > sweepPoints.size( ) )
+        numThreads = sweepPoints.size( );
+
+    /* Decode the trace once. Lines past the simulated cycles are never used. */
+    GenericTraceReader *reader = NULL;
+    ncycle_t lastCycle = atoi( argv[3] );
+    bool ignoreData = false;
+
+    if( config->KeyExists( "TraceReader" ) )
+        reader = TraceReaderFactory::CreateNewTraceReader( 
+                config->GetString( "TraceReader" ) );
+    else
+        reader = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+    if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
+        ignoreData = true;
+
+    if( config->KeyExists( "IgnoreTraceCycle" ) 
+            && config->GetString( "IgnoreTraceCycle" ) == "true" )
+        lastCycle = 0;
+
+    /*
+     *  Open-loop runs scale the input cycles to memory cycles, which are the
+     *  cycles of the trace lines. Keep enough lines for the point with the
+     *  largest scale, as points may override CPUFreq or CLK.
+     */
+    double cycleScale = 1.0;
+
+    for( size_t point = 0; point < sweepPoints.size( ); point++ )
+    {
+        double cpuFreq = static_cast<double>( config->GetValue( "CPUFreq" ) );
+        double clk = static_cast<double>( config->GetValue( "CLK" ) );
+
+        for( size_t i = 0; i < sweepPoints[point].size( ); i++ )
+        {
+            const std::string& token = sweepPoints[point][i];
+
+            if( token.compare( 0, 8, "CPUFreq=" ) == 0 )
+                cpuFreq = atof( token.substr( 8 ).c_str( ) );
+            else if( token.compare( 0, 4, "CLK=" ) == 0 )
+                clk = atof( token.substr( 4 ).c_str( ) );
+        }
+
+        if( clk > 0.0 && cpuFreq / clk > cycleScale )
+            cycleScale = cpuFreq / clk;
+    }
+
+    lastCycle = (ncycle_t)ceil( cycleScale * (double)lastCycle );
+
+    reader->SetConfig( config );
+    reader->SetTraceFile( argv[2] );
+
+    sweepBuffer = new TraceBuffer( );
+    sweepBuffer->Load( reader, ignoreData, lastCycle );
+
+    delete reader;
+
+    std::cout << "*** Sweeping " << sweepPoints.size( ) << " configurations on " 
+        << numThreads << " threads with " << sweepBuffer->GetLineCount( ) 
+        << " trace lines ***" << std::endl;
+
+    /* Start from empty stat files since RunTrace appends to StatsFile. */
+    std::ofstream indexStream( ( sweepPrefix + ".index" ).c_str( ) );
+
+    for( size_t point = 0; point < sweepPoints.size( ); point++ )
+    {
+        std::ofstream statStream( SweepStatsFile( point ).c_str( ), std::ofstream::trunc );
+
+        indexStream << SweepStatsFile( point );
+        for( size_t i = 0; i < sweepPoints[point].size( ); i++ )
+            indexStream << " " << sweepPoints[point][i];
+        indexStream << std::endl;
+    }
+
+    nextSweepPoint = 0;
+
+    std::vector<std::thread> workers;
+
+    for( size_t thread = 0; thread < numThreads; thread++ )
+        workers.push_back( std::thread( &TraceMain::SweepWorker, this ) );
+
+    for( size_t thread = 0; thread < numThreads; thread++ )
+        workers[thread].join( );
+
+    delete sweepBuffer;
+    sweepBuffer = NULL;
 
     return 0;
 }
 
+void TraceMain::SweepWorker( )
+{
+    size_t point;
+
+    while( ( point = nextSweepPoint++ ) < sweepPoints.size( ) )
+    {
+        std::vector<std::string> pointArgs( sweepArgs );
+        std::vector<char *> pointArgv;
+
+        pointArgs.insert( pointArgs.end( ), sweepPoints[point].begin( ), 
+                          sweepPoints[point].end( ) );
+        pointArgs.push_back( "StatsFile=" + SweepStatsFile( point ) );
+
+        for( size_t i = 0; i < pointArgs.size( ); i++ )
+            pointArgv.push_back( const_cast<char *>( pointArgs[i].c_str( ) ) );
+
+        TraceMain *runner = new TraceMain( );
+
+        runner->SetTraceSource( new BufferTraceReader( sweepBuffer ) );
+        runner->RunTrace( static_cast<int>( pointArgv.size( ) ), &pointArgv[0] );
+
+        delete runner;
+    }
+}
+
+std::string TraceMain::SweepStatsFile( size_t point )
+{
+    std::stringstream fileName;
+
+    fileName << sweepPrefix << "." << point << ".stats";
+
+    return fileName.str( );
+}
+
 void TraceMain::Cycle( ncycle_t /*steps*/ )
 {
 
@@ -319,6 +723,10 @@ void TraceMain::Cycle( ncycle_t /*steps*/ )
 
 bool TraceMain::RequestComplete( NVMainRequest* request )
 {
+    /* Requests issued by the closed-loop cores are returned to their core. */
+    if( request->owner != this )
+        return request->owner->RequestComplete( request );
+
     /* This is the top-level module, so there are no more parents to fallback. */
     assert( request->owner == this );
 
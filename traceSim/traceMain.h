@@ -37,7 +37,14 @@
 #define __TRACESIM_TRACEMAIN_H__
 
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "src/NVMObject.h"
+#include "src/Config.h"
+#include "traceSim/TraceCore.h"
+#include "traceReader/BufferTrace/BufferTraceReader.h"
 
 
 namespace NVM {
@@ -51,12 +58,37 @@ class TraceMain : public NVMObject
 
     int RunTrace( int argc, char *argv[] );
 
+    void SetTraceSource( GenericTraceReader *source );
+
     void Cycle( ncycle_t steps );
 
     bool RequestComplete( NVMainRequest *request );
 
   private:
     ncounter_t outstandingRequests;
+    std::vector<TraceCore *> cores;
+    GenericTraceReader *traceSource;
+
+    /* Closed-loop readers of the cores, freed along with the cores. */
+    std::vector<GenericTraceReader *> coreReaders;
+    TraceDemultiplexer *coreDemux;
+    GenericTraceReader *coreTrace;
+
+    /* Sweep state shared by all worker threads. */
+    std::vector< std::vector<std::string> > sweepPoints;
+    std::vector<std::string> sweepArgs;
+    std::string sweepPrefix;
+    TraceBuffer *sweepBuffer;
+    std::atomic<size_t> nextSweepPoint;
+
+    ncycle_t RunOpenLoop( Config *config, std::string traceFile, 
+                          uint64_t& simulateCycles );
+    ncycle_t RunClosedLoop( Config *config, std::string traceFile, 
+                            uint64_t& simulateCycles );
+
+    int RunSweep( int argc, char *argv[], Config *config );
+    void SweepWorker( );
+    std::string SweepStatsFile( size_t point );
 };
 
 
@@ -255,6 +255,13 @@ void DRAMPower2TraceWriter::WriteTraceLine( std::ostream& stream, TraceLine *lin
             pdState = DRAMPower2TraceWriter::PDN_S_PRE;
             break;
         }
+        case POWERDOWN_SREF:
+        {
+            stream << (line->GetCycle() - lastCommand) << ",SREN,0" << std::endl;
+            lastCommand = line->GetCycle();
+            pdState = DRAMPower2TraceWriter::SREF;
+            break;
+        }
         case POWERUP:
         {
             if( pdState == DRAMPower2TraceWriter::PDN_F_ACT )
@@ -266,6 +273,10 @@ void DRAMPower2TraceWriter::WriteTraceLine( std::ostream& stream, TraceLine *lin
             {
                 stream << (line->GetCycle() - lastCommand) << ",PDN_S_PRE,0" << std::endl;
             }
+            else if( pdState == DRAMPower2TraceWriter::SREF )
+            {
+                stream << (line->GetCycle() - lastCommand) << ",SREX,0" << std::endl;
+            }
             else
             {
                 std::cerr << "DRAMPower2TraceWriter: Unknown powerdown state" << std::endl;
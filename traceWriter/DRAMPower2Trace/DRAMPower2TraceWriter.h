@@ -58,7 +58,7 @@ class DRAMPower2TraceWriter : public GenericTraceWriter
     bool SetNextAccess( TraceLine *nextAccess );
   
   private:
-    enum pdStates { PUP, PDN_F_ACT, PDN_F_PRE, PDN_S_PRE }; 
+    enum pdStates { PUP, PDN_F_ACT, PDN_F_PRE, PDN_S_PRE, SREF }; 
     
     pdStates pdState;
 
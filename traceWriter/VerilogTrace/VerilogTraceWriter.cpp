@@ -199,6 +199,7 @@ void VerilogTraceWriter::WriteTraceLine( std::ostream& stream, TraceLine *line )
         case POWERDOWN_PDA:
         case POWERDOWN_PDPF:
         case POWERDOWN_PDPS:
+        case POWERDOWN_SREF:
         {
             stream << "        power_down(" << (line->GetCycle() - lastCommand) 
                    << ");" << std::endl;